@@ -0,0 +1,59 @@
+"""Chunked replay of one long recording against a single-threaded replay.
+
+    python3 bench_chunked_replay.py [hours] [warmup_windows]
+
+Builds a synthetic session (rest and tremor minutes, as in test_pd_detect),
+replays it once with pd_detect.run(learning=False) and then with
+pd_detect.run_chunked() on 1, 2, 4 and 8 threads, checking that every run
+returns the same windows. Each chunk replays warmup_windows ahead of its
+start, and a boundary that does not reconcile is replayed on one thread
+until it meets the worker's state, so "bound" is the speed-up the window
+counts allow with one core per thread: windows / (largest segment +
+warm-up + replayed windows). "speedup" is what this machine measured; it
+can only approach the bound with as many free cores as threads.
+"""
+
+import os
+import sys
+import time
+from array import array
+
+import pd_detect
+from test_pd_detect import recording
+
+
+def timed(fn):
+    start = time.perf_counter()
+    result = fn()
+    return time.perf_counter() - start, result
+
+
+def main(argv):
+    hours = float(argv[0]) if argv else 48.0
+    warmup = int(argv[1]) if len(argv) > 1 else 0
+
+    # A pool of distinct minutes repeated over the session
+    pool = [recording(60, 4.8, 40.0 if m % 2 else 0.0, seed=m) for m in range(20)]
+    samples = array("h")
+    for minute in range(int(hours * 60)):
+        samples.extend(pool[minute % len(pool)])
+    windows = len(samples) // 6 // 156
+
+    elapsed, reference = timed(lambda: pd_detect.run(samples, learning=False))
+    print("%.1f h, %d windows, %d cores" % (hours, windows, os.cpu_count() or 1))
+    print("%-12s %8s %12s %8s %8s %9s %11s %9s %8s" % (
+        "replay", "s", "windows/s", "speedup", "bound", "segments", "reconciled", "replayed", "windows"))
+    print("%-12s %8.2f %12.0f %8s %8s" % ("sequential", elapsed, windows / elapsed, "x1.00", "x1.00"))
+    for threads in (1, 2, 4, 8):
+        t, (out, stats) = timed(lambda: pd_detect.run_chunked(samples, threads=threads, warmup_windows=warmup))
+        segment = -(-windows // threads)
+        longest = segment + (min(warmup or pd_detect.chunk_warmup_windows, windows - segment) if threads > 1 else 0)
+        print("%-12s %8.2f %12.0f %8s %8s %9d %11d %9d %8d%s" % (
+            "%d thread%s" % (threads, "s" if threads > 1 else ""), t, windows / t, "x%.2f" % (elapsed / t),
+            "x%.2f" % (windows / (longest + stats["replayed_windows"])),
+            stats["segments"], stats["reconciled"], stats["replayed"], stats["replayed_windows"],
+            "" if out == reference else "   MISMATCH"))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,88 @@
+"""Flash log write throughput and boot recovery scan on a file-backed flash.
+
+    python3 bench_flash_log.py [hours] [path]
+
+Encodes a synthetic session (rest and tremor minutes, as in test_pd_detect)
+into IMU blocks and logs it with pd_detect.flash_write() into an 8 MB log
+file, each block followed by its window record as on the device. The
+first run costs only the host's file I/O and shows what the staging ring
+and writer thread sustain; the second emulates the QSPI part's busy times
+(about the MX25R6435F's typical page program and 4 KB sector erase), so
+"program KB/s" and "x real time" approximate the device's headroom over the
+recording rate.
+
+The boot scan remounts logs filled with increasing lengths of the session,
+up to a wrapped log. It reads one header per segment and walks the records
+of the newest segment only, so the reads stay bounded however much is
+logged; on the device each read costs a QSPI command on top of its bytes.
+"""
+
+import os
+import sys
+import tempfile
+import time
+from array import array
+
+import pd_detect
+from test_pd_detect import recording
+
+PAGE_PROGRAM_US = 850
+SECTOR_ERASE_US = 40000
+
+
+def session(hours):
+    # A pool of distinct minutes repeated over the session
+    pool = [recording(60, 4.8, 40.0 if m % 2 else 0.0, seed=m) for m in range(20)]
+    samples = array("h")
+    for minute in range(int(hours * 60)):
+        samples.extend(pool[minute % len(pool)])
+    return samples
+
+
+def fresh(path):
+    if os.path.exists(path):
+        os.remove(path)
+
+
+def main(argv):
+    hours = float(argv[0]) if argv else 1.0
+    path = argv[1] if len(argv) > 1 else os.path.join(tempfile.gettempdir(), "bench_flash_log.bin")
+
+    samples = session(hours)
+    blocks = pd_detect.encode(samples)
+    windows = len(samples) // 6 // pd_detect.window_samples
+    recorded_kbs = len(blocks) / 1024.0 / (hours * 3600)
+    print("%.2f h, %d windows, %.0f KB of IMU blocks, %.2f KB/s recorded" % (
+        hours, windows, len(blocks) / 1024.0, recorded_kbs))
+
+    print("\nwrite throughput")
+    print("%-14s %8s %9s %12s %7s %9s %8s %12s" % (
+        "flash", "s", "KB/s", "program KB/s", "erases", "erase s", "dropped", "x real time"))
+    logged_per_hour = 0
+    for name, program_us, erase_us in (("file I/O", 0, 0), ("part timing", PAGE_PROGRAM_US, SECTOR_ERASE_US)):
+        fresh(path)
+        start = time.perf_counter()
+        s = pd_detect.flash_write(path, blocks, page_program_us=program_us, block_erase_us=erase_us)
+        elapsed = time.perf_counter() - start
+        kb = s["bytes_written"] / 1024.0
+        logged_per_hour = s["bytes_written"] / hours
+        print("%-14s %8.2f %9.0f %12.0f %7d %9.2f %8d %12.0f" % (
+            name, elapsed, kb / s["seconds"], kb / (s["program_us"] / 1e6), s["erases"],
+            s["erase_us"] / 1e6, s["records_dropped"], hours * 3600 / s["seconds"]))
+
+    print("\nboot scan")
+    print("%-9s %9s %10s %8s %9s %9s %8s" % (
+        "logged h", "segments", "wear", "records", "reads", "KB read", "ms"))
+    full = 8 * 1024 * 1024 / logged_per_hour         # about where the log wraps
+    for logged in (0.25, 1.0, 4.0, full * 0.99, full * 2):
+        fresh(path)
+        pd_detect.flash_write(path, pd_detect.encode(session(logged)))
+        s = pd_detect.flash_mount(path)
+        print("%-9.2f %9d %10s %8d %9d %9.1f %8.2f" % (
+            logged, s["segments"], "%d-%d" % (s["min_erase_count"], s["max_erase_count"]),
+            s["scan_records"], s["reads"], s["read_bytes"] / 1024.0, s["seconds"] * 1000))
+    fresh(path)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
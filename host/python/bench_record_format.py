@@ -0,0 +1,73 @@
+"""Load speed of IMU block files against CSV exports of the same recording.
+
+    python3 bench_record_format.py [minutes]
+
+Writes a synthetic recording (rest and tremor, as in test_pd_detect) as CSV
+and as compressed and raw block files in a temporary directory, then times
+getting the samples into memory from each, and a full replay from each.
+"""
+
+import os
+import sys
+import tempfile
+import time
+from array import array
+
+import pd_detect
+import record_convert
+from test_pd_detect import recording
+
+
+def best_of(runs, fn):
+    best = None
+    for _ in range(runs):
+        start = time.perf_counter()
+        fn()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None or elapsed < best else best
+    return best
+
+
+def main(argv):
+    minutes = float(argv[0]) if argv else 60.0
+    samples = array("h")
+    for segment in range(int(minutes)):
+        samples.extend(recording(60, 4.8, 40.0 if segment % 2 else 0.0, seed=segment))
+    n = len(samples) // 6
+    sample_mb = len(samples) * 2 / 1e6
+
+    with tempfile.TemporaryDirectory() as tmp:
+        paths = {
+            "csv": os.path.join(tmp, "session.csv"),
+            "blocks": os.path.join(tmp, "session.imu"),
+            "blocks, raw": os.path.join(tmp, "session_raw.imu"),
+        }
+        record_convert.write_csv(paths["csv"], samples)
+        record_convert.main([paths["csv"], paths["blocks"]])
+        record_convert.main(["--raw", paths["csv"], paths["blocks, raw"]])
+
+        loaders = {
+            "csv": lambda p: record_convert.read_csv(p)[0],
+            "blocks": lambda p: pd_detect.decode(record_convert.map_blocks(p)),
+            "blocks, raw": lambda p: pd_detect.decode(record_convert.map_blocks(p)),
+        }
+        replays = {
+            "csv": lambda p: pd_detect.run(record_convert.read_csv(p)[0]),
+            "blocks": lambda p: pd_detect.run_blocks(record_convert.map_blocks(p)),
+            "blocks, raw": lambda p: pd_detect.run_blocks(record_convert.map_blocks(p)),
+        }
+
+        print("%.0f min, %d samples, %.1f MB as int16" % (minutes, n, sample_mb))
+        print("%-12s %9s %12s %13s %10s" % ("format", "file MB", "load ms", "load MB/s*", "replay s"))
+        csv_load = None
+        for name, path in paths.items():
+            load = best_of(3, lambda: loaders[name](path))
+            replay = best_of(1, lambda: replays[name](path))
+            csv_load = csv_load or load
+            print("%-12s %9.2f %12.1f %13.1f %10.2f   x%.0f" % (
+                name, os.path.getsize(path) / 1e6, load * 1e3, sample_mb / load, replay, csv_load / load))
+        print("* MB of int16 samples delivered per second")
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
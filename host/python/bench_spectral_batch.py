@@ -0,0 +1,68 @@
+"""Throughput of the batched spectral front end on each SIMD kernel.
+
+    python3 bench_spectral_batch.py [windows]
+
+Builds float32 accel and gyro magnitude windows (a 3.6-6.8 Hz tone over
+walking-rate motion and noise), runs pd_detect.spectra() on every kernel
+the CPU supports and reports windows per second, checking that all kernels
+return the same bytes. For scale, pd_detect.run() replays the whole
+pipeline, of which this front end is one stage.
+"""
+
+import math
+import random
+import sys
+import time
+from array import array
+
+import pd_detect
+
+RATE_HZ = 52.0
+
+
+def best_of(runs, fn):
+    best = None
+    for _ in range(runs):
+        start = time.perf_counter()
+        fn()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None or elapsed < best else best
+    return best
+
+
+def magnitudes(windows, seed=1):
+    rng = random.Random(seed)
+    n = pd_detect.window_samples
+    accel, gyro = array("f"), array("f")
+    for w in range(windows):
+        tone = rng.uniform(3.6, 6.8)
+        gait = rng.uniform(1.0, 2.0)
+        for i in range(n):
+            t = (w * n + i) / RATE_HZ
+            accel.append(1.0 + 0.05 * math.sin(2 * math.pi * tone * t) + 0.03 * math.sin(2 * math.pi * gait * t)
+                         + rng.uniform(-0.01, 0.01))
+            gyro.append(30.0 + 20.0 * math.sin(2 * math.pi * tone * t + 0.4) + rng.uniform(-2, 2))
+    return accel, gyro
+
+
+def main(argv):
+    windows = int(argv[0]) if argv else 20000
+    accel, gyro = magnitudes(windows)
+    print("%d windows" % windows)
+    print("%-8s %10s %12s %8s" % ("kernel", "ms", "windows/s", "speedup"))
+    reference = generic = None
+    for isa in ("generic", "avx2", "avx512"):
+        try:
+            out = pd_detect.spectra(accel, gyro, isa=isa)
+        except ValueError:
+            print("%-8s %10s" % (isa, "n/a"))
+            continue
+        elapsed = best_of(5, lambda: pd_detect.spectra(accel, gyro, isa=isa))
+        reference = reference or out
+        generic = generic or elapsed
+        print("%-8s %10.1f %12.0f %8s%s" % (isa, elapsed * 1e3, windows / elapsed, "x%.2f" % (generic / elapsed),
+                                          "" if out == reference else "   MISMATCH"))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
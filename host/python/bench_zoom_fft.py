@@ -0,0 +1,94 @@
+"""Zoom spectrum of 2-8 Hz against the real FFTs it stands in for.
+
+    python3 bench_zoom_fft.py [blocks]
+
+The host counterpart of zoom_fft_benchmark() (env
+disco_l475vg_iot01a_bench). Each block is 6 s of a test tone between 3
+and 7 Hz over noise, zoom_input samples. pd_detect.zoom() mixes it down,
+decimates and takes the 256-point complex FFT; pd_detect.rfft() takes the
+1024-point real FFT of the block zero padded, which has the same 0.05 Hz
+bins over the whole 0-26 Hz, and the 512-point one, the smallest that
+holds the block. All run in C with the GIL released; the table reports
+the best of five runs and the mean and worst error of the peak bin
+against the tone.
+"""
+
+import math
+import random
+import sys
+import time
+from array import array
+
+import pd_detect
+
+RATE_HZ = 52.0
+
+
+def best_of(runs, fn):
+    best = None
+    for _ in range(runs):
+        start = time.perf_counter()
+        fn()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None or elapsed < best else best
+    return best
+
+
+def tones(blocks, seed=1):
+    rng = random.Random(seed)
+    n = pd_detect.zoom_input
+    samples, freqs = array("f"), []
+    for _ in range(blocks):
+        hz = rng.uniform(3.0, 7.0)
+        phase = rng.uniform(0, 2 * math.pi)
+        samples.extend(math.sin(2 * math.pi * hz * i / RATE_HZ + phase) + rng.uniform(-0.2, 0.2) for i in range(n))
+        freqs.append(hz)
+    return samples, freqs
+
+
+def zoom_peaks(magnitude):
+    bins = pd_detect.zoom_bins
+    lo = int(math.ceil((2.0 - pd_detect.zoom_center_hz) / pd_detect.zoom_bin_hz)) + bins // 2
+    hi = int(math.floor((8.0 - pd_detect.zoom_center_hz) / pd_detect.zoom_bin_hz)) + bins // 2
+    peaks = []
+    for b in range(len(magnitude) // bins):
+        block = magnitude[b * bins:(b + 1) * bins]
+        k = max(range(lo, hi + 1), key=lambda i: block[i])
+        peaks.append(pd_detect.zoom_center_hz + (k - bins // 2) * pd_detect.zoom_bin_hz)
+    return peaks
+
+
+def rfft_peaks(magnitude, size):
+    bins = size // 2 - 1
+    hz = RATE_HZ / size
+    lo, hi = int(math.ceil(2.0 / hz)) - 1, int(math.floor(8.0 / hz)) - 1     # bin k + 1 at k
+    peaks = []
+    for b in range(len(magnitude) // bins):
+        block = magnitude[b * bins:(b + 1) * bins]
+        peaks.append((max(range(lo, hi + 1), key=lambda k: block[k]) + 1) * hz)
+    return peaks
+
+
+def main(argv):
+    blocks = int(argv[0]) if argv else 5000
+    n = pd_detect.zoom_input
+    samples, freqs = tones(blocks)
+
+    print("%d blocks of %d samples (%.0f s)" % (blocks, n, n / RATE_HZ))
+    print("%-18s %9s %8s %10s %8s %12s %12s" % (
+        "transform", "bin Hz", "ms", "us/block", "x zoom", "mean err Hz", "max err Hz"))
+    zoom_s = best_of(5, lambda: pd_detect.zoom(samples))
+    rows = [("zoom 2-8 Hz", pd_detect.zoom_bin_hz, zoom_s, zoom_peaks(pd_detect.zoom(samples)))]
+    for size in (1024, 512):
+        elapsed = best_of(5, lambda: pd_detect.rfft(samples, size=size, length=n))
+        rows.append(("rfft %d" % size, RATE_HZ / size, elapsed,
+                     rfft_peaks(pd_detect.rfft(samples, size=size, length=n), size)))
+    for name, bin_hz, elapsed, peaks in rows:
+        errors = [abs(p - f) for p, f in zip(peaks, freqs)]
+        print("%-18s %9.3f %8.1f %10.2f %8.2f %12.3f %12.3f" % (
+            name, bin_hz, elapsed * 1e3, elapsed / blocks * 1e6, elapsed / zoom_s,
+            sum(errors) / len(errors), max(errors)))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
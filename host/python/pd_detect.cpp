@@ -0,0 +1,924 @@
+/**
+ * @file pd_detect.cpp
+ * @brief Python binding for the detection pipeline (detect_api.h)
+ *
+ *   import pd_detect
+ *   raw = numpy.load("session.npy")              # int16, (n, 6) or (6, n)
+ *   windows = pd_detect.run(raw)                 # {field: memoryview}, one value per window
+ *   tremor = numpy.asarray(windows["tremor_intensity"])
+ *
+ * Window results come back as one typed column per DetectWindow field
+ * (window_fields, in struct order), read-only memoryviews over a single
+ * copy, so numpy or array.array take them without unpacking records.
+ *
+ * Samples are read in place through the buffer protocol: any 2-D int16
+ * buffer with a sample axis and a 6-long axis, in any stride, or a flat
+ * interleaved buffer. The GIL is released while the pipeline runs. The
+ * pipeline state is thread_local in the host build, so Python threads
+ * replay concurrently, and run_batch() spreads a list of recordings over
+ * its own worker threads. run_chunked() spreads one long recording over
+ * threads in segments (detect_run_chunked), with the same windows as
+ * run(learning=False). Every call starts from detect_reset().
+ *
+ * Recordings can also be kept in the firmware's IMU block format
+ * (record_format.h): encode() packs counts into consecutive blocks,
+ * decode() unpacks them, and run_blocks() replays a block file in place,
+ * e.g. from an mmap, reading RAW16 columns without a copy.
+ *
+ * telemetry() replays with the binary telemetry stream (telemetry.h) on and
+ * returns the frames the device would have sent, for the host monitor.
+ *
+ * spectra() runs the batched spectral front end (spectral_batch.h) over
+ * float32 accel and gyro magnitude windows, on the widest SIMD kernel the
+ * CPU has unless isa= names one.
+ *
+ * wavelet(), zoom() and rfft() run single transforms of the pipeline block
+ * by block, the lifting wavelet (wavelet.h), the 2-8 Hz zoom spectrum
+ * (zoom_fft.h) and the CMSIS real FFT, so the benchmarks can time them
+ * against each other.
+ *
+ * flash_write() logs IMU blocks the way the recorder does (flash_log.h),
+ * each followed by its window record, on a file-backed NOR stand-in
+ * (FileBlockDevice), optionally with the part's program and erase times;
+ * flash_mount() remounts such a file and reports the boot recovery scan.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "detect_api.h"
+#include "config.h"
+#include "flash_log.h"
+#include "FileBlockDevice.h"
+#include "record_format.h"
+#include "spectral_batch.h"
+#include "telemetry.h"
+#include "wavelet.h"
+#include "zoom_fft.h"
+#include "arm_math.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Recording {
+    Py_buffer view;
+    const int16_t* axes[6];
+    size_t stride;
+    size_t samples;
+    std::vector<DetectWindow> windows;
+};
+
+// Axis pointers and sample stride of an int16 buffer; false with an exception set
+static bool open_recording(PyObject* obj, Recording* rec) {
+    if (PyObject_GetBuffer(obj, &rec->view, PyBUF_STRIDES | PyBUF_FORMAT) != 0) return false;
+
+    Py_buffer& v = rec->view;
+    const char* fmt = (v.format != nullptr) ? v.format : "B";
+    if (fmt[0] == '@' || fmt[0] == '=' || fmt[0] == '<') fmt++;
+    if (v.itemsize != 2 || (fmt[0] != 'h' && fmt[0] != 'H') || fmt[1] != '\0') {
+        PyErr_SetString(PyExc_TypeError, "samples must be an int16 buffer");
+        PyBuffer_Release(&v);
+        return false;
+    }
+
+    Py_ssize_t sample_step, axis_step;
+    if (v.ndim == 1 && v.shape[0] % 6 == 0) {
+        rec->samples = (size_t)(v.shape[0] / 6);
+        axis_step = v.strides[0];
+        sample_step = 6 * v.strides[0];
+    } else if (v.ndim == 2 && v.shape[1] == 6) {
+        rec->samples = (size_t)v.shape[0];
+        sample_step = v.strides[0];
+        axis_step = v.strides[1];
+    } else if (v.ndim == 2 && v.shape[0] == 6) {
+        rec->samples = (size_t)v.shape[1];
+        axis_step = v.strides[0];
+        sample_step = v.strides[1];
+    } else {
+        PyErr_SetString(PyExc_ValueError, "samples must have shape (n, 6), (6, n) or (6 * n,)");
+        PyBuffer_Release(&v);
+        return false;
+    }
+    if (sample_step <= 0 || sample_step % 2 != 0 || axis_step % 2 != 0) {
+        PyErr_SetString(PyExc_ValueError, "sample stride must be positive and int16-aligned");
+        PyBuffer_Release(&v);
+        return false;
+    }
+
+    const char* base = static_cast<const char*>(v.buf);
+    for (int axis = 0; axis < 6; axis++) {
+        rec->axes[axis] = reinterpret_cast<const int16_t*>(base + axis * axis_step);
+    }
+    rec->stride = (size_t)(sample_step / 2);
+    return true;
+}
+
+// Runs on any thread, without the GIL
+static void replay(Recording* rec, uint32_t start_ms, bool learning = true) {
+    detect_reset();
+    detect_set_learning(learning);
+    rec->windows.resize(rec->samples / WINDOW_SIZE + 1);
+    size_t n = detect_run(rec->axes, rec->stride, rec->samples, start_ms,
+                          rec->windows.data(), rec->windows.size());
+    rec->windows.resize(n < rec->windows.size() ? n : rec->windows.size());
+}
+
+// DetectWindow fields as columns, struct order, with their array typecodes
+struct DetectColumn {
+    const char* name;
+    const char* code;
+    size_t offset;
+    size_t size;
+};
+
+#define DETECT_COLUMN(member, code) \
+    {#member, code, offsetof(DetectWindow, member), sizeof(DetectWindow::member)}
+
+static const DetectColumn DETECT_COLUMNS[] = {
+    DETECT_COLUMN(window_index, "I"),
+    DETECT_COLUMN(start_sample, "I"),
+    DETECT_COLUMN(std_dev, "f"),
+    DETECT_COLUMN(tremor_freq, "f"),
+    DETECT_COLUMN(dysk_freq, "f"),
+    DETECT_COLUMN(raw_intensity, "f"),
+    DETECT_COLUMN(freeze_index, "f"),
+    DETECT_COLUMN(tremor_intensity, "H"),
+    DETECT_COLUMN(dysk_intensity, "H"),
+    DETECT_COLUMN(brady_score, "H"),
+    DETECT_COLUMN(off_score, "H"),
+    DETECT_COLUMN(steps, "H"),
+    DETECT_COLUMN(raw_detection, "B"),
+    DETECT_COLUMN(fog_state, "B"),
+    DETECT_COLUMN(quality_score, "B"),
+    DETECT_COLUMN(quality_flags, "B"),
+    DETECT_COLUMN(motor_state, "B"),
+    DETECT_COLUMN(heel_strikes, "B"),
+};
+
+#undef DETECT_COLUMN
+
+const size_t DETECT_COLUMN_COUNT = sizeof(DETECT_COLUMNS) / sizeof(DETECT_COLUMNS[0]);
+
+// One read-only typed memoryview per column
+static PyObject* windows_columns(const Recording& rec) {
+    const size_t n = rec.windows.size();
+    PyObject* columns = PyDict_New();
+    for (size_t c = 0; columns != nullptr && c < DETECT_COLUMN_COUNT; c++) {
+        const DetectColumn& col = DETECT_COLUMNS[c];
+        PyObject* bytes = PyBytes_FromStringAndSize(nullptr, (Py_ssize_t)(n * col.size));
+        PyObject* view = nullptr;
+        PyObject* typed = nullptr;
+        if (bytes != nullptr) {
+            char* out = PyBytes_AS_STRING(bytes);
+            for (size_t i = 0; i < n; i++) {
+                memcpy(out + i * col.size, reinterpret_cast<const char*>(&rec.windows[i]) + col.offset, col.size);
+            }
+            view = PyMemoryView_FromObject(bytes);
+        }
+        if (view != nullptr) typed = PyObject_CallMethod(view, "cast", "s", col.code);
+        if (typed == nullptr || PyDict_SetItemString(columns, col.name, typed) != 0) Py_CLEAR(columns);
+        Py_XDECREF(typed);
+        Py_XDECREF(view);
+        Py_XDECREF(bytes);
+    }
+    return columns;
+}
+
+static PyObject* pd_run(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"samples", "start_ms", "learning", nullptr};
+    PyObject* samples;
+    unsigned long start_ms = 0;
+    int learning = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|kp", const_cast<char**>(keywords),
+                                     &samples, &start_ms, &learning)) {
+        return nullptr;
+    }
+
+    Recording rec;
+    if (!open_recording(samples, &rec)) return nullptr;
+
+    Py_BEGIN_ALLOW_THREADS
+    replay(&rec, (uint32_t)start_ms, learning != 0);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&rec.view);
+    return windows_columns(rec);
+}
+
+static PyObject* pd_run_chunked(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"samples", "threads", "segment_windows", "warmup_windows",
+                                     "start_ms", nullptr};
+    PyObject* samples;
+    DetectChunking chunking = {};
+    unsigned long start_ms = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nnnk", const_cast<char**>(keywords),
+                                     &samples, &chunking.threads, &chunking.segment_windows,
+                                     &chunking.warmup_windows, &start_ms)) {
+        return nullptr;
+    }
+
+    Recording rec;
+    if (!open_recording(samples, &rec)) return nullptr;
+
+    DetectChunkStats stats;
+    Py_BEGIN_ALLOW_THREADS
+    rec.windows.resize(rec.samples / WINDOW_SIZE);
+    detect_run_chunked(rec.axes, rec.stride, rec.samples, (uint32_t)start_ms,
+                       rec.windows.data(), rec.windows.size(), &chunking, &stats);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&rec.view);
+    PyObject* windows = windows_columns(rec);
+    if (windows == nullptr) return nullptr;
+    return Py_BuildValue("(N{snsnsnsn})", windows, "segments", (Py_ssize_t)stats.segments,
+                         "reconciled", (Py_ssize_t)stats.reconciled, "replayed", (Py_ssize_t)stats.replayed,
+                         "replayed_windows", (Py_ssize_t)stats.replayed_windows);
+}
+
+static PyObject* pd_run_batch(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"recordings", "threads", "start_ms", "learning", nullptr};
+    PyObject* list;
+    int threads = 0;
+    unsigned long start_ms = 0;
+    int learning = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ikp", const_cast<char**>(keywords),
+                                     &list, &threads, &start_ms, &learning)) {
+        return nullptr;
+    }
+
+    PyObject* seq = PySequence_Fast(list, "recordings must be a sequence");
+    if (seq == nullptr) return nullptr;
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(seq);
+
+    std::vector<Recording> recs((size_t)count);
+    Py_ssize_t opened = 0;
+    for (; opened < count; opened++) {
+        if (!open_recording(PySequence_Fast_GET_ITEM(seq, opened), &recs[(size_t)opened])) break;
+    }
+    if (opened < count) {
+        for (Py_ssize_t i = 0; i < opened; i++) PyBuffer_Release(&recs[(size_t)i].view);
+        Py_DECREF(seq);
+        return nullptr;
+    }
+
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads > count) threads = (int)count;
+    if (threads < 1) threads = 1;
+
+    Py_BEGIN_ALLOW_THREADS
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < recs.size(); i = next++) {
+            replay(&recs[i], (uint32_t)start_ms, learning != 0);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+    Py_END_ALLOW_THREADS
+
+    PyObject* result = PyList_New(count);
+    for (Py_ssize_t i = 0; i < count; i++) {
+        PyBuffer_Release(&recs[(size_t)i].view);
+        PyObject* item = (result != nullptr) ? windows_columns(recs[(size_t)i]) : nullptr;
+        if (item == nullptr) {
+            Py_CLEAR(result);
+            continue;
+        }
+        PyList_SET_ITEM(result, i, item);
+    }
+    Py_DECREF(seq);
+    return result;
+}
+
+// IMU blocks: WINDOW_SIZE samples each, the last one possibly shorter
+static PyObject* pd_encode(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"samples", "compress", "start_ms", nullptr};
+    PyObject* samples;
+    int compress = 1;
+    unsigned long start_ms = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pk", const_cast<char**>(keywords),
+                                     &samples, &compress, &start_ms)) {
+        return nullptr;
+    }
+
+    Recording rec;
+    if (!open_recording(samples, &rec)) return nullptr;
+
+    size_t blocks = (rec.samples + WINDOW_SIZE - 1) / WINDOW_SIZE;
+    std::vector<uint32_t> out((blocks * imu_block_max_size(WINDOW_SIZE)) / 4 + 1);
+    size_t used = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    int16_t columns[IMU_AXES][WINDOW_SIZE];
+    const int16_t* column_ptrs[IMU_AXES];
+    uint8_t* base = reinterpret_cast<uint8_t*>(out.data());
+    for (size_t first = 0; first < rec.samples; first += WINDOW_SIZE) {
+        uint16_t n = (uint16_t)((rec.samples - first < WINDOW_SIZE) ? rec.samples - first : WINDOW_SIZE);
+        for (int axis = 0; axis < IMU_AXES; axis++) {
+            for (uint16_t i = 0; i < n; i++) columns[axis][i] = rec.axes[axis][(first + i) * rec.stride];
+            column_ptrs[axis] = columns[axis];
+        }
+        uint32_t t = (uint32_t)start_ms + (uint32_t)(first * 1000.0 / TARGET_SAMPLE_RATE_HZ);
+        used += imu_block_encode(column_ptrs, n, (uint32_t)first, t, compress != 0,
+                                 base + used, out.size() * 4 - used);
+    }
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&rec.view);
+    return PyBytes_FromStringAndSize(reinterpret_cast<const char*>(out.data()), (Py_ssize_t)used);
+}
+
+struct BlockFile {
+    Py_buffer view;
+    std::vector<uint32_t> aligned;          // copy, only if the buffer is not 4-byte aligned
+    std::vector<const ImuBlockHeader*> blocks;
+    size_t samples;
+};
+
+// Validate and index every block; false with an exception set
+static bool open_blocks(PyObject* obj, BlockFile* file) {
+    if (PyObject_GetBuffer(obj, &file->view, PyBUF_SIMPLE) != 0) return false;
+
+    const uint8_t* data = static_cast<const uint8_t*>(file->view.buf);
+    size_t size = (size_t)file->view.len;
+    if (((uintptr_t)data & 3) != 0) {
+        file->aligned.resize(size / 4 + 1);
+        memcpy(file->aligned.data(), data, size);
+        data = reinterpret_cast<const uint8_t*>(file->aligned.data());
+    }
+
+    file->samples = 0;
+    for (size_t offset = 0; offset < size;) {
+        const ImuBlockHeader* hdr = imu_block_view(data + offset, size - offset);
+        if (hdr == nullptr) {
+            PyErr_Format(PyExc_ValueError, "no valid IMU block at byte %zu", offset);
+            PyBuffer_Release(&file->view);
+            return false;
+        }
+        file->blocks.push_back(hdr);
+        file->samples += hdr->sample_count;
+        offset += imu_block_size(hdr);
+    }
+    return true;
+}
+
+// Column pointers for one block: in place for RAW16, decoded into scratch otherwise
+static void block_columns(const ImuBlockHeader* hdr, int16_t scratch[IMU_AXES][UINT16_MAX],
+                          const int16_t* axes[IMU_AXES]) {
+    for (int axis = 0; axis < IMU_AXES; axis++) {
+        axes[axis] = imu_block_column(hdr, (ImuAxis)axis);
+        if (axes[axis] == nullptr) {
+            imu_block_decode_column(hdr, (ImuAxis)axis, scratch[axis]);
+            axes[axis] = scratch[axis];
+        }
+    }
+}
+
+static PyObject* pd_decode(PyObject*, PyObject* args) {
+    PyObject* obj;
+    if (!PyArg_ParseTuple(args, "O", &obj)) return nullptr;
+
+    BlockFile file;
+    if (!open_blocks(obj, &file)) return nullptr;
+
+    PyObject* result = PyBytes_FromStringAndSize(nullptr, (Py_ssize_t)(file.samples * IMU_AXES * sizeof(int16_t)));
+    if (result != nullptr) {
+        int16_t* out = reinterpret_cast<int16_t*>(PyBytes_AS_STRING(result));
+        Py_BEGIN_ALLOW_THREADS
+        std::vector<int16_t> scratch((size_t)IMU_AXES * UINT16_MAX);
+        auto columns = reinterpret_cast<int16_t (*)[UINT16_MAX]>(scratch.data());
+        const int16_t* axes[IMU_AXES];
+        for (const ImuBlockHeader* hdr : file.blocks) {
+            block_columns(hdr, columns, axes);
+            for (uint16_t i = 0; i < hdr->sample_count; i++) {
+                for (int axis = 0; axis < IMU_AXES; axis++) *out++ = axes[axis][i];
+            }
+        }
+        Py_END_ALLOW_THREADS
+    }
+    PyBuffer_Release(&file.view);
+    return result;
+}
+
+static PyObject* pd_run_blocks(PyObject*, PyObject* args) {
+    PyObject* obj;
+    if (!PyArg_ParseTuple(args, "O", &obj)) return nullptr;
+
+    BlockFile file;
+    if (!open_blocks(obj, &file)) return nullptr;
+
+    Recording rec;
+    Py_BEGIN_ALLOW_THREADS
+    std::vector<int16_t> scratch((size_t)IMU_AXES * UINT16_MAX);
+    auto columns = reinterpret_cast<int16_t (*)[UINT16_MAX]>(scratch.data());
+    const int16_t* axes[IMU_AXES];
+    size_t n = 0;
+
+    // A fresh pipeline completes at most one window per WINDOW_SIZE samples
+    rec.windows.resize(file.samples / WINDOW_SIZE + 1);
+    detect_reset();
+    for (const ImuBlockHeader* hdr : file.blocks) {
+        block_columns(hdr, columns, axes);
+        n += detect_run(axes, 1, hdr->sample_count, hdr->timestamp_ms,
+                        rec.windows.data() + n, rec.windows.size() - n);
+    }
+    rec.windows.resize(n);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&file.view);
+    return windows_columns(rec);
+}
+
+// Port stand-in that keeps what the telemetry stream writes
+class FrameCapture : public FileHandle {
+public:
+    std::string frames;
+
+    ssize_t write(const void* buffer, size_t size) override {
+        frames.append(static_cast<const char*>(buffer), size);
+        return (ssize_t)size;
+    }
+    ssize_t read(void*, size_t) override { return 0; }
+    off_t seek(off_t, int) override { return -ESPIPE; }
+    int close() override { return 0; }
+};
+
+// One second of samples at a time, with the main loop's health service in between
+static void replay_telemetry(Recording* rec, uint32_t start_ms, FrameCapture* capture) {
+    const size_t chunk = (size_t)TARGET_SAMPLE_RATE_HZ;
+    const int16_t* axes[IMU_AXES];
+
+    detect_reset();
+    telemetry_console(capture);
+    telemetry_set_active(true);
+    for (size_t first = 0; first < rec->samples; first += chunk) {
+        size_t n = (rec->samples - first < chunk) ? rec->samples - first : chunk;
+        for (int axis = 0; axis < IMU_AXES; axis++) axes[axis] = rec->axes[axis] + first * rec->stride;
+        uint32_t t = start_ms + (uint32_t)(first * 1000.0 / TARGET_SAMPLE_RATE_HZ);
+        detect_run(axes, rec->stride, n, t, nullptr, 0);
+        telemetry_service(t + (uint32_t)(n * 1000.0 / TARGET_SAMPLE_RATE_HZ));
+    }
+    telemetry_set_active(false);
+    telemetry_console(nullptr);
+}
+
+static PyObject* pd_telemetry(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"samples", "start_ms", nullptr};
+    PyObject* samples;
+    unsigned long start_ms = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|k", const_cast<char**>(keywords),
+                                     &samples, &start_ms)) {
+        return nullptr;
+    }
+
+    Recording rec;
+    if (!open_recording(samples, &rec)) return nullptr;
+
+    FrameCapture capture;
+    Py_BEGIN_ALLOW_THREADS
+    replay_telemetry(&rec, (uint32_t)start_ms, &capture);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&rec.view);
+    return PyBytes_FromStringAndSize(capture.frames.data(), (Py_ssize_t)capture.frames.size());
+}
+
+// The flash log is one store per process
+static std::mutex flash_log_lock;
+
+struct FlashRun {
+    FlashLogStats log;
+    FileBlockDevice::Counters device;
+    double seconds;
+};
+
+static PyObject* flash_run_dict(const FlashRun& run) {
+    const FlashLogStats& s = run.log;
+    const FileBlockDevice::Counters& d = run.device;
+    return Py_BuildValue("{s:d,s:k,s:k,s:k,s:k,s:k,s:k,s:k,s:k,s:k,s:k,s:k,s:k,"
+                         "s:K,s:K,s:K,s:K,s:K}",
+        "seconds", run.seconds,
+        "records_written", (unsigned long)s.records_written,
+        "records_dropped", (unsigned long)s.records_dropped,
+        "bytes_written", (unsigned long)s.bytes_written,
+        "program_us", (unsigned long)s.program_us,
+        "erases", (unsigned long)s.erases,
+        "erase_us", (unsigned long)s.erase_us,
+        "scan_ms", (unsigned long)s.scan_ms,
+        "scan_records", (unsigned long)s.scan_records,
+        "min_erase_count", (unsigned long)s.min_erase_count,
+        "max_erase_count", (unsigned long)s.max_erase_count,
+        "segments", (unsigned long)s.segments,
+        "active_segment", (unsigned long)s.active_segment,
+        "reads", (unsigned long long)d.reads,
+        "read_bytes", (unsigned long long)d.read_bytes,
+        "programs", (unsigned long long)d.programs,
+        "program_bytes", (unsigned long long)d.program_bytes,
+        "erase_blocks", (unsigned long long)d.erases);
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Producers never block on the device; a replay that outruns the writer waits for room
+static void flash_append_waiting(FlashRecordType type, const void* payload, size_t length) {
+    while (flash_log_staging_free() < 2 * (sizeof(FlashRecordHeader) + FLASH_LOG_MAX_PAYLOAD)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    flash_log_append(type, 0, payload, length);
+}
+
+static bool flash_write(FileBlockDevice* bd, const BlockFile& file, FlashRun* run) {
+    std::lock_guard<std::mutex> guard(flash_log_lock);
+    if (!init_flash_log(bd)) return false;
+
+    bd->counters = {};
+    auto start = std::chrono::steady_clock::now();
+    uint32_t window_index = 0;
+    for (const ImuBlockHeader* hdr : file.blocks) {
+        flash_append_waiting(FLASH_REC_IMU_BLOCK, hdr, imu_block_size(hdr));
+        WindowRecord record = {};
+        record.magic = WINDOW_RECORD_MAGIC;
+        record.window_index = window_index++;
+        record.start_sample = hdr->first_sample;
+        record.timestamp_ms = hdr->timestamp_ms;
+        flash_append_waiting(FLASH_REC_WINDOW, &record, sizeof(record));
+    }
+    deinit_flash_log();             // returns once the writer has programmed the last record
+
+    run->seconds = seconds_since(start);
+    run->log = flash_log_stats;
+    run->device = bd->counters;
+    return true;
+}
+
+static bool flash_mount(FileBlockDevice* bd, FlashRun* run) {
+    std::lock_guard<std::mutex> guard(flash_log_lock);
+    auto start = std::chrono::steady_clock::now();
+    if (!init_flash_log(bd)) return false;
+    run->seconds = seconds_since(start);
+    run->log = flash_log_stats;
+    run->device = bd->counters;
+    deinit_flash_log();
+    return true;
+}
+
+static PyObject* pd_flash_write(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"path", "blocks", "size", "page_program_us", "block_erase_us", nullptr};
+    const char* path;
+    PyObject* obj;
+    unsigned long long size = 8 * 1024 * 1024;
+    unsigned int page_program_us = 0, block_erase_us = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO|KII", const_cast<char**>(keywords),
+                                     &path, &obj, &size, &page_program_us, &block_erase_us)) {
+        return nullptr;
+    }
+
+    BlockFile file;
+    if (!open_blocks(obj, &file)) return nullptr;
+
+    FileBlockDevice bd(path, size);
+    bd.set_timing(page_program_us, block_erase_us);
+    FlashRun run = {};
+    bool ok;
+    Py_BEGIN_ALLOW_THREADS
+    ok = flash_write(&bd, file, &run);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&file.view);
+    if (!ok) return PyErr_Format(PyExc_OSError, "cannot mount a flash log of %llu bytes on %s", size, path);
+    return flash_run_dict(run);
+}
+
+static PyObject* pd_flash_mount(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"path", "size", nullptr};
+    const char* path;
+    unsigned long long size = 8 * 1024 * 1024;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|K", const_cast<char**>(keywords), &path, &size)) {
+        return nullptr;
+    }
+
+    FileBlockDevice bd(path, size);
+    FlashRun run = {};
+    bool ok;
+    Py_BEGIN_ALLOW_THREADS
+    ok = flash_mount(&bd, &run);
+    Py_END_ALLOW_THREADS
+
+    if (!ok) return PyErr_Format(PyExc_OSError, "cannot mount a flash log of %llu bytes on %s", size, path);
+    return flash_run_dict(run);
+}
+
+static const char* const ISA_NAMES[] = {"auto", "generic", "avx2", "avx512"};
+
+// Contiguous float32 magnitude windows; false with an exception set
+static bool open_magnitudes(PyObject* obj, Py_buffer* view, size_t* windows) {
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) return false;
+    const char* fmt = (view->format != nullptr) ? view->format : "B";
+    if (fmt[0] == '@' || fmt[0] == '=' || fmt[0] == '<') fmt++;
+    if (view->itemsize != 4 || fmt[0] != 'f' || fmt[1] != '\0' ||
+        (size_t)(view->len / 4) % WINDOW_SIZE != 0) {
+        PyErr_SetString(PyExc_TypeError, "magnitudes must be float32, window_samples per window");
+        PyBuffer_Release(view);
+        return false;
+    }
+    *windows = (size_t)(view->len / 4) / WINDOW_SIZE;
+    return true;
+}
+
+static PyObject* pd_spectra(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"accel", "gyro", "accel_weight", "isa", "magnitude", nullptr};
+    PyObject *accel_obj, *gyro_obj;
+    float accel_weight = FUSION_DEFAULT_ACCEL_WEIGHT;
+    const char* isa_name = "auto";
+    int with_magnitude = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|fsp", const_cast<char**>(keywords), &accel_obj,
+                                     &gyro_obj, &accel_weight, &isa_name, &with_magnitude)) {
+        return nullptr;
+    }
+    int isa = 0;
+    while (isa <= SPECTRAL_ISA_AVX512 && strcmp(isa_name, ISA_NAMES[isa]) != 0) isa++;
+    if (isa > SPECTRAL_ISA_AVX512 || !spectral_batch_use((SpectralIsa)isa)) {
+        PyErr_Format(PyExc_ValueError, "instruction set '%s' not available", isa_name);
+        return nullptr;
+    }
+
+    Py_buffer accel, gyro;
+    size_t windows, gyro_windows;
+    if (!open_magnitudes(accel_obj, &accel, &windows)) return nullptr;
+    if (!open_magnitudes(gyro_obj, &gyro, &gyro_windows)) {
+        PyBuffer_Release(&accel);
+        return nullptr;
+    }
+    if (gyro_windows != windows) {
+        PyErr_SetString(PyExc_ValueError, "accel and gyro must hold the same number of windows");
+        PyBuffer_Release(&accel);
+        PyBuffer_Release(&gyro);
+        return nullptr;
+    }
+
+    std::vector<SpectralWindow> out(windows);
+    std::vector<float> magnitude(with_magnitude ? windows * SPECTRAL_BATCH_BINS : 0);
+    Py_BEGIN_ALLOW_THREADS
+    spectral_batch(static_cast<const float*>(accel.buf), static_cast<const float*>(gyro.buf), windows,
+                   &accel_weight, out.data(), with_magnitude ? magnitude.data() : nullptr);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&accel);
+    PyBuffer_Release(&gyro);
+
+    PyObject* records = PyBytes_FromStringAndSize(reinterpret_cast<const char*>(out.data()),
+                                                  (Py_ssize_t)(out.size() * sizeof(SpectralWindow)));
+    if (!with_magnitude) return records;
+    if (records == nullptr) return nullptr;
+    PyObject* bins = PyBytes_FromStringAndSize(reinterpret_cast<const char*>(magnitude.data()),
+                                               (Py_ssize_t)(magnitude.size() * sizeof(float)));
+    if (bins == nullptr) {
+        Py_DECREF(records);
+        return nullptr;
+    }
+    return Py_BuildValue("(NN)", records, bins);
+}
+
+// Read-only memoryview of a copy of n bytes, cast to the struct code
+static PyObject* typed_view(const void* data, size_t n, const char* code) {
+    PyObject* bytes = PyBytes_FromStringAndSize(static_cast<const char*>(data), (Py_ssize_t)n);
+    if (bytes == nullptr) return nullptr;
+    PyObject* view = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if (view == nullptr) return nullptr;
+    PyObject* typed = PyObject_CallMethod(view, "cast", "s", code);
+    Py_DECREF(view);
+    return typed;
+}
+
+// Contiguous buffer of whole blocks of one item type; false with an exception set
+static bool open_blocks_of(PyObject* obj, Py_buffer* view, char code, size_t block, size_t* blocks,
+                           const char* message) {
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) return false;
+    const char* fmt = (view->format != nullptr) ? view->format : "B";
+    if (fmt[0] == '@' || fmt[0] == '=' || fmt[0] == '<') fmt++;
+    const size_t itemsize = (code == 'h') ? 2 : 4;
+    if ((size_t)view->itemsize != itemsize || fmt[0] != code || fmt[1] != '\0' ||
+        (size_t)view->len / itemsize % block != 0) {
+        PyErr_SetString(PyExc_TypeError, message);
+        PyBuffer_Release(view);
+        return false;
+    }
+    *blocks = (size_t)view->len / itemsize / block;
+    return true;
+}
+
+static PyObject* pd_wavelet(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"samples", "levels", nullptr};
+    PyObject* obj;
+    unsigned int levels = WAVELET_LEVELS;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|I", const_cast<char**>(keywords), &obj, &levels)) {
+        return nullptr;
+    }
+    if (levels < 1 || levels > WAVELET_LEVELS) {
+        return PyErr_Format(PyExc_ValueError, "levels must be 1-%u", (unsigned)WAVELET_LEVELS);
+    }
+    Py_buffer view;
+    size_t windows;
+    if (!open_blocks_of(obj, &view, 'h', WINDOW_SIZE, &windows,
+                        "samples must be int16 counts, window_samples per window")) {
+        return nullptr;
+    }
+
+    std::vector<int32_t> coeffs(windows * WINDOW_SIZE);
+    const int16_t* in = static_cast<const int16_t*>(view.buf);
+    Py_BEGIN_ALLOW_THREADS
+    for (size_t w = 0; w < windows; w++) {
+        int32_t* x = &coeffs[w * WINDOW_SIZE];
+        for (size_t i = 0; i < WINDOW_SIZE; i++) x[i] = in[w * WINDOW_SIZE + i];
+        wavelet_forward(x, WINDOW_SIZE, levels);
+    }
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+    return typed_view(coeffs.data(), coeffs.size() * sizeof(int32_t), "i");
+}
+
+static PyObject* pd_zoom(PyObject*, PyObject* args) {
+    PyObject* obj;
+    if (!PyArg_ParseTuple(args, "O", &obj)) return nullptr;
+    Py_buffer view;
+    size_t blocks;
+    if (!open_blocks_of(obj, &view, 'f', ZOOM_MAX_INPUT, &blocks, "samples must be float32, zoom_input per block")) {
+        return nullptr;
+    }
+
+    std::vector<float> magnitude(blocks * ZOOM_FFT_SIZE);
+    std::vector<float> work(ZOOM_WORK_FLOATS);
+    const float* samples = static_cast<const float*>(view.buf);
+    bool ok;
+    Py_BEGIN_ALLOW_THREADS
+    ok = init_zoom_fft();
+    for (size_t b = 0; ok && b < blocks; b++) {
+        ok = zoom_fft_compute(samples + b * ZOOM_MAX_INPUT, ZOOM_MAX_INPUT, work.data());
+        memcpy(&magnitude[b * ZOOM_FFT_SIZE], zoom_magnitude, sizeof(zoom_magnitude));
+    }
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+    if (!ok) return PyErr_Format(PyExc_RuntimeError, "zoom spectrum failed");
+    return typed_view(magnitude.data(), magnitude.size() * sizeof(float), "f");
+}
+
+static PyObject* pd_rfft(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"samples", "size", "length", nullptr};
+    PyObject* obj;
+    unsigned int size = FFT_SIZE;
+    unsigned int length = WINDOW_SIZE;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|II", const_cast<char**>(keywords), &obj, &size, &length)) {
+        return nullptr;
+    }
+    arm_rfft_fast_instance_f32 rfft;
+    if (length < 1 || length > size || arm_rfft_fast_init_f32(&rfft, (uint16_t)size) != ARM_MATH_SUCCESS) {
+        return PyErr_Format(PyExc_ValueError, "size must be a power of two 32-4096, length 1-size");
+    }
+    Py_buffer view;
+    size_t blocks;
+    if (!open_blocks_of(obj, &view, 'f', length, &blocks, "samples must be float32, length per block")) {
+        return nullptr;
+    }
+
+    const size_t bins = size / 2 - 1;
+    std::vector<float> magnitude(blocks * bins);
+    std::vector<float> in(size), out(size);
+    const float* samples = static_cast<const float*>(view.buf);
+    Py_BEGIN_ALLOW_THREADS
+    for (size_t b = 0; b < blocks; b++) {
+        memcpy(in.data(), samples + b * length, length * sizeof(float));
+        memset(in.data() + length, 0, (size - length) * sizeof(float));
+        arm_rfft_fast_f32(&rfft, in.data(), out.data(), 0);
+        arm_cmplx_mag_f32(&out[2], &magnitude[b * bins], bins);
+    }
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+    return typed_view(magnitude.data(), magnitude.size() * sizeof(float), "f");
+}
+
+static PyMethodDef pd_methods[] = {
+    {"run", (PyCFunction)(void (*)(void))pd_run, METH_VARARGS | METH_KEYWORDS,
+     "run(samples, start_ms=0, learning=True) -> dict\n\n"
+     "Replay raw LSM6DSL counts (int16, ax ay az gx gy gz) through a fresh\n"
+     "pipeline and return the windows as columns: window_fields mapped to\n"
+     "typed memoryviews, one value per window. With learning=False\n"
+     "calibration and baseline stay as reset left them."},
+    {"run_chunked", (PyCFunction)(void (*)(void))pd_run_chunked, METH_VARARGS | METH_KEYWORDS,
+     "run_chunked(samples, threads=0, segment_windows=0, warmup_windows=0, start_ms=0)\n"
+     "    -> (dict, stats)\n\n"
+     "run(learning=False) of one recording in segments over threads\n"
+     "(detect_run_chunked, 0 = defaults); stats counts the segments and how\n"
+     "they were reconciled."},
+    {"run_batch", (PyCFunction)(void (*)(void))pd_run_batch, METH_VARARGS | METH_KEYWORDS,
+     "run_batch(recordings, threads=0, start_ms=0, learning=True) -> list[dict]\n\n"
+     "run() over each recording, spread over threads (0: one per core)."},
+    {"encode", (PyCFunction)(void (*)(void))pd_encode, METH_VARARGS | METH_KEYWORDS,
+     "encode(samples, compress=True, start_ms=0) -> bytes\n\n"
+     "Pack raw counts into IMU blocks of window_samples samples\n"
+     "(record_format.h), delta-compressing the columns that allow it."},
+    {"decode", pd_decode, METH_VARARGS,
+     "decode(blocks) -> bytes\n\n"
+     "Unpack IMU blocks to interleaved int16 counts, ax ay az gx gy gz."},
+    {"run_blocks", pd_run_blocks, METH_VARARGS,
+     "run_blocks(blocks) -> dict\n\n"
+     "run() on a buffer of IMU blocks (bytes, mmap), read in place."},
+    {"telemetry", (PyCFunction)(void (*)(void))pd_telemetry, METH_VARARGS | METH_KEYWORDS,
+     "telemetry(samples, start_ms=0) -> bytes\n\n"
+     "Replay with binary telemetry on and return the frame stream the\n"
+     "device would send (telemetry.h), stage timings measured on the host."},
+    {"spectra", (PyCFunction)(void (*)(void))pd_spectra, METH_VARARGS | METH_KEYWORDS,
+     "spectra(accel, gyro, accel_weight=0.7, isa='auto', magnitude=False) -> bytes\n\n"
+     "Batched spectral front end (spectral_batch.h) of float32 magnitude\n"
+     "windows, spectral_format per window; with magnitude=True also the\n"
+     "fused spectra, spectral_bins float32 each. isa: auto, generic, avx2,\n"
+     "avx512 (ValueError if the CPU lacks it)."},
+    {"wavelet", (PyCFunction)(void (*)(void))pd_wavelet, METH_VARARGS | METH_KEYWORDS,
+     "wavelet(samples, levels=wavelet_levels) -> memoryview\n\n"
+     "Forward lifting wavelet (wavelet.h) of int16 counts, each window of\n"
+     "window_samples transformed in place: int32 coefficients, the level-j\n"
+     "details at (2i + 1) * 2^(j-1)."},
+    {"zoom", pd_zoom, METH_VARARGS,
+     "zoom(samples) -> memoryview\n\n"
+     "Zoom spectrum (zoom_fft.h) of float32 blocks of zoom_input samples:\n"
+     "zoom_bins float32 amplitudes per block, lowest frequency first, bin i\n"
+     "at zoom_center_hz + (i - zoom_bins / 2) * zoom_bin_hz."},
+    {"rfft", (PyCFunction)(void (*)(void))pd_rfft, METH_VARARGS | METH_KEYWORDS,
+     "rfft(samples, size=fft_size, length=window_samples) -> memoryview\n\n"
+     "CMSIS real FFT of float32 blocks of length samples, zero padded to size\n"
+     "and not windowed: float32 magnitudes of bins 1..size/2-1 per block."},
+    {"flash_write", (PyCFunction)(void (*)(void))pd_flash_write, METH_VARARGS | METH_KEYWORDS,
+     "flash_write(path, blocks, size=8 MB, page_program_us=0, block_erase_us=0) -> dict\n\n"
+     "Log IMU blocks (encode()) and a window record per block into a flash log\n"
+     "on a file-backed NOR stand-in, created erased if missing, as fast as the\n"
+     "writer thread takes them. The busy times emulate the part per 256-byte\n"
+     "page and 4 KB erase block. Returns the log statistics, the device\n"
+     "operations and the wall time once the last record is programmed."},
+    {"flash_mount", (PyCFunction)(void (*)(void))pd_flash_mount, METH_VARARGS | METH_KEYWORDS,
+     "flash_mount(path, size=8 MB) -> dict\n\n"
+     "Mount a flash log file as at boot; the statistics of the recovery scan,\n"
+     "its device reads and wall time, as flash_write()."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static struct PyModuleDef pd_module = {
+    PyModuleDef_HEAD_INIT, "pd_detect",
+    "Parkinson's symptom detection pipeline, replayed on recorded IMU samples", -1, pd_methods
+};
+
+PyMODINIT_FUNC PyInit_pd_detect(void) {
+    static_assert(sizeof(SpectralWindow) == 40, "spectral_format out of date");
+
+    PyObject* m = PyModule_Create(&pd_module);
+    if (m == nullptr) return nullptr;
+
+    PyObject* fields = PyTuple_New((Py_ssize_t)DETECT_COLUMN_COUNT);
+    for (size_t c = 0; fields != nullptr && c < DETECT_COLUMN_COUNT; c++) {
+        PyObject* name = PyUnicode_FromString(DETECT_COLUMNS[c].name);
+        if (name == nullptr) {
+            Py_CLEAR(fields);
+            break;
+        }
+        PyTuple_SET_ITEM(fields, (Py_ssize_t)c, name);
+    }
+    if (fields == nullptr ||
+        PyModule_AddIntConstant(m, "api_version", DETECT_API_VERSION) != 0 ||
+        PyModule_AddIntConstant(m, "window_samples", WINDOW_SIZE) != 0 ||
+        PyModule_AddIntConstant(m, "chunk_warmup_windows", DETECT_CHUNK_WARMUP_WINDOWS) != 0 ||
+        PyModule_AddIntConstant(m, "fft_size", FFT_SIZE) != 0 ||
+        PyModule_AddIntConstant(m, "wavelet_levels", WAVELET_LEVELS) != 0 ||
+        PyModule_AddObject(m, "window_fields", fields) != 0) {
+        Py_XDECREF(fields);
+        Py_DECREF(m);
+        return nullptr;
+    }
+
+    PyObject* spectral_fields = Py_BuildValue("(ssssssssss)",
+        "accel_std", "gyro_std", "accel_snr", "gyro_snr", "accel_weight", "noise_floor",
+        "tremor_peak", "tremor_freq", "dysk_peak", "dysk_freq");
+    if (PyModule_AddStringConstant(m, "spectral_format", "<10f") != 0 ||
+        PyModule_AddIntConstant(m, "spectral_bins", (long)SPECTRAL_BATCH_BINS) != 0 ||
+        PyModule_AddObject(m, "spectral_fields", spectral_fields) != 0) {
+        Py_XDECREF(spectral_fields);
+        Py_DECREF(m);
+        return nullptr;
+    }
+
+    if (PyModule_AddIntConstant(m, "zoom_input", (long)ZOOM_MAX_INPUT) != 0 ||
+        PyModule_AddIntConstant(m, "zoom_bins", ZOOM_FFT_SIZE) != 0 ||
+        PyModule_AddObject(m, "zoom_center_hz", PyFloat_FromDouble(ZOOM_CENTER_HZ)) != 0 ||
+        PyModule_AddObject(m, "zoom_bin_hz",
+                           PyFloat_FromDouble(TARGET_SAMPLE_RATE_HZ / ZOOM_DECIMATION / ZOOM_FFT_SIZE)) != 0) {
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
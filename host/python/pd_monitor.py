@@ -0,0 +1,210 @@
+"""Live terminal monitor for the device's binary telemetry stream.
+
+    python3 pd_monitor.py /dev/ttyACM0                 # device (send 't' to start the stream)
+    python3 pd_monitor.py capture.bin                  # recorded stream
+    python3 pd_monitor.py --simulate session.imu       # pseudo-terminal driven by a replay
+
+Renders per-stage timings, sample rate and read jitter, queue depths, BLE
+throughput, the detection state and the latest spectrogram row, plus link
+statistics (CRC errors, lost frames). --simulate replays a recording
+(.imu block file or .csv, see record_convert.py) through the pipeline with
+pd_detect.telemetry() and writes the frames into a pseudo-terminal at the
+recording's pace (--speed), so the monitor reads it exactly as it reads
+the serial port. Stage timings are then the host's, and the sample-rate
+fields are 0 since nothing is read from a sensor.
+"""
+
+import argparse
+import os
+import select
+import sys
+import termios
+import threading
+import time
+import tty
+from collections import deque
+
+import telemetry_frames as tf
+
+DETECTION = ("none", "TREMOR", "DYSKINESIA")
+FOG = ("not walking", "walking", "potential freeze", "FREEZE")
+MOTOR = ("unknown", "ON", "OFF", "dyskinetic ON")
+QUALITY_FLAGS = ("stuck", "dropout", "read error", "saturated", "magnitude", "noise jump")
+SPARK = " .:-=+*#%@"
+BIN_HZ = 52.0 / 256
+
+
+def open_port(path, baud):
+    """Raw, non-blocking read end of a serial port, pty or file."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK) if os.path.exists(path) \
+        and not os.path.isfile(path) else os.open(path, os.O_RDONLY)
+    if os.isatty(fd):
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def simulate(recording, speed):
+    """Pseudo-terminal fed with the frames of a replay; returns the reader's path."""
+    import pd_detect
+    import record_convert
+    from array import array
+
+    if recording.endswith(".csv"):
+        samples = record_convert.read_csv(recording)[0]
+    else:
+        samples = array("h", pd_detect.decode(record_convert.map_blocks(recording)))
+    stream = pd_detect.telemetry(samples)
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+
+    def feed():
+        decoder = tf.FrameDecoder()
+        start = time.monotonic()
+        offset = 0
+        while offset < len(stream):
+            # A frame at a time, paced by the window and health timestamps
+            length = stream[offset + 3] + tf.OVERHEAD
+            chunk = stream[offset:offset + length]
+            for frame in decoder.feed(chunk):
+                stamp = frame.fields.get("timestamp_ms", frame.fields.get("uptime_ms"))
+                if stamp is not None:
+                    delay = stamp / 1000.0 / speed - (time.monotonic() - start)
+                    if delay > 0:
+                        time.sleep(delay)
+            os.write(master, chunk)
+            offset += length
+        time.sleep(0.5)                   # let the reader drain before hanging up
+        os.close(master)
+
+    threading.Thread(target=feed, daemon=True).start()
+    return os.ttyname(slave)
+
+
+class Monitor:
+    def __init__(self, history):
+        self.decoder = tf.FrameDecoder()
+        self.window = None
+        self.health = None
+        self.spectrum = None
+        self.stages = deque(maxlen=history)
+        self.bytes = 0
+
+    def feed(self, data):
+        self.bytes += len(data)
+        for frame in self.decoder.feed(data):
+            if frame.type == tf.WINDOW:
+                self.window = frame.fields
+            elif frame.type == tf.STAGES:
+                self.stages.append(frame.fields)
+            elif frame.type == tf.SPECTRUM:
+                self.spectrum = frame.fields
+            elif frame.type == tf.HEALTH:
+                self.health = frame.fields
+
+    def render(self):
+        lines = ["PD monitor  %d frames  %d B  CRC errors %d  lost %d  skipped %d B" % (
+            self.decoder.frames, self.bytes, self.decoder.crc_errors, self.decoder.lost,
+            self.decoder.skipped_bytes), ""]
+
+        h = self.health
+        if h:
+            seconds = tf.HEALTH_INTERVAL_S
+            lines += [
+                "uptime %8.1f s   night %s   BLE %s" % (
+                    h["uptime_ms"] / 1000.0, "yes" if h["night"] else "no",
+                    "connected" if h["ble_connected"] else "advertising"),
+                "sample rate %6.2f Hz   read interval %5d us  std %5d  max %5d" % (
+                    h["sample_rate_chz"] / 100.0, h["interval_mean_us"], h["interval_std_us"],
+                    h["interval_max_us"]),
+                "ISR backlog %3d   flash staging %5d B   multires deferred %3d" % (
+                    h["isr_backlog_max"], h["flash_staging_used"], h["multires_deferred"]),
+                "BLE %6.0f B/s   console text %6.0f B/s   telemetry %6.0f B/s" % (
+                    h["ble_tx_bytes"] / seconds, h["text_bytes"] / seconds,
+                    h["telemetry_bytes"] / seconds),
+                "",
+            ]
+
+        w = self.window
+        if w:
+            flags = [name for bit, name in enumerate(QUALITY_FLAGS) if w["quality_flags"] & (1 << bit)]
+            lines += [
+                "window %6d  t %9.1f s   std %4d mg   quality %3d %s" % (
+                    w["window_index"], w["timestamp_ms"] / 1000.0, w["std_mg"], w["quality_score"],
+                    ",".join(flags)),
+                "detection %-10s  tremor %4.2f Hz  %4d/1000   dyskinesia %4d/1000" % (
+                    DETECTION[w["raw_detection"]] if w["raw_detection"] < len(DETECTION) else "?",
+                    w["tremor_freq_chz"] / 100.0, w["tremor_intensity"], w["dysk_intensity"]),
+                "FOG %-16s  steps %3d  heel strikes %2d   brady %4d   motor %s (OFF %4d)" % (
+                    FOG[w["fog_state"]] if w["fog_state"] < len(FOG) else "?", w["steps"],
+                    w["heel_strikes"], w["brady_score"],
+                    MOTOR[w["motor_state"]] if w["motor_state"] < len(MOTOR) else "?", w["off_score"]),
+                "",
+            ]
+
+        if self.stages:
+            n = len(self.stages)
+            lines.append("stage timings, mean of last %d windows (us)" % n)
+            total = sum(s["total_us"] for s in self.stages) / n
+            for name in tf.STAGE_NAMES:
+                mean = sum(s[name] for s in self.stages) / n
+                bar = "#" * int(40 * mean / total) if total else ""
+                lines.append("  %-9s %7.0f %s" % (name, mean, bar))
+            lines += ["  %-9s %7.0f  (max %d)" % ("total", total, max(s["total_us"] for s in self.stages)), ""]
+
+        if self.spectrum:
+            bins = self.spectrum["bins"]
+            top = max(bins) or 1
+            peak = max(range(len(bins)), key=bins.__getitem__)
+            lines += [
+                "spectrum, window %d (0.4-13.2 Hz), peak %.2f Hz" % (
+                    self.spectrum["window_index"], (peak + 2) * BIN_HZ),
+                "  |" + "".join(SPARK[b * (len(SPARK) - 1) // top] for b in bins) + "|",
+            ]
+        return "\n".join(lines)
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", nargs="?", help="serial device, pty or capture file")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--simulate", metavar="RECORDING", help="replay a .imu or .csv recording")
+    parser.add_argument("--speed", type=float, default=10.0, help="simulation speed-up")
+    parser.add_argument("--history", type=int, default=20, help="windows in the timing means")
+    parser.add_argument("--once", action="store_true", help="no live screen, only the summary at end of input")
+    args = parser.parse_args(argv)
+    if not args.port and not args.simulate:
+        parser.error("a port or --simulate is required")
+
+    path = simulate(args.simulate, args.speed) if args.simulate else args.port
+    fd = open_port(path, args.baud)
+    monitor = Monitor(args.history)
+    last_draw = 0.0
+    try:
+        while True:
+            ready, _, _ = select.select([fd], [], [], 0.5)
+            if ready:
+                try:
+                    data = os.read(fd, 4096)
+                except BlockingIOError:
+                    continue
+                except OSError:
+                    data = b""            # EIO: the simulator closed the pty
+                if not data:
+                    break                 # end of the capture or stream
+                monitor.feed(data)
+            if not args.once and time.monotonic() - last_draw > 0.2:
+                sys.stdout.write("\x1b[H\x1b[2J" + monitor.render() + "\n")
+                sys.stdout.flush()
+                last_draw = time.monotonic()
+    except KeyboardInterrupt:
+        pass
+    print(monitor.render())
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,80 @@
+"""Convert recordings between CSV exports and IMU block files.
+
+    python3 record_convert.py session.csv session.imu          # CSV -> blocks
+    python3 record_convert.py --raw session.csv session.imu    # no delta compression
+    python3 record_convert.py session.imu session.csv          # blocks -> CSV
+
+CSV rows hold raw LSM6DSL counts ax,ay,az,gx,gy,gz, optionally after a
+timestamp_ms column (its first value becomes the block timestamp origin)
+and below a header row. Block files are the firmware's record_format.h
+blocks back to back, one window (156 samples) each, and replay in place:
+
+    with open("session.imu", "rb") as f:
+        windows = pd_detect.run_blocks(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ))
+"""
+
+import argparse
+import csv
+import mmap
+import sys
+from array import array
+
+import pd_detect
+
+AXES = ("ax", "ay", "az", "gx", "gy", "gz")
+
+
+def read_csv(path):
+    """Interleaved int16 counts and the first timestamp (0 without one)."""
+    samples = array("h")
+    start_ms = None
+    with open(path, newline="") as f:
+        for row in csv.reader(f):
+            if not row or not row[0].lstrip("-").isdigit():
+                continue                       # header or blank line
+            if len(row) == 7:
+                if start_ms is None:
+                    start_ms = int(row[0])
+                row = row[1:]
+            elif len(row) != 6:
+                raise ValueError("%s: expected 6 or 7 columns, got %d" % (path, len(row)))
+            samples.extend(int(v) for v in row)
+    return samples, start_ms or 0
+
+
+def write_csv(path, samples):
+    with open(path, "w", newline="") as f:
+        out = csv.writer(f)
+        out.writerow(AXES)
+        for i in range(0, len(samples), 6):
+            out.writerow(samples[i:i + 6])
+
+
+def map_blocks(path):
+    """Read-only mapping of a block file, for decode() or run_blocks()."""
+    with open(path, "rb") as f:
+        return mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--raw", action="store_true", help="store every column uncompressed")
+    parser.add_argument("source")
+    parser.add_argument("target")
+    args = parser.parse_args(argv)
+
+    if args.source.endswith(".csv"):
+        samples, start_ms = read_csv(args.source)
+        blocks = pd_detect.encode(samples, compress=not args.raw, start_ms=start_ms)
+        with open(args.target, "wb") as f:
+            f.write(blocks)
+        print("%d samples, %d -> %d bytes" % (len(samples) // 6, len(samples) * 2, len(blocks)))
+    else:
+        samples = array("h")
+        samples.frombytes(pd_detect.decode(map_blocks(args.source)))
+        write_csv(args.target, samples)
+        print("%d samples" % (len(samples) // 6))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,40 @@
+"""Build the pd_detect extension: the firmware's pipeline modules compiled
+for the host (PD_HOST_BUILD, lib/host_platform) behind detect_api.h.
+
+    python3 setup.py build_ext --inplace
+"""
+
+import glob
+import os
+
+from setuptools import Extension, setup
+
+ROOT = os.path.relpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+# Same split as env:native in platformio.ini
+DEVICE_ONLY = {"main.cpp", "ble_comm.cpp", "led_control.cpp"}
+
+sources = ["pd_detect.cpp"]
+sources += sorted(p for p in glob.glob(os.path.join(ROOT, "src", "*.cpp"))
+                  if os.path.basename(p) not in DEVICE_ONLY)
+sources += sorted(glob.glob(os.path.join(ROOT, "lib", "host_platform", "src", "*.cpp")))
+sources += sorted(glob.glob(os.path.join(ROOT, "lib", "host_platform", "src", "cmsis", "*.c")))
+
+setup(
+    name="pd_detect",
+    version="1.0.0",
+    ext_modules=[
+        Extension(
+            "pd_detect",
+            sources=sources,
+            include_dirs=[
+                os.path.join(ROOT, "include"),
+                os.path.join(ROOT, "lib", "host_platform", "include"),
+                os.path.join(ROOT, "lib", "CMSIS-DSP-main", "Include"),
+            ],
+            define_macros=[("PD_HOST_BUILD", None), ("ARM_MATH_CM4", None), ("__GNUC_PYTHON__", None)],
+            extra_compile_args=["-O2", "-pthread"],
+            extra_link_args=["-pthread"],
+        )
+    ],
+)
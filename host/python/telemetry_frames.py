@@ -0,0 +1,112 @@
+"""Decoder for the device's binary telemetry stream (include/telemetry.h).
+
+    0xA5 0x5A | type | length | sequence | payload | CRC-8
+
+The CRC (CCITT, poly 0x07, init 0) covers type through payload. The decoder
+accepts the stream in arbitrary pieces, skips noise and text between frames,
+drops frames that fail the CRC and counts sequence gaps as lost frames. A
+header whose type and length do not match a known layout is taken for noise
+at once, so a stray sync pair cannot hold back the frames behind it.
+"""
+
+import struct
+from collections import namedtuple
+
+SYNC = b"\xa5\x5a"
+OVERHEAD = 6
+HEALTH_INTERVAL_S = 2.0            # TELEMETRY_HEALTH_INTERVAL_MS
+
+WINDOW, STAGES, SPECTRUM, HEALTH = 1, 2, 3, 4
+
+STAGE_NAMES = ("quality", "motion", "spectrum", "detect", "record")
+SPECTRO_BINS = 64
+
+# type: (name, struct format, field names); layouts as in telemetry.h / spectrogram.h
+LAYOUTS = {
+    WINDOW: ("window", "<IIHHHHHHBBBBBBBB", (
+        "window_index", "timestamp_ms", "std_mg", "tremor_freq_chz", "tremor_intensity",
+        "dysk_intensity", "brady_score", "off_score", "raw_detection", "fog_state",
+        "quality_score", "quality_flags", "motor_state", "heel_strikes", "steps", "night")),
+    STAGES: ("stages", "<I5HH", ("window_index",) + STAGE_NAMES + ("total_us",)),
+    SPECTRUM: ("spectrum", "<I%dB" % SPECTRO_BINS, ("window_index", "bins")),
+    HEALTH: ("health", "<IHHHHHHHHHHBB2x", (
+        "uptime_ms", "sample_rate_chz", "interval_mean_us", "interval_std_us", "interval_max_us",
+        "isr_backlog_max", "flash_staging_used", "multires_deferred", "ble_tx_bytes",
+        "text_bytes", "telemetry_bytes", "ble_connected", "night")),
+}
+
+SIZES = {t: struct.calcsize(layout[1]) for t, layout in LAYOUTS.items()}
+
+Frame = namedtuple("Frame", "type name sequence fields")
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode(frame_type, sequence, payload):
+    """One frame as the device sends it (for tests and stand-ins)."""
+    body = bytes((frame_type, len(payload), sequence & 0xFF)) + payload
+    return SYNC + body + bytes((crc8(body),))
+
+
+def _fields(frame_type, payload):
+    layout = LAYOUTS[frame_type]
+    values = struct.unpack(layout[1], payload)
+    if frame_type == SPECTRUM:
+        return {"window_index": values[0], "bins": list(values[1:])}
+    return dict(zip(layout[2], values))
+
+
+class FrameDecoder:
+    def __init__(self):
+        self.buffer = bytearray()
+        self.frames = 0
+        self.crc_errors = 0
+        self.lost = 0              # frames missing from the sequence
+        self.skipped_bytes = 0     # text or noise between frames
+        self.last_sequence = None
+
+    def feed(self, data):
+        """Decode what data completes; returns a list of Frame."""
+        self.buffer += data
+        out = []
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                keep = 1 if self.buffer.endswith(SYNC[:1]) else 0
+                self.skipped_bytes += len(self.buffer) - keep
+                del self.buffer[:len(self.buffer) - keep]
+                return out
+            self.skipped_bytes += start
+            del self.buffer[:start]
+            if len(self.buffer) < OVERHEAD:
+                return out
+            frame_type, length = self.buffer[2], self.buffer[3]
+            if frame_type not in SIZES or SIZES[frame_type] != length:
+                self.skipped_bytes += 1
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < OVERHEAD + length:
+                return out
+
+            body = bytes(self.buffer[2:5 + length])
+            if crc8(body) != self.buffer[5 + length]:
+                # Not a frame after all, or a damaged one: resync past this sync
+                self.crc_errors += 1
+                self.skipped_bytes += 1
+                del self.buffer[:1]
+                continue
+            del self.buffer[:OVERHEAD + length]
+
+            sequence, payload = body[2], body[3:]
+            if self.last_sequence is not None:
+                self.lost += (sequence - self.last_sequence - 1) & 0xFF
+            self.last_sequence = sequence
+            self.frames += 1
+            out.append(Frame(frame_type, LAYOUTS[frame_type][0], sequence, _fields(frame_type, payload)))
@@ -0,0 +1,186 @@
+"""pd_detect binding: layouts, determinism and threaded replay.
+
+    python3 setup.py build_ext --inplace && python3 -m unittest test_pd_detect
+"""
+
+import math
+import mmap
+import os
+import random
+import struct
+import tempfile
+import unittest
+from array import array
+from concurrent.futures import ThreadPoolExecutor
+
+import pd_detect
+import record_convert
+
+RATE_HZ = 52.0
+ACCEL_LSB_G = 0.000061
+GYRO_LSB_DPS = 0.00875
+
+
+def recording(seconds, tremor_hz, tremor_dps, seed):
+    """Forearm at rest, rolling about x at tremor_hz (interleaved int16 counts)."""
+    rng = random.Random(seed)
+    out = array("h")
+    roll = 0.0
+    for i in range(int(seconds * RATE_HZ)):
+        t = i / RATE_HZ
+        gx = tremor_dps * math.sin(2 * math.pi * tremor_hz * t) + rng.uniform(-1, 1)
+        roll += math.radians(gx / RATE_HZ)
+        ay = math.sin(roll + 0.3) + 0.002 * tremor_dps * math.sin(2 * math.pi * tremor_hz * t)
+        az = math.cos(roll + 0.3)
+        out.extend((
+            int(rng.uniform(-15, 15)),
+            int(ay / ACCEL_LSB_G),
+            int(az / ACCEL_LSB_G),
+            int(gx / GYRO_LSB_DPS),
+            int(rng.uniform(-50, 50)),
+            int(rng.uniform(-50, 50)),
+        ))
+    return out
+
+
+def windows(columns):
+    return [dict(zip(pd_detect.window_fields, w)) for w in zip(*(columns[f] for f in pd_detect.window_fields))]
+
+
+class PdDetectTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.tremor = recording(120, 4.8, 40.0, seed=1)
+        cls.rest = recording(120, 4.8, 0.0, seed=2)
+
+    def test_detects_tremor_and_not_rest(self):
+        tremor = windows(pd_detect.run(self.tremor))
+        rest = windows(pd_detect.run(self.rest))
+        self.assertEqual(len(tremor), int(120 * RATE_HZ) // 156)
+        self.assertGreater(sum(w["tremor_intensity"] > 0 for w in tremor), len(tremor) // 2)
+        self.assertTrue(all(abs(w["tremor_freq"] - 4.8) < 0.3 for w in tremor if w["raw_detection"] == 1))
+        self.assertEqual(sum(w["raw_detection"] for w in rest), 0)
+
+    def test_windows_are_typed_columns(self):
+        columns = pd_detect.run(self.tremor)
+        self.assertEqual(list(columns), list(pd_detect.window_fields))
+        count = int(120 * RATE_HZ) // 156
+        self.assertTrue(all(len(c) == count for c in columns.values()))
+        self.assertEqual(columns["window_index"].format, "I")
+        self.assertEqual(columns["tremor_freq"].format, "f")
+        self.assertEqual(columns["tremor_intensity"].format, "H")
+        self.assertEqual(columns["raw_detection"].format, "B")
+        self.assertEqual(array("f", columns["tremor_freq"].tobytes()).tolist(), columns["tremor_freq"].tolist())
+        self.assertEqual(columns["window_index"].tolist(), list(range(1, count + 1)))
+
+    def test_layouts_agree(self):
+        n = len(self.tremor) // 6
+        columns = array("h", (self.tremor[i * 6 + axis] for axis in range(6) for i in range(n)))
+        interleaved = pd_detect.run(memoryview(self.tremor).cast("B").cast("h", [n, 6]))
+        column_major = pd_detect.run(memoryview(columns).cast("B").cast("h", [6, n]))
+        self.assertEqual(pd_detect.run(self.tremor), interleaved)
+        self.assertEqual(interleaved, column_major)
+
+    def test_threads_match_sequential(self):
+        inputs = [self.tremor, self.rest] * 4
+        sequential = [pd_detect.run(r) for r in inputs]
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            threaded = list(pool.map(pd_detect.run, inputs))
+        self.assertEqual(threaded, sequential)
+        self.assertEqual(pd_detect.run_batch(inputs, threads=4), sequential)
+        frozen = [pd_detect.run(r, learning=False) for r in inputs]
+        self.assertEqual(pd_detect.run_batch(inputs, threads=4, learning=False), frozen)
+
+    def test_chunked_matches_sequential(self):
+        session = self.rest + self.tremor + self.rest + self.tremor
+        sequential = pd_detect.run(session, learning=False)
+        chunked, stats = pd_detect.run_chunked(session, threads=3, segment_windows=40, warmup_windows=20)
+        self.assertEqual(chunked, sequential)
+        self.assertEqual(stats["segments"], 4)
+        self.assertEqual(stats["reconciled"] + stats["replayed"], 3)
+
+    def test_spectra_find_the_tone_on_every_kernel(self):
+        n = 156
+        accel = array("f", (1.0 + 0.05 * math.sin(2 * math.pi * 4.8 * i / RATE_HZ) for i in range(40 * n)))
+        gyro = array("f", (30.0 + 20.0 * math.sin(2 * math.pi * 4.8 * i / RATE_HZ) for i in range(40 * n)))
+        reference = pd_detect.spectra(accel, gyro, isa="generic")
+        records = [dict(zip(pd_detect.spectral_fields, r))
+                   for r in struct.iter_unpack(pd_detect.spectral_format, reference)]
+        self.assertEqual(len(records), 40)
+        self.assertTrue(all(abs(r["tremor_freq"] - 4.8) < 0.21 for r in records))
+        for isa in ("avx2", "avx512"):
+            try:
+                self.assertEqual(pd_detect.spectra(accel, gyro, isa=isa), reference)
+            except ValueError:
+                pass                      # not on this CPU
+        records, bins = pd_detect.spectra(accel, gyro, magnitude=True)
+        self.assertEqual(len(bins), 40 * pd_detect.spectral_bins * 4)
+        with self.assertRaises(TypeError):
+            pd_detect.spectra(array("f", [0.0] * 100), gyro)
+
+    def test_single_transforms(self):
+        n = pd_detect.window_samples
+        rail = array("h", [32767, -32768] * (2 * n))
+        coeffs = pd_detect.wavelet(rail)
+        self.assertEqual(coeffs.format, "i")
+        self.assertEqual(len(coeffs), 4 * n)
+        self.assertEqual(coeffs[1], -65535)                   # past int16, not clipped
+        tone = array("f", (math.sin(2 * math.pi * 4.8 * i / RATE_HZ) for i in range(3 * n)))
+        magnitude = pd_detect.rfft(tone)
+        bins = pd_detect.fft_size // 2 - 1
+        self.assertEqual(len(magnitude), 3 * bins)
+        peak = max(range(bins), key=lambda k: magnitude[k])
+        self.assertAlmostEqual((peak + 1) * RATE_HZ / pd_detect.fft_size, 4.8, delta=0.21)
+        zoomed = pd_detect.zoom(array("f", (math.sin(2 * math.pi * 4.2 * i / RATE_HZ)
+                                            for i in range(pd_detect.zoom_input))))
+        peak = max(range(pd_detect.zoom_bins), key=lambda i: zoomed[i])
+        self.assertAlmostEqual(pd_detect.zoom_center_hz + (peak - pd_detect.zoom_bins // 2) * pd_detect.zoom_bin_hz,
+                               4.2, delta=pd_detect.zoom_bin_hz)
+        self.assertAlmostEqual(zoomed[peak], 1.0, delta=0.2)
+        with self.assertRaises(ValueError):
+            pd_detect.rfft(tone, size=100)
+        with self.assertRaises(TypeError):
+            pd_detect.wavelet(tone)
+
+    def test_rejects_bad_buffers(self):
+        with self.assertRaises(TypeError):
+            pd_detect.run(array("f", [0.0] * 12))
+        with self.assertRaises(ValueError):
+            pd_detect.run(array("h", [0] * 7))
+
+    def test_blocks_round_trip(self):
+        for compress in (True, False):
+            blocks = pd_detect.encode(self.tremor, compress=compress)
+            self.assertEqual(pd_detect.decode(blocks), self.tremor.tobytes())
+        self.assertLess(len(pd_detect.encode(self.rest)), len(pd_detect.encode(self.rest, compress=False)))
+        with self.assertRaises(ValueError):
+            pd_detect.decode(pd_detect.encode(self.rest)[:-4])
+
+    def test_block_file_replays_like_samples(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            csv_path = os.path.join(tmp, "session.csv")
+            imu_path = os.path.join(tmp, "session.imu")
+            record_convert.write_csv(csv_path, self.tremor)
+            record_convert.main([csv_path, imu_path])
+            self.assertEqual(record_convert.read_csv(csv_path)[0], self.tremor)
+            with open(imu_path, "rb") as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as m:
+                self.assertEqual(pd_detect.run_blocks(m), pd_detect.run(self.tremor))
+
+    def test_flash_log_survives_a_remount(self):
+        blocks = pd_detect.encode(self.tremor)
+        count = len(self.tremor) // 6 // pd_detect.window_samples
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "flash.bin")
+            written = pd_detect.flash_write(path, blocks, size=1024 * 1024)
+            self.assertEqual(written["records_written"], 2 * count)
+            self.assertEqual(written["records_dropped"], 0)
+            self.assertEqual(os.path.getsize(path), 1024 * 1024)
+            mounted = pd_detect.flash_mount(path, size=1024 * 1024)
+            self.assertEqual(mounted["segments"], 16)
+            self.assertEqual(mounted["scan_records"], 2 * count)     # one segment, all walked
+            with self.assertRaises(OSError):
+                pd_detect.flash_mount(path, size=64 * 1024)          # too small for a log
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,97 @@
+"""Telemetry frame decoder and monitor: CRC, sequence gaps, resync, pty stand-in.
+
+    python3 setup.py build_ext --inplace && python3 -m unittest test_telemetry_frames
+"""
+
+import contextlib
+import io
+import os
+import struct
+import tempfile
+import unittest
+
+import pd_detect
+import pd_monitor
+import record_convert
+import telemetry_frames as tf
+from test_pd_detect import recording
+
+
+def window_payload(index):
+    return struct.pack("<IIHHHHHHBBBBBBBB", index, index * 3000, 12, 480, 300, 0, 0, 0,
+                       1, 0, 95, 0, 2, 0, 0, 0)
+
+
+class FrameDecoderTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.samples = recording(120, 4.8, 40.0, seed=1)
+        cls.stream = pd_detect.telemetry(cls.samples)
+
+    def test_crc_matches_the_device(self):
+        # CRC-8/CCITT check value
+        self.assertEqual(tf.crc8(b"123456789"), 0xF4)
+
+    def test_decodes_in_arbitrary_pieces(self):
+        frames = b"".join(tf.encode(tf.WINDOW, i, window_payload(i)) for i in range(5))
+        decoder = tf.FrameDecoder()
+        out = []
+        for i in range(len(frames)):
+            out += decoder.feed(frames[i:i + 1])
+        self.assertEqual([f.fields["window_index"] for f in out], list(range(5)))
+        self.assertEqual(out[0].fields["tremor_freq_chz"], 480)
+        self.assertEqual((decoder.crc_errors, decoder.lost, decoder.skipped_bytes), (0, 0, 0))
+
+    def test_skips_text_and_damaged_frames(self):
+        good = [tf.encode(tf.WINDOW, i, window_payload(i)) for i in range(4)]
+        damaged = bytearray(good[1])
+        damaged[10] ^= 0x40
+        stream = b"boot text \xa5\n" + good[0] + bytes(damaged) + b"\xa5\x5a" + good[2] + good[3]
+        decoder = tf.FrameDecoder()
+        out = decoder.feed(stream)
+        self.assertEqual([f.sequence for f in out], [0, 2, 3])
+        self.assertEqual(decoder.lost, 1)
+        self.assertGreaterEqual(decoder.crc_errors, 1)
+
+    def test_sequence_gaps_count_across_the_wrap(self):
+        decoder = tf.FrameDecoder()
+        decoder.feed(tf.encode(tf.HEALTH, 254, bytes(28)) + tf.encode(tf.HEALTH, 2, bytes(28)))
+        self.assertEqual(decoder.lost, 3)
+
+    def test_replay_stream_is_complete(self):
+        decoder = tf.FrameDecoder()
+        frames = decoder.feed(self.stream)
+        self.assertEqual((decoder.crc_errors, decoder.lost, decoder.skipped_bytes), (0, 0, 0))
+        windows = [f.fields for f in frames if f.type == tf.WINDOW]
+        self.assertEqual(len(windows), len(self.samples) // 6 // 156)
+        self.assertEqual(len([f for f in frames if f.type == tf.STAGES]), len(windows))
+        self.assertEqual(len([f for f in frames if f.type == tf.HEALTH]), 60)
+        tremor = [w for w in windows if w["raw_detection"] == 1]
+        self.assertTrue(tremor)
+        self.assertTrue(all(abs(w["tremor_freq_chz"] - 480) <= 30 for w in tremor))
+
+    def test_monitor_reads_a_capture(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "capture.bin")
+            with open(path, "wb") as f:
+                f.write(self.stream)
+            out = io.StringIO()
+            with contextlib.redirect_stdout(out):
+                pd_monitor.main(["--once", path])
+        self.assertIn("CRC errors 0  lost 0", out.getvalue())
+        self.assertIn("detection TREMOR", out.getvalue())
+
+    def test_monitor_reads_a_simulated_pty(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "session.csv")
+            record_convert.write_csv(path, self.samples)
+            out = io.StringIO()
+            with contextlib.redirect_stdout(out):
+                pd_monitor.main(["--once", "--simulate", path, "--speed", "1000"])
+        frames = tf.FrameDecoder().feed(self.stream)
+        self.assertIn("PD monitor  %d frames  %d B  CRC errors 0  lost 0" % (len(frames), len(self.stream)),
+                      out.getvalue())
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,90 @@
+/**
+ * @file baseline.h
+ * @brief Per-patient adaptive baseline and personalized detection thresholds
+ *
+ * During normal wear the distributions of a few per-window metrics are
+ * tracked with P² streaming quantile estimators (five markers each, fixed
+ * memory, O(1) per observation):
+ * - the 0.5-2 Hz noise floor (low quantile)
+ * - tremor and dyskinesia band peak over the floor (high quantile), from
+ *   windows that the default factors would not detect and with no
+ *   confirmed episode only, so the thresholds cannot ratchet up on
+ *   symptoms they have stopped detecting
+ * - accel magnitude variance while walking (low quantile)
+ *
+ * After a burn-in the thresholds in personal_thresholds are derived from
+ * these quantiles. They are bounded between the population defaults
+ * (config.h) and a cap, so personalization only ever makes detection
+ * stricter for patients whose everyday baseline sits near the defaults.
+ * The model is persisted through KVStore (kv_writer.h) and restored at
+ * boot. A replay with learning off (replay_learning) ignores observations.
+ */
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include "mbed.h"
+#include "config.h"
+
+const uint32_t BASELINE_BURN_IN_WINDOWS = 1200;      // analysed windows (~1 h of movement)
+const uint32_t BASELINE_WALK_BURN_IN_WINDOWS = 100;  // walking windows
+const float BASELINE_RATIO_MARGIN = 1.2f;            // threshold above the everyday high quantile
+const float BASELINE_FACTOR_CAP = 2.0f;              // personal factor <= 2x the default
+const float BASELINE_FLOOR_MIN_CAP = 0.5f;
+const float BASELINE_FREEZE_VARIANCE_MIN = 0.005f;
+const float BASELINE_FREEZE_SHARE = 0.5f;            // freeze variance vs low walking variance
+const uint32_t BASELINE_SAVE_INTERVAL_MS = 1800000;  // at most one flash write per 30 min
+const char* const BASELINE_KV_KEY = "/kv/baseline";
+
+// P² estimate of one quantile
+struct P2Quantile {
+    float p;
+    float height[5];
+    float desired[5];
+    int32_t position[5];
+    uint32_t count;
+};
+
+enum BaselineMetric {
+    BASELINE_NOISE_FLOOR,        // P10
+    BASELINE_TREMOR_RATIO,       // P95 of tremor peak / floor
+    BASELINE_DYSK_RATIO,         // P95 of dysk peak / floor
+    BASELINE_WALK_VARIANCE,      // P10 while walking
+    BASELINE_METRICS
+};
+
+struct PersonalThresholds {
+    float noise_floor_min;       // replaces the fixed floor clamp
+    float tremor_factor;         // tremor threshold = floor * factor
+    float dysk_factor;
+    float freeze_variance_max;   // FOG: max variance of a freeze
+    bool band_personal;          // band burn-in complete
+    bool gait_personal;          // walking burn-in complete
+    bool restored;               // model loaded from flash at boot
+};
+
+extern PIPELINE_STATE P2Quantile baseline_sketch[BASELINE_METRICS];
+extern PIPELINE_STATE PersonalThresholds personal_thresholds;
+
+void init_baseline();
+
+void p2_init(P2Quantile* q, float p);
+void p2_add(P2Quantile* q, float x);
+float p2_value(const P2Quantile* q);
+
+/**
+ * @brief Observe an analysed, symptom-free window (unclamped floor, peaks over the used floor)
+ */
+void baseline_observe_spectrum(float raw_noise_floor, float tremor_ratio, float dysk_ratio);
+
+/**
+ * @brief Observe a window classified as walking
+ */
+void baseline_observe_gait(float variance);
+
+/**
+ * @brief Refresh personal_thresholds and persist periodically (once per window)
+ */
+void baseline_update(uint32_t current_time);
+
+#endif // BASELINE_H
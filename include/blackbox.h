@@ -0,0 +1,91 @@
+/**
+ * @file blackbox.h
+ * @brief Pre-event capture of raw 6-axis data around detections
+ *
+ * Raw int16 samples are written into a circular SoA capture slot sized for
+ * BLACKBOX_PRE_SAMPLES of history plus BLACKBOX_POST_SAMPLES of tail. When
+ * a triggering episode is confirmed, the slot keeps recording the tail
+ * (which only overwrites samples older than the pre-trigger window), then
+ * it is frozen by handing the slot pointer to the frozen list and switching
+ * acquisition to a free slot. Nothing is copied, so acquisition never
+ * stalls. The new live slot starts empty, so a trigger shortly after a
+ * freeze gets a shorter pre-trigger window (see BlackboxCapture::filled).
+ * Frozen captures stay in RAM until a consumer releases them; the flash
+ * log moves one to flash within a few main-loop passes. A trigger while
+ * the only spare slot still holds a capture is counted in
+ * blackbox_dropped rather than given more RAM.
+ */
+
+#ifndef BLACKBOX_H
+#define BLACKBOX_H
+
+#include "mbed.h"
+#include "config.h"
+#include "episode_tracker.h"
+
+const size_t BLACKBOX_PRE_SAMPLES = 624;    // 12 s at 52 Hz (covers 3-window confirmation)
+const size_t BLACKBOX_POST_SAMPLES = 156;   // 3 s tail
+const size_t BLACKBOX_CAPTURE_SAMPLES = BLACKBOX_PRE_SAMPLES + BLACKBOX_POST_SAMPLES;
+const size_t BLACKBOX_SLOTS = 2;            // one live + one frozen (9.4 KB each)
+
+// EpisodeType bits that trigger a capture
+const uint8_t BLACKBOX_TRIGGER_MASK = (1u << EPISODE_DYSK) | (1u << EPISODE_FOG);
+
+enum BlackboxState : uint8_t {
+    BLACKBOX_FREE,
+    BLACKBOX_LIVE,        // pre-trigger ring
+    BLACKBOX_TAIL,        // triggered, recording post-trigger samples
+    BLACKBOX_FROZEN,      // complete, waiting for a consumer
+    BLACKBOX_READING      // handed to a consumer
+};
+
+struct BlackboxCapture {
+    int16_t data[IMU_AXES][BLACKBOX_CAPTURE_SAMPLES];
+    uint32_t write_pos;           // next ring index
+    uint32_t filled;              // valid samples, <= BLACKBOX_CAPTURE_SAMPLES
+    uint32_t first_sample;        // sample_count index of the oldest sample (set on freeze)
+    uint32_t trigger_sample;      // sample_count index at trigger
+    uint32_t trigger_ms;
+    uint16_t post_remaining;
+    uint8_t trigger_type;         // EpisodeType
+    volatile uint8_t state;       // BlackboxState
+};
+
+extern uint32_t blackbox_captures;   // captures frozen
+extern uint32_t blackbox_dropped;    // triggers lost because no slot was free
+
+void init_blackbox();
+
+/**
+ * @brief Append one raw sample (called from read_sensor_data)
+ */
+void blackbox_push(const int16_t raw[IMU_AXES]);
+
+/**
+ * @brief Empty the live pre-trigger ring after a gap in the pushes (night mode)
+ */
+void blackbox_flush();
+
+/**
+ * @brief Arm a capture: record the tail and freeze when it completes
+ */
+void blackbox_trigger(uint8_t trigger_type);
+
+/**
+ * @brief Take the oldest frozen capture (state becomes READING), or nullptr
+ */
+BlackboxCapture* blackbox_acquire_frozen();
+
+/**
+ * @brief Return a capture obtained from blackbox_acquire_frozen()
+ */
+void blackbox_release(BlackboxCapture* capture);
+
+/**
+ * @brief Zero-copy chronological view of one column as up to two spans
+ */
+void blackbox_column_spans(const BlackboxCapture* capture, ImuAxis axis,
+                           const int16_t** first, size_t* first_len,
+                           const int16_t** second, size_t* second_len);
+
+#endif // BLACKBOX_H
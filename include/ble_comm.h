@@ -7,6 +7,20 @@
 #define BLE_COMM_H
 
 #include "mbed.h"
+#include "config.h"
+
+// Episode events waiting to be notified (one per update); oldest dropped when full
+const size_t BLE_EPISODE_QUEUE_SIZE = 8;
+
+extern bool ble_connected;
+extern uint32_t ble_tx_bytes;       // characteristic value bytes written
+extern uint32_t ble_episodes_dropped;  // episode events overwritten before notify
+
+void ble_set_advertising_interval(uint32_t interval_ms);
+
+// The host build (env:native) has no radio: only the counters above exist,
+// provided by lib/host_platform
+#ifndef PD_HOST_BUILD
 #include "ble/BLE.h"
 #include "ble/Gap.h"
 #include "ble/GattServer.h"
@@ -14,19 +28,25 @@
 #include "ble/gatt/GattService.h"
 #include "ble/gap/AdvertisingDataBuilder.h"
 #include "events/EventQueue.h"
-#include "config.h"
 
 extern events::EventQueue ble_event_queue;
 extern BLE &ble_instance;
 extern GattCharacteristic *tremor_char;
 extern GattCharacteristic *dysk_char;
 extern GattCharacteristic *fog_char;
+extern GattCharacteristic *summary_char;
+extern GattCharacteristic *episode_char;
+extern GattCharacteristic *brady_char;
+extern GattCharacteristic *spectro_char;
+extern GattCharacteristic *summary_rev_char;
+extern GattCharacteristic *time_char;
 extern GattServer *gatt_server;
-extern bool ble_connected;
 
 void schedule_ble_events(BLE::OnEventsToProcessCallbackContext *context);
 void on_ble_init_complete(BLE::InitializationCompleteCallbackContext *params);
 void update_ble_characteristics();
 void init_ble();
 
+#endif // PD_HOST_BUILD
+
 #endif // BLE_COMM_H
\ No newline at end of file
@@ -0,0 +1,94 @@
+/**
+ * @file bradykinesia.h
+ * @brief Bradykinesia metrics from repetitive pronation/supination
+ *
+ * The forearm-axis gyro channel is read in place from raw_imu_buffer and
+ * segmented into movement cycles at rising zero crossings (with
+ * hysteresis), so a cycle always contains one positive and one negative
+ * half-wave. Each valid cycle gives an amplitude (integrated rotation,
+ * degrees), a peak speed and a period.
+ *
+ * Consecutive cycles form a sequence. Decrement is the least-squares slope
+ * of amplitude and speed over the cycle index, kept as running sums so each
+ * new cycle costs O(1). Rhythm is the coefficient of variation of the
+ * period.
+ */
+
+#ifndef BRADYKINESIA_H
+#define BRADYKINESIA_H
+
+#include "mbed.h"
+#include "config.h"
+
+const ImuAxis BRADY_AXIS = IMU_GX;               // board x axis along the forearm
+const float BRADY_HYSTERESIS_DPS = 30.0f;
+const float BRADY_MIN_PEAK_DPS = 60.0f;
+const uint32_t BRADY_MIN_PERIOD_MS = 250;
+const uint32_t BRADY_MAX_PERIOD_MS = 2500;
+const uint32_t BRADY_SEQUENCE_GAP_MS = 2500;     // no valid cycle for this long ends a sequence
+const uint16_t BRADY_MIN_SEQUENCE_CYCLES = 5;    // before a score is reported
+const float BRADY_REFERENCE_SPEED_DPS = 600.0f;  // typical unimpaired peak speed
+
+struct BradykinesiaResult {
+    uint32_t sequence_start_sample;
+    uint16_t sequence_cycles;
+    uint8_t cycles_in_window;
+    bool sequence_active;
+    float mean_amplitude_deg;
+    float mean_speed_dps;
+    float mean_period_ms;
+    float rhythm_cv;             // period std / mean
+    float amplitude_decrement;   // fitted change per cycle / initial amplitude (< 0 = shrinking)
+    float speed_decrement;       // same for peak speed
+    uint16_t score;              // 0-1000, 0 until BRADY_MIN_SEQUENCE_CYCLES
+};
+
+// BLE payload (little-endian)
+struct BradyPacket {
+    uint16_t score;
+    uint16_t cycles;
+    uint16_t amplitude_ddeg;     // 0.1 degree
+    uint16_t speed_dps;
+    uint16_t period_ms;
+    int16_t amplitude_decrement_permille;
+    int16_t speed_decrement_permille;
+    uint16_t rhythm_cv_permille;
+};
+
+static_assert(sizeof(BradyPacket) == 16, "BradyPacket layout changed");
+
+// Cycle segmentation and sequence sums carried between windows (checkpoint.h)
+struct BradyState {
+    BradykinesiaResult result;
+    float n;                     // running sums, x = cycle index
+    float sx, sxx;
+    float s_amp, sx_amp;
+    float s_speed, sx_speed;
+    float s_period, s_period2;
+    int8_t phase;                // +1 / -1 half-wave, 0 before the first crossing
+    bool cycle_open;
+    uint32_t cycle_start_sample;
+    uint32_t last_cycle_end;
+    float angle;
+    float angle_min;
+    float angle_max;
+    float peak_speed;
+};
+
+extern PIPELINE_STATE BradykinesiaResult brady_result;
+
+void init_bradykinesia();
+
+/**
+ * @brief Segment the window in raw_imu_buffer (first sample = start_sample)
+ *
+ * Cycle state carries over between windows.
+ */
+void bradykinesia_update_window(uint32_t start_sample);
+
+void bradykinesia_packet(BradyPacket* packet);
+
+void bradykinesia_save(BradyState* state);
+void bradykinesia_restore(const BradyState* state);
+
+#endif // BRADYKINESIA_H
@@ -0,0 +1,97 @@
+/**
+ * @file calibration.h
+ * @brief Online gyro-bias and accelerometer offset/scale calibration
+ *
+ * Still windows (low gyro and accel-magnitude variance) are used to
+ * refine a per-axis gyro bias (EMA of the at-rest mean) and to collect
+ * up to CAL_MAX_ORIENTATIONS distinct gravity directions. Once enough
+ * directions are available, the accelerometer offset and scale are
+ * fitted so that every corrected direction has a magnitude of 1 g.
+ *
+ * Bias drift with temperature is modelled per axis as a linear function of
+ * the LSM6DSL die temperature (sampled at ~1 Hz). Slopes are fitted online
+ * from still windows with a forgetting-factor least-squares fit and only
+ * used once the temperatures seen span enough range.
+ *
+ * The result is folded into per-axis gain/bias coefficients that
+ * read_sensor_data() applies to each sample in a single multiply-add
+ * pass with no branches. The calibration is persisted to internal flash
+ * through KVStore and restored at boot.
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include "mbed.h"
+#include "config.h"
+
+const size_t CAL_MAX_ORIENTATIONS = 12;
+const size_t CAL_MIN_ORIENTATIONS = 6;           // needed for the offset/scale fit
+const float CAL_STILL_GYRO_STD_DPS = 0.6f;       // per-axis std at rest
+const float CAL_ORIENTATION_MIN_DEG = 20.0f;     // separation between stored directions
+const uint32_t CAL_SAVE_INTERVAL_MS = 600000;    // at most one flash write per 10 min
+const char* const CAL_KV_KEY = "/kv/imu_cal";
+
+const float CAL_TEMP_REF_C = 25.0f;              // LSM6DSL temperature output zero point
+const float CAL_TEMP_MIN_SPREAD_C = 1.0f;        // temperature std needed to trust a slope
+const float CAL_TEMP_FORGET = 0.995f;            // per still window
+const float CAL_GYRO_TEMP_COEFF_MAX = 0.1f;      // dps/°C
+const float CAL_ACCEL_TEMP_COEFF_MAX = 0.002f;   // g/°C
+
+struct CalibrationState {
+    float gyro_bias[3];          // dps
+    float accel_offset[3];       // g
+    float accel_scale[3];
+    float accel_residual_g;      // RMS of | |a_corrected| - 1 g | over stored directions
+    float gyro_residual_dps;     // |at-rest mean - bias| of the last still window
+    uint32_t updated_ms;         // uptime of the last update (0 = none this session)
+    uint32_t still_windows;
+    float temperature_c;         // latest die temperature
+    float gyro_temp_coeff[3];    // dps/°C: bias(T) = gyro_bias + coeff * (T - 25 °C)
+    float accel_temp_coeff[3];   // g/°C, added to accel_offset the same way
+    float temp_spread_c;         // std of the temperatures seen in still windows
+    uint8_t orientations;        // stored gravity directions
+    bool gyro_valid;
+    bool accel_valid;
+    bool temp_valid;             // temperature slopes in use
+    bool restored;               // loaded from flash at boot
+};
+
+// Decode coefficients: physical = raw * cal_gain + cal_bias
+extern PIPELINE_STATE float cal_gain[IMU_AXES];
+extern PIPELINE_STATE float cal_bias[IMU_AXES];
+extern PIPELINE_STATE CalibrationState calibration;
+
+void init_calibration();
+
+/**
+ * @brief Convert one raw sample to g / dps with calibration applied
+ */
+inline void calibration_apply(const int16_t raw[IMU_AXES], float out[IMU_AXES]) {
+    for (int axis = 0; axis < IMU_AXES; axis++) {
+        out[axis] = raw[axis] * cal_gain[axis] + cal_bias[axis];
+    }
+}
+
+/**
+ * @brief Set the die temperature and refresh cal_bias for it
+ *
+ * Called at a low rate from the acquisition path, so temperature
+ * compensation costs nothing per sample.
+ */
+void calibration_set_temperature(float temperature_c);
+
+/**
+ * @brief Update estimates from the raw window in raw_imu_buffer
+ *
+ * Called once per window; does nothing unless the window is still (or
+ * learning is off, see replay_learning).
+ */
+void calibration_update_window(uint32_t current_time);
+
+/**
+ * @brief Seconds since the last update (UINT32_MAX if none this session)
+ */
+uint32_t calibration_age_s(uint32_t current_time);
+
+#endif // CALIBRATION_H
@@ -0,0 +1,138 @@
+/**
+ * @file checkpoint.h
+ * @brief Versioned snapshot and restore of the pipeline state
+ *
+ * PipelineState is a flat, fixed-layout copy of the state the detectors
+ * carry between windows. It is refreshed in RAM after every window (under
+ * a kilobyte of copies) and posted to the KV writer thread (kv_writer.h)
+ * every CHECKPOINT_INTERVAL_MS. At boot, after the modules have
+ * initialised, the stored state is applied in two tiers:
+ *  - slow state (step-detector gravity baseline, accel/gyro fusion weight,
+ *    sensor noise level, the phone's UTC offset) is always restored;
+ *  - short-term state (detection confirmation counters and EMA intensities,
+ *    FOG state machine and step hysteresis, motor-state levels, open
+ *    episodes, the bradykinesia sequence, the last heel strike, night-mode
+ *    statistics)
+ *    is restored only when the snapshot is at most CHECKPOINT_MAX_GAP_S
+ *    old. Timestamps are rebased onto the new uptime clock and sample
+ *    indices onto the new sample_count.
+ * The age comes from the RTC. The STM32 RTC keeps counting through a
+ * software, watchdog or pin reset whether or not it was set, so after a
+ * warm reset the raw difference is valid. After a power loss it restarts,
+ * and only a clock set (over BLE) on both sides vouches for the gap.
+ * Calibration and the personal baseline keep their own records.
+ *
+ * PipelineHistory holds the sample and spectral histories (multi-resolution
+ * ring, spectrogram, coherence averages). It is 14 KB and is not persisted:
+ * after any outage
+ * the new samples would be spliced onto stale ones (as after a night-mode
+ * wake, see multires_flush). In-process checkpoints, such as a replay
+ * resuming mid-recording, carry it with pipeline_snapshot_history.
+ *
+ * The snapshot/restore functions take no hidden inputs besides the module
+ * globals, so a replay can checkpoint and resume with them too. Together
+ * the two cover everything the detectors carry from one window to the next
+ * apart from the learnt calibration and baseline: a pipeline restored at a
+ * window boundary, with the sample clock set to match, produces the same
+ * windows as the one the snapshot was taken from (detect_run_chunked
+ * relies on this).
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "mbed.h"
+#include "config.h"
+#include "signal_processing.h"
+#include "fog_detection.h"
+#include "motor_state.h"
+#include "episode_tracker.h"
+#include "bradykinesia.h"
+#include "night_mode.h"
+#include "multires.h"
+#include "spectrogram.h"
+
+const char* const CHECKPOINT_KV_KEY = "/kv/pipeline";
+const uint32_t CHECKPOINT_INTERVAL_MS = 60000;   // flash write at most once a minute
+const uint32_t CHECKPOINT_MAX_GAP_S = 120;       // snapshot age + downtime for short-term state
+
+struct PipelineState {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                   // sizeof(PipelineState) when written
+    uint32_t saved_rtc;              // raw time(NULL) at snapshot, set or not
+    uint32_t saved_ms;               // uptime at snapshot (timestamps below use this clock)
+    uint32_t saved_sample;           // sample_count at snapshot (sample indices below)
+
+    // Slow state
+    float accel_baseline_ema;
+    float fusion_accel_weight;
+    float still_noise_lsb;
+    uint32_t still_windows;
+    uint32_t noise_jump_run;
+    int16_t utc_offset_min;
+
+    // Short-term state
+    DetectionConfirmation detection;
+    uint16_t tremor_intensity;
+    uint16_t dysk_intensity;
+    FOGDetector fog;
+    uint32_t last_step_time_ms;
+    bool above_step_threshold;
+    uint8_t fog_status;
+    MotorStateEstimate motor;
+    EpisodeTrack episodes[EPISODE_TYPES];
+    uint32_t episode_sequence;
+    BradyState brady;
+    uint32_t last_strike_ms;
+    NightModeStats night;
+    bool night_active;
+};
+
+// Histories, in-process only (see above)
+struct PipelineHistory {
+    MultiResHistory multires;
+    SpectroHistory spectro;
+    CoherenceHistory coherence;
+};
+
+enum RestoreLevel : uint8_t {
+    RESTORE_NONE,
+    RESTORE_SLOW,                    // slow state only
+    RESTORE_FULL
+};
+
+struct CheckpointStats {
+    uint32_t saves;                  // posted to the KV writer (kv_writer_stats has the outcome)
+    uint32_t last_save_ms;
+    RestoreLevel restored;
+    uint32_t restored_gap_s;         // snapshot age at boot, if known
+};
+
+extern PIPELINE_STATE CheckpointStats checkpoint_stats;
+
+/**
+ * @brief Restore the stored state; call after all module init_*() calls
+ */
+void init_checkpoint();
+
+/**
+ * @brief Refresh the RAM snapshot and write it out when due (once per window)
+ */
+void checkpoint_update(uint32_t current_time);
+
+void pipeline_snapshot(PipelineState* state, uint32_t current_time);
+
+/**
+ * @brief Apply a snapshot to the module globals
+ *
+ * @param level         RESTORE_SLOW leaves the short-term detectors as initialised
+ * @param current_time  Uptime clock the restored timestamps are rebased onto
+ *                      (sample indices are rebased onto sample_count)
+ */
+void pipeline_restore(const PipelineState* state, RestoreLevel level, uint32_t current_time);
+
+void pipeline_snapshot_history(PipelineHistory* history);
+void pipeline_restore_history(const PipelineHistory* history);
+
+#endif // CHECKPOINT_H
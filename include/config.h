@@ -7,8 +7,30 @@
 #define CONFIG_H
 
 #include "mbed.h"
+#include <ctime>
+#ifndef PD_HOST_BUILD
 #include "ble/BLE.h"
 #include "ble/UUID.h"
+#endif
+
+// Pipeline module state (buffers, detector and tracker state, scratch).
+// The host build (PD_HOST_BUILD, env:native) makes it thread_local, so every
+// thread that replays a recording owns a complete pipeline of its own; on
+// the device it is plain static storage.
+#ifdef PD_HOST_BUILD
+#define PIPELINE_STATE thread_local
+#else
+#define PIPELINE_STATE
+#endif
+
+// Replay (detect_api.h): the pipeline runs on recorded samples, with
+// persistence (KVStore, flash log, black box), sensor/BLE reconfiguration
+// and wall-clock dependent behaviour (night mode) switched off
+extern PIPELINE_STATE bool replay_mode;
+
+// Calibration and personal-baseline learning; only a replay can turn it off
+// (detect_set_learning), on the device it is always on
+extern PIPELINE_STATE bool replay_learning;
 
 // Hardware configuration
 #define LSM6DSL_ADDR        (0x6A << 1)
@@ -20,18 +42,55 @@
 #define STATUS_REG          0x1E
 #define OUTX_L_XL           0x28
 #define OUTX_L_G            0x22
+#define OUT_TEMP_L          0x20
 #define LSM6DSL_WHO_AM_I_VAL  0x6A
 
+// Raw IMU channel order (column index in SoA raw buffers)
+enum ImuAxis {
+    IMU_AX, IMU_AY, IMU_AZ,
+    IMU_GX, IMU_GY, IMU_GZ,
+    IMU_AXES
+};
+
+// LSM6DSL sensitivity at ±2 g / ±250 dps
+const float ACCEL_SCALE = 0.000061f;   // g per LSB
+const float GYRO_SCALE = 0.00875f;     // dps per LSB
+const float TEMP_SCALE = 1.0f / 256.0f;  // °C per LSB, 0 = 25 °C
+const uint32_t TEMP_READ_INTERVAL_SAMPLES = 52;  // ~1 Hz
+
 // Signal processing
 const float TARGET_SAMPLE_RATE_HZ = 52.0f;
 const size_t WINDOW_SIZE = 156;
 const size_t FFT_SIZE = 256;
+const float STILLNESS_STD_THRESHOLD = 0.005f;  // accel magnitude std (g) below which a window is "still"
 
 // Detection parameters
 const uint8_t DETECTION_CONFIRM_WINDOWS = 3;
 const uint8_t CLEAR_CONFIRM_WINDOWS = 3;
 const float EMA_ALPHA = 0.3f;
 
+// Population default thresholds (personalized in baseline.h)
+const float NOISE_FLOOR_MIN = 0.25f;           // floor clamp for the band thresholds
+const float TREMOR_THRESHOLD_FACTOR = 3.0f;    // x noise floor
+const float DYSK_THRESHOLD_FACTOR = 4.0f;
+const float FOG_FREEZE_VARIANCE_MAX = 0.020f;
+
+// Harmonic analysis (fundamental search over the 3-7 Hz bands)
+const size_t HARMONIC_COUNT = 3;               // fundamental + 2 harmonics
+const size_t HARMONIC_LOBE_BINS = 2;           // Hann main-lobe half width after zero padding
+const float HARMONIC_CONFIDENCE_MIN = 0.5f;    // share of series energy needed to reattribute
+
+// Accel/gyro fusion weights (SNR-adaptive, replaces the fixed 0.7/0.3 blend)
+const float FUSION_DEFAULT_ACCEL_WEIGHT = 0.7f;
+const float FUSION_WEIGHT_MIN = 0.15f;          // neither sensor is ever dropped completely
+const float FUSION_WEIGHT_ALPHA = 0.3f;         // EMA across windows
+
+// Accel-gyro coherence (tremor confirmation: most active gyro axis, accel along the gravity it moves)
+const float COHERENCE_MIN = 0.6f;              // magnitude-squared coherence at the tremor peak
+const float COHERENCE_EMA_ALPHA = 0.3f;        // cross/auto spectra averaging across windows
+const uint8_t COHERENCE_MIN_WINDOWS = 3;       // averaged before the gate can pass: one window always looks coherent
+const size_t COHERENCE_MAX_BINS = 32;          // covers 3-7 Hz at FFT_SIZE 256
+
 const float STEP_THRESHOLD = 0.03f;
 const uint32_t MIN_STEP_INTERVAL_MS = 100;
 
@@ -40,10 +99,36 @@ const uint32_t DYSK_TOTAL_PERIOD_MS = 250;
 const uint32_t FOG_CYCLE_PERIOD_MS = 1000;
 const uint32_t HEARTBEAT_PERIOD_MS = 2000;
 
+// RTC: unset after a cold boot, set over BLE (TIME_CHAR_UUID_STR). It runs
+// on UTC; the phone's UTC offset comes with the time write.
+const uint32_t RTC_VALID_EPOCH = 1577836800;   // clock counts as set from 2020-01-01
+const int16_t RTC_MAX_UTC_OFFSET_MIN = 14 * 60;  // UTC-12 .. UTC+14 fit within this
+
+extern PIPELINE_STATE int16_t rtc_utc_offset_min;   // local time = UTC + offset
+
+/**
+ * @brief Local wall-clock time from the RTC and rtc_utc_offset_min
+ * @return false while the clock has not been set
+ */
+bool rtc_local_time(struct tm* local);
+
+/**
+ * @brief Same as rtc_local_time(), as seconds since 1970-01-01 00:00 local
+ * @return false while the clock has not been set
+ */
+bool rtc_local_seconds(time_t* local);
+
 // BLE configuration
 extern const char* PD_SERVICE_UUID_STR;
 extern const char* TREMOR_CHAR_UUID_STR;
 extern const char* DYSK_CHAR_UUID_STR;
 extern const char* FOG_CHAR_UUID_STR;
+extern const char* SUMMARY_CHAR_UUID_STR;
+extern const char* EPISODE_CHAR_UUID_STR;
+extern const char* BRADY_CHAR_UUID_STR;
+extern const char* SPECTRO_CHAR_UUID_STR;
+extern const char* SUMMARY_REV_CHAR_UUID_STR;
+extern const char* TIME_CHAR_UUID_STR;
+const uint32_t BLE_ADV_INTERVAL_MS = 1000;
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -0,0 +1,69 @@
+/**
+ * @file data_quality.h
+ * @brief Per-window sensor data quality and fault monitor
+ *
+ * One pass over the raw int16 window checks for:
+ * - stuck data: an axis that never changes, or runs of identical 6-axis
+ *   samples (stale registers re-read after the sensor stopped updating)
+ * - saturation: samples at the ±2 g / ±250 dps rails
+ * - implausible gravity: mean accel magnitude far from 1 g
+ * - noise jumps: sample-to-sample gyro noise on still windows moving far
+ *   from its running level
+ * Dropouts (gaps between reads) and failed I2C reads are counted on the
+ * acquisition path in sensor.cpp and picked up per window.
+ *
+ * Windows scoring below QUALITY_MIN_SCORE are not analysed: detector
+ * counters are held, so a bad window neither confirms nor clears a state.
+ */
+
+#ifndef DATA_QUALITY_H
+#define DATA_QUALITY_H
+
+#include "mbed.h"
+#include "config.h"
+
+const uint8_t QUALITY_MIN_SCORE = 60;            // 0-100, below this the window is rejected
+const size_t QUALITY_STUCK_RUN = 4;              // identical consecutive 6-axis samples
+const int16_t QUALITY_SATURATION_LSB = 32700;
+const float QUALITY_GRAVITY_MIN_G = 0.6f;        // plausible window-mean accel magnitude
+const float QUALITY_GRAVITY_MAX_G = 1.4f;
+const float QUALITY_NOISE_JUMP_RATIO = 4.0f;     // still-window noise vs its running level
+const float QUALITY_NOISE_ALPHA = 0.1f;
+const uint32_t QUALITY_NOISE_MIN_WINDOWS = 5;    // still windows before the noise check is armed
+const uint32_t QUALITY_NOISE_RELEARN_WINDOWS = 20;  // consecutive jumps accepted as a new level
+const float QUALITY_GAP_PERIODS = 2.5f;          // read interval counted as a dropout
+
+enum QualityFlag {
+    QUALITY_STUCK      = 0x01,
+    QUALITY_DROPOUT    = 0x02,
+    QUALITY_READ_ERROR = 0x04,
+    QUALITY_SATURATED  = 0x08,
+    QUALITY_MAGNITUDE  = 0x10,
+    QUALITY_NOISE_JUMP = 0x20,
+    QUALITY_FLAG_COUNT = 6
+};
+
+struct DataQualityStats {
+    uint32_t windows;
+    uint32_t rejected;
+    uint32_t flag_counts[QUALITY_FLAG_COUNT];   // indexed by bit position
+    float still_noise_lsb;                       // running gyro |diff| on still windows
+    uint32_t still_windows;
+    uint32_t noise_jump_run;                     // consecutive still windows off that level
+};
+
+extern PIPELINE_STATE DataQualityStats quality_stats;
+
+void init_data_quality();
+
+/**
+ * @brief Assess the window in raw_imu_buffer
+ *
+ * @param accel_mean  Mean accel magnitude of the window (g)
+ * @param std_dev     Accel magnitude std (g), selects still windows
+ * @param flags       QualityFlag bits found
+ * @return Quality score 0-100
+ */
+uint8_t data_quality_assess(float accel_mean, float std_dev, uint8_t* flags);
+
+#endif // DATA_QUALITY_H
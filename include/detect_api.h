@@ -0,0 +1,150 @@
+/**
+ * @file detect_api.h
+ * @brief C ABI over the detection pipeline for replay and bindings
+ *
+ * Recorded raw samples go through the same path as live data
+ * (sensor_ingest_sample, then process_window on every full window), and
+ * each window comes back as a flat, fixed-layout DetectWindow. The input
+ * is read in place through per-axis pointers with an element stride, so
+ * interleaved (n x 6) and column-major (6 x n) int16 arrays are both
+ * accepted without a copy.
+ *
+ * Replay mode: persistence (KVStore, flash log, black box), sensor and
+ * BLE reconfiguration and night mode are off, and the multi-resolution
+ * jobs run every hop instead of within the CPU budget, so the same input
+ * always gives the same windows.
+ *
+ * Pipeline state (PIPELINE_STATE, config.h) is thread_local in the host
+ * build: each thread has its own pipeline and threads replay independently.
+ * Calls on one thread continue that thread's pipeline. detect_run_chunked
+ * uses this to spread one recording over several threads.
+ *
+ * Plain C header: no mbed or C++ types.
+ */
+
+#ifndef DETECT_API_H
+#define DETECT_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DETECT_API_VERSION 1
+
+typedef struct {
+    uint32_t window_index;
+    uint32_t start_sample;
+    float std_dev;               /* accel magnitude std (g) */
+    float tremor_freq;           /* Hz, 0 if not analysed */
+    float dysk_freq;
+    float raw_intensity;
+    float freeze_index;
+    uint16_t tremor_intensity;   /* confirmed, 0-1000 */
+    uint16_t dysk_intensity;
+    uint16_t brady_score;
+    uint16_t off_score;
+    uint16_t steps;
+    uint8_t raw_detection;       /* 0 none, 1 tremor, 2 dyskinesia */
+    uint8_t fog_state;           /* 0 not walking, 1 walking, 2 potential freeze, 3 freeze */
+    uint8_t quality_score;
+    uint8_t quality_flags;
+    uint8_t motor_state;         /* 0 unknown, 1 ON, 2 OFF, 3 dyskinetic ON */
+    uint8_t heel_strikes;
+} DetectWindow;
+
+/**
+ * @brief Reset the calling thread's pipeline to its power-on state and
+ *        enter replay mode (stored calibration and baseline are not loaded)
+ */
+void detect_reset(void);
+
+/**
+ * @brief Feed recorded samples and collect the windows they complete
+ *
+ * @param axes        Six int16 axis pointers, order ax ay az gx gy gz (raw LSM6DSL counts)
+ * @param stride      Distance between consecutive samples of one axis, in elements
+ * @param n_samples   Samples to feed
+ * @param start_ms    Timestamp of the first sample (sample i is at start_ms + i / 52 Hz)
+ * @param out         Window results, in order
+ * @param max_out     Capacity of out; later windows are processed but not returned
+ * @return            Number of windows completed (may exceed max_out)
+ *
+ * Continues from the previous call on this thread, so a recording can be
+ * fed in pieces; the first call on a thread resets it.
+ */
+size_t detect_run(const int16_t* const axes[6], size_t stride, size_t n_samples,
+                  uint32_t start_ms, DetectWindow* out, size_t max_out);
+
+/**
+ * @brief Turn calibration and personal-baseline learning on or off for the
+ *        calling thread's pipeline (detect_reset turns it on)
+ *
+ * With learning off both stay as the reset left them (uncalibrated,
+ * population thresholds) for the rest of the replay.
+ */
+void detect_set_learning(int enabled);
+
+#define DETECT_CHUNK_WARMUP_WINDOWS 1000   /* ~43 min, see detect_run_chunked */
+
+typedef struct {
+    size_t threads;              /* worker threads, 0 = one per hardware thread */
+    size_t segment_windows;      /* windows per segment, 0 = an equal share per thread */
+    size_t warmup_windows;       /* replayed ahead of each segment, 0 = DETECT_CHUNK_WARMUP_WINDOWS */
+} DetectChunking;
+
+typedef struct {
+    size_t segments;
+    size_t reconciled;           /* warm-up reached the state of the run before it */
+    size_t replayed;             /* replayed again from the end of the segment before */
+    size_t replayed_windows;     /* windows those replays took to meet the worker's state */
+} DetectChunkStats;
+
+/**
+ * @brief Replay a whole recording in segments on several threads
+ *
+ * Returns the windows of detect_reset(), detect_set_learning(0) and one
+ * detect_run() over the recording, bit for bit. Learning is off because
+ * the calibration and baseline learners keep statistics of everything
+ * before them, which no segment can see.
+ *
+ * The recording is cut into segments on the window grid, and each worker
+ * thread starts a fresh pipeline warmup_windows ahead of its segment, with
+ * the sample clock set as if it had run from the start. At the segment's
+ * first window its state (pipeline_snapshot and pipeline_snapshot_history,
+ * checkpoint.h) is compared with the state the previous segment ended in.
+ * Open episodes only feed episode records, not windows, and are left out;
+ * counters and timestamps that are only compared against a threshold are
+ * compared saturated. If the states are equal the segment's windows stand,
+ * since the same state and samples give the same windows. Otherwise the
+ * segment is replayed on the calling thread from the previous segment's
+ * end state, which is exact, until it meets the worker's state at one of
+ * the marks the worker kept every 100 windows; the worker's windows from
+ * there on stand.
+ *
+ * The motor-state estimate would need thousands of windows to forget its
+ * start to the last bit (0.5 % per active window), and nothing else reads
+ * it back, so it is left out of the comparison and run over the whole
+ * recording afterwards from the per-window inputs (motor_state.h). The
+ * rest settles in a few hundred windows; float EMAs can keep a last-bit
+ * difference for longer, which the marks keep cheap to replay. A shorter
+ * warm-up is safe, it only leaves more to replay.
+ *
+ * @param chunking  NULL for the defaults
+ * @param stats     Optional, how the segments were reconciled
+ * @return          Number of windows, as detect_run
+ *
+ * Host build only. The calling thread's pipeline is reset and left in an
+ * unspecified state.
+ */
+size_t detect_run_chunked(const int16_t* const axes[6], size_t stride, size_t n_samples,
+                          uint32_t start_ms, DetectWindow* out, size_t max_out,
+                          const DetectChunking* chunking, DetectChunkStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DETECT_API_H */
@@ -0,0 +1,94 @@
+/**
+ * @file episode_tracker.h
+ * @brief Episode segmentation from confirmed-state transitions
+ *
+ * Turns the per-window confirmed state (tremor/dysk intensity, fog_status,
+ * motor state) into discrete episode records. The start of an episode is the first
+ * sample of the raw-detection run that led to confirmation, and the end is
+ * the last sample of the final window that still matched. Closed episodes
+ * are kept in a fixed ring and pushed to subscribers, so consumers don't
+ * have to poll the intensities.
+ */
+
+#ifndef EPISODE_TRACKER_H
+#define EPISODE_TRACKER_H
+
+#include "mbed.h"
+#include "config.h"
+#include "signal_processing.h"
+
+const size_t EPISODE_RING_SIZE = 32;
+const size_t EPISODE_MAX_LISTENERS = 4;
+
+enum EpisodeType : uint8_t {
+    EPISODE_TREMOR,
+    EPISODE_DYSK,
+    EPISODE_FOG,
+    EPISODE_OFF,                  // motor OFF period (motor_state.h)
+    EPISODE_DYSK_ON,              // dyskinetic ON period
+    EPISODE_TYPES
+};
+
+enum EpisodeFlags : uint8_t {
+    EPISODE_FLAG_OPEN = 0x01      // start event; end/duration/mean not final yet
+};
+
+struct EpisodeRecord {
+    uint32_t sequence;            // increments per published event
+    uint32_t start_sample;        // sample_count index of first sample
+    uint32_t end_sample;          // one past the last sample (0 while open)
+    uint32_t start_ms;
+    uint32_t duration_ms;
+    uint16_t peak_intensity;      // 0-1000 (0 for FOG, slow level for OFF/DYSK_ON)
+    uint16_t mean_intensity;
+    uint16_t dominant_freq_chz;   // mean peak frequency of matching windows, centi-Hz
+    uint8_t type;                 // EpisodeType
+    uint8_t flags;                // EpisodeFlags
+};
+
+static_assert(sizeof(EpisodeRecord) == 28, "EpisodeRecord layout changed");
+
+typedef Callback<void(const EpisodeRecord&)> EpisodeListener;
+
+// Segmentation state of one episode type (carried between windows, see checkpoint.h)
+struct EpisodeTrack {
+    bool active;
+    bool in_run;                  // raw detection matched in the previous window
+    uint32_t run_start_sample;
+    uint32_t last_match_end;
+    uint32_t intensity_sum;
+    uint16_t confirmed_windows;
+    uint16_t freq_count;
+    float freq_sum;
+    EpisodeRecord record;
+};
+
+extern PIPELINE_STATE EpisodeRecord episode_ring[EPISODE_RING_SIZE];
+extern PIPELINE_STATE uint32_t episode_count;     // closed episodes written to the ring
+extern PIPELINE_STATE uint32_t episode_sequence;  // events published (start + end)
+extern PIPELINE_STATE EpisodeRecord last_episode_event;
+
+void init_episode_tracker();
+
+/**
+ * @brief Register a listener for episode start/end events
+ * @return false if all listener slots are used
+ */
+bool episode_subscribe(EpisodeListener listener);
+
+/**
+ * @brief Update episode state with the latest window result
+ *
+ * Called once per window after FOG processing.
+ */
+void episode_tracker_update(const WindowResult& result);
+
+void episode_tracker_save(EpisodeTrack tracks_out[EPISODE_TYPES]);
+void episode_tracker_restore(const EpisodeTrack tracks_in[EPISODE_TYPES]);
+
+/**
+ * @brief Closed episode n positions back (0 = most recent), or nullptr
+ */
+const EpisodeRecord* episode_get(size_t n);
+
+#endif // EPISODE_TRACKER_H
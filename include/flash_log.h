@@ -0,0 +1,142 @@
+/**
+ * @file flash_log.h
+ * @brief Log-structured session recorder on the on-board QSPI NOR flash
+ *
+ * The flash is split into erase-aligned segments. Each segment starts with
+ * a FlashSegmentHeader (sequence number, erase count) followed by
+ * append-only records: compressed raw IMU blocks, window results, episode
+ * events and frozen black-box captures.
+ *
+ * Producers copy records into a RAM staging ring and never block. A
+ * low-priority writer thread programs the flash and pre-erases the next
+ * segment while acquisition keeps running. When the log wraps, the
+ * oldest segment is reclaimed, with ties broken by lowest erase count
+ * (wear levelling). At boot, the recovery scan reads one header per
+ * segment and then walks the record headers of the newest segment only,
+ * so its duration is bounded.
+ *
+ * Any mbed BlockDevice can back the store, e.g. a HeapBlockDevice for
+ * testing without the QSPI part, or on the host the FileBlockDevice of
+ * lib/host_platform, which keeps the log across a remount.
+ */
+
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include "mbed.h"
+#include "blockdevice/BlockDevice.h"
+#include "config.h"
+#include "signal_processing.h"
+
+const uint32_t FLASH_LOG_SEGMENT_SIZE = 64 * 1024;
+const size_t FLASH_LOG_MAX_SEGMENTS = 128;          // 8 MB MX25R6435F
+const size_t FLASH_LOG_STAGING_SIZE = 8 * 1024;
+const size_t FLASH_LOG_MAX_PAYLOAD = 2048;
+
+const uint32_t FLASH_SEGMENT_MAGIC = 0x474F4C50;    // "PLOG"
+const uint16_t FLASH_RECORD_MAGIC = 0xA55A;
+
+enum FlashRecordType : uint8_t {
+    FLASH_REC_IMU_BLOCK = 1,     // record_format IMU block
+    FLASH_REC_WINDOW = 2,        // WindowRecord
+    FLASH_REC_EPISODE = 3,       // EpisodeRecord
+    FLASH_REC_CAPTURE = 4        // FlashCaptureInfo, followed by its IMU blocks
+};
+
+enum FlashRecordFlags : uint8_t {
+    FLASH_FLAG_CAPTURE = 0x01    // IMU block belongs to a black-box capture
+};
+
+struct FlashSegmentHeader {
+    uint32_t magic;
+    uint32_t sequence;           // increases with every opened segment, never 0
+    uint32_t erase_count;
+    uint32_t check;              // magic ^ sequence ^ erase_count
+};
+
+struct FlashRecordHeader {
+    uint16_t magic;
+    uint8_t type;                // FlashRecordType
+    uint8_t flags;
+    uint16_t length;             // payload bytes (record is padded to 4)
+    uint16_t reserved;
+    uint32_t crc;                // CRC-32 of the payload
+};
+
+struct FlashCaptureInfo {
+    uint32_t first_sample;
+    uint32_t trigger_sample;
+    uint32_t trigger_ms;
+    uint32_t samples;
+    uint8_t trigger_type;        // EpisodeType
+    uint8_t reserved[3];
+};
+
+struct FlashLogStats {
+    uint32_t records_written;
+    uint32_t records_dropped;    // staging ring full or store unavailable
+    uint32_t bytes_written;
+    uint32_t program_us;         // time spent programming (throughput = bytes / time)
+    uint32_t erases;
+    uint32_t erase_us;
+    uint32_t scan_ms;            // boot recovery scan
+    uint32_t scan_records;
+    uint32_t min_erase_count;
+    uint32_t max_erase_count;
+    uint16_t segments;
+    uint16_t active_segment;
+};
+
+struct FlashLogCursor {
+    uint16_t segment;
+    uint32_t sequence;
+    uint32_t offset;
+};
+
+extern FlashLogStats flash_log_stats;
+extern bool flash_log_ready;
+
+/**
+ * @brief Mount the store, run the recovery scan and start the writer thread
+ *
+ * @param bd Block device to use, or nullptr for the on-board QSPI flash
+ */
+bool init_flash_log(BlockDevice* bd = nullptr);
+
+/**
+ * @brief Write out the staged records, stop the writer and unmount
+ *
+ * The statistics stay readable until init_flash_log() mounts the store
+ * again.
+ */
+void deinit_flash_log();
+
+/**
+ * @brief Stage one record for writing (non-blocking)
+ * @return false if the record was dropped
+ */
+bool flash_log_append(FlashRecordType type, uint8_t flags, const void* payload, size_t length);
+
+size_t flash_log_staging_free();
+
+/**
+ * @brief Log the raw IMU block and result of the window just processed
+ */
+void flash_log_record_window(const WindowResult& result);
+
+/**
+ * @brief Main-loop hook: moves frozen black-box captures into the log a
+ *        block at a time, as staging space allows
+ */
+void flash_log_service();
+
+/**
+ * @brief Iterate stored records, oldest first
+ *
+ * @return Payload length, 0 at the end of the log, -1 on error or if the
+ *         payload does not fit
+ */
+void flash_log_rewind(FlashLogCursor* cursor);
+int flash_log_next(FlashLogCursor* cursor, FlashRecordHeader* hdr, void* payload, size_t payload_size);
+
+#endif // FLASH_LOG_H
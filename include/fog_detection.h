@@ -9,6 +9,8 @@
 #include "mbed.h"
 #include "config.h"
 
+const uint32_t FOG_MAX_TIME_SINCE_STEP_MS = 15000;   // no freeze without a step this recent
+
 // FOG state machine states
 enum FOGState {
     FOG_NOT_WALKING,
@@ -27,12 +29,12 @@ struct FOGDetector {
     uint8_t consecutive_freeze_windows;
 };
 
-extern FOGDetector fog_detector;
-extern uint16_t steps_in_window;
-extern bool above_step_threshold;
-extern uint32_t last_step_time_ms;
-extern float accel_baseline_ema;
-extern uint8_t fog_status;
+extern PIPELINE_STATE FOGDetector fog_detector;
+extern PIPELINE_STATE uint16_t steps_in_window;
+extern PIPELINE_STATE bool above_step_threshold;
+extern PIPELINE_STATE uint32_t last_step_time_ms;
+extern PIPELINE_STATE float accel_baseline_ema;
+extern PIPELINE_STATE uint8_t fog_status;
 
 void init_fog_detection();
 
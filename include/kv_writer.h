@@ -0,0 +1,50 @@
+/**
+ * @file kv_writer.h
+ * @brief Deferred KVStore writes on a low-priority thread
+ *
+ * kv_set on the internal-flash TDB can take tens of milliseconds, and far
+ * longer when it triggers a garbage-collection pass. Called from
+ * process_window() that holds up the main loop, and with it the sensor
+ * reads. Modules instead post a finished record to their slot: it is
+ * copied under a mutex and the writer thread stores it while acquisition
+ * keeps running. A slot holds one record; posting again before it was
+ * written replaces it, since only the newest state is worth keeping.
+ */
+
+#ifndef KV_WRITER_H
+#define KV_WRITER_H
+
+#include "mbed.h"
+#include "config.h"
+
+const size_t KV_WRITER_MAX_RECORD = 768;
+
+enum KvSlot : uint8_t {
+    KV_SLOT_CALIBRATION,
+    KV_SLOT_BASELINE,
+    KV_SLOT_CHECKPOINT,
+    KV_SLOTS
+};
+
+struct KvSlotStats {
+    uint32_t posted;
+    uint32_t written;
+    uint32_t failed;
+    uint32_t superseded;         // replaced before the writer got to it
+    uint32_t max_write_ms;       // longest kv_set
+};
+
+extern KvSlotStats kv_writer_stats[KV_SLOTS];
+
+/**
+ * @brief Start the writer thread; records posted earlier are written then
+ */
+void init_kv_writer();
+
+/**
+ * @brief Queue a record for kv_set (non-blocking, copies data)
+ * @return false if the record is too large, or in replay (nothing is stored)
+ */
+bool kv_writer_post(KvSlot slot, const char* key, const void* data, size_t size);
+
+#endif // KV_WRITER_H
@@ -0,0 +1,86 @@
+/**
+ * @file motor_state.h
+ * @brief Slow ON/OFF motor-fluctuation estimator
+ *
+ * Wearing-off shows up over tens of minutes as more tremor and
+ * bradykinesia and less dyskinesia. Confirmed per-window intensities and
+ * the bradykinesia score are folded into slow EMAs (~10 min time constant),
+ * updated only on windows with movement so rest and sleep do not dilute
+ * them; the score only on windows that add cycles to a scored sequence. The levels classify a candidate state with enter/exit hysteresis,
+ * and a candidate must hold for MOTOR_CONFIRM_WINDOWS before the state
+ * changes. OFF and dyskinetic-ON periods are published as episodes
+ * (episode_tracker.h), so they reach BLE and the flash log like any other
+ * event.
+ *
+ * Per window: three multiply-adds and a few compares, no buffers.
+ */
+
+#ifndef MOTOR_STATE_H
+#define MOTOR_STATE_H
+
+#include "mbed.h"
+#include "config.h"
+#include "signal_processing.h"
+
+const float MOTOR_EMA_ALPHA = 0.005f;            // ~200 windows (10 min)
+const uint32_t MOTOR_WARMUP_WINDOWS = 100;       // active windows before a state is reported
+const float MOTOR_OFF_ENTER = 0.15f;             // off score (0-1)
+const float MOTOR_OFF_EXIT = 0.08f;
+const float MOTOR_DYSK_ENTER = 0.15f;            // dyskinesia level (0-1)
+const float MOTOR_DYSK_EXIT = 0.08f;
+const float MOTOR_TREMOR_WEIGHT = 0.6f;          // off score = w * tremor + (1 - w) * bradykinesia
+const uint16_t MOTOR_CONFIRM_WINDOWS = 20;       // ~1 min of a consistent candidate
+
+enum MotorState : uint8_t {
+    MOTOR_UNKNOWN,
+    MOTOR_ON,
+    MOTOR_OFF,
+    MOTOR_DYSK_ON,               // ON with troublesome dyskinesia
+    MOTOR_STATES
+};
+
+struct MotorStateEstimate {
+    MotorState state;
+    MotorState candidate;        // classification of the current levels
+    uint16_t candidate_windows;  // consecutive windows the candidate has held
+    uint32_t active_windows;     // windows folded into the levels
+    float tremor_level;          // EMAs, 0-1
+    float dysk_level;
+    float brady_level;
+    float off_score;
+    uint32_t transitions;
+    uint32_t state_since_ms;
+};
+
+// All a window contributes to the estimate. Nothing else in the pipeline
+// reads the estimate back, so a chunked replay (detect_run_chunked) can
+// recompute it afterwards from these alone.
+struct MotorInput {
+    uint32_t timestamp_ms;
+    uint16_t tremor_intensity;
+    uint16_t dysk_intensity;
+    uint16_t brady_score;
+    bool active;                 // window had movement and passed the data-quality check
+    bool brady_scored;           // a scored movement sequence added cycles in this window
+};
+
+extern PIPELINE_STATE MotorStateEstimate motor_state;
+extern PIPELINE_STATE MotorInput motor_last_input;
+
+void init_motor_state();
+
+/**
+ * @brief Fold in the window's confirmed results (after FOG processing)
+ *
+ * @param active  Window had movement and passed the data-quality check
+ */
+void motor_state_update(WindowResult& result, bool active);
+
+/**
+ * @brief Fold in one window's input (motor_state_update without a WindowResult)
+ */
+void motor_state_fold(const MotorInput& in);
+
+const char* motor_state_name(MotorState state);
+
+#endif // MOTOR_STATE_H
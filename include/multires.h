@@ -0,0 +1,123 @@
+/**
+ * @file multires.h
+ * @brief Multi-resolution time-frequency analysis on a shared sample history
+ *
+ * Calibrated accel/gyro magnitudes are kept in one history ring. Analysis
+ * jobs read windows of different lengths from it, each at its own hop:
+ * a 1 s window every 0.5 s for short 3-7 Hz bursts, and a 6 s window every
+ * 3 s for the 0.5-2 Hz locomotor band and a steadier noise floor. The
+ * same 6 s window also feeds the 2-8 Hz zoom spectrum (zoom_fft.h). rfft
+ * instances are cached per FFT size and shared by all jobs.
+ *
+ * A token-bucket scheduler, run from the main loop, bounds the total
+ * analysis time per second of data. Jobs that do not fit the budget are
+ * deferred and, if they fall a full hop behind, skipped.
+ *
+ * Spectra are scaled to amplitude (2 / sum of window) so that results from
+ * different window lengths are directly comparable.
+ */
+
+#ifndef MULTIRES_H
+#define MULTIRES_H
+
+#include "mbed.h"
+#include "arm_math.h"
+#include "config.h"
+#include "window_functions.h"
+
+const size_t MULTIRES_HISTORY_SIZE = 512;            // power of two, > longest window
+const size_t MULTIRES_SHORT_SAMPLES = 52;            // 1 s
+const size_t MULTIRES_SHORT_HOP = 26;
+const uint16_t MULTIRES_SHORT_FFT = 64;
+const size_t MULTIRES_LONG_SAMPLES = 312;            // 6 s
+const size_t MULTIRES_LONG_HOP = 156;
+const uint16_t MULTIRES_LONG_FFT = 512;
+const size_t MULTIRES_FFT_CACHE_SIZE = 4;
+const uint32_t MULTIRES_CPU_BUDGET_US = 20000;       // per second of data (2% of the core)
+const float MULTIRES_BURST_RATIO = 3.0f;             // short-window peak vs long noise floor
+const WindowType MULTIRES_SHORT_WINDOW = WINDOW_HANN;
+const WindowType MULTIRES_LONG_WINDOW = WINDOW_HANN;
+
+enum MultiResJobId {
+    MULTIRES_SHORT,
+    MULTIRES_LONG,
+    MULTIRES_ZOOM,               // 2-8 Hz zoom spectrum of the long window
+    MULTIRES_JOBS
+};
+
+struct MultiResJob {
+    const char* name;
+    uint16_t window_samples;
+    uint16_t hop_samples;
+    uint16_t fft_size;
+    uint32_t next_sample;        // sample_count at which the job is next due
+    uint32_t cost_us;            // EMA of measured run time
+    uint32_t runs;
+    uint32_t deferred;           // postponed by the budget
+    uint32_t skipped;            // dropped after falling a hop behind
+};
+
+struct MultiResResult {
+    // Short windows (latest)
+    uint32_t short_end_sample;
+    float short_tremor_amp;
+    float short_tremor_freq;
+    float short_dysk_amp;
+    float short_dysk_freq;
+    uint16_t tremor_bursts;      // short windows over the burst threshold, since last taken
+
+    // Long windows (latest)
+    uint32_t long_end_sample;
+    float long_noise_floor;      // mean 0.5-2 Hz amplitude
+    float locomotor_amp;
+    float locomotor_freq;
+};
+
+// Sample history and job schedule (in-process checkpoints, see checkpoint.h)
+struct MultiResHistory {
+    float accel[MULTIRES_HISTORY_SIZE];
+    float gyro[MULTIRES_HISTORY_SIZE];
+    uint32_t samples;
+    uint32_t next_sample[MULTIRES_JOBS];
+    MultiResResult result;
+};
+
+extern PIPELINE_STATE MultiResJob multires_jobs[MULTIRES_JOBS];
+extern PIPELINE_STATE MultiResResult multires_result;
+extern PIPELINE_STATE uint32_t multires_busy_us;   // total analysis time
+
+void init_multires();
+
+/**
+ * @brief Append one sample to the history (acquisition path)
+ */
+void multires_push(float accel_magnitude, float gyro_magnitude);
+
+/**
+ * @brief Drop the history after a gap in the pushes (night mode)
+ *
+ * Jobs wait until their window has refilled with contiguous samples.
+ */
+void multires_flush();
+
+/**
+ * @brief Run the jobs that are due, within the CPU budget (main loop)
+ *
+ * In replay every due job runs (detect_run calls this after each sample).
+ */
+void multires_service();
+
+void multires_save(MultiResHistory* history);
+void multires_restore(const MultiResHistory* history);
+
+/**
+ * @brief Shared rfft instance for a power-of-two size, or nullptr
+ */
+arm_rfft_fast_instance_f32* multires_fft_instance(uint16_t fft_size);
+
+/**
+ * @brief Return and clear the short-window burst count
+ */
+uint16_t multires_take_bursts();
+
+#endif // MULTIRES_H
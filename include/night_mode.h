@@ -0,0 +1,76 @@
+/**
+ * @file night_mode.h
+ * @brief Low-duty nocturnal monitoring mode
+ *
+ * Entered after a sustained run of still windows with the forearm lying
+ * roughly horizontal during night hours. Night hours need a set RTC
+ * (written over BLE, see TIME_CHAR_UUID_STR): without a clock the mode is
+ * never entered, so a daytime nap cannot switch the detector off. They are
+ * local hours, from the UTC offset the phone writes with the time. In night
+ * mode the LSM6DSL runs at 12.5 Hz, so a WINDOW_SIZE window becomes a
+ * 12.5 s hop. Windows skip the full analysis and are folded into the
+ * summary and session log as still/moving time, with a tremor screen on
+ * the signed axes (3-6 Hz is below the 6.25 Hz Nyquist limit). The LED is
+ * off and BLE advertising slows down. Movement or a tremor peak restores
+ * 52 Hz and the full pipeline; the multi-resolution and black-box
+ * histories are flushed on wake, since they stopped at night entry.
+ */
+
+#ifndef NIGHT_MODE_H
+#define NIGHT_MODE_H
+
+#include "mbed.h"
+#include "config.h"
+#include "signal_processing.h"
+
+const uint32_t NIGHT_ENTER_WINDOWS = 100;        // 5 min of still 3 s windows
+const float NIGHT_POSTURE_MAX_X = 0.5f;          // |g_x| / |g| (forearm within 30° of horizontal)
+const int NIGHT_START_HOUR = 22;
+const int NIGHT_END_HOUR = 7;
+const float NIGHT_WAKE_STD = 2.0f * STILLNESS_STD_THRESHOLD;  // accel magnitude std (g) over one night window
+const float NIGHT_TREMOR_RATIO = 6.0f;           // 3-6 Hz peak over 0.5-2 Hz floor, signed axis
+const float NIGHT_SAMPLE_RATE_HZ = 12.5f;
+const uint8_t NIGHT_ODR_BITS = 0x10;             // CTRL1_XL / CTRL2_G: 12.5 Hz
+const uint8_t DAY_ODR_BITS = 0x30;               // 52 Hz
+const uint32_t NIGHT_ADV_INTERVAL_MS = 4000;
+
+struct NightModeStats {
+    uint32_t entries;
+    uint32_t wakes;
+    uint32_t night_ms;           // time spent in night mode (closed periods)
+    uint32_t day_ms;
+    uint32_t last_change_ms;
+    uint32_t still_windows;      // consecutive qualifying day windows
+};
+
+extern PIPELINE_STATE bool night_mode_active;
+extern PIPELINE_STATE NightModeStats night_stats;
+
+void init_night_mode();
+
+/**
+ * @brief Per-window entry/wake decision (called at the end of process_window)
+ *
+ * Does nothing in replay: a recording keeps its acquisition rate.
+ */
+void night_mode_update(const WindowResult& result, uint32_t current_time);
+
+/**
+ * @brief Apply checkpointed statistics (checkpoint.h)
+ *
+ * Night mode itself is not switched on here: the sensor and BLE may not be
+ * up yet. If it was active, the next qualifying window re-enters it.
+ */
+void night_mode_restore(bool was_active, const NightModeStats& stats);
+
+/**
+ * @brief Length of one window at the current sample rate
+ */
+uint32_t night_mode_window_ms();
+
+/**
+ * @brief Share of uptime spent in night mode, 0-1
+ */
+float night_mode_residency(uint32_t current_time);
+
+#endif // NIGHT_MODE_H
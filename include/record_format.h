@@ -0,0 +1,186 @@
+/**
+ * @file record_format.h
+ * @brief Compact binary record format for raw IMU blocks and window results
+ *
+ * Raw IMU data is stored as fixed-size blocks of SoA int16 columns (one per
+ * axis) with per-column min/max statistics. Each column is either stored
+ * raw or delta-encoded to int8 when every delta fits (lossless). Blocks are
+ * self-describing and 4-byte aligned, so a reader can walk them in place
+ * from RAM or memory-mapped QSPI flash; raw columns are returned as direct
+ * pointers without copying.
+ *
+ * Per-window results are stored as fixed-width 48-byte WindowRecords, one
+ * per window as they are produced. For reading back many windows at once
+ * they can be regrouped into window blocks: one column per WindowRecord
+ * field (magic excluded), each 4-byte aligned, so a query over a day of
+ * tremor_intensity touches one contiguous array.
+ */
+
+#ifndef RECORD_FORMAT_H
+#define RECORD_FORMAT_H
+
+#include "mbed.h"
+#include "config.h"
+#include "signal_processing.h"
+
+const uint32_t IMU_BLOCK_MAGIC = 0x31554D49;      // "IMU1"
+const uint32_t WINDOW_RECORD_MAGIC = 0x314E4957;  // "WIN1"
+const uint32_t WINDOW_BLOCK_MAGIC = 0x31435757;   // "WWC1"
+
+// Largest IMU block whose RAW16 payload still fits payload_bytes
+const uint16_t IMU_BLOCK_MAX_SAMPLES = (UINT16_MAX - 3) / (IMU_AXES * sizeof(int16_t));
+
+enum ColumnEncoding : uint8_t {
+    COLUMN_RAW16 = 0,    // n x int16
+    COLUMN_DELTA8 = 1    // int16 first value, (n - 1) x int8 deltas, padded to even length
+};
+
+struct ColumnStats {
+    int16_t min;
+    int16_t max;
+};
+
+struct ImuBlockHeader {
+    uint32_t magic;
+    uint32_t first_sample;             // sample_count of the first sample
+    uint32_t timestamp_ms;
+    uint16_t sample_count;
+    uint16_t payload_bytes;            // bytes following the header
+    uint8_t encoding[IMU_AXES];        // ColumnEncoding per axis
+    uint8_t reserved[2];
+    ColumnStats stats[IMU_AXES];
+    uint16_t column_offset[IMU_AXES];  // byte offset of each column from payload start
+};
+
+struct WindowRecord {
+    uint32_t magic;
+    uint32_t window_index;
+    uint32_t start_sample;
+    uint32_t timestamp_ms;
+    float std_dev;
+    float noise_floor;
+    float tremor_peak;
+    float dysk_peak;
+    uint16_t tremor_freq_chz;          // centi-Hz
+    uint16_t dysk_freq_chz;
+    uint16_t tremor_intensity;
+    uint16_t dysk_intensity;
+    uint16_t raw_intensity_milli;      // raw intensity x 1000
+    uint16_t steps;
+    uint8_t raw_detection;
+    uint8_t fog_state;
+    uint8_t fog_status;
+    uint8_t flags;                     // QualityFlag bits
+};
+
+// Columns of a window block, in WindowRecord order
+enum WindowField : uint8_t {
+    WINDOW_FIELD_WINDOW_INDEX,
+    WINDOW_FIELD_START_SAMPLE,
+    WINDOW_FIELD_TIMESTAMP_MS,
+    WINDOW_FIELD_STD_DEV,
+    WINDOW_FIELD_NOISE_FLOOR,
+    WINDOW_FIELD_TREMOR_PEAK,
+    WINDOW_FIELD_DYSK_PEAK,
+    WINDOW_FIELD_TREMOR_FREQ_CHZ,
+    WINDOW_FIELD_DYSK_FREQ_CHZ,
+    WINDOW_FIELD_TREMOR_INTENSITY,
+    WINDOW_FIELD_DYSK_INTENSITY,
+    WINDOW_FIELD_RAW_INTENSITY_MILLI,
+    WINDOW_FIELD_STEPS,
+    WINDOW_FIELD_RAW_DETECTION,
+    WINDOW_FIELD_FOG_STATE,
+    WINDOW_FIELD_FOG_STATUS,
+    WINDOW_FIELD_FLAGS,
+    WINDOW_FIELDS
+};
+
+struct WindowBlockHeader {
+    uint32_t magic;
+    uint32_t first_window;             // window_index of the first record
+    uint16_t window_count;
+    uint16_t field_count;              // WINDOW_FIELDS when written
+    uint32_t payload_bytes;            // bytes following the header
+};
+
+static_assert(sizeof(ImuBlockHeader) % 4 == 0, "ImuBlockHeader must keep columns aligned");
+static_assert(sizeof(WindowRecord) == 48, "WindowRecord layout changed");
+static_assert(sizeof(WindowBlockHeader) % 4 == 0, "WindowBlockHeader must keep columns aligned");
+
+/**
+ * @brief Worst-case encoded size of an IMU block with n samples
+ */
+constexpr size_t imu_block_max_size(uint16_t n) {
+    return sizeof(ImuBlockHeader) + IMU_AXES * ((size_t)n * sizeof(int16_t) + 2);
+}
+
+/**
+ * @brief Encode SoA raw columns into a block
+ *
+ * @param columns   One pointer per axis, each with n samples
+ * @param n         Samples per column, 1..IMU_BLOCK_MAX_SAMPLES
+ * @param compress  Try DELTA8 per column (falls back to RAW16 if a delta overflows)
+ * @return Bytes written (4-byte multiple), or 0 if n is out of range or out is too small
+ */
+size_t imu_block_encode(const int16_t* const columns[IMU_AXES], uint16_t n,
+                        uint32_t first_sample, uint32_t timestamp_ms, bool compress,
+                        uint8_t* out, size_t out_size);
+
+/**
+ * @brief Validate a block in place and return its header, or nullptr
+ */
+const ImuBlockHeader* imu_block_view(const uint8_t* data, size_t size);
+
+/**
+ * @brief Total block size (header + payload), for walking consecutive blocks
+ */
+inline size_t imu_block_size(const ImuBlockHeader* hdr) {
+    return sizeof(ImuBlockHeader) + hdr->payload_bytes;
+}
+
+/**
+ * @brief Zero-copy access to a RAW16 column (nullptr if the column is delta-encoded)
+ */
+const int16_t* imu_block_column(const ImuBlockHeader* hdr, ImuAxis axis);
+
+/**
+ * @brief Decode one column of any encoding into out[hdr->sample_count]
+ */
+bool imu_block_decode_column(const ImuBlockHeader* hdr, ImuAxis axis, int16_t* out);
+
+void window_record_from_result(const WindowResult& result, WindowRecord* record);
+
+/**
+ * @brief Bytes per value of a window block column
+ */
+size_t window_field_size(WindowField field);
+
+/**
+ * @brief Encoded size of a window block with n windows
+ */
+size_t window_block_size(uint16_t n);
+
+/**
+ * @brief Regroup n consecutive records into a window block
+ * @return Bytes written (4-byte multiple), or 0 if n is 0 or out is too small
+ */
+size_t window_block_encode(const WindowRecord* records, uint16_t n, uint8_t* out, size_t out_size);
+
+/**
+ * @brief Validate a window block in place and return its header, or nullptr
+ */
+const WindowBlockHeader* window_block_view(const uint8_t* data, size_t size);
+
+/**
+ * @brief Zero-copy access to one column, window_count values of
+ *        window_field_size(field) bytes (uint32, float, uint16 or uint8 as
+ *        in WindowRecord)
+ */
+const void* window_block_column(const WindowBlockHeader* hdr, WindowField field);
+
+/**
+ * @brief Reassemble record i of a block
+ */
+bool window_block_record(const WindowBlockHeader* hdr, uint16_t i, WindowRecord* record);
+
+#endif // RECORD_FORMAT_H
@@ -15,20 +15,39 @@ extern InterruptIn data_ready_pin;
 extern volatile bool new_data_available;
 extern volatile uint32_t interrupt_count;
 extern volatile uint32_t pending_samples;
-extern uint32_t sample_count;
-extern uint32_t last_sample_time_ms;
+extern PIPELINE_STATE uint32_t sample_count;
+extern PIPELINE_STATE uint32_t last_sample_time_ms;
+extern PIPELINE_STATE uint32_t sensor_read_errors;      // failed I2C sample reads
+extern PIPELINE_STATE uint32_t sensor_missed_samples;   // estimated from gaps between reads
 
-extern float accel_magnitude_buffer[WINDOW_SIZE];
-extern float gyro_magnitude_buffer[WINDOW_SIZE];
-extern size_t buffer_index;
-extern volatile bool window_ready;
-extern uint32_t window_count;
+extern PIPELINE_STATE float accel_magnitude_buffer[WINDOW_SIZE];
+extern PIPELINE_STATE float gyro_magnitude_buffer[WINDOW_SIZE];
+extern PIPELINE_STATE int16_t raw_imu_buffer[IMU_AXES][WINDOW_SIZE];  // SoA raw counts, same indexing
+extern PIPELINE_STATE size_t buffer_index;
+extern PIPELINE_STATE volatile bool window_ready;
+extern PIPELINE_STATE uint32_t window_count;
+extern PIPELINE_STATE float sensor_rate_hz;          // current output data rate
 
 bool write_register(uint8_t reg, uint8_t value);
 bool read_register(uint8_t reg, uint8_t &value);
 bool read_burst(uint8_t start_reg, uint8_t *buffer, uint8_t length);
 bool init_lsm6dsl();
+bool set_sensor_odr(uint8_t odr_bits, float rate_hz);
+
+/**
+ * @brief Empty the window buffers and zero the sample counters (replay reset)
+ */
+void init_sensor_state();
+
 void data_ready_isr();
 void read_sensor_data();
 
+/**
+ * @brief Calibrate, buffer and step-detect one raw 6-axis sample
+ *
+ * read_sensor_data() calls this after the I2C reads; replays feed recorded
+ * samples through it with their own timestamps.
+ */
+void sensor_ingest_sample(const int16_t raw_sample[IMU_AXES], uint32_t current_time);
+
 #endif // SENSOR_H
\ No newline at end of file
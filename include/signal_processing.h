@@ -9,17 +9,18 @@
 #include "mbed.h"
 #include "arm_math.h"
 #include "config.h"
+#include "window_functions.h"
+
+const WindowType ANALYSIS_WINDOW = WINDOW_HANN;   // main 3 s window (HARMONIC_LOBE_BINS assumes Hann)
 
 // FFT processing arrays
-extern arm_rfft_fast_instance_f32 fft_instance;
-extern bool fft_initialized;
-extern float hann_window[WINDOW_SIZE];
-extern bool hann_computed;
-extern float combined_data[WINDOW_SIZE];
-extern float accel_norm[WINDOW_SIZE], gyro_norm[WINDOW_SIZE];
-extern float fft_input[FFT_SIZE];
-extern float fft_output[FFT_SIZE];
-extern float magnitude_spectrum[FFT_SIZE/2];
+extern PIPELINE_STATE arm_rfft_fast_instance_f32 fft_instance;
+extern PIPELINE_STATE bool fft_initialized;
+extern PIPELINE_STATE float accel_norm[WINDOW_SIZE], gyro_norm[WINDOW_SIZE];
+extern PIPELINE_STATE float fft_work[2 * FFT_SIZE];       // rfft input and output, or one complex FFT
+extern PIPELINE_STATE float accel_spectrum[FFT_SIZE];     // packed rfft outputs of each channel
+extern PIPELINE_STATE float gyro_spectrum[FFT_SIZE];
+extern PIPELINE_STATE float magnitude_spectrum[FFT_SIZE/2];
 
 struct DetectionConfirmation {
     char last_raw_detection[16];
@@ -30,13 +31,98 @@ struct DetectionConfirmation {
     float dysk_ema_intensity;
 };
 
-extern DetectionConfirmation detection_state;
-extern uint16_t tremor_intensity;
-extern uint16_t dysk_intensity;
+// Raw per-window classification
+enum DetectionCode : uint8_t {
+    DETECT_NONE,
+    DETECT_TREMOR,
+    DETECT_DYSK
+};
+
+// Per-window analysis output, refreshed by process_window()
+struct WindowResult {
+    uint32_t window_index;
+    uint32_t start_sample;       // sample_count of the first sample in the window
+    uint32_t timestamp_ms;       // when the window was processed
+    float std_dev;               // accel magnitude std (g)
+    float noise_floor;           // 0.5-2 Hz mean magnitude (0 if not analyzed)
+    float tremor_peak;
+    float tremor_freq;
+    float dysk_peak;
+    float dysk_freq;
+    float fundamental_freq;      // harmonic-series fundamental (0 if none)
+    float harmonic_confidence;   // 0-1, share of 3-21 Hz energy in the series
+    bool harmonic_reattributed;  // tremor harmonic removed from the dyskinesia band
+    float tremor_coherence;      // signed accel-gyro axis coherence at the tremor peak, 0-1
+    float accel_snr;             // 3-7 Hz peak over 0.5-2 Hz floor, per sensor
+    float gyro_snr;
+    float accel_weight;          // blend weight used (gyro gets 1 - accel_weight)
+    uint16_t tremor_bursts;      // 1 s tremor bursts seen by the multi-resolution engine
+    float locomotor_freq;        // 0.5-2 Hz peak of the latest 6 s window
+    float raw_intensity;         // 0.0-3.0
+    DetectionCode raw_detection;
+    uint16_t tremor_intensity;   // confirmed, 0-1000
+    uint16_t dysk_intensity;     // confirmed, 0-1000
+    uint16_t steps;
+    uint8_t heel_strikes;        // wavelet transients, see wavelet.h
+    float freeze_index;          // wavelet 3-6.5 Hz over 0.8-3.3 Hz energy
+    uint16_t brady_score;        // 0-1000, see bradykinesia.h
+    uint8_t brady_cycles;        // movement cycles completed in this window
+    uint8_t fog_state;           // FOGState after this window
+    uint8_t fog_status;
+    uint8_t quality_score;       // 0-100, see data_quality.h
+    uint8_t quality_flags;       // QualityFlag bits
+    uint8_t motor_state;         // MotorState, see motor_state.h
+    uint8_t motor_candidate;     // state the slow levels currently point to
+    uint16_t off_score;          // 0-1000, slow tremor/bradykinesia level
+    uint16_t dysk_level;         // 0-1000, slow dyskinesia level
+};
+
+extern PIPELINE_STATE DetectionConfirmation detection_state;
+extern PIPELINE_STATE WindowResult window_result;
+extern PIPELINE_STATE uint16_t tremor_intensity;
+extern PIPELINE_STATE uint16_t dysk_intensity;
+extern PIPELINE_STATE float fusion_accel_weight;        // smoothed accel share of the blend
+
+// Accel/gyro cross and auto spectra averaged across windows (in-process
+// checkpoints, see checkpoint.h)
+struct CoherenceHistory {
+    float cross[2 * COHERENCE_MAX_BINS];
+    float accel_psd[COHERENCE_MAX_BINS];
+    float gyro_psd[COHERENCE_MAX_BINS];
+    uint32_t k_lo;
+    int8_t gyro_axis;            // axis the averages belong to, -1 before the first
+    uint8_t windows;             // windows in the averages, up to COHERENCE_MIN_WINDOWS
+};
+
+/**
+ * @brief Clear detection confirmation, intensities, fusion and coherence state
+ */
+void init_signal_processing();
 
 void analyze_frequency_content(float* accel_data, float* gyro_data, size_t size, float sample_rate,
                                char* raw_condition, float* raw_intensity);
 
-void process_window();
+/**
+ * @brief Tremor screen for low-rate (night) windows
+ *
+ * 3-6 Hz peak over the 0.5-2 Hz mean on the most active signed accel and
+ * gyro axes of the raw window. Stateless: nothing is folded into the
+ * daytime averages.
+ *
+ * @param sample_rate  Rate the window was acquired at (Hz)
+ * @param peak_freq    Frequency of the larger peak
+ * @return             Larger of the two peak / floor ratios
+ */
+float night_tremor_ratio(float sample_rate, float* peak_freq);
+
+/**
+ * @brief Analyse the full window in the acquisition buffers
+ *
+ * @param current_time  Window timestamp (uptime ms live, recording time in replay)
+ */
+void process_window(uint32_t current_time);
+
+void coherence_save(CoherenceHistory* history);
+void coherence_restore(const CoherenceHistory* history);
 
 #endif // SIGNAL_PROCESSING_H
\ No newline at end of file
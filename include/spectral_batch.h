@@ -0,0 +1,77 @@
+/**
+ * @file spectral_batch.h
+ * @brief Spectral front end of many windows at once (host build)
+ *
+ * The part of analyze_frequency_content() that each window does on its
+ * own: DC removal and std normalization, ANALYSIS_WINDOW weighting, the
+ * 256-point real FFT of accel and gyro, the per-sensor band SNR, the
+ * fused magnitude spectrum and its band scans (noise floor, 3-5 Hz and
+ * 5-7 Hz peaks). Windows are transposed into groups as wide as a vector
+ * register (16 windows on AVX-512, 8 on AVX2, 4 otherwise), sample i of
+ * every window in one vector, so each step runs across windows instead of
+ * along one. Only the fusion weight EMA links
+ * windows; it is carried lane by lane between the two vector passes.
+ *
+ * The kernel is compiled for AVX-512, AVX2 and the build's baseline
+ * instruction set and picked at run time (spectral_batch_use). All of them
+ * round alike (no FMA contraction), so their output is identical. Against
+ * the firmware path the FFT and the sums associate differently: spectra
+ * agree to a few 1e-6 relative, the band peaks and their bins to the same
+ * except where two bins are that close. Harmonic reattribution, coherence
+ * and the detection decision stay in the per-window pipeline.
+ */
+
+#ifndef SPECTRAL_BATCH_H
+#define SPECTRAL_BATCH_H
+
+#include "config.h"
+
+const size_t SPECTRAL_BATCH_BINS = FFT_SIZE / 2 - 1;   // k = 1..127, as magnitude_spectrum
+
+enum SpectralIsa : uint8_t {
+    SPECTRAL_ISA_AUTO,           // widest the CPU supports
+    SPECTRAL_ISA_GENERIC,        // baseline instruction set of the build (SSE2 on x86-64)
+    SPECTRAL_ISA_AVX2,
+    SPECTRAL_ISA_AVX512
+};
+
+// Per-window results, named as in WindowResult
+struct SpectralWindow {
+    float accel_std;             // magnitude std + 1e-6, as analyze_frequency_content
+    float gyro_std;
+    float accel_snr;             // 3-7 Hz peak over 0.5-2 Hz floor, per sensor
+    float gyro_snr;
+    float accel_weight;          // fusion weight after this window
+    float noise_floor;           // 0.5-2 Hz mean, before the personal minimum
+    float tremor_peak;
+    float tremor_freq;
+    float dysk_peak;
+    float dysk_freq;
+};
+
+/**
+ * @brief Select the kernel; false if the CPU lacks it (selection unchanged)
+ */
+bool spectral_batch_use(SpectralIsa isa);
+
+/**
+ * @brief Kernel that spectral_batch runs (the selection is process-wide)
+ */
+SpectralIsa spectral_batch_isa();
+
+/**
+ * @brief Spectral front end of consecutive analysed windows
+ *
+ * @param accel, gyro   magnitude windows, WINDOW_SIZE samples each, back to back
+ * @param windows       number of windows
+ * @param accel_weight  fusion weight before the first window (FUSION_DEFAULT_ACCEL_WEIGHT
+ *                      after reset); updated to the weight after the last
+ * @param out           one result per window
+ * @param magnitude     SPECTRAL_BATCH_BINS fused magnitudes per window, or nullptr
+ * @param window        WINDOW_SIZE coefficients in place of ANALYSIS_WINDOW, or nullptr;
+ *                      for comparing window types on the same windows
+ */
+void spectral_batch(const float* accel, const float* gyro, size_t windows, float* accel_weight,
+                    SpectralWindow* out, float* magnitude, const float* window = nullptr);
+
+#endif // SPECTRAL_BATCH_H
@@ -0,0 +1,101 @@
+/**
+ * @file spectrogram.h
+ * @brief Spectral history ring for trend features and export
+ *
+ * Each analysed window's 0.4-13.2 Hz magnitude spectrum is stored as one
+ * row of 8-bit log magnitudes (16 steps per octave, 0.38 dB), so 128
+ * windows (6.4 min) take 8 KB. Windows that were not analysed (still,
+ * rejected) get a blank row, which keeps the time axis uniform. Rows can
+ * be read in place; queries dequantize through a 256-entry power table.
+ *
+ * Export: the newest row is notified over BLE as a SpectroPacket, and the
+ * whole ring can be dumped on the serial console (send 's'), one row per
+ * main loop pass.
+ */
+
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include "mbed.h"
+#include "config.h"
+
+const size_t SPECTRO_ROWS = 128;                 // 6.4 min of 3 s windows
+const size_t SPECTRO_FIRST_BIN = 2;              // FFT bin of column 0 (0.41 Hz)
+const size_t SPECTRO_BINS = 64;                  // up to 13.2 Hz
+const float SPECTRO_STEPS_PER_OCTAVE = 16.0f;
+const int SPECTRO_ZERO_STEP = 96;                // code of magnitude 1.0; code 0 = blank / below 1/64
+const uint8_t SPECTRO_PRESENCE_STEPS = 25;       // band peak 3x above the row's geometric mean
+
+// One row, as notified over BLE (little-endian)
+struct SpectroPacket {
+    uint32_t window_index;
+    uint8_t bins[SPECTRO_BINS];
+};
+
+static_assert(sizeof(SpectroPacket) == 68, "SpectroPacket layout changed");
+
+// Spectral peak behaviour in a band over a span of rows
+struct SpectroTrend {
+    float presence;              // share of rows with a clear band peak, 0-1
+    float mean_freq;             // over rows with a peak (Hz)
+    float freq_std;
+    float drift_hz_per_min;      // least-squares slope of the peak frequency
+};
+
+// Row ring (in-process checkpoints, see checkpoint.h)
+struct SpectroHistory {
+    uint8_t data[SPECTRO_ROWS][SPECTRO_BINS];
+    uint32_t window[SPECTRO_ROWS];
+    uint32_t head;
+    uint32_t count;
+    uint32_t revision;
+};
+
+extern PIPELINE_STATE uint32_t spectro_revision;   // bumped on every append
+
+void init_spectrogram();
+
+/**
+ * @brief Append a row from magnitude_spectrum (index 0 = bin 1), nullptr for a blank row
+ */
+void spectro_append(uint32_t window_index, const float* magnitude);
+
+void spectro_save(SpectroHistory* history);
+void spectro_restore(const SpectroHistory* history);
+
+size_t spectro_rows();
+
+/**
+ * @brief Row by age (0 = newest), read in place, or nullptr
+ */
+const uint8_t* spectro_row(size_t age);
+uint32_t spectro_row_window(size_t age);
+
+float spectro_bin_freq(size_t column);
+
+/**
+ * @brief Band power of the last rows, oldest first
+ * @return Number of values written
+ */
+size_t spectro_band_series(float f_lo, float f_hi, size_t rows, float* out);
+
+/**
+ * @brief Mean magnitude per column over the last rows (out[SPECTRO_BINS])
+ */
+void spectro_mean_spectrum(size_t rows, float* out);
+
+/**
+ * @brief Peak presence, frequency spread and drift in a band over the last rows
+ * @return false if no row had a peak
+ */
+bool spectro_band_trend(float f_lo, float f_hi, size_t rows, SpectroTrend* trend);
+
+bool spectro_packet(size_t age, SpectroPacket* packet);
+
+/**
+ * @brief Start / continue a serial dump of the ring (one row per call)
+ */
+void spectro_request_dump();
+void spectro_service();
+
+#endif // SPECTROGRAM_H
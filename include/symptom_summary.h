@@ -0,0 +1,90 @@
+/**
+ * @file symptom_summary.h
+ * @brief Hourly aggregation of confirmed window results
+ *
+ * Every processed window is folded into a fixed ring of hourly buckets
+ * (time in each state, intensity and frequency histograms, FOG episode
+ * counts and durations). Work per window is O(1) and RAM is fixed at
+ * SUMMARY_HOURS buckets. The ring is exported over BLE as a table of
+ * compact 20-byte SummaryPackets, oldest hour first.
+ *
+ * Once the RTC is set (config.h) buckets are local wall-clock hours, so
+ * slot i of the ring is the hour i:00-i:59 of the day. Before that, and
+ * in replays, they are hours of uptime counted from the window
+ * timestamps, across the 32-bit millisecond wrap (~49.7 days). Uptime
+ * hours recorded before the clock was set export ahead of the wall-clock
+ * hours, each kind limited to its newest SUMMARY_HOURS.
+ */
+
+#ifndef SYMPTOM_SUMMARY_H
+#define SYMPTOM_SUMMARY_H
+
+#include "mbed.h"
+#include "config.h"
+#include "signal_processing.h"
+
+const size_t SUMMARY_HOURS = 24;
+const size_t SUMMARY_INTENSITY_BINS = 8;   // 0-1000 in steps of 125
+const size_t SUMMARY_FREQ_BINS = 8;        // 3.0-7.0 Hz in steps of 0.5 Hz
+const uint32_t SUMMARY_HOUR_MS = 3600000;
+const uint16_t SUMMARY_HOUR_RTC = 0x8000;  // SummaryPacket.hour_index: wall-clock hour
+const uint16_t SUMMARY_HOUR_MASK = 0x7FFF;
+
+struct SummaryBucket {
+    uint32_t hour_index;                   // local hours since 1970 (rtc) or uptime hours
+    uint32_t covered_ms;
+    uint32_t still_ms;
+    uint32_t tremor_ms;
+    uint32_t dysk_ms;
+    uint32_t fog_ms;
+    uint16_t windows;
+    uint16_t peak_tremor;
+    uint16_t peak_dysk;
+    uint16_t fog_count;
+    uint16_t tremor_hist[SUMMARY_INTENSITY_BINS];
+    uint16_t dysk_hist[SUMMARY_INTENSITY_BINS];
+    uint16_t freq_hist[SUMMARY_FREQ_BINS];
+    bool rtc;                              // hour_index from the RTC
+    bool valid;
+};
+
+// BLE wire format, little-endian
+struct SummaryPacket {
+    uint16_t hour_index;                   // low 15 bits of the hour, | SUMMARY_HOUR_RTC
+    uint16_t windows;
+    uint16_t tremor_s;
+    uint16_t dysk_s;
+    uint16_t fog_s;
+    uint16_t still_s;
+    uint16_t peak_tremor;
+    uint16_t peak_dysk;
+    uint8_t fog_count;
+    uint8_t tremor_median_bin;             // median bin of tremor_hist (0xFF if empty)
+    uint8_t dysk_median_bin;
+    uint8_t dominant_freq_bin;             // mode of freq_hist (0xFF if empty)
+};
+
+static_assert(sizeof(SummaryPacket) == 20, "SummaryPacket layout changed");
+
+const size_t SUMMARY_EXPORT_SIZE = SUMMARY_HOURS * sizeof(SummaryPacket);
+
+extern PIPELINE_STATE SummaryBucket summary_buckets[SUMMARY_HOURS];
+extern PIPELINE_STATE uint32_t summary_revision;          // bumped on every update
+
+void init_symptom_summary();
+
+/**
+ * @brief Fold one processed window into its hourly bucket
+ *
+ * @param result      Output of process_window()
+ * @param window_ms   Duration covered by the window
+ */
+void summary_add_window(const WindowResult& result, uint32_t window_ms);
+
+/**
+ * @brief Pack valid buckets (oldest first) into out
+ * @return Bytes written (multiple of sizeof(SummaryPacket))
+ */
+size_t summary_export(uint8_t* out, size_t out_size);
+
+#endif // SYMPTOM_SUMMARY_H
@@ -0,0 +1,137 @@
+/**
+ * @file telemetry.h
+ * @brief Compact binary metrics and trace stream on the serial port
+ *
+ * The text console costs a few hundred bytes per window at 115200 baud.
+ * In telemetry mode (console command 't') printf output is muted at the
+ * console FileHandle and the port carries framed binary records instead:
+ *
+ *   0xA5 0x5A | type | length | sequence | payload (length bytes) | CRC-8
+ *
+ * The CRC (CCITT, poly 0x07) covers type through payload, and the sequence
+ * byte exposes lost frames. Payloads are little-endian fixed-layout structs,
+ * listed below. Per window the stream sends a window record, the stage
+ * timings and, when the window was analysed, its spectrogram row. A health
+ * record is sent every TELEMETRY_HEALTH_INTERVAL_MS. Muted text is still
+ * counted, so the health record shows both rates side by side.
+ *
+ * Frame sizes: window 34 bytes, stages 22, spectrum row 74, health 34.
+ * The health record carries text_bytes and telemetry_bytes for the same
+ * interval, so the saving can be read off the stream itself.
+ *
+ * The stream state is per pipeline (PIPELINE_STATE), so in the host build
+ * a replay thread can capture the frames of its own pipeline; the host
+ * monitor (host/python/pd_monitor.py) decodes them.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "mbed.h"
+#include "config.h"
+#include "signal_processing.h"
+
+const uint8_t TELEMETRY_SYNC0 = 0xA5;
+const uint8_t TELEMETRY_SYNC1 = 0x5A;
+const size_t TELEMETRY_OVERHEAD = 6;             // sync x2, type, length, sequence, CRC
+const uint32_t TELEMETRY_HEALTH_INTERVAL_MS = 2000;
+
+enum TelemetryType : uint8_t {
+    TELEM_WINDOW = 1,            // TelemWindow
+    TELEM_STAGES = 2,            // TelemStages
+    TELEM_SPECTRUM = 3,          // SpectroPacket (spectrogram.h)
+    TELEM_HEALTH = 4             // TelemHealth
+};
+
+// process_window() sections, timed in order
+enum TelemetryStage : uint8_t {
+    STAGE_QUALITY,               // window statistics and data-quality check
+    STAGE_MOTION,                // bradykinesia cycles and wavelet events
+    STAGE_SPECTRUM,              // FFT analysis and spectrogram row
+    STAGE_DETECT,                // confirmation, FOG, motor state
+    STAGE_RECORD,                // summary, episodes, flash log, learning, checkpoint
+    TELEMETRY_STAGES
+};
+
+struct TelemWindow {
+    uint32_t window_index;
+    uint32_t timestamp_ms;
+    uint16_t std_mg;
+    uint16_t tremor_freq_chz;
+    uint16_t tremor_intensity;
+    uint16_t dysk_intensity;
+    uint16_t brady_score;
+    uint16_t off_score;
+    uint8_t raw_detection;
+    uint8_t fog_state;
+    uint8_t quality_score;
+    uint8_t quality_flags;
+    uint8_t motor_state;
+    uint8_t heel_strikes;
+    uint8_t steps;
+    uint8_t night;
+};
+
+struct TelemStages {
+    uint32_t window_index;
+    uint16_t stage_us[TELEMETRY_STAGES];
+    uint16_t total_us;
+};
+
+struct TelemHealth {
+    uint32_t uptime_ms;
+    uint16_t sample_rate_chz;    // samples read over the interval, centi-Hz
+    uint16_t interval_mean_us;   // between sensor reads
+    uint16_t interval_std_us;    // jitter
+    uint16_t interval_max_us;    // saturates at 65535
+    uint16_t isr_backlog_max;    // pending_samples high-water mark
+    uint16_t flash_staging_used; // bytes queued for the flash writer
+    uint16_t multires_deferred;  // jobs postponed by the CPU budget this interval
+    uint16_t ble_tx_bytes;       // characteristic bytes written this interval
+    uint16_t text_bytes;         // console text this interval (muted or not)
+    uint16_t telemetry_bytes;    // frame bytes this interval
+    uint8_t ble_connected;
+    uint8_t night;
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(TelemWindow) == 28, "TelemWindow layout changed");
+static_assert(sizeof(TelemStages) == 16, "TelemStages layout changed");
+static_assert(sizeof(TelemHealth) == 28, "TelemHealth layout changed");
+
+struct TelemetryStats {
+    uint32_t frames;
+    uint32_t telemetry_bytes;
+    uint32_t text_bytes;         // everything printf produced since boot
+    uint32_t text_muted_bytes;
+};
+
+extern PIPELINE_STATE bool telemetry_active;
+extern PIPELINE_STATE TelemetryStats telemetry_stats;
+
+/**
+ * @brief Console FileHandle for mbed_override_console(): forwards text to
+ *        the port unless telemetry is active, and sends frames to it directly
+ */
+FileHandle* telemetry_console(FileHandle* port);
+
+void telemetry_set_active(bool active);
+
+/**
+ * @brief Restart the sequence, counters and timing statistics (detect_reset);
+ *        the port and the mode are kept
+ */
+void init_telemetry();
+
+// Timing hooks
+void telemetry_sample_read();                    // after each successful sensor read
+void telemetry_window_begin();
+void telemetry_stage(TelemetryStage stage);      // closes the stage since the previous mark
+void telemetry_window_end(const WindowResult& result, bool analysed);
+
+/**
+ * @brief Track queue depths and send the health record when due (main loop)
+ */
+void telemetry_service(uint32_t now);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,84 @@
+/**
+ * @file wavelet.h
+ * @brief Integer lifting wavelet transform for transient gait events
+ *
+ * The FFT spreads a heel strike or the last step before a freeze over the
+ * whole 3 s window. Here the vertical accelerometer channel (raw counts,
+ * same axis as the step detector) is decomposed with the reversible
+ * LeGall 5/3 integer lifting scheme: int16 counts in, int32 coefficients
+ * out, one predict and one update pass per level, symmetric extension at
+ * the edges. The transform runs in place with stride 2^(level-1), so every
+ * detail coefficient stays at the sample it describes and no reordering or
+ * scratch memory is needed. The acquisition window itself is left intact
+ * (the session log reads it later); it is widened once into a static
+ * buffer (624 bytes).
+ *
+ * Scales at 52 Hz:
+ *   d1 13-26 Hz   d2 6.5-13 Hz   d3 3.3-6.5 Hz   d4 1.6-3.3 Hz   d5 0.8-1.6 Hz
+ *
+ * Heel strikes are local maxima of |d2| plus the two neighbouring |d1|
+ * (which makes them independent of where a strike falls on the dyadic
+ * grid) above an absolute floor, with a refractory period. The freeze
+ * index is d3 energy over d4 + d5 energy (freeze band over locomotor
+ * band), which picks out trembling in place. The time of the last heel
+ * strike lets the FOG state machine date a freeze onset to the sample
+ * rather than to the window. A level-1 detail of a full-scale swing needs
+ * 17 bits, and the approximation grows at most 1.5x per level, so five
+ * levels stay within 20 bits: int32 holds every coefficient of any int16
+ * input and the transform is lossless.
+ *
+ * Trembling only counts towards FOG right after gait and never on a
+ * window the tremor detector claims (fog_detection.cpp), since rest
+ * tremor fills the same 3-6.5 Hz band.
+ */
+
+#ifndef WAVELET_H
+#define WAVELET_H
+
+#include "mbed.h"
+#include "config.h"
+
+const size_t WAVELET_LEVELS = 5;                  // 156 -> 78 -> 39 -> 20 -> 10 -> 5
+const ImuAxis WAVELET_AXIS = IMU_AZ;              // vertical, as the step detector
+const size_t WAVELET_STRIKE_LEVEL = 2;            // 6.5-13 Hz detail
+const float WAVELET_STRIKE_MIN_G = 0.08f;         // |d2| floor for a heel strike
+const uint32_t WAVELET_STRIKE_REFRACTORY_MS = 250;
+const uint8_t WAVELET_MAX_STRIKES = 16;
+const float WAVELET_FREEZE_INDEX_MIN = 2.0f;      // d3 / (d4 + d5) energy for trembling
+const float WAVELET_FREEZE_BAND_MIN_G = 0.02f;    // d3 RMS floor, ignores sensor noise
+
+struct WaveletResult {
+    uint32_t energy[WAVELET_LEVELS];   // mean squared detail per level (counts^2, saturated)
+    float freeze_index;                // d3 / (d4 + d5) energy, 0 if no locomotor energy
+    bool trembling;                    // freeze index and d3 level both above threshold
+    uint8_t strikes;                   // heel strikes in the window
+    uint16_t strike_offset[WAVELET_MAX_STRIKES];  // sample offsets in the window
+    uint32_t last_strike_ms;           // time of the most recent strike (kept across windows)
+};
+
+extern PIPELINE_STATE WaveletResult wavelet_result;
+
+void init_wavelet();
+
+/**
+ * @brief Transform the window in raw_imu_buffer and extract events
+ *
+ * @param current_time  Time the window is processed; strikes are dated back
+ *                      from it using the samples acquired since the window
+ *                      closed (buffer_index)
+ */
+void wavelet_update_window(uint32_t current_time);
+
+/**
+ * @brief In-place forward LeGall 5/3 lifting over x[0..length)
+ *
+ * Level j details end up at x[(2i + 1) * 2^(j-1)].
+ */
+void wavelet_forward(int32_t* x, size_t length, size_t levels);
+
+/**
+ * @brief Undo wavelet_forward exactly (levels <= WAVELET_LEVELS)
+ */
+void wavelet_inverse(int32_t* x, size_t length, size_t levels);
+
+#endif // WAVELET_H
@@ -0,0 +1,130 @@
+/**
+ * @file window_functions.h
+ * @brief Analysis window library with compile-time coefficient tables
+ *
+ * Symmetric generalized-cosine windows, w[i] = sum_k (-1)^k a_k
+ * cos(2 pi k i / (N - 1)). The compiler evaluates the table (constexpr) of
+ * the window each analysis stage is configured with, at that stage's
+ * length, so it lives in flash and nothing is computed or held in RAM at
+ * run time. A stage picks its window through a constant in its own
+ * header (ANALYSIS_WINDOW, MULTIRES_*_WINDOW, ZOOM_WINDOW); other
+ * type/length pairs are not linked.
+ *
+ * The CMSIS-DSP window generators (arm_hanning_f32 and the others) are not
+ * used: they fill a RAM buffer with cosf() at run time, and they are
+ * periodic, cos(2 pi k i / N), whereas the pipeline has always used the
+ * symmetric Hann its thresholds were tuned with. The Blackman-Harris terms
+ * are those of arm_blackman_harris_92db_f32.
+ *
+ * Leakage at N = 156 (64x zero padding, checked by test_window_functions):
+ *   type             coherent gain  ENBW (bins)  highest sidelobe  scalloping
+ *   rectangular          1.000         1.00          -13.3 dB        3.92 dB
+ *   Hann                 0.497         1.51          -31.5 dB        1.41 dB
+ *   Hamming              0.537         1.37          -42.6 dB        1.74 dB
+ *   Blackman-Harris      0.356         2.02          -92.0 dB        0.81 dB
+ *   flat-top             0.214         3.79          -91.9 dB        0.01 dB
+ * Hann stays the default; flat-top is for amplitude readout only. Wider
+ * main lobes than Hann need a larger HARMONIC_LOBE_BINS.
+ *
+ * Replayed detections, 20 synthetic minutes of 4.8 Hz tremor (8-40 dps) in
+ * every other minute with 1.2 Hz sway, each window scaled to Hann's
+ * coherent gain and run through spectral_batch() with the default factors
+ * (checked by test_spectral_batch):
+ *   type             tremor windows found  false alarms
+ *   rectangular          139 / 200           5 / 200
+ *   Hann                 119 / 200           8 / 200
+ *   Hamming              125 / 200           8 / 200
+ *   Blackman-Harris       81 / 200           6 / 200
+ *   flat-top               8 / 200          11 / 200
+ * At equal coherent gain the wider main lobes spread the tremor peak over
+ * more bins and lose the weak minutes against the absolute noise floor.
+ */
+
+#ifndef WINDOW_FUNCTIONS_H
+#define WINDOW_FUNCTIONS_H
+
+#include "mbed.h"
+#include "config.h"
+
+enum WindowType : uint8_t {
+    WINDOW_RECT,
+    WINDOW_HANN,
+    WINDOW_HAMMING,
+    WINDOW_BLACKMAN_HARRIS,      // 4-term, 92 dB
+    WINDOW_FLAT_TOP,             // 5-term, amplitude-accurate
+    WINDOW_TYPES
+};
+
+// Flash-resident window of one type and length
+struct WindowView {
+    const float* coeffs;
+    uint16_t length;
+    float sum;                   // coherent gain x length (amplitude scaling)
+    float power;                 // sum of squares (noise scaling)
+};
+
+namespace window_detail {
+
+constexpr size_t MAX_TERMS = 5;
+
+constexpr double WINDOW_TERMS[WINDOW_TYPES][MAX_TERMS] = {
+    {1.0, 0.0, 0.0, 0.0, 0.0},
+    {0.5, 0.5, 0.0, 0.0, 0.0},
+    {0.54, 0.46, 0.0, 0.0, 0.0},
+    {0.35875, 0.48829, 0.14128, 0.01168, 0.0},
+    {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368},
+};
+
+// Compile-time cosine: reduce to [-pi, pi], then Taylor series
+constexpr double cos_ct(double x) {
+    const double pi = 3.14159265358979323846;
+    while (x > pi) x -= 2.0 * pi;
+    while (x < -pi) x += 2.0 * pi;
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < 24; k++) {
+        term *= -x * x / ((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+template <size_t N>
+struct Table {
+    float coeffs[N];
+    float sum;
+    float power;
+};
+
+template <size_t N>
+constexpr Table<N> make_table(WindowType type) {
+    const double pi = 3.14159265358979323846;
+    Table<N> t{};
+    double sum = 0.0, power = 0.0;
+    for (size_t i = 0; i < N; i++) {
+        double w = 0.0, sign = 1.0;
+        for (size_t k = 0; k < MAX_TERMS; k++) {
+            if (WINDOW_TERMS[type][k] != 0.0) {
+                w += sign * WINDOW_TERMS[type][k] * cos_ct(2.0 * pi * k * i / (N - 1));
+            }
+            sign = -sign;
+        }
+        t.coeffs[i] = (float)w;
+        sum += w;
+        power += w * w;
+    }
+    t.sum = (float)sum;
+    t.power = (float)power;
+    return t;
+}
+
+} // namespace window_detail
+
+/**
+ * @brief Window a stage is configured with, at its length, or an empty view
+ *        (coeffs == nullptr) for any other type or length
+ */
+WindowView window_get(WindowType type, size_t length);
+
+const char* window_name(WindowType type);
+
+#endif // WINDOW_FUNCTIONS_H
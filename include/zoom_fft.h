@@ -0,0 +1,82 @@
+/**
+ * @file zoom_fft.h
+ * @brief Zoom spectrum of the 2-8 Hz region
+ *
+ * The input is mixed down by ZOOM_CENTER_HZ to complex baseband, low-pass
+ * filtered and decimated with the CMSIS FIR decimator (I and Q share one
+ * coefficient set), windowed and transformed with a small complex FFT.
+ * Only the region of interest is resolved: a 256-point complex FFT after
+ * 4x decimation gives the same 0.05 Hz bin spacing over 2-8 Hz as a
+ * 1024-point real FFT over the whole 0-26 Hz range.
+ *
+ * Only the filter, the mixer (one second: ZOOM_CENTER_HZ is a whole number
+ * of cycles per second) and the result are kept. The intermediate signals
+ * live in scratch the caller lends for the call, the multi-resolution work
+ * buffers in the pipeline.
+ */
+
+#ifndef ZOOM_FFT_H
+#define ZOOM_FFT_H
+
+#include "mbed.h"
+#include "arm_math.h"
+#include "config.h"
+#include "window_functions.h"
+
+const float ZOOM_CENTER_HZ = 5.0f;
+const float ZOOM_HALF_SPAN_HZ = 3.0f;          // 2-8 Hz
+const uint8_t ZOOM_DECIMATION = 4;             // 13 Hz complex rate
+const uint16_t ZOOM_TAPS = 32;
+const uint16_t ZOOM_FFT_SIZE = 256;            // complex points
+const size_t ZOOM_MAX_INPUT = 312;             // multiple of ZOOM_DECIMATION
+const size_t ZOOM_WINDOW_SAMPLES = (ZOOM_MAX_INPUT - ZOOM_TAPS) / ZOOM_DECIMATION;  // settled outputs of a full input
+const WindowType ZOOM_WINDOW = WINDOW_HANN;
+const size_t ZOOM_MIX_PERIOD = 52;             // samples per mixer period (1 s)
+const size_t ZOOM_FIR_BLOCK = 52;              // decimator block, multiple of ZOOM_DECIMATION
+const size_t ZOOM_WORK_FLOATS = 2 * ZOOM_MAX_INPUT + 2 * (ZOOM_MAX_INPUT / ZOOM_DECIMATION);
+
+struct ZoomResult {
+    uint32_t end_sample;
+    float freq_res;              // Hz per bin
+    float tremor_amp;            // 3-5 Hz peak
+    float tremor_freq;
+    float dysk_amp;              // 5-7 Hz peak
+    float dysk_freq;
+};
+
+extern PIPELINE_STATE float zoom_magnitude[ZOOM_FFT_SIZE];   // amplitude, lowest frequency first
+extern PIPELINE_STATE ZoomResult zoom_result;
+
+bool init_zoom_fft();
+
+/**
+ * @brief Zoom spectrum of n real samples (n <= ZOOM_MAX_INPUT, multiple of ZOOM_DECIMATION)
+ *
+ * @param work  ZOOM_WORK_FLOATS of scratch, not overlapping input
+ */
+bool zoom_fft_compute(const float* input, size_t n, float* work);
+
+/**
+ * @brief Frequency of zoom_magnitude[i]
+ */
+inline float zoom_bin_freq(size_t i) {
+    const float res = TARGET_SAMPLE_RATE_HZ / ZOOM_DECIMATION / ZOOM_FFT_SIZE;
+    return ZOOM_CENTER_HZ + ((int)i - (int)(ZOOM_FFT_SIZE / 2)) * res;
+}
+
+/**
+ * @brief Peak amplitude of the last zoom spectrum over f_lo..f_hi
+ */
+void zoom_band_peak(float f_lo, float f_hi, float* amp, float* freq);
+
+#ifdef ZOOM_FFT_BENCHMARK
+/**
+ * @brief Time one zoom spectrum against a 1024-point real FFT and print both
+ *
+ * Bench builds only (env disco_l475vg_iot01a_bench): it borrows 8 KB of
+ * heap for the reference FFT.
+ */
+void zoom_fft_benchmark();
+#endif
+
+#endif // ZOOM_FFT_H
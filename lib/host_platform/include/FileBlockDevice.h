@@ -0,0 +1,73 @@
+/**
+ * @file FileBlockDevice.h
+ * @brief NOR flash stand-in backed by a file, for the flash log on the host
+ *
+ * Behaves like the QSPI part as the flash log sees it: erase sets whole
+ * erase blocks to 0xFF, program can only clear bits (the stored byte
+ * becomes old & new), and out-of-range or misaligned requests fail. The
+ * file keeps its contents across deinit()/init(), so a remount runs the
+ * same recovery scan as a reboot.
+ *
+ * Optional busy times make program and erase take about as long as on the
+ * part (page_program_us per started program page, block_erase_us per erase
+ * block); by default they cost only the file I/O. The counters tell
+ * what a caller asked of the part, e.g. the reads of a boot scan.
+ */
+
+#ifndef HOST_FILEBLOCKDEVICE_H
+#define HOST_FILEBLOCKDEVICE_H
+
+#include "blockdevice/BlockDevice.h"
+#include <string>
+
+class FileBlockDevice : public BlockDevice {
+public:
+    struct Counters {
+        uint64_t reads;
+        uint64_t read_bytes;
+        uint64_t programs;
+        uint64_t program_bytes;
+        uint64_t erases;         // erase blocks
+    };
+    Counters counters = {};
+
+    /**
+     * @param path         backing file, created erased (0xFF) if missing or short
+     * @param size         device size, a multiple of erase_size
+     * @param erase_size   erase block
+     * @param page_size    program page, the unit page_program_us is charged for
+     */
+    FileBlockDevice(const std::string& path, bd_size_t size = 8 * 1024 * 1024,
+                    bd_size_t erase_size = 4096, bd_size_t page_size = 256);
+    ~FileBlockDevice() override;
+
+    /**
+     * @brief Emulated busy time of the part, 0 for none
+     */
+    void set_timing(uint32_t page_program_us, uint32_t block_erase_us);
+
+    int init() override;
+    int deinit() override;
+    int read(void* buffer, bd_addr_t addr, bd_size_t size) override;
+    int program(const void* buffer, bd_addr_t addr, bd_size_t size) override;
+    int erase(bd_addr_t addr, bd_size_t size) override;
+    bd_size_t get_read_size() const override { return 1; }
+    bd_size_t get_program_size() const override { return 1; }
+    bd_size_t get_erase_size() const override { return erase_size_; }
+    int get_erase_value() const override { return 0xFF; }
+    bd_size_t size() const override { return size_; }
+
+private:
+    bool in_range(bd_addr_t addr, bd_size_t size) const;
+    void busy(uint64_t us) const;
+
+    std::string path_;
+    bd_size_t size_;
+    bd_size_t erase_size_;
+    bd_size_t page_size_;
+    uint32_t page_program_us_ = 0;
+    uint32_t block_erase_us_ = 0;
+    int fd_ = -1;
+};
+
+#endif // HOST_FILEBLOCKDEVICE_H
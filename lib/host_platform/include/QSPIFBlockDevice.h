@@ -0,0 +1,27 @@
+/**
+ * @file QSPIFBlockDevice.h
+ * @brief Host stand-in for the on-board QSPI flash: there is none, init fails
+ *
+ * Host code that wants a flash log passes its own BlockDevice to
+ * init_flash_log().
+ */
+
+#ifndef HOST_QSPIFBLOCKDEVICE_H
+#define HOST_QSPIFBLOCKDEVICE_H
+
+#include "blockdevice/BlockDevice.h"
+
+class QSPIFBlockDevice : public BlockDevice {
+public:
+    int init() override { return -1; }
+    int deinit() override { return 0; }
+    int read(void*, bd_addr_t, bd_size_t) override { return -1; }
+    int program(const void*, bd_addr_t, bd_size_t) override { return -1; }
+    int erase(bd_addr_t, bd_size_t) override { return -1; }
+    bd_size_t get_read_size() const override { return 1; }
+    bd_size_t get_program_size() const override { return 1; }
+    bd_size_t get_erase_size() const override { return 4096; }
+    bd_size_t size() const override { return 0; }
+};
+
+#endif // HOST_QSPIFBLOCKDEVICE_H
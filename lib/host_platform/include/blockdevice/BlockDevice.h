@@ -0,0 +1,35 @@
+/**
+ * @file BlockDevice.h
+ * @brief Host stand-in for the mbed BlockDevice interface
+ */
+
+#ifndef HOST_BLOCKDEVICE_H
+#define HOST_BLOCKDEVICE_H
+
+#include <cstdint>
+
+typedef uint64_t bd_addr_t;
+typedef uint64_t bd_size_t;
+
+namespace mbed {
+
+class BlockDevice {
+public:
+    virtual ~BlockDevice() = default;
+    virtual int init() = 0;
+    virtual int deinit() = 0;
+    virtual int read(void* buffer, bd_addr_t addr, bd_size_t size) = 0;
+    virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size) = 0;
+    virtual int erase(bd_addr_t addr, bd_size_t size) = 0;
+    virtual bd_size_t get_read_size() const = 0;
+    virtual bd_size_t get_program_size() const = 0;
+    virtual bd_size_t get_erase_size() const = 0;
+    virtual int get_erase_value() const { return -1; }
+    virtual bd_size_t size() const = 0;
+};
+
+} // namespace mbed
+
+using mbed::BlockDevice;
+
+#endif // HOST_BLOCKDEVICE_H
@@ -0,0 +1,19 @@
+/**
+ * @file kvstore_global_api.h
+ * @brief Host stand-in for the mbed KVStore global API (in-memory, per process)
+ */
+
+#ifndef HOST_KVSTORE_GLOBAL_API_H
+#define HOST_KVSTORE_GLOBAL_API_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define MBED_ERROR_ITEM_NOT_FOUND (-1)
+
+int kv_set(const char* full_name_key, const void* buffer, size_t size, uint32_t create_flags);
+int kv_get(const char* full_name_key, void* buffer, size_t buffer_size, size_t* actual_size);
+int kv_remove(const char* full_name_key);
+int kv_reset(const char* kvstore_path);
+
+#endif // HOST_KVSTORE_GLOBAL_API_H
@@ -0,0 +1,243 @@
+/**
+ * @file mbed.h
+ * @brief Host stand-in for the mbed OS API used by the pipeline modules
+ *
+ * Only what the modules outside main.cpp, ble_comm.cpp and led_control.cpp
+ * touch: timers and the kernel clock on std::chrono, RTOS primitives on
+ * std::thread, MbedCRC, and pin/bus classes that report "no device". The
+ * console is off by default (host_console_enabled) so replays run quietly.
+ */
+
+#ifndef HOST_MBED_H
+#define HOST_MBED_H
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <sys/types.h>
+
+using namespace std::chrono_literals;
+
+// Console: printf in the pipeline goes here and is dropped unless enabled
+extern bool host_console_enabled;
+int host_printf(const char* format, ...);
+#define printf host_printf
+
+#define MBED_SUCCESS 0
+
+// RTC: time() is the host clock; set_time has no host equivalent
+inline void set_time(time_t) {}
+
+// Pins, and buses with nothing on them
+typedef int PinName;
+enum : int { PB_10, PB_11, PD_11, LED1, USBTX, USBRX };
+enum PinMode { PullNone, PullUp, PullDown };
+
+namespace mbed {
+
+template <typename F> class Callback;
+
+template <typename R, typename... Args>
+class Callback<R(Args...)> {
+public:
+    Callback() = default;
+    Callback(R (*func)(Args...)) : fn(func) {}
+    template <typename T>
+    Callback(T* obj, R (T::*method)(Args...))
+        : fn([obj, method](Args... args) { return (obj->*method)(args...); }) {}
+
+    R operator()(Args... args) const { return fn(args...); }
+    explicit operator bool() const { return static_cast<bool>(fn); }
+
+private:
+    std::function<R(Args...)> fn;
+};
+
+class FileHandle {
+public:
+    virtual ~FileHandle() = default;
+    virtual ssize_t read(void* buffer, size_t size) = 0;
+    virtual ssize_t write(const void* buffer, size_t size) = 0;
+    virtual off_t seek(off_t offset, int whence = SEEK_SET) = 0;
+    virtual int close() = 0;
+    virtual int isatty() { return 0; }
+};
+
+class I2C {
+public:
+    I2C(PinName, PinName) {}
+    void frequency(int) {}
+    int write(int, const char*, int, bool = false) { return -1; }   // NACK
+    int read(int, char*, int, bool = false) { return -1; }
+};
+
+class InterruptIn {
+public:
+    InterruptIn(PinName, PinMode = PullNone) {}
+    void rise(Callback<void()>) {}
+    void fall(Callback<void()>) {}
+};
+
+class DigitalOut {
+public:
+    DigitalOut(PinName) {}
+    DigitalOut& operator=(int v) { value = v; return *this; }
+    operator int() const { return value; }
+
+private:
+    int value = 0;
+};
+
+class Timer {
+public:
+    void start() {
+        if (!running) origin = std::chrono::steady_clock::now();
+        running = true;
+    }
+    void stop() {
+        if (running) accumulated += std::chrono::steady_clock::now() - origin;
+        running = false;
+    }
+    void reset() {
+        accumulated = {};
+        origin = std::chrono::steady_clock::now();
+    }
+    std::chrono::microseconds elapsed_time() const {
+        auto t = accumulated;
+        if (running) t += std::chrono::steady_clock::now() - origin;
+        return std::chrono::duration_cast<std::chrono::microseconds>(t);
+    }
+
+private:
+    bool running = false;
+    std::chrono::steady_clock::time_point origin;
+    std::chrono::steady_clock::duration accumulated{};
+};
+
+enum CrcPolynomial : uint32_t {
+    POLY_8BIT_CCITT = 0x07,
+    POLY_32BIT_ANSI = 0x04C11DB7
+};
+
+// Bitwise CRC with mbed's defaults: CCITT-8 plain, ANSI-32 reflected with
+// 0xFFFFFFFF initial value and final XOR
+template <uint32_t Polynomial, int Width>
+class MbedCRC {
+public:
+    int compute(const void* buffer, unsigned long long size, uint32_t* crc) const {
+        const uint8_t* p = static_cast<const uint8_t*>(buffer);
+        if (Width == 32) {
+            uint32_t c = 0xFFFFFFFFu;
+            for (unsigned long long i = 0; i < size; i++) {
+                c ^= p[i];
+                for (int k = 0; k < 8; k++) c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1u)));
+            }
+            *crc = ~c;
+        } else {
+            uint8_t c = 0;
+            for (unsigned long long i = 0; i < size; i++) {
+                c ^= p[i];
+                for (int k = 0; k < 8; k++) c = (c & 0x80) ? (uint8_t)((c << 1) ^ Polynomial) : (uint8_t)(c << 1);
+            }
+            *crc = c;
+        }
+        return 0;
+    }
+};
+
+} // namespace mbed
+
+using namespace mbed;
+
+namespace Kernel {
+uint64_t get_ms_count();   // since the first call
+}
+
+namespace rtos {
+
+enum osPriority { osPriorityLow, osPriorityBelowNormal, osPriorityNormal, osPriorityAboveNormal };
+const uint32_t osWaitForever = 0xFFFFFFFFu;
+
+class Mutex {
+public:
+    void lock() { m.lock(); }
+    void unlock() { m.unlock(); }
+    bool trylock() { return m.try_lock(); }
+
+private:
+    std::recursive_mutex m;
+};
+
+class Thread {
+public:
+    Thread(osPriority = osPriorityNormal, uint32_t = 0, unsigned char* = nullptr, const char* = nullptr) {}
+    ~Thread() {
+        if (worker.joinable()) worker.detach();
+    }
+    int start(Callback<void()> task) {
+        worker = std::thread([task]() { task(); });
+        return 0;
+    }
+    int join() {
+        if (worker.joinable()) worker.join();
+        return 0;
+    }
+
+private:
+    std::thread worker;
+};
+
+class EventFlags {
+public:
+    uint32_t set(uint32_t flags) {
+        std::lock_guard<std::mutex> guard(m);
+        bits |= flags;
+        cv.notify_all();
+        return bits;
+    }
+    uint32_t clear(uint32_t flags = 0x7FFFFFFFu) {
+        std::lock_guard<std::mutex> guard(m);
+        uint32_t previous = bits;
+        bits &= ~flags;
+        return previous;
+    }
+    uint32_t get() const { return bits; }
+    uint32_t wait_any(uint32_t flags, uint32_t timeout_ms = osWaitForever, bool clear = true) {
+        std::unique_lock<std::mutex> lock(m);
+        auto ready = [&] { return (bits & flags) != 0; };
+        if (timeout_ms == osWaitForever) {
+            cv.wait(lock, ready);
+        } else if (!cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready)) {
+            return 0;
+        }
+        uint32_t result = bits & flags;
+        if (clear) bits &= ~result;
+        return result;
+    }
+
+private:
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t bits = 0;
+};
+
+namespace ThisThread {
+template <typename Rep, typename Period>
+void sleep_for(std::chrono::duration<Rep, Period> d) { std::this_thread::sleep_for(d); }
+}
+
+} // namespace rtos
+
+using namespace rtos;
+
+#endif // HOST_MBED_H
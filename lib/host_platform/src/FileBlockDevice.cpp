@@ -0,0 +1,104 @@
+/**
+ * @file FileBlockDevice.cpp
+ * @brief NOR flash stand-in backed by a file
+ */
+
+#include "FileBlockDevice.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+FileBlockDevice::FileBlockDevice(const std::string& path, bd_size_t size,
+                                 bd_size_t erase_size, bd_size_t page_size)
+    : path_(path), size_(size), erase_size_(erase_size), page_size_(page_size) {}
+
+FileBlockDevice::~FileBlockDevice() {
+    deinit();
+}
+
+void FileBlockDevice::set_timing(uint32_t page_program_us, uint32_t block_erase_us) {
+    page_program_us_ = page_program_us;
+    block_erase_us_ = block_erase_us;
+}
+
+int FileBlockDevice::init() {
+    if (fd_ >= 0) return 0;
+    if (erase_size_ == 0 || page_size_ == 0 || size_ % erase_size_ != 0) return -1;
+
+    fd_ = open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) return -1;
+
+    // A new or short file reads as freshly erased flash
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        deinit();
+        return -1;
+    }
+    std::vector<uint8_t> erased(erase_size_, 0xFF);
+    for (bd_addr_t addr = (bd_addr_t)st.st_size; addr < size_;) {
+        bd_size_t n = erase_size_ - addr % erase_size_;
+        if (n > size_ - addr) n = size_ - addr;
+        if (pwrite(fd_, erased.data(), n, (off_t)addr) != (ssize_t)n) {
+            deinit();
+            return -1;
+        }
+        addr += n;
+    }
+    return 0;
+}
+
+int FileBlockDevice::deinit() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    return 0;
+}
+
+bool FileBlockDevice::in_range(bd_addr_t addr, bd_size_t size) const {
+    return fd_ >= 0 && addr <= size_ && size <= size_ - addr;
+}
+
+void FileBlockDevice::busy(uint64_t us) const {
+    if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+int FileBlockDevice::read(void* buffer, bd_addr_t addr, bd_size_t size) {
+    if (!in_range(addr, size)) return -1;
+    counters.reads++;
+    counters.read_bytes += size;
+    return (pread(fd_, buffer, size, (off_t)addr) == (ssize_t)size) ? 0 : -1;
+}
+
+int FileBlockDevice::program(const void* buffer, bd_addr_t addr, bd_size_t size) {
+    if (!in_range(addr, size)) return -1;
+    if (size == 0) return 0;
+
+    // NOR: programming only clears bits
+    std::vector<uint8_t> cells(size);
+    if (pread(fd_, cells.data(), size, (off_t)addr) != (ssize_t)size) return -1;
+    const uint8_t* data = static_cast<const uint8_t*>(buffer);
+    for (bd_size_t i = 0; i < size; i++) cells[i] &= data[i];
+    if (pwrite(fd_, cells.data(), size, (off_t)addr) != (ssize_t)size) return -1;
+    counters.programs++;
+    counters.program_bytes += size;
+
+    const uint64_t pages = (addr + size - 1) / page_size_ - addr / page_size_ + 1;
+    busy(pages * page_program_us_);
+    return 0;
+}
+
+int FileBlockDevice::erase(bd_addr_t addr, bd_size_t size) {
+    if (!in_range(addr, size) || addr % erase_size_ != 0 || size % erase_size_ != 0) return -1;
+
+    std::vector<uint8_t> erased(erase_size_, 0xFF);
+    for (bd_size_t done = 0; done < size; done += erase_size_) {
+        if (pwrite(fd_, erased.data(), erase_size_, (off_t)(addr + done)) != (ssize_t)erase_size_) return -1;
+    }
+    counters.erases += size / erase_size_;
+    busy(size / erase_size_ * block_erase_us_);
+    return 0;
+}
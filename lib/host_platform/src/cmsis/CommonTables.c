@@ -0,0 +1,2 @@
+/* CMSIS-DSP CommonTables for the host build (aggregated source from lib/CMSIS-DSP-main) */
+#include "../../../CMSIS-DSP-main/Source/CommonTables/CommonTables.c"
@@ -0,0 +1,5 @@
+/* CMSIS-DSP filtering kernels used by the pipeline (zoom FFT decimator).
+   The aggregated FilteringFunctions.c also pulls in q15 kernels that need
+   SupportFunctions, which the vendored tree does not carry. */
+#include "../../../CMSIS-DSP-main/Source/FilteringFunctions/arm_fir_decimate_f32.c"
+#include "../../../CMSIS-DSP-main/Source/FilteringFunctions/arm_fir_decimate_init_f32.c"
@@ -0,0 +1,2 @@
+/* CMSIS-DSP StatisticsFunctions for the host build (aggregated source from lib/CMSIS-DSP-main) */
+#include "../../../CMSIS-DSP-main/Source/StatisticsFunctions/StatisticsFunctions.c"
@@ -0,0 +1,9 @@
+/* CMSIS-DSP f32 FFTs used by the pipeline. The aggregated
+   TransformFunctions.c also builds the MFCC kernels, which need
+   MatrixFunctions (not vendored). */
+#include "../../../CMSIS-DSP-main/Source/TransformFunctions/arm_bitreversal2.c"
+#include "../../../CMSIS-DSP-main/Source/TransformFunctions/arm_cfft_f32.c"
+#include "../../../CMSIS-DSP-main/Source/TransformFunctions/arm_cfft_init_f32.c"
+#include "../../../CMSIS-DSP-main/Source/TransformFunctions/arm_cfft_radix8_f32.c"
+#include "../../../CMSIS-DSP-main/Source/TransformFunctions/arm_rfft_fast_f32.c"
+#include "../../../CMSIS-DSP-main/Source/TransformFunctions/arm_rfft_fast_init_f32.c"
@@ -0,0 +1,67 @@
+/**
+ * @file host_platform.cpp
+ * @brief Kernel clock, console, KVStore and BLE counters for the host build
+ */
+
+#include "mbed.h"
+#include "kvstore_global_api.h"
+#include <map>
+#include <string>
+#include <vector>
+
+bool host_console_enabled = false;
+
+#undef printf
+int host_printf(const char* format, ...) {
+    if (!host_console_enabled) return 0;
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+uint64_t Kernel::get_ms_count() {
+    static const auto origin = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - origin).count();
+}
+
+// KVStore: one map per process, shared by all threads
+static std::mutex kv_mutex;
+static std::map<std::string, std::vector<uint8_t>> kv_store;
+
+int kv_set(const char* key, const void* buffer, size_t size, uint32_t) {
+    std::lock_guard<std::mutex> guard(kv_mutex);
+    const uint8_t* p = static_cast<const uint8_t*>(buffer);
+    kv_store[key].assign(p, p + size);
+    return MBED_SUCCESS;
+}
+
+int kv_get(const char* key, void* buffer, size_t buffer_size, size_t* actual_size) {
+    std::lock_guard<std::mutex> guard(kv_mutex);
+    auto it = kv_store.find(key);
+    if (it == kv_store.end()) return MBED_ERROR_ITEM_NOT_FOUND;
+    size_t n = (it->second.size() < buffer_size) ? it->second.size() : buffer_size;
+    memcpy(buffer, it->second.data(), n);
+    if (actual_size != nullptr) *actual_size = n;
+    return MBED_SUCCESS;
+}
+
+int kv_remove(const char* key) {
+    std::lock_guard<std::mutex> guard(kv_mutex);
+    return (kv_store.erase(key) > 0) ? MBED_SUCCESS : MBED_ERROR_ITEM_NOT_FOUND;
+}
+
+int kv_reset(const char*) {
+    std::lock_guard<std::mutex> guard(kv_mutex);
+    kv_store.clear();
+    return MBED_SUCCESS;
+}
+
+// ble_comm.h counters; the host has no radio (ble_comm.cpp is not built)
+bool ble_connected = false;
+uint32_t ble_tx_bytes = 0;
+uint32_t ble_episodes_dropped = 0;
+
+void ble_set_advertising_interval(uint32_t) {}
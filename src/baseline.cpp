@@ -0,0 +1,199 @@
+/**
+ * @file baseline.cpp
+ * @brief Per-patient adaptive baseline and personalized detection thresholds
+ */
+
+#include "baseline.h"
+#include "kv_writer.h"
+#include "kvstore_global_api.h"
+#include <cstring>
+
+const uint32_t BASELINE_RECORD_MAGIC = 0x45534142;  // "BASE"
+const uint16_t BASELINE_RECORD_VERSION = 1;
+
+// Persisted form (KVStore value)
+struct BaselineRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t metrics;
+    P2Quantile sketch[BASELINE_METRICS];
+};
+
+static_assert(sizeof(BaselineRecord) <= KV_WRITER_MAX_RECORD, "BaselineRecord too large for a KV slot");
+
+PIPELINE_STATE P2Quantile baseline_sketch[BASELINE_METRICS];
+PIPELINE_STATE PersonalThresholds personal_thresholds;
+
+static const float baseline_quantile[BASELINE_METRICS] = {0.10f, 0.95f, 0.95f, 0.10f};
+static PIPELINE_STATE uint32_t last_save_ms = 0;
+static PIPELINE_STATE bool dirty = false;
+
+void p2_init(P2Quantile* q, float p) {
+    memset(q, 0, sizeof(*q));
+    q->p = p;
+}
+
+void p2_add(P2Quantile* q, float x) {
+    // First five observations: keep them sorted
+    if (q->count < 5) {
+        size_t i = q->count++;
+        while (i > 0 && q->height[i - 1] > x) {
+            q->height[i] = q->height[i - 1];
+            i--;
+        }
+        q->height[i] = x;
+        if (q->count == 5) {
+            const float p = q->p;
+            for (int j = 0; j < 5; j++) q->position[j] = j + 1;
+            q->desired[0] = 1.0f;
+            q->desired[1] = 1.0f + 2.0f * p;
+            q->desired[2] = 1.0f + 4.0f * p;
+            q->desired[3] = 3.0f + 2.0f * p;
+            q->desired[4] = 5.0f;
+        }
+        return;
+    }
+
+    const float p = q->p;
+    const float increment[5] = {0.0f, p / 2.0f, p, (1.0f + p) / 2.0f, 1.0f};
+    float* h = q->height;
+    int32_t* n = q->position;
+
+    // Cell containing x, extending the extremes
+    int k;
+    if (x < h[0]) {
+        h[0] = x;
+        k = 0;
+    } else if (x >= h[4]) {
+        h[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= h[k + 1]) k++;
+    }
+
+    for (int i = k + 1; i < 5; i++) n[i]++;
+    for (int i = 0; i < 5; i++) q->desired[i] += increment[i];
+    q->count++;
+
+    // Move the middle markers toward their desired positions
+    for (int i = 1; i <= 3; i++) {
+        float d = q->desired[i] - n[i];
+        if ((d >= 1.0f && n[i + 1] - n[i] > 1) || (d <= -1.0f && n[i - 1] - n[i] < -1)) {
+            int s = (d > 0.0f) ? 1 : -1;
+
+            // Piecewise-parabolic prediction, linear if it would break ordering
+            float parabolic = h[i] + (float)s / (n[i + 1] - n[i - 1]) *
+                ((n[i] - n[i - 1] + s) * (h[i + 1] - h[i]) / (n[i + 1] - n[i]) +
+                 (n[i + 1] - n[i] - s) * (h[i] - h[i - 1]) / (n[i] - n[i - 1]));
+            if (h[i - 1] < parabolic && parabolic < h[i + 1]) {
+                h[i] = parabolic;
+            } else {
+                h[i] = h[i] + s * (h[i + s] - h[i]) / (n[i + s] - n[i]);
+            }
+            n[i] += s;
+        }
+    }
+}
+
+float p2_value(const P2Quantile* q) {
+    if (q->count == 0) return 0.0f;
+    if (q->count < 5) return q->height[(size_t)(q->p * (q->count - 1) + 0.5f)];
+    return q->height[2];
+}
+
+static float clampf(float x, float lo, float hi) {
+    return (x < lo) ? lo : (x > hi) ? hi : x;
+}
+
+static void update_thresholds() {
+    PersonalThresholds& t = personal_thresholds;
+
+    t.band_personal = baseline_sketch[BASELINE_TREMOR_RATIO].count >= BASELINE_BURN_IN_WINDOWS;
+    if (t.band_personal) {
+        t.noise_floor_min = clampf(p2_value(&baseline_sketch[BASELINE_NOISE_FLOOR]),
+                                   NOISE_FLOOR_MIN, BASELINE_FLOOR_MIN_CAP);
+        t.tremor_factor = clampf(p2_value(&baseline_sketch[BASELINE_TREMOR_RATIO]) * BASELINE_RATIO_MARGIN,
+                                 TREMOR_THRESHOLD_FACTOR, TREMOR_THRESHOLD_FACTOR * BASELINE_FACTOR_CAP);
+        t.dysk_factor = clampf(p2_value(&baseline_sketch[BASELINE_DYSK_RATIO]) * BASELINE_RATIO_MARGIN,
+                               DYSK_THRESHOLD_FACTOR, DYSK_THRESHOLD_FACTOR * BASELINE_FACTOR_CAP);
+    } else {
+        t.noise_floor_min = NOISE_FLOOR_MIN;
+        t.tremor_factor = TREMOR_THRESHOLD_FACTOR;
+        t.dysk_factor = DYSK_THRESHOLD_FACTOR;
+    }
+
+    // A freeze has to be clearly quieter than this patient's own walking
+    t.gait_personal = baseline_sketch[BASELINE_WALK_VARIANCE].count >= BASELINE_WALK_BURN_IN_WINDOWS;
+    if (t.gait_personal) {
+        t.freeze_variance_max = clampf(p2_value(&baseline_sketch[BASELINE_WALK_VARIANCE]) * BASELINE_FREEZE_SHARE,
+                                       BASELINE_FREEZE_VARIANCE_MIN, FOG_FREEZE_VARIANCE_MAX);
+    } else {
+        t.freeze_variance_max = FOG_FREEZE_VARIANCE_MAX;
+    }
+}
+
+static void save_baseline(uint32_t current_time) {
+    BaselineRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = BASELINE_RECORD_MAGIC;
+    rec.version = BASELINE_RECORD_VERSION;
+    rec.metrics = BASELINE_METRICS;
+    memcpy(rec.sketch, baseline_sketch, sizeof(rec.sketch));
+
+    kv_writer_post(KV_SLOT_BASELINE, BASELINE_KV_KEY, &rec, sizeof(rec));
+    printf(" | 💾 Baseline queued");
+    last_save_ms = current_time;
+    dirty = false;
+}
+
+void init_baseline() {
+    memset(&personal_thresholds, 0, sizeof(personal_thresholds));
+    for (size_t m = 0; m < BASELINE_METRICS; m++) {
+        p2_init(&baseline_sketch[m], baseline_quantile[m]);
+    }
+    last_save_ms = 0;
+    dirty = false;
+
+    // A replay learns from the recording alone
+    BaselineRecord rec;
+    size_t actual = 0;
+    if (!replay_mode && kv_get(BASELINE_KV_KEY, &rec, sizeof(rec), &actual) == MBED_SUCCESS &&
+        actual == sizeof(rec) && rec.magic == BASELINE_RECORD_MAGIC &&
+        rec.version == BASELINE_RECORD_VERSION && rec.metrics == BASELINE_METRICS) {
+        memcpy(baseline_sketch, rec.sketch, sizeof(baseline_sketch));
+        personal_thresholds.restored = true;
+        last_save_ms = Kernel::get_ms_count();
+        printf("✓ Baseline restored: %lu windows, %lu walking\n",
+               (unsigned long)baseline_sketch[BASELINE_TREMOR_RATIO].count,
+               (unsigned long)baseline_sketch[BASELINE_WALK_VARIANCE].count);
+    } else {
+        printf("✓ No stored baseline, learning from wear\n");
+    }
+
+    update_thresholds();
+}
+
+void baseline_observe_spectrum(float raw_noise_floor, float tremor_ratio, float dysk_ratio) {
+    if (!replay_learning) return;
+    p2_add(&baseline_sketch[BASELINE_NOISE_FLOOR], raw_noise_floor);
+    p2_add(&baseline_sketch[BASELINE_TREMOR_RATIO], tremor_ratio);
+    p2_add(&baseline_sketch[BASELINE_DYSK_RATIO], dysk_ratio);
+    dirty = true;
+}
+
+void baseline_observe_gait(float variance) {
+    if (!replay_learning) return;
+    p2_add(&baseline_sketch[BASELINE_WALK_VARIANCE], variance);
+    dirty = true;
+}
+
+void baseline_update(uint32_t current_time) {
+    update_thresholds();
+    if (dirty && (last_save_ms == 0 || current_time - last_save_ms >= BASELINE_SAVE_INTERVAL_MS)) {
+        // First save only once there is something worth keeping
+        if (last_save_ms != 0 || baseline_sketch[BASELINE_TREMOR_RATIO].count >= 100) {
+            save_baseline(current_time);
+        }
+    }
+}
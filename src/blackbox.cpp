@@ -0,0 +1,127 @@
+/**
+ * @file blackbox.cpp
+ * @brief Pre-event capture of raw 6-axis data around detections
+ */
+
+#include "blackbox.h"
+#include "sensor.h"
+#include <cstring>
+
+uint32_t blackbox_captures = 0;
+uint32_t blackbox_dropped = 0;
+
+static BlackboxCapture slots[BLACKBOX_SLOTS];
+static BlackboxCapture *live = nullptr;
+
+static BlackboxCapture* find_free_slot() {
+    for (size_t i = 0; i < BLACKBOX_SLOTS; i++) {
+        if (slots[i].state == BLACKBOX_FREE) return &slots[i];
+    }
+    return nullptr;
+}
+
+static void start_live(BlackboxCapture* slot) {
+    slot->write_pos = 0;
+    slot->filled = 0;
+    slot->post_remaining = 0;
+    slot->state = BLACKBOX_LIVE;
+    live = slot;
+}
+
+static void on_episode(const EpisodeRecord& record) {
+    if ((record.flags & EPISODE_FLAG_OPEN) && (BLACKBOX_TRIGGER_MASK & (1u << record.type))) {
+        blackbox_trigger(record.type);
+    }
+}
+
+void init_blackbox() {
+    for (size_t i = 0; i < BLACKBOX_SLOTS; i++) {
+        slots[i].state = BLACKBOX_FREE;
+    }
+    blackbox_captures = 0;
+    blackbox_dropped = 0;
+    start_live(&slots[0]);
+    episode_subscribe(on_episode);
+}
+
+void blackbox_push(const int16_t raw[IMU_AXES]) {
+    BlackboxCapture* slot = live;
+    if (slot == nullptr || replay_mode) return;
+
+    const uint32_t pos = slot->write_pos;
+    for (int axis = 0; axis < IMU_AXES; axis++) {
+        slot->data[axis][pos] = raw[axis];
+    }
+    slot->write_pos = (pos + 1 < BLACKBOX_CAPTURE_SAMPLES) ? pos + 1 : 0;
+    if (slot->filled < BLACKBOX_CAPTURE_SAMPLES) slot->filled++;
+
+    if (slot->state != BLACKBOX_TAIL || --slot->post_remaining > 0) return;
+
+    // Tail complete: hand the slot off and continue in a free one
+    slot->first_sample = sample_count - slot->filled;
+    slot->state = BLACKBOX_FROZEN;
+    blackbox_captures++;
+
+    BlackboxCapture* next = find_free_slot();
+    if (next != nullptr) {
+        start_live(next);
+    } else {
+        live = nullptr;  // not reached: blackbox_trigger() reserves a free slot
+    }
+}
+
+void blackbox_flush() {
+    if (live != nullptr && live->state == BLACKBOX_LIVE) start_live(live);
+}
+
+void blackbox_trigger(uint8_t trigger_type) {
+    if (live == nullptr || live->state == BLACKBOX_TAIL) return;  // already capturing
+
+    // Only arm if a slot will be free to continue into after the freeze
+    if (find_free_slot() == nullptr) {
+        blackbox_dropped++;
+        return;
+    }
+
+    live->trigger_sample = sample_count;
+    live->trigger_ms = Kernel::get_ms_count();
+    live->trigger_type = trigger_type;
+    live->post_remaining = BLACKBOX_POST_SAMPLES;
+    live->state = BLACKBOX_TAIL;
+    printf(" | 🎥 capture armed");
+}
+
+BlackboxCapture* blackbox_acquire_frozen() {
+    BlackboxCapture* oldest = nullptr;
+    for (size_t i = 0; i < BLACKBOX_SLOTS; i++) {
+        if (slots[i].state == BLACKBOX_FROZEN &&
+            (oldest == nullptr || slots[i].trigger_sample < oldest->trigger_sample)) {
+            oldest = &slots[i];
+        }
+    }
+    if (oldest != nullptr) oldest->state = BLACKBOX_READING;
+    return oldest;
+}
+
+void blackbox_release(BlackboxCapture* capture) {
+    if (capture == nullptr) return;
+    capture->state = BLACKBOX_FREE;
+    if (live == nullptr) start_live(capture);
+}
+
+void blackbox_column_spans(const BlackboxCapture* capture, ImuAxis axis,
+                           const int16_t** first, size_t* first_len,
+                           const int16_t** second, size_t* second_len) {
+    const int16_t* col = capture->data[axis];
+    if (capture->filled < BLACKBOX_CAPTURE_SAMPLES) {
+        *first = col;
+        *first_len = capture->filled;
+        *second = col;
+        *second_len = 0;
+    } else {
+        *first = &col[capture->write_pos];
+        *first_len = BLACKBOX_CAPTURE_SAMPLES - capture->write_pos;
+        *second = col;
+        *second_len = capture->write_pos;
+    }
+}
@@ -6,6 +6,10 @@
 #include "ble_comm.h"
 #include "signal_processing.h"
 #include "fog_detection.h"
+#include "symptom_summary.h"
+#include "episode_tracker.h"
+#include "bradykinesia.h"
+#include "spectrogram.h"
 
 // BLE objects and state
 events::EventQueue ble_event_queue(16 * EVENTS_EVENT_SIZE);
@@ -13,18 +17,51 @@ BLE &ble_instance = BLE::Instance();
 GattCharacteristic *tremor_char = nullptr;
 GattCharacteristic *dysk_char = nullptr;
 GattCharacteristic *fog_char = nullptr;
+GattCharacteristic *summary_char = nullptr;
+GattCharacteristic *episode_char = nullptr;
+GattCharacteristic *brady_char = nullptr;
+GattCharacteristic *spectro_char = nullptr;
+GattCharacteristic *summary_rev_char = nullptr;
+GattCharacteristic *time_char = nullptr;
 GattServer *gatt_server = nullptr;
 bool ble_connected = false;
+uint32_t ble_tx_bytes = 0;
+uint32_t ble_episodes_dropped = 0;
 
 // String buffers for BLE characteristics
 static char tremor_buffer[32] = "TREMOR:0";
 static char dysk_buffer[32] = "DYSK:0";
 static char fog_buffer[32] = "FOG:0";
+static uint8_t summary_buffer[SUMMARY_EXPORT_SIZE];
+static uint8_t episode_buffer[sizeof(EpisodeRecord)];
+static uint8_t brady_buffer[sizeof(BradyPacket)];
+static uint8_t spectro_buffer[sizeof(SpectroPacket)];
+static uint8_t summary_rev_buffer[sizeof(uint32_t)];
+static uint8_t time_buffer[sizeof(uint32_t) + sizeof(int16_t)];
 
 // Previous values for change detection
 static uint16_t previous_tremor = 0;
 static uint16_t previous_dysk = 0;
 static uint16_t previous_fog = 0;
+static uint32_t previous_summary_revision = 0;
+static uint16_t previous_brady_score = 0;
+static uint16_t previous_brady_cycles = 0;
+static uint32_t previous_spectro_revision = 0;
+
+// Every published episode event, in order, until it has been notified
+static EpisodeRecord episode_queue[BLE_EPISODE_QUEUE_SIZE];
+static size_t episode_queue_head = 0;
+static size_t episode_queue_count = 0;
+
+static void on_episode(const EpisodeRecord& record) {
+    if (episode_queue_count == BLE_EPISODE_QUEUE_SIZE) {
+        episode_queue_head = (episode_queue_head + 1) % BLE_EPISODE_QUEUE_SIZE;
+        episode_queue_count--;
+        ble_episodes_dropped++;
+    }
+    episode_queue[(episode_queue_head + episode_queue_count) % BLE_EPISODE_QUEUE_SIZE] = record;
+    episode_queue_count++;
+}
 
 void schedule_ble_events(BLE::OnEventsToProcessCallbackContext *context) {
     ble_event_queue.call(Callback<void()>(&context->ble, &BLE::processEvents));
@@ -51,11 +88,48 @@ class PDGapEventHandler : public ble::Gap::EventHandler {
 
 static PDGapEventHandler gap_event_handler;
 
-void on_ble_init_complete(BLE::InitializationCompleteCallbackContext *params) {
-    extern uint16_t tremor_intensity;
-    extern uint16_t dysk_intensity;
-    extern uint8_t fog_status;
+// GATT write handler: the phone sets the RTC (uint32 Unix time, UTC),
+// optionally followed by its UTC offset (int16 minutes, east positive);
+// a bare time keeps the offset last written
+class PDGattEventHandler : public GattServer::EventHandler {
+    void onDataWritten(const GattWriteCallbackParams &params) override {
+        if (time_char == nullptr || params.handle != time_char->getValueHandle()) return;
+
+        uint32_t epoch;
+        int16_t offset_min = rtc_utc_offset_min;
+        if (params.len != sizeof(epoch) && params.len != sizeof(epoch) + sizeof(offset_min)) return;
+        memcpy(&epoch, params.data, sizeof(epoch));
+        if (params.len > sizeof(epoch)) memcpy(&offset_min, params.data + sizeof(epoch), sizeof(offset_min));
+        if (epoch < RTC_VALID_EPOCH || offset_min > RTC_MAX_UTC_OFFSET_MIN || offset_min < -RTC_MAX_UTC_OFFSET_MIN) {
+            printf("\n⚠️  Clock write rejected (%lu, %d min)\n\n", (unsigned long)epoch, offset_min);
+            return;
+        }
+        set_time((time_t)epoch);
+        rtc_utc_offset_min = offset_min;
+        printf("\n🕒 Clock set over BLE (%lu, UTC%+d min)\n\n", (unsigned long)epoch, offset_min);
+    }
+};
+
+static PDGattEventHandler gatt_event_handler;
+
+void ble_set_advertising_interval(uint32_t interval_ms) {
+    ble::AdvertisingParameters adv_params(
+        ble::advertising_type_t::CONNECTABLE_UNDIRECTED,
+        ble::adv_interval_t(ble::millisecond_t(interval_ms))
+    );
 
+    // Parameters can only change while stopped
+    bool active = ble_instance.gap().isAdvertisingActive(ble::LEGACY_ADVERTISING_HANDLE);
+    if (active) {
+        ble_instance.gap().stopAdvertising(ble::LEGACY_ADVERTISING_HANDLE);
+    }
+    ble_instance.gap().setAdvertisingParameters(ble::LEGACY_ADVERTISING_HANDLE, adv_params);
+    if (active) {
+        ble_instance.gap().startAdvertising(ble::LEGACY_ADVERTISING_HANDLE);
+    }
+}
+
+void on_ble_init_complete(BLE::InitializationCompleteCallbackContext *params) {
     if (params->error != BLE_ERROR_NONE) {
         printf("❌ BLE initialization failed\n");
         return;
@@ -65,6 +139,7 @@ void on_ble_init_complete(BLE::InitializationCompleteCallbackContext *params) {
 
     BLE &ble = params->ble;
     gatt_server = &ble.gattServer();
+    gatt_server->setEventHandler(&gatt_event_handler);
     
     // Create three GATT characteristics: tremor, dyskinesia, FOG
     tremor_char = new GattCharacteristic(
@@ -91,16 +166,74 @@ void on_ble_init_complete(BLE::InitializationCompleteCallbackContext *params) {
         GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
     );
     
+    // Hourly symptom summary table (SummaryPacket[], oldest hour first). Up
+    // to 480 bytes, more than a notification carries at any MTU, so it is
+    // read only (long read) and its revision is notified separately.
+    summary_char = new GattCharacteristic(
+        SUMMARY_CHAR_UUID_STR,
+        summary_buffer,
+        0,
+        SUMMARY_EXPORT_SIZE,
+        GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ
+    );
+    
+    // summary_revision (uint32), notified when the table changes
+    summary_rev_char = new GattCharacteristic(
+        SUMMARY_REV_CHAR_UUID_STR,
+        summary_rev_buffer,
+        sizeof(summary_rev_buffer),
+        sizeof(summary_rev_buffer),
+        GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
+    );
+    
+    // Episode start/end events (EpisodeRecord), one notification each
+    episode_char = new GattCharacteristic(
+        EPISODE_CHAR_UUID_STR,
+        episode_buffer,
+        sizeof(episode_buffer),
+        sizeof(episode_buffer),
+        GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
+    );
+    
+    // Bradykinesia metrics of the current/last movement sequence (BradyPacket)
+    brady_char = new GattCharacteristic(
+        BRADY_CHAR_UUID_STR,
+        brady_buffer,
+        sizeof(brady_buffer),
+        sizeof(brady_buffer),
+        GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
+    );
+    
+    // Newest spectrogram row (SpectroPacket)
+    spectro_char = new GattCharacteristic(
+        SPECTRO_CHAR_UUID_STR,
+        spectro_buffer,
+        sizeof(spectro_buffer),
+        sizeof(spectro_buffer),
+        GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
+    );
+    
+    // Wall-clock time from the phone (uint32 Unix time, optional int16 UTC
+    // offset in minutes), enables night hours
+    time_char = new GattCharacteristic(
+        TIME_CHAR_UUID_STR,
+        time_buffer,
+        sizeof(time_buffer),
+        sizeof(time_buffer),
+        GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE
+    );
+    
     // Register GATT service with all characteristics
-    GattCharacteristic *char_table[] = {tremor_char, dysk_char, fog_char};
-    GattService pd_service(PD_SERVICE_UUID_STR, char_table, 3);
+    GattCharacteristic *char_table[] = {tremor_char, dysk_char, fog_char, summary_char, episode_char, brady_char,
+                                        spectro_char, summary_rev_char, time_char};
+    GattService pd_service(PD_SERVICE_UUID_STR, char_table, sizeof(char_table) / sizeof(char_table[0]));
     
     gatt_server->addService(pd_service);
     
     // Configure advertising parameters
     ble::AdvertisingParameters adv_params(
         ble::advertising_type_t::CONNECTABLE_UNDIRECTED,
-        ble::adv_interval_t(ble::millisecond_t(1000))
+        ble::adv_interval_t(ble::millisecond_t(BLE_ADV_INTERVAL_MS))
     );
     
     ble.gap().setAdvertisingParameters(ble::LEGACY_ADVERTISING_HANDLE, adv_params);
@@ -137,14 +270,17 @@ void init_ble() {
     ble_instance.onEventsToProcess(schedule_ble_events);
     ble_instance.gap().setEventHandler(&gap_event_handler);
     ble_instance.init(on_ble_init_complete);
+    episode_subscribe(on_episode);
+}
+
+// Value write (notifies subscribed clients), counted for telemetry
+static void write_characteristic(GattCharacteristic* characteristic, const uint8_t* data, uint16_t length) {
+    gatt_server->write(characteristic->getValueHandle(), data, length);
+    ble_tx_bytes += length;
 }
 
 // Update BLE characteristics when values change
 void update_ble_characteristics() {
-    extern uint16_t tremor_intensity;
-    extern uint16_t dysk_intensity;
-    extern uint8_t fog_status;
-    
     if (!ble_connected || gatt_server == nullptr) return;
 
     // Check which values changed
@@ -155,11 +291,7 @@ void update_ble_characteristics() {
     if (tremor_changed) {
         snprintf(tremor_buffer, sizeof(tremor_buffer), "TREMOR:%u", tremor_intensity);
         
-        gatt_server->write(
-            tremor_char->getValueHandle(),
-            (uint8_t*)tremor_buffer,
-            strlen(tremor_buffer)
-        );
+        write_characteristic(tremor_char, (uint8_t*)tremor_buffer, strlen(tremor_buffer));
 
         if (tremor_intensity > 0) {
             printf("   📢 BLE NOTIFICATION: %s\n", tremor_buffer);
@@ -173,11 +305,7 @@ void update_ble_characteristics() {
     if (dysk_changed) {
         snprintf(dysk_buffer, sizeof(dysk_buffer), "DYSK:%u", dysk_intensity);
         
-        gatt_server->write(
-            dysk_char->getValueHandle(),
-            (uint8_t*)dysk_buffer,
-            strlen(dysk_buffer)
-        );
+        write_characteristic(dysk_char, (uint8_t*)dysk_buffer, strlen(dysk_buffer));
 
         if (dysk_intensity > 0) {
             printf("   📢 BLE NOTIFICATION: %s\n", dysk_buffer);
@@ -191,11 +319,7 @@ void update_ble_characteristics() {
     if (fog_changed) {
         snprintf(fog_buffer, sizeof(fog_buffer), "FOG:%u", fog_status);
         
-        gatt_server->write(
-            fog_char->getValueHandle(),
-            (uint8_t*)fog_buffer,
-            strlen(fog_buffer)
-        );
+        write_characteristic(fog_char, (uint8_t*)fog_buffer, strlen(fog_buffer));
 
         if (fog_status == 1) {
             printf("   📢 BLE NOTIFICATION: %s (detected!)\n", fog_buffer);
@@ -206,6 +330,55 @@ void update_ble_characteristics() {
         previous_fog = fog_status;
     }
 
+    // Summary table changes once per window: the value is refreshed in the
+    // attribute table (nothing is sent) and the revision notify tells the
+    // client to read it
+    bool summary_changed = (summary_revision != previous_summary_revision);
+    if (summary_changed) {
+        size_t len = summary_export(summary_buffer, sizeof(summary_buffer));
+        gatt_server->write(summary_char->getValueHandle(), summary_buffer, (uint16_t)len);
+
+        memcpy(summary_rev_buffer, &summary_revision, sizeof(summary_rev_buffer));
+        write_characteristic(summary_rev_char, summary_rev_buffer, sizeof(summary_rev_buffer));
+
+        previous_summary_revision = summary_revision;
+    }
+
+    // One queued event per update, so a burst of start/end events is not
+    // collapsed into the last one; the sequence field exposes any drops
+    if (episode_queue_count > 0) {
+        const EpisodeRecord& record = episode_queue[episode_queue_head];
+        memcpy(episode_buffer, &record, sizeof(episode_buffer));
+        
+        write_characteristic(episode_char, episode_buffer, sizeof(episode_buffer));
+
+        printf("   📢 BLE NOTIFICATION: episode #%lu\n", (unsigned long)record.sequence);
+        episode_queue_head = (episode_queue_head + 1) % BLE_EPISODE_QUEUE_SIZE;
+        episode_queue_count--;
+    }
+
+    if (brady_result.score != previous_brady_score || brady_result.sequence_cycles != previous_brady_cycles) {
+        BradyPacket packet;
+        bradykinesia_packet(&packet);
+        memcpy(brady_buffer, &packet, sizeof(brady_buffer));
+        
+        write_characteristic(brady_char, brady_buffer, sizeof(brady_buffer));
+
+        previous_brady_score = brady_result.score;
+        previous_brady_cycles = brady_result.sequence_cycles;
+    }
+
+    if (spectro_revision != previous_spectro_revision) {
+        SpectroPacket packet;
+        if (spectro_packet(0, &packet)) {
+            memcpy(spectro_buffer, &packet, sizeof(spectro_buffer));
+            
+            write_characteristic(spectro_char, spectro_buffer, sizeof(spectro_buffer));
+        }
+
+        previous_spectro_revision = spectro_revision;
+    }
+
     if (tremor_changed || dysk_changed || fog_changed) {
         printf("   BLE characteristics updated and notifications sent!\n");
     }
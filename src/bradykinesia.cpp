@@ -0,0 +1,207 @@
+/**
+ * @file bradykinesia.cpp
+ * @brief Bradykinesia metrics from repetitive pronation/supination
+ */
+
+#include "bradykinesia.h"
+#include "sensor.h"
+#include "calibration.h"
+
+PIPELINE_STATE BradykinesiaResult brady_result = {};
+
+// Running sums for the sequence (x = cycle index)
+struct SequenceSums {
+    float n;
+    float sx, sxx;
+    float s_amp, sx_amp;
+    float s_speed, sx_speed;
+    float s_period, s_period2;
+};
+
+static PIPELINE_STATE SequenceSums seq;
+
+// Cycle segmentation state
+static PIPELINE_STATE int8_t phase = 0;               // +1 / -1 half-wave, 0 before the first crossing
+static PIPELINE_STATE bool cycle_open = false;
+static PIPELINE_STATE uint32_t cycle_start_sample = 0;
+static PIPELINE_STATE uint32_t last_cycle_end = 0;
+static PIPELINE_STATE float angle = 0.0f;
+static PIPELINE_STATE float angle_min = 0.0f;
+static PIPELINE_STATE float angle_max = 0.0f;
+static PIPELINE_STATE float peak_speed = 0.0f;
+
+void init_bradykinesia() {
+    brady_result = {};
+    seq = {};
+    phase = 0;
+    cycle_open = false;
+    cycle_start_sample = 0;
+    last_cycle_end = 0;
+    angle = 0.0f;
+    angle_min = 0.0f;
+    angle_max = 0.0f;
+    peak_speed = 0.0f;
+}
+
+// Least-squares slope / intercept over the sequence, as a fraction of the intercept
+static float relative_slope(float sy, float sxy) {
+    float denom = seq.n * seq.sxx - seq.sx * seq.sx;
+    if (seq.n < 2.0f || denom <= 0.0f) return 0.0f;
+    float slope = (seq.n * sxy - seq.sx * sy) / denom;
+    float intercept = (sy - slope * seq.sx) / seq.n;
+    return (intercept > 0.0f) ? slope / intercept : 0.0f;
+}
+
+static void update_result() {
+    BradykinesiaResult& r = brady_result;
+    r.sequence_cycles = (uint16_t)seq.n;
+    r.mean_amplitude_deg = seq.s_amp / seq.n;
+    r.mean_speed_dps = seq.s_speed / seq.n;
+    r.mean_period_ms = seq.s_period / seq.n;
+    float var = seq.s_period2 / seq.n - r.mean_period_ms * r.mean_period_ms;
+    r.rhythm_cv = (var > 0.0f && r.mean_period_ms > 0.0f) ? sqrtf(var) / r.mean_period_ms : 0.0f;
+    r.amplitude_decrement = relative_slope(seq.s_amp, seq.sx_amp);
+    r.speed_decrement = relative_slope(seq.s_speed, seq.sx_speed);
+
+    if (r.sequence_cycles < BRADY_MIN_SEQUENCE_CYCLES) {
+        r.score = 0;
+        return;
+    }
+
+    // Slowness, fraction of amplitude lost over the sequence, and irregularity
+    float slowness = 1.0f - r.mean_speed_dps / BRADY_REFERENCE_SPEED_DPS;
+    float decrement = -r.amplitude_decrement * (seq.n - 1.0f);
+    float irregularity = r.rhythm_cv / 0.5f;
+    if (slowness < 0.0f) slowness = 0.0f;
+    if (decrement < 0.0f) decrement = 0.0f;
+    if (decrement > 1.0f) decrement = 1.0f;
+    if (irregularity > 1.0f) irregularity = 1.0f;
+
+    r.score = (uint16_t)(1000.0f * (0.5f * slowness + 0.3f * decrement + 0.2f * irregularity));
+}
+
+static void close_cycle(uint32_t end_sample) {
+    uint32_t period_ms = (uint32_t)((end_sample - cycle_start_sample) * 1000.0f / TARGET_SAMPLE_RATE_HZ);
+    if (period_ms < BRADY_MIN_PERIOD_MS || period_ms > BRADY_MAX_PERIOD_MS ||
+        peak_speed < BRADY_MIN_PEAK_DPS) {
+        return;
+    }
+
+    const uint32_t gap_samples = (uint32_t)(BRADY_SEQUENCE_GAP_MS * TARGET_SAMPLE_RATE_HZ / 1000.0f);
+    if (!brady_result.sequence_active || cycle_start_sample - last_cycle_end > gap_samples) {
+        seq = {};
+        brady_result.sequence_active = true;
+        brady_result.sequence_start_sample = cycle_start_sample;
+    }
+
+    // O(1) update of the regression and rhythm sums
+    float x = seq.n;
+    float amplitude = angle_max - angle_min;
+    seq.n += 1.0f;
+    seq.sx += x;
+    seq.sxx += x * x;
+    seq.s_amp += amplitude;
+    seq.sx_amp += x * amplitude;
+    seq.s_speed += peak_speed;
+    seq.sx_speed += x * peak_speed;
+    seq.s_period += period_ms;
+    seq.s_period2 += (float)period_ms * period_ms;
+
+    last_cycle_end = end_sample;
+    brady_result.cycles_in_window++;
+    update_result();
+}
+
+void bradykinesia_update_window(uint32_t start_sample) {
+    const int16_t* raw = raw_imu_buffer[BRADY_AXIS];
+    const float gain = cal_gain[BRADY_AXIS];
+    const float bias = cal_bias[BRADY_AXIS];
+    const float dt = 1.0f / TARGET_SAMPLE_RATE_HZ;
+
+    brady_result.cycles_in_window = 0;
+
+    for (size_t i = 0; i < WINDOW_SIZE; i++) {
+        float w = raw[i] * gain + bias;
+        uint32_t sample = start_sample + i;
+
+        angle += w * dt;
+        if (angle < angle_min) angle_min = angle;
+        if (angle > angle_max) angle_max = angle;
+        if (fabsf(w) > peak_speed) peak_speed = fabsf(w);
+
+        if (w > BRADY_HYSTERESIS_DPS && phase <= 0) {
+            // Rising crossing: closes the previous cycle, opens the next
+            if (phase < 0 && cycle_open) close_cycle(sample);
+            cycle_open = true;
+            cycle_start_sample = sample;
+            angle = angle_min = angle_max = 0.0f;
+            peak_speed = fabsf(w);
+            phase = 1;
+        } else if (w < -BRADY_HYSTERESIS_DPS && phase >= 0) {
+            phase = -1;
+        }
+    }
+
+    // End the sequence once movement has stopped
+    const uint32_t gap_samples = (uint32_t)(BRADY_SEQUENCE_GAP_MS * TARGET_SAMPLE_RATE_HZ / 1000.0f);
+    uint32_t end_sample = start_sample + WINDOW_SIZE;
+    if (brady_result.sequence_active && end_sample - last_cycle_end > gap_samples) {
+        brady_result.sequence_active = false;
+        cycle_open = false;
+        phase = 0;
+    }
+}
+
+void bradykinesia_save(BradyState* state) {
+    state->result = brady_result;
+    state->n = seq.n;
+    state->sx = seq.sx;
+    state->sxx = seq.sxx;
+    state->s_amp = seq.s_amp;
+    state->sx_amp = seq.sx_amp;
+    state->s_speed = seq.s_speed;
+    state->sx_speed = seq.sx_speed;
+    state->s_period = seq.s_period;
+    state->s_period2 = seq.s_period2;
+    state->phase = phase;
+    state->cycle_open = cycle_open;
+    state->cycle_start_sample = cycle_start_sample;
+    state->last_cycle_end = last_cycle_end;
+    state->angle = angle;
+    state->angle_min = angle_min;
+    state->angle_max = angle_max;
+    state->peak_speed = peak_speed;
+}
+
+void bradykinesia_restore(const BradyState* state) {
+    brady_result = state->result;
+    seq.n = state->n;
+    seq.sx = state->sx;
+    seq.sxx = state->sxx;
+    seq.s_amp = state->s_amp;
+    seq.sx_amp = state->sx_amp;
+    seq.s_speed = state->s_speed;
+    seq.sx_speed = state->sx_speed;
+    seq.s_period = state->s_period;
+    seq.s_period2 = state->s_period2;
+    phase = state->phase;
+    cycle_open = state->cycle_open;
+    cycle_start_sample = state->cycle_start_sample;
+    last_cycle_end = state->last_cycle_end;
+    angle = state->angle;
+    angle_min = state->angle_min;
+    angle_max = state->angle_max;
+    peak_speed = state->peak_speed;
+}
+
+void bradykinesia_packet(BradyPacket* packet) {
+    const BradykinesiaResult& r = brady_result;
+    packet->score = r.score;
+    packet->cycles = r.sequence_cycles;
+    packet->amplitude_ddeg = (uint16_t)(r.mean_amplitude_deg * 10.0f);
+    packet->speed_dps = (uint16_t)r.mean_speed_dps;
+    packet->period_ms = (uint16_t)r.mean_period_ms;
+    packet->amplitude_decrement_permille = (int16_t)(r.amplitude_decrement * 1000.0f);
+    packet->speed_decrement_permille = (int16_t)(r.speed_decrement * 1000.0f);
+    packet->rhythm_cv_permille = (uint16_t)(r.rhythm_cv * 1000.0f);
+}
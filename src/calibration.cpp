@@ -0,0 +1,392 @@
+/**
+ * @file calibration.cpp
+ * @brief Online gyro-bias and accelerometer offset/scale calibration
+ */
+
+#include "calibration.h"
+#include "sensor.h"
+#include "kv_writer.h"
+#include "kvstore_global_api.h"
+#include <cstring>
+
+const uint32_t CAL_RECORD_MAGIC = 0x4C414343;  // "CCAL"
+const uint16_t CAL_RECORD_VERSION = 2;
+
+// Forgetting-factor weighted sums for the fit y = a + k * (T - 25 °C)
+struct TempFit {
+    float sw, swt, swtt, swy, swty;
+};
+
+// Persisted form (KVStore value)
+struct CalibrationRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t orientations;
+    uint8_t flags;               // bit0 gyro_valid, bit1 accel_valid
+    float gyro_bias[3];
+    float accel_offset[3];
+    float accel_scale[3];
+    float accel_residual_g;
+    float directions[CAL_MAX_ORIENTATIONS][3];
+    TempFit temp_fit[IMU_AXES];
+};
+
+static_assert(sizeof(CalibrationRecord) <= KV_WRITER_MAX_RECORD, "CalibrationRecord too large for a KV slot");
+
+PIPELINE_STATE float cal_gain[IMU_AXES];
+PIPELINE_STATE float cal_bias[IMU_AXES];
+PIPELINE_STATE CalibrationState calibration;
+
+// Uncorrected mean gravity vector (g) of each stored still orientation
+static PIPELINE_STATE float directions[CAL_MAX_ORIENTATIONS][3];
+static PIPELINE_STATE TempFit temp_fit[IMU_AXES];
+static PIPELINE_STATE uint8_t next_replace = 0;
+static PIPELINE_STATE uint32_t last_save_ms = 0;
+static PIPELINE_STATE bool save_pending = false;
+
+static void update_coefficients() {
+    float dt = calibration.temperature_c - CAL_TEMP_REF_C;
+    for (int i = 0; i < 3; i++) {
+        float accel_offset = calibration.accel_offset[i] + calibration.accel_temp_coeff[i] * dt;
+        float gyro_bias = calibration.gyro_bias[i] + calibration.gyro_temp_coeff[i] * dt;
+        cal_gain[IMU_AX + i] = ACCEL_SCALE * calibration.accel_scale[i];
+        cal_bias[IMU_AX + i] = -accel_offset * calibration.accel_scale[i];
+        cal_gain[IMU_GX + i] = GYRO_SCALE;
+        cal_bias[IMU_GX + i] = -gyro_bias;
+    }
+}
+
+static void temp_fit_add(TempFit& fit, float w, float dt, float y) {
+    fit.sw = CAL_TEMP_FORGET * fit.sw + w;
+    fit.swt = CAL_TEMP_FORGET * fit.swt + w * dt;
+    fit.swtt = CAL_TEMP_FORGET * fit.swtt + w * dt * dt;
+    fit.swy = CAL_TEMP_FORGET * fit.swy + w * y;
+    fit.swty = CAL_TEMP_FORGET * fit.swty + w * dt * y;
+}
+
+// Weighted std of the temperatures in a fit
+static float temp_fit_spread(const TempFit& fit) {
+    if (fit.sw <= 0.0f) return 0.0f;
+    float mean = fit.swt / fit.sw;
+    float var = fit.swtt / fit.sw - mean * mean;
+    return (var > 0.0f) ? sqrtf(var) : 0.0f;
+}
+
+// Slope of the fit, or 0 while the temperature range is too narrow
+static float temp_fit_slope(const TempFit& fit, float limit) {
+    if (temp_fit_spread(fit) < CAL_TEMP_MIN_SPREAD_C) return 0.0f;
+    float k = (fit.sw * fit.swty - fit.swt * fit.swy) / (fit.sw * fit.swtt - fit.swt * fit.swt);
+    if (k > limit) return limit;
+    if (k < -limit) return -limit;
+    return k;
+}
+
+static void update_temp_model() {
+    for (int i = 0; i < 3; i++) {
+        calibration.gyro_temp_coeff[i] = temp_fit_slope(temp_fit[IMU_GX + i], CAL_GYRO_TEMP_COEFF_MAX);
+        calibration.accel_temp_coeff[i] = temp_fit_slope(temp_fit[IMU_AX + i], CAL_ACCEL_TEMP_COEFF_MAX);
+    }
+    calibration.temp_spread_c = temp_fit_spread(temp_fit[IMU_GX]);
+    calibration.temp_valid = calibration.temp_spread_c >= CAL_TEMP_MIN_SPREAD_C;
+}
+
+// Solve A x = b (6x6) by Gaussian elimination with partial pivoting
+static bool solve6(float A[6][6], float b[6], float x[6]) {
+    for (int col = 0; col < 6; col++) {
+        int pivot = col;
+        for (int r = col + 1; r < 6; r++) {
+            if (fabsf(A[r][col]) > fabsf(A[pivot][col])) pivot = r;
+        }
+        if (fabsf(A[pivot][col]) < 1e-9f) return false;
+
+        if (pivot != col) {
+            for (int c = 0; c < 6; c++) {
+                float t = A[col][c]; A[col][c] = A[pivot][c]; A[pivot][c] = t;
+            }
+            float t = b[col]; b[col] = b[pivot]; b[pivot] = t;
+        }
+
+        for (int r = col + 1; r < 6; r++) {
+            float f = A[r][col] / A[col][col];
+            for (int c = col; c < 6; c++) A[r][c] -= f * A[col][c];
+            b[r] -= f * b[col];
+        }
+    }
+
+    for (int r = 5; r >= 0; r--) {
+        float sum = b[r];
+        for (int c = r + 1; c < 6; c++) sum -= A[r][c] * x[c];
+        x[r] = sum / A[r][r];
+    }
+    return true;
+}
+
+// RMS of (|s * (m - o)| - 1) over the stored directions
+static float fit_residual(const float o[3], const float s[3]) {
+    float sum = 0.0f;
+    for (uint8_t k = 0; k < calibration.orientations; k++) {
+        float n2 = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            float c = s[i] * (directions[k][i] - o[i]);
+            n2 += c * c;
+        }
+        float r = sqrtf(n2) - 1.0f;
+        sum += r * r;
+    }
+    return sqrtf(sum / calibration.orientations);
+}
+
+// Gauss-Newton fit of per-axis offset and scale so all directions have |a| = 1 g
+static bool fit_accel(float offset[3], float scale[3], float* residual) {
+    float o[3], s[3];
+    memcpy(o, offset, sizeof(o));
+    memcpy(s, scale, sizeof(s));
+
+    for (int iter = 0; iter < 8; iter++) {
+        float JTJ[6][6] = {};
+        float JTr[6] = {};
+
+        for (uint8_t k = 0; k < calibration.orientations; k++) {
+            float d[3], c[3];
+            float n2 = 0.0f;
+            for (int i = 0; i < 3; i++) {
+                d[i] = directions[k][i] - o[i];
+                c[i] = s[i] * d[i];
+                n2 += c[i] * c[i];
+            }
+            float n = sqrtf(n2);
+            if (n < 1e-3f) return false;
+            float r = n - 1.0f;
+
+            float J[6];
+            for (int i = 0; i < 3; i++) {
+                J[i] = -s[i] * c[i] / n;       // dr/do_i
+                J[3 + i] = d[i] * c[i] / n;    // dr/ds_i
+            }
+            for (int a = 0; a < 6; a++) {
+                JTr[a] += J[a] * r;
+                for (int b = 0; b < 6; b++) JTJ[a][b] += J[a] * J[b];
+            }
+        }
+
+        float rhs[6], step[6];
+        for (int a = 0; a < 6; a++) {
+            JTJ[a][a] += 1e-4f;            // damping for poorly spread directions
+            rhs[a] = -JTr[a];
+        }
+        if (!solve6(JTJ, rhs, step)) return false;
+
+        float step_norm = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            o[i] += step[i];
+            s[i] += step[3 + i];
+            step_norm += step[i] * step[i] + step[3 + i] * step[3 + i];
+        }
+        if (step_norm < 1e-10f) break;
+    }
+
+    // Reject fits outside what the LSM6DSL datasheet tolerances allow
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(o[i]) > 0.25f || s[i] < 0.85f || s[i] > 1.15f) return false;
+    }
+
+    memcpy(offset, o, sizeof(o));
+    memcpy(scale, s, sizeof(s));
+    *residual = fit_residual(o, s);
+    return true;
+}
+
+static void save_calibration(uint32_t current_time) {
+    CalibrationRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = CAL_RECORD_MAGIC;
+    rec.version = CAL_RECORD_VERSION;
+    rec.orientations = calibration.orientations;
+    rec.flags = (calibration.gyro_valid ? 0x01 : 0) | (calibration.accel_valid ? 0x02 : 0);
+    memcpy(rec.gyro_bias, calibration.gyro_bias, sizeof(rec.gyro_bias));
+    memcpy(rec.accel_offset, calibration.accel_offset, sizeof(rec.accel_offset));
+    memcpy(rec.accel_scale, calibration.accel_scale, sizeof(rec.accel_scale));
+    rec.accel_residual_g = calibration.accel_residual_g;
+    memcpy(rec.directions, directions, sizeof(rec.directions));
+    memcpy(rec.temp_fit, temp_fit, sizeof(rec.temp_fit));
+
+    // Written by the KV thread; the result shows in kv_writer_stats. A post
+    // that is refused leaves the save pending for the next interval
+    last_save_ms = current_time;
+    if (!kv_writer_post(KV_SLOT_CALIBRATION, CAL_KV_KEY, &rec, sizeof(rec))) return;
+    printf(" | 💾 Cal queued");
+    save_pending = false;
+}
+
+void init_calibration() {
+    memset(&calibration, 0, sizeof(calibration));
+    memset(directions, 0, sizeof(directions));
+    memset(temp_fit, 0, sizeof(temp_fit));
+    for (int i = 0; i < 3; i++) calibration.accel_scale[i] = 1.0f;
+    calibration.temperature_c = CAL_TEMP_REF_C;
+    next_replace = 0;
+    last_save_ms = 0;
+    save_pending = false;
+
+    // A replay starts uncalibrated, like a first boot
+    CalibrationRecord rec;
+    size_t actual = 0;
+    if (!replay_mode && kv_get(CAL_KV_KEY, &rec, sizeof(rec), &actual) == MBED_SUCCESS &&
+        actual == sizeof(rec) && rec.magic == CAL_RECORD_MAGIC && rec.version == CAL_RECORD_VERSION &&
+        rec.orientations <= CAL_MAX_ORIENTATIONS) {
+        memcpy(calibration.gyro_bias, rec.gyro_bias, sizeof(rec.gyro_bias));
+        memcpy(calibration.accel_offset, rec.accel_offset, sizeof(rec.accel_offset));
+        memcpy(calibration.accel_scale, rec.accel_scale, sizeof(rec.accel_scale));
+        memcpy(directions, rec.directions, sizeof(directions));
+        memcpy(temp_fit, rec.temp_fit, sizeof(temp_fit));
+        calibration.accel_residual_g = rec.accel_residual_g;
+        calibration.orientations = rec.orientations;
+        calibration.gyro_valid = (rec.flags & 0x01) != 0;
+        calibration.accel_valid = (rec.flags & 0x02) != 0;
+        calibration.restored = true;
+        next_replace = rec.orientations % CAL_MAX_ORIENTATIONS;
+        update_temp_model();
+
+        printf("✓ Calibration restored: gyro bias %.2f/%.2f/%.2f dps, %u directions\n",
+               calibration.gyro_bias[0], calibration.gyro_bias[1], calibration.gyro_bias[2],
+               calibration.orientations);
+    } else {
+        printf("✓ No stored calibration, learning at rest\n");
+    }
+
+    update_coefficients();
+}
+
+void calibration_set_temperature(float temperature_c) {
+    calibration.temperature_c = temperature_c;
+    update_coefficients();
+}
+
+void calibration_update_window(uint32_t current_time) {
+    // Updates since the last save are written once the interval has passed,
+    // whether or not this window is still
+    if (save_pending && current_time - last_save_ms >= CAL_SAVE_INTERVAL_MS) {
+        save_calibration(current_time);
+    }
+    if (!replay_learning) return;
+
+    // Per-axis mean and variance of the raw window (counts)
+    float mean[IMU_AXES], var[IMU_AXES];
+    for (int axis = 0; axis < IMU_AXES; axis++) {
+        int32_t sum = 0;
+        int64_t sum_sq = 0;
+        for (size_t i = 0; i < WINDOW_SIZE; i++) {
+            int32_t v = raw_imu_buffer[axis][i];
+            sum += v;
+            sum_sq += (int64_t)v * v;
+        }
+        mean[axis] = (float)sum / WINDOW_SIZE;
+        var[axis] = (float)sum_sq / WINDOW_SIZE - mean[axis] * mean[axis];
+    }
+
+    // Stillness: quiet gyro on every axis and quiet accelerometer overall
+    const float gyro_var_max = (CAL_STILL_GYRO_STD_DPS / GYRO_SCALE) * (CAL_STILL_GYRO_STD_DPS / GYRO_SCALE);
+    bool still = var[IMU_GX] < gyro_var_max && var[IMU_GY] < gyro_var_max && var[IMU_GZ] < gyro_var_max;
+    float accel_std_g = sqrtf(var[IMU_AX] + var[IMU_AY] + var[IMU_AZ]) * ACCEL_SCALE;
+    if (!still || accel_std_g >= STILLNESS_STD_THRESHOLD) return;
+
+    calibration.still_windows++;
+
+    const float dt = calibration.temperature_c - CAL_TEMP_REF_C;
+
+    // Gyro bias: EMA of the at-rest mean, referred to 25 °C
+    const float GYRO_BIAS_ALPHA = 0.1f;
+    float residual = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        float observed = mean[IMU_GX + i] * GYRO_SCALE;
+        temp_fit_add(temp_fit[IMU_GX + i], 1.0f, dt, observed);
+
+        float m = observed - calibration.gyro_temp_coeff[i] * dt;
+        float err = m - calibration.gyro_bias[i];
+        if (fabsf(err) > residual) residual = fabsf(err);
+        calibration.gyro_bias[i] = calibration.gyro_valid ? calibration.gyro_bias[i] + GYRO_BIAS_ALPHA * err : m;
+    }
+    calibration.gyro_residual_dps = residual;
+    calibration.gyro_valid = true;
+
+    // Accelerometer: collect distinct gravity directions
+    float g[3];
+    float g_norm2 = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        g[i] = mean[IMU_AX + i] * ACCEL_SCALE;
+        g_norm2 += g[i] * g[i];
+    }
+    float g_norm = sqrtf(g_norm2);
+
+    if (g_norm > 0.8f && g_norm < 1.2f) {
+        // Temperature slope of the accel offset: the radial error of the
+        // corrected gravity vector, weighted by how well each axis sees gravity
+        if (calibration.accel_valid) {
+            float a[3];
+            float a_norm2 = 0.0f;
+            for (int i = 0; i < 3; i++) {
+                a[i] = (g[i] - calibration.accel_offset[i]) * calibration.accel_scale[i];
+                a_norm2 += a[i] * a[i];
+            }
+            float a_norm = sqrtf(a_norm2);
+            for (int i = 0; i < 3; i++) {
+                float err = a[i] * (1.0f - 1.0f / a_norm) / calibration.accel_scale[i];
+                temp_fit_add(temp_fit[IMU_AX + i], a[i] * a[i] / a_norm2, dt, err);
+            }
+        }
+
+        // Directions are stored with the temperature drift removed
+        for (int i = 0; i < 3; i++) g[i] -= calibration.accel_temp_coeff[i] * dt;
+        g_norm2 = g[0] * g[0] + g[1] * g[1] + g[2] * g[2];
+        g_norm = sqrtf(g_norm2);
+
+        const float cos_min = cosf(CAL_ORIENTATION_MIN_DEG * 3.14159265f / 180.0f);
+        int nearest = -1;
+        float best_cos = -2.0f;
+        for (uint8_t k = 0; k < calibration.orientations; k++) {
+            float dot = 0.0f, n2 = 0.0f;
+            for (int i = 0; i < 3; i++) {
+                dot += g[i] * directions[k][i];
+                n2 += directions[k][i] * directions[k][i];
+            }
+            float c = dot / (g_norm * sqrtf(n2));
+            if (c > best_cos) { best_cos = c; nearest = k; }
+        }
+
+        if (nearest >= 0 && best_cos > cos_min) {
+            for (int i = 0; i < 3; i++) directions[nearest][i] += 0.2f * (g[i] - directions[nearest][i]);
+        } else {
+            uint8_t slot = calibration.orientations;
+            if (slot >= CAL_MAX_ORIENTATIONS) {
+                slot = next_replace;
+                next_replace = (uint8_t)((next_replace + 1) % CAL_MAX_ORIENTATIONS);
+            } else {
+                calibration.orientations++;
+            }
+            memcpy(directions[slot], g, sizeof(g));
+        }
+
+        if (calibration.orientations >= CAL_MIN_ORIENTATIONS) {
+            float fit_residual_g;
+            if (fit_accel(calibration.accel_offset, calibration.accel_scale, &fit_residual_g)) {
+                calibration.accel_residual_g = fit_residual_g;
+                calibration.accel_valid = true;
+            }
+        }
+    }
+
+    update_temp_model();
+    update_coefficients();
+    calibration.updated_ms = current_time;
+    save_pending = true;
+
+    // The first estimate of a session is kept right away
+    if (last_save_ms == 0) {
+        save_calibration(current_time);
+    }
+}
+
+uint32_t calibration_age_s(uint32_t current_time) {
+    if (calibration.updated_ms == 0) return UINT32_MAX;
+    return (current_time - calibration.updated_ms) / 1000;
+}
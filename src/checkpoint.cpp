@@ -0,0 +1,199 @@
+/**
+ * @file checkpoint.cpp
+ * @brief Versioned snapshot and restore of the pipeline state
+ */
+
+#include "checkpoint.h"
+#include "data_quality.h"
+#include "wavelet.h"
+#include "sensor.h"
+#include "kv_writer.h"
+#include "kvstore_global_api.h"
+#include <cstring>
+
+const uint32_t CHECKPOINT_MAGIC = 0x54505043;  // "CPPT"
+const uint16_t CHECKPOINT_VERSION = 5;
+
+static_assert(sizeof(PipelineState) <= KV_WRITER_MAX_RECORD, "PipelineState too large for a KV slot");
+
+PIPELINE_STATE CheckpointStats checkpoint_stats = {};
+
+static PIPELINE_STATE PipelineState snapshot;
+
+void pipeline_snapshot(PipelineState* state, uint32_t current_time) {
+    memset(state, 0, sizeof(*state));
+    state->magic = CHECKPOINT_MAGIC;
+    state->version = CHECKPOINT_VERSION;
+    state->size = sizeof(PipelineState);
+    state->saved_rtc = replay_mode ? 0 : (uint32_t)time(NULL);
+    state->saved_ms = current_time;
+    state->saved_sample = sample_count;
+
+    state->accel_baseline_ema = accel_baseline_ema;
+    state->fusion_accel_weight = fusion_accel_weight;
+    state->still_noise_lsb = quality_stats.still_noise_lsb;
+    state->still_windows = quality_stats.still_windows;
+    state->noise_jump_run = quality_stats.noise_jump_run;
+    state->utc_offset_min = rtc_utc_offset_min;
+
+    state->detection = detection_state;
+    state->tremor_intensity = tremor_intensity;
+    state->dysk_intensity = dysk_intensity;
+    state->fog = fog_detector;
+    state->last_step_time_ms = last_step_time_ms;
+    state->above_step_threshold = above_step_threshold;
+    state->fog_status = fog_status;
+    state->motor = motor_state;
+    episode_tracker_save(state->episodes);
+    state->episode_sequence = episode_sequence;
+    bradykinesia_save(&state->brady);
+    state->last_strike_ms = wavelet_result.last_strike_ms;
+    state->night = night_stats;
+    state->night_active = night_mode_active;
+}
+
+// Same age on the new clock; 0 stays "unset"
+static uint32_t rebase(uint32_t t, uint32_t saved_ms, uint32_t current_time) {
+    if (t == 0) return 0;
+    uint32_t rebased = current_time - (saved_ms - t);
+    return (rebased == 0) ? 1 : rebased;
+}
+
+// Same distance from sample_count; differences stay exact across the wrap
+static uint32_t rebase_sample(uint32_t s, uint32_t saved_sample) {
+    return sample_count - (saved_sample - s);
+}
+
+void pipeline_restore(const PipelineState* state, RestoreLevel level, uint32_t current_time) {
+    if (level == RESTORE_NONE) return;
+
+    accel_baseline_ema = state->accel_baseline_ema;
+    fusion_accel_weight = state->fusion_accel_weight;
+    quality_stats.still_noise_lsb = state->still_noise_lsb;
+    quality_stats.still_windows = state->still_windows;
+    quality_stats.noise_jump_run = state->noise_jump_run;
+    rtc_utc_offset_min = state->utc_offset_min;
+
+    if (level != RESTORE_FULL) return;
+
+    const uint32_t saved = state->saved_ms;
+    const uint32_t saved_sample = state->saved_sample;
+    detection_state = state->detection;
+    tremor_intensity = state->tremor_intensity;
+    dysk_intensity = state->dysk_intensity;
+
+    fog_detector = state->fog;
+    fog_detector.walking_start_time = rebase(fog_detector.walking_start_time, saved, current_time);
+    fog_detector.freeze_start_time = rebase(fog_detector.freeze_start_time, saved, current_time);
+    fog_detector.freeze_confirmed_start = rebase(fog_detector.freeze_confirmed_start, saved, current_time);
+    last_step_time_ms = rebase(state->last_step_time_ms, saved, current_time);
+    above_step_threshold = state->above_step_threshold;
+    fog_status = state->fog_status;
+
+    motor_state = state->motor;
+    motor_state.state_since_ms = rebase(motor_state.state_since_ms, saved, current_time);
+
+    EpisodeTrack tracks[EPISODE_TYPES];
+    memcpy(tracks, state->episodes, sizeof(tracks));
+    for (size_t i = 0; i < EPISODE_TYPES; i++) {
+        EpisodeTrack& t = tracks[i];
+        t.run_start_sample = rebase_sample(t.run_start_sample, saved_sample);
+        t.last_match_end = rebase_sample(t.last_match_end, saved_sample);
+        t.record.start_sample = rebase_sample(t.record.start_sample, saved_sample);
+        if (t.record.end_sample != 0) t.record.end_sample = rebase_sample(t.record.end_sample, saved_sample);
+        t.record.start_ms = rebase(t.record.start_ms, saved, current_time);
+    }
+    episode_tracker_restore(tracks);
+    episode_sequence = state->episode_sequence;
+
+    BradyState brady = state->brady;
+    brady.result.sequence_start_sample = rebase_sample(brady.result.sequence_start_sample, saved_sample);
+    brady.cycle_start_sample = rebase_sample(brady.cycle_start_sample, saved_sample);
+    brady.last_cycle_end = rebase_sample(brady.last_cycle_end, saved_sample);
+    bradykinesia_restore(&brady);
+
+    wavelet_result.last_strike_ms = rebase(state->last_strike_ms, saved, current_time);
+
+    NightModeStats night = state->night;
+    night.last_change_ms = rebase(night.last_change_ms, saved, current_time);
+    night_mode_restore(state->night_active, night);
+}
+
+void pipeline_snapshot_history(PipelineHistory* history) {
+    multires_save(&history->multires);
+    spectro_save(&history->spectro);
+    coherence_save(&history->coherence);
+}
+
+void pipeline_restore_history(const PipelineHistory* history) {
+    multires_restore(&history->multires);
+    spectro_restore(&history->spectro);
+    coherence_restore(&history->coherence);
+}
+
+// Resets that leave the RTC running (its count is comparable, set or not)
+static bool warm_reset() {
+#if DEVICE_RESET_REASON
+    switch (ResetReason::get()) {
+        case RESET_REASON_SOFTWARE:
+        case RESET_REASON_WATCHDOG:
+        case RESET_REASON_PIN_RESET:
+        case RESET_REASON_LOCKUP:
+            return true;
+        default:
+            return false;
+    }
+#else
+    return false;
+#endif
+}
+
+void init_checkpoint() {
+    checkpoint_stats = {};
+
+    PipelineState rec;
+    size_t actual = 0;
+    if (kv_get(CHECKPOINT_KV_KEY, &rec, sizeof(rec), &actual) != MBED_SUCCESS) {
+        printf("✓ No pipeline checkpoint, starting fresh\n");
+        return;
+    }
+    if (actual != sizeof(rec) || rec.magic != CHECKPOINT_MAGIC ||
+        rec.version != CHECKPOINT_VERSION || rec.size != sizeof(rec)) {
+        printf("⚠️  Pipeline checkpoint discarded (version %u, %u bytes)\n",
+               (rec.magic == CHECKPOINT_MAGIC) ? rec.version : 0, (unsigned)actual);
+        return;
+    }
+
+    // Short-term state only makes sense after a short outage the RTC can vouch for
+    uint32_t now_rtc = (uint32_t)time(NULL);
+    bool comparable = warm_reset() || (rec.saved_rtc >= RTC_VALID_EPOCH && now_rtc >= RTC_VALID_EPOCH);
+    RestoreLevel level = RESTORE_SLOW;
+    if (comparable && now_rtc >= rec.saved_rtc) {
+        checkpoint_stats.restored_gap_s = now_rtc - rec.saved_rtc;
+        if (checkpoint_stats.restored_gap_s <= CHECKPOINT_MAX_GAP_S) level = RESTORE_FULL;
+    }
+
+    pipeline_restore(&rec, level, Kernel::get_ms_count());
+    checkpoint_stats.restored = level;
+    if (level == RESTORE_FULL) {
+        printf("✓ Pipeline state restored (%lus old): FOG %d, motor %s\n",
+               (unsigned long)checkpoint_stats.restored_gap_s, (int)fog_detector.state,
+               motor_state_name(motor_state.state));
+    } else {
+        printf("✓ Pipeline slow state restored (gravity %.3f g, fusion %.2f)\n",
+               accel_baseline_ema, fusion_accel_weight);
+    }
+}
+
+void checkpoint_update(uint32_t current_time) {
+    if (replay_mode) return;
+    pipeline_snapshot(&snapshot, current_time);
+
+    CheckpointStats& s = checkpoint_stats;
+    if (s.saves > 0 && current_time - s.last_save_ms < CHECKPOINT_INTERVAL_MS) return;
+
+    // Copied by the writer thread; the flash write happens off the main loop
+    kv_writer_post(KV_SLOT_CHECKPOINT, CHECKPOINT_KV_KEY, &snapshot, sizeof(snapshot));
+    s.saves++;
+    s.last_save_ms = current_time;
+}
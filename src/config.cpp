@@ -4,11 +4,35 @@
  */
 
 #include "config.h"
+#ifndef PD_HOST_BUILD
 #include "ble/BLE.h"
+#endif
+
+PIPELINE_STATE int16_t rtc_utc_offset_min = 0;
+
+bool rtc_local_seconds(time_t* local) {
+    time_t now = time(NULL);
+    if (now < (time_t)RTC_VALID_EPOCH) return false;
+    *local = now + (time_t)rtc_utc_offset_min * 60;
+    return true;
+}
+
+bool rtc_local_time(struct tm* local) {
+    time_t shifted;
+    if (!rtc_local_seconds(&shifted)) return false;
+    gmtime_r(&shifted, local);
+    return true;
+}
 
 // BLE UUID constants
 
 const char* PD_SERVICE_UUID_STR = "A0E1B2C3-D4E5-F6A7-B8C9-D0E1F2A3B4C5";
 const char* TREMOR_CHAR_UUID_STR = "A1E2B3C4-D5E6-F7A8-B9C0-D1E2F3A4B5C6";
 const char* DYSK_CHAR_UUID_STR = "A2E3B4C5-D6E7-F8A9-B0C1-D2E3F4A5B6C7";
-const char* FOG_CHAR_UUID_STR = "A3E4B5C6-D7E8-F9AA-B1C2-D3E4F5A6B7C8";
\ No newline at end of file
+const char* FOG_CHAR_UUID_STR = "A3E4B5C6-D7E8-F9AA-B1C2-D3E4F5A6B7C8";
+const char* SUMMARY_CHAR_UUID_STR = "A4E5B6C7-D8E9-FAAB-B2C3-D4E5F6A7B8C9";
+const char* EPISODE_CHAR_UUID_STR = "A5E6B7C8-D9EA-FBAC-B3C4-D5E6F7A8B9CA";
+const char* BRADY_CHAR_UUID_STR = "A6E7B8C9-DAEB-FCAD-B4C5-D6E7F8A9BACB";
+const char* SPECTRO_CHAR_UUID_STR = "A7E8B9CA-DBEC-FDAE-B5C6-D7E8F9AABBCC";
+const char* SUMMARY_REV_CHAR_UUID_STR = "A8E9BACB-DCED-FEAF-B6C7-D8E9FAABBCCD";
+const char* TIME_CHAR_UUID_STR = "AAEBBCCD-DEEF-FAB0-B8C9-DAEBFCADBECF";
\ No newline at end of file
@@ -0,0 +1,113 @@
+/**
+ * @file data_quality.cpp
+ * @brief Per-window sensor data quality and fault monitor
+ */
+
+#include "data_quality.h"
+#include "sensor.h"
+#include <cstdlib>
+
+PIPELINE_STATE DataQualityStats quality_stats = {};
+
+// Acquisition counters at the previous window
+static PIPELINE_STATE uint32_t last_read_errors = 0;
+static PIPELINE_STATE uint32_t last_missed_samples = 0;
+
+void init_data_quality() {
+    quality_stats = {};
+    last_read_errors = sensor_read_errors;
+    last_missed_samples = sensor_missed_samples;
+}
+
+uint8_t data_quality_assess(float accel_mean, float std_dev, uint8_t* flags) {
+    uint32_t changes[IMU_AXES] = {0};
+    uint32_t saturated = 0;
+    uint32_t gyro_diff = 0;
+    size_t run = 1, longest_run = 1;
+
+    // Single pass over the raw columns
+    for (size_t i = 0; i < WINDOW_SIZE; i++) {
+        bool repeat = (i > 0);
+        for (size_t axis = 0; axis < IMU_AXES; axis++) {
+            int16_t v = raw_imu_buffer[axis][i];
+            if (v >= QUALITY_SATURATION_LSB || v <= -QUALITY_SATURATION_LSB) saturated++;
+            if (i == 0) continue;
+            int16_t prev = raw_imu_buffer[axis][i - 1];
+            if (v != prev) {
+                changes[axis]++;
+                repeat = false;
+            }
+            if (axis >= IMU_GX) gyro_diff += abs(v - prev);
+        }
+        run = repeat ? run + 1 : 1;
+        if (run > longest_run) longest_run = run;
+    }
+
+    uint8_t f = 0;
+    int score = 100;
+
+    bool dead_axis = false;
+    for (size_t axis = 0; axis < IMU_AXES; axis++) {
+        if (changes[axis] == 0) dead_axis = true;
+    }
+    if (dead_axis || longest_run >= QUALITY_STUCK_RUN) {
+        f |= QUALITY_STUCK;
+        score -= 60;
+    }
+
+    uint32_t missed = sensor_missed_samples - last_missed_samples;
+    uint32_t read_errors = sensor_read_errors - last_read_errors;
+    last_missed_samples = sensor_missed_samples;
+    last_read_errors = sensor_read_errors;
+    if (missed > 0) {
+        f |= QUALITY_DROPOUT;
+        score -= (missed * 200 > 50 * WINDOW_SIZE) ? 50 : (int)(missed * 200 / WINDOW_SIZE) + 5;
+    }
+    if (read_errors > 0) {
+        f |= QUALITY_READ_ERROR;
+        score -= (read_errors > 10) ? 50 : (int)read_errors * 5;
+    }
+
+    if (saturated > 0) {
+        f |= QUALITY_SATURATED;
+        score -= (saturated > 10) ? 40 : (int)saturated * 4;
+    }
+
+    if (accel_mean < QUALITY_GRAVITY_MIN_G || accel_mean > QUALITY_GRAVITY_MAX_G) {
+        f |= QUALITY_MAGNITUDE;
+        score -= 50;
+    }
+
+    // Gyro noise only means something while the arm is still
+    if (std_dev < STILLNESS_STD_THRESHOLD && !(f & QUALITY_STUCK)) {
+        float noise = (float)gyro_diff / (3 * (WINDOW_SIZE - 1));
+        DataQualityStats& s = quality_stats;
+        if (s.still_windows >= QUALITY_NOISE_MIN_WINDOWS &&
+            (noise > s.still_noise_lsb * QUALITY_NOISE_JUMP_RATIO ||
+             noise * QUALITY_NOISE_JUMP_RATIO < s.still_noise_lsb)) {
+            f |= QUALITY_NOISE_JUMP;
+            score -= 30;
+            // A lasting shift is the new normal: relearn the level
+            if (++s.noise_jump_run >= QUALITY_NOISE_RELEARN_WINDOWS) {
+                s.still_windows = 0;
+                s.noise_jump_run = 0;
+            }
+        } else {
+            s.noise_jump_run = 0;
+            s.still_noise_lsb = (s.still_windows == 0) ? noise
+                : QUALITY_NOISE_ALPHA * noise + (1.0f - QUALITY_NOISE_ALPHA) * s.still_noise_lsb;
+            s.still_windows++;
+        }
+    }
+
+    if (score < 0) score = 0;
+
+    quality_stats.windows++;
+    if (score < QUALITY_MIN_SCORE) quality_stats.rejected++;
+    for (size_t bit = 0; bit < QUALITY_FLAG_COUNT; bit++) {
+        if (f & (1u << bit)) quality_stats.flag_counts[bit]++;
+    }
+
+    *flags = f;
+    return (uint8_t)score;
+}
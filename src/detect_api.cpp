@@ -0,0 +1,100 @@
+/**
+ * @file detect_api.cpp
+ * @brief C ABI over the detection pipeline for replay and bindings
+ */
+
+#include "detect_api.h"
+#include "sensor.h"
+#include "signal_processing.h"
+#include "fog_detection.h"
+#include "symptom_summary.h"
+#include "episode_tracker.h"
+#include "calibration.h"
+#include "bradykinesia.h"
+#include "wavelet.h"
+#include "motor_state.h"
+#include "multires.h"
+#include "night_mode.h"
+#include "data_quality.h"
+#include "spectrogram.h"
+#include "baseline.h"
+#include "checkpoint.h"
+#include "telemetry.h"
+
+static_assert(sizeof(DetectWindow) == 44, "DetectWindow layout changed");
+
+PIPELINE_STATE bool replay_mode = false;
+PIPELINE_STATE bool replay_learning = true;
+
+// Same order as main(); no checkpoint restore, a replay starts from power-on
+void detect_reset(void) {
+    replay_mode = true;
+    replay_learning = true;
+
+    init_sensor_state();
+    init_signal_processing();
+    init_calibration();
+    init_baseline();
+    init_fog_detection();
+    init_symptom_summary();
+    init_episode_tracker();
+    init_bradykinesia();
+    init_wavelet();
+    init_motor_state();
+    init_multires();
+    init_night_mode();
+    init_data_quality();
+    init_spectrogram();
+    init_telemetry();
+    checkpoint_stats = {};
+}
+
+void detect_set_learning(int enabled) {
+    if (!replay_mode) detect_reset();
+    replay_learning = (enabled != 0);
+}
+
+static void copy_window(const WindowResult& r, DetectWindow* w) {
+    w->window_index = r.window_index;
+    w->start_sample = r.start_sample;
+    w->std_dev = r.std_dev;
+    w->tremor_freq = r.tremor_freq;
+    w->dysk_freq = r.dysk_freq;
+    w->raw_intensity = r.raw_intensity;
+    w->freeze_index = r.freeze_index;
+    w->tremor_intensity = r.tremor_intensity;
+    w->dysk_intensity = r.dysk_intensity;
+    w->brady_score = r.brady_score;
+    w->off_score = r.off_score;
+    w->steps = r.steps;
+    w->raw_detection = r.raw_detection;
+    w->fog_state = r.fog_state;
+    w->quality_score = r.quality_score;
+    w->quality_flags = r.quality_flags;
+    w->motor_state = r.motor_state;
+    w->heel_strikes = r.heel_strikes;
+}
+
+size_t detect_run(const int16_t* const axes[6], size_t stride, size_t n_samples,
+                  uint32_t start_ms, DetectWindow* out, size_t max_out) {
+    size_t windows = 0;
+    int16_t raw[IMU_AXES];
+
+    if (!replay_mode) detect_reset();   // first call on this thread
+
+    for (size_t i = 0; i < n_samples; i++) {
+        for (size_t axis = 0; axis < IMU_AXES; axis++) {
+            raw[axis] = axes[axis][i * stride];
+        }
+        uint32_t t = start_ms + (uint32_t)(i * 1000.0 / TARGET_SAMPLE_RATE_HZ);
+        sensor_ingest_sample(raw, t);
+        multires_service();
+
+        if (window_ready) {
+            process_window(t);
+            if (windows < max_out) copy_window(window_result, &out[windows]);
+            windows++;
+        }
+    }
+    return windows;
+}
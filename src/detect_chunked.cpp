@@ -0,0 +1,230 @@
+/**
+ * @file detect_chunked.cpp
+ * @brief Chunked replay of one recording on several threads (host build)
+ */
+
+#ifdef PD_HOST_BUILD
+
+#include "detect_api.h"
+#include "sensor.h"
+#include "checkpoint.h"
+#include "data_quality.h"
+#include "fog_detection.h"
+#include "motor_state.h"
+#include "multires.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Worker state is kept this often, so that a replay can stop where it meets it
+static const size_t MARK_WINDOWS = 100;
+
+// Pipeline state at a window boundary
+struct Boundary {
+    PipelineState state;
+    PipelineHistory history;
+};
+
+struct Segment {
+    size_t first_window;         // index on the recording's window grid
+    size_t windows;
+    size_t warmup;               // windows replayed ahead of first_window
+    std::vector<DetectWindow> out;
+    std::vector<MotorInput> motor;     // per window, for the motor-state pass
+    std::unique_ptr<Boundary> start;   // after the warm-up
+    std::unique_ptr<Boundary> end;
+    std::vector<std::unique_ptr<Boundary>> marks;   // before window MARK_WINDOWS * (k + 1)
+};
+
+struct Recording {
+    const int16_t* const* axes;
+    size_t stride;
+    uint32_t start_ms;
+};
+
+// Same clock as detect_run; exact across calls since windows start on a
+// multiple of 13 samples (1000 / 52 Hz = 250 / 13 ms)
+static uint32_t sample_ms(const Recording& rec, size_t i) {
+    return rec.start_ms + (uint32_t)(i * 1000.0 / TARGET_SAMPLE_RATE_HZ);
+}
+
+static void feed(const Recording& rec, size_t first, size_t n, DetectWindow* out, size_t max_out) {
+    const int16_t* axes[IMU_AXES];
+    for (size_t a = 0; a < IMU_AXES; a++) axes[a] = rec.axes[a] + first * rec.stride;
+    detect_run(axes, rec.stride, n, sample_ms(rec, first), out, max_out);
+}
+
+static void capture(const Recording& rec, size_t sample, Boundary* b) {
+    memset(b, 0, sizeof(*b));
+    pipeline_snapshot(&b->state, sample_ms(rec, sample - 1));
+    pipeline_snapshot_history(&b->history);
+}
+
+// Fresh pipeline whose sample clock, window count and multi-resolution
+// schedule read as if it had run from the start of the recording
+static void fresh_pipeline_at(const Recording& rec, size_t sample) {
+    detect_reset();
+    detect_set_learning(0);
+    if (sample == 0) return;
+
+    sample_count = (uint32_t)sample;
+    window_count = (uint32_t)(sample / WINDOW_SIZE);
+    last_sample_time_ms = sample_ms(rec, sample - 1);
+
+    std::unique_ptr<PipelineHistory> history(new PipelineHistory());
+    pipeline_snapshot_history(history.get());
+    history->spectro.head = (uint32_t)((sample / WINDOW_SIZE) % SPECTRO_ROWS);   // a row per window
+    history->multires.samples = (uint32_t)sample;
+    for (int id = 0; id < MULTIRES_JOBS; id++) {
+        // Every hop runs in a replay: next due is the first grid point past sample
+        const uint32_t w = multires_jobs[id].window_samples;
+        const uint32_t hop = multires_jobs[id].hop_samples;
+        history->multires.next_sample[id] = (sample < w) ? w : w + ((uint32_t)(sample - w) / hop + 1) * hop;
+    }
+    pipeline_restore_history(history.get());
+}
+
+// What only feeds records rather than windows (episodes) or is recomputed
+// afterwards (the motor estimate) is set aside, counters only compared
+// against a threshold are saturated, and everything else has to match to
+// the bit
+static void normalise(Boundary* b) {
+    PipelineState& s = b->state;
+    memset(s.episodes, 0, sizeof(s.episodes));
+    s.episode_sequence = 0;
+    s.still_windows = std::min(s.still_windows, QUALITY_NOISE_MIN_WINDOWS);
+    if (s.saved_ms - s.last_step_time_ms > FOG_MAX_TIME_SINCE_STEP_MS) s.last_step_time_ms = 0;   // as no step
+    memset(&s.motor, 0, sizeof(s.motor));
+    s.night = {};
+    b->history.spectro.revision = 0;
+}
+
+static bool same_state(const Boundary& a, const Boundary& b) {
+    std::unique_ptr<Boundary> x(new Boundary(a)), y(new Boundary(b));
+    normalise(x.get());
+    normalise(y.get());
+    return memcmp(x.get(), y.get(), sizeof(Boundary)) == 0;
+}
+
+// The segment's windows one at a time, keeping what each contributed to
+// the motor estimate. The worker pass keeps a mark every MARK_WINDOWS; a
+// replay (converge = true) compares against them instead and stops at the
+// first it meets, since the worker's windows from there on are exact.
+// Returns the windows fed.
+static size_t feed_windows(const Recording& rec, Segment& seg, bool converge) {
+    std::unique_ptr<Boundary> here;
+    if (converge) here.reset(new Boundary());
+    for (size_t i = 0; i < seg.windows; i++) {
+        const size_t sample = (seg.first_window + i) * WINDOW_SIZE;
+        if (i > 0 && i % MARK_WINDOWS == 0 && !seg.marks.empty()) {
+            Boundary* mark = seg.marks[i / MARK_WINDOWS - 1].get();
+            if (!converge) {
+                capture(rec, sample, mark);
+            } else {
+                capture(rec, sample, here.get());
+                if (same_state(*here, *mark)) return i;
+            }
+        }
+        feed(rec, sample, WINDOW_SIZE, &seg.out[i], 1);
+        seg.motor[i] = motor_last_input;
+    }
+    capture(rec, (seg.first_window + seg.windows) * WINDOW_SIZE, seg.end.get());
+    return seg.windows;
+}
+
+static void run_segment(const Recording& rec, Segment& seg) {
+    const size_t first = seg.first_window * WINDOW_SIZE;
+    const size_t warmup = seg.warmup * WINDOW_SIZE;
+
+    fresh_pipeline_at(rec, first - warmup);
+    feed(rec, first - warmup, warmup, nullptr, 0);
+    if (seg.first_window > 0) capture(rec, first, seg.start.get());
+    feed_windows(rec, seg, false);
+}
+
+// Continue exactly where the previous segment ended, until the worker's
+// state is met; returns the windows replayed
+static size_t replay_segment(const Recording& rec, Segment& seg, const Boundary& from) {
+    fresh_pipeline_at(rec, seg.first_window * WINDOW_SIZE);
+    pipeline_restore(&from.state, RESTORE_FULL, from.state.saved_ms);
+    pipeline_restore_history(&from.history);
+    return feed_windows(rec, seg, true);
+}
+
+size_t detect_run_chunked(const int16_t* const axes[6], size_t stride, size_t n_samples,
+                          uint32_t start_ms, DetectWindow* out, size_t max_out,
+                          const DetectChunking* chunking, DetectChunkStats* stats) {
+    const Recording rec = {axes, stride, start_ms};
+    const size_t total = n_samples / WINDOW_SIZE;
+
+    DetectChunking opt = {};
+    if (chunking != nullptr) opt = *chunking;
+    if (opt.threads == 0) opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (opt.segment_windows == 0) opt.segment_windows = (total + opt.threads - 1) / opt.threads;
+    if (opt.segment_windows == 0) opt.segment_windows = 1;
+    if (opt.warmup_windows == 0) opt.warmup_windows = DETECT_CHUNK_WARMUP_WINDOWS;
+
+    std::vector<Segment> segments((total + opt.segment_windows - 1) / opt.segment_windows);
+    for (size_t k = 0; k < segments.size(); k++) {
+        Segment& seg = segments[k];
+        seg.first_window = k * opt.segment_windows;
+        seg.windows = std::min(opt.segment_windows, total - seg.first_window);
+        seg.warmup = std::min(opt.warmup_windows, seg.first_window);
+        seg.out.resize(seg.windows);
+        seg.motor.resize(seg.windows);
+        seg.start.reset(new Boundary());
+        seg.end.reset(new Boundary());
+        if (k > 0) {
+            seg.marks.resize((seg.windows - 1) / MARK_WINDOWS);
+            for (auto& mark : seg.marks) mark.reset(new Boundary());
+        }
+    }
+
+    // Workers take segments in order, each on its own thread's pipeline
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t k = next++; k < segments.size(); k = next++) run_segment(rec, segments[k]);
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < std::min(opt.threads, segments.size()); t++) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+
+    // Reconcile in order: each boundary against the exact end of the segment before
+    DetectChunkStats s = {segments.size(), 0, 0, 0};
+    for (size_t k = 1; k < segments.size(); k++) {
+        if (same_state(*segments[k].start, *segments[k - 1].end)) {
+            s.reconciled++;
+        } else {
+            s.replayed_windows += replay_segment(rec, segments[k], *segments[k - 1].end);
+            s.replayed++;
+        }
+    }
+    if (stats != nullptr) *stats = s;
+
+    // The motor estimate forgets its start too slowly for any warm-up (see
+    // detect_run_chunked), so it is run over the whole recording here, from
+    // the inputs the segments kept: a few multiply-adds per window
+    init_motor_state();
+    for (Segment& seg : segments) {
+        for (size_t i = 0; i < seg.windows; i++) {
+            motor_state_fold(seg.motor[i]);
+            seg.out[i].motor_state = motor_state.state;
+            seg.out[i].off_score = (uint16_t)(motor_state.off_score * 1000.0f);
+        }
+    }
+
+    // Trailing samples that complete no window change no output
+    size_t copied = 0;
+    for (const Segment& seg : segments) {
+        size_t n = std::min(seg.windows, max_out - copied);
+        if (n > 0) memcpy(out + copied, seg.out.data(), n * sizeof(DetectWindow));
+        copied += n;
+    }
+    return total;
+}
+
+#endif // PD_HOST_BUILD
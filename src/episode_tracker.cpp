@@ -0,0 +1,153 @@
+/**
+ * @file episode_tracker.cpp
+ * @brief Episode segmentation from confirmed-state transitions
+ */
+
+#include "episode_tracker.h"
+#include "fog_detection.h"
+#include "motor_state.h"
+#include <cstring>
+
+PIPELINE_STATE EpisodeRecord episode_ring[EPISODE_RING_SIZE];
+PIPELINE_STATE uint32_t episode_count = 0;
+PIPELINE_STATE uint32_t episode_sequence = 0;
+PIPELINE_STATE EpisodeRecord last_episode_event = {};
+
+static PIPELINE_STATE EpisodeTrack tracks[EPISODE_TYPES];
+static PIPELINE_STATE EpisodeListener listeners[EPISODE_MAX_LISTENERS];
+static PIPELINE_STATE size_t listener_count = 0;
+
+static const char* const EPISODE_NAMES[EPISODE_TYPES] = {"TREMOR", "DYSK", "FOG", "OFF", "DYSK-ON"};
+
+void init_episode_tracker() {
+    memset(episode_ring, 0, sizeof(episode_ring));
+    memset(tracks, 0, sizeof(tracks));
+    episode_count = 0;
+    episode_sequence = 0;
+    last_episode_event = {};
+}
+
+bool episode_subscribe(EpisodeListener listener) {
+    if (listener_count >= EPISODE_MAX_LISTENERS) return false;
+    listeners[listener_count++] = listener;
+    return true;
+}
+
+static void publish(const EpisodeRecord& record) {
+    last_episode_event = record;
+    last_episode_event.sequence = ++episode_sequence;
+    for (size_t i = 0; i < listener_count; i++) {
+        listeners[i](last_episode_event);
+    }
+}
+
+static inline uint32_t samples_to_ms(uint32_t samples) {
+    return (uint32_t)(samples * 1000.0f / TARGET_SAMPLE_RATE_HZ);
+}
+
+static void update_track(EpisodeType type, bool raw_match, bool confirmed,
+                         uint16_t intensity, float freq, const WindowResult& r) {
+    EpisodeTrack& t = tracks[type];
+    const uint32_t win_start = r.start_sample;
+    const uint32_t win_end = win_start + WINDOW_SIZE;
+
+    if (raw_match) {
+        if (!t.in_run && !t.active) {
+            t.run_start_sample = win_start;
+            t.freq_sum = 0.0f;
+            t.freq_count = 0;
+        }
+        t.in_run = true;
+        t.last_match_end = win_end;
+        if (freq > 0.0f) {
+            t.freq_sum += freq;
+            t.freq_count++;
+        }
+    } else {
+        t.in_run = false;
+    }
+
+    if (confirmed) {
+        if (!t.active) {
+            t.active = true;
+            t.intensity_sum = 0;
+            t.confirmed_windows = 0;
+
+            uint32_t start = t.in_run ? t.run_start_sample : win_start;
+            memset(&t.record, 0, sizeof(t.record));
+            t.record.type = type;
+            t.record.start_sample = start;
+            t.record.start_ms = r.timestamp_ms - samples_to_ms(win_end - start);
+            t.record.flags = EPISODE_FLAG_OPEN;
+            publish(t.record);
+        }
+        t.intensity_sum += intensity;
+        t.confirmed_windows++;
+        if (intensity > t.record.peak_intensity) t.record.peak_intensity = intensity;
+        return;
+    }
+
+    if (!t.active) return;
+
+    // Episode closed: end at the last window that still matched
+    t.active = false;
+    EpisodeRecord& rec = t.record;
+    rec.flags = 0;
+    rec.end_sample = ((int32_t)(t.last_match_end - rec.start_sample) > 0) ? t.last_match_end : win_start;
+    rec.duration_ms = samples_to_ms(rec.end_sample - rec.start_sample);
+    rec.mean_intensity = (t.confirmed_windows > 0)
+                       ? (uint16_t)(t.intensity_sum / t.confirmed_windows) : 0;
+    rec.dominant_freq_chz = (t.freq_count > 0)
+                          ? (uint16_t)(t.freq_sum / t.freq_count * 100.0f + 0.5f) : 0;
+
+    publish(rec);
+    rec.sequence = last_episode_event.sequence;
+    episode_ring[episode_count % EPISODE_RING_SIZE] = rec;
+    episode_count++;
+
+    printf(" | 📌 %s episode %.1fs", EPISODE_NAMES[type], rec.duration_ms / 1000.0f);
+}
+
+void episode_tracker_update(const WindowResult& result) {
+    update_track(EPISODE_TREMOR,
+                 result.raw_detection == DETECT_TREMOR,
+                 result.tremor_intensity > 0,
+                 result.tremor_intensity,
+                 (result.raw_detection == DETECT_TREMOR) ? result.tremor_freq : 0.0f,
+                 result);
+
+    update_track(EPISODE_DYSK,
+                 result.raw_detection == DETECT_DYSK,
+                 result.dysk_intensity > 0,
+                 result.dysk_intensity,
+                 (result.raw_detection == DETECT_DYSK) ? result.dysk_freq : 0.0f,
+                 result);
+
+    // FOG run starts when the state machine first suspects a freeze
+    bool fog_candidate = (result.fog_state == FOG_POTENTIAL_FREEZE ||
+                          result.fog_state == FOG_FREEZE_CONFIRMED);
+    update_track(EPISODE_FOG, fog_candidate, result.fog_status != 0, 0, 0.0f, result);
+
+    // Motor fluctuation periods: the run starts when the slow levels first point there
+    update_track(EPISODE_OFF,
+                 result.motor_candidate == MOTOR_OFF,
+                 result.motor_state == MOTOR_OFF,
+                 result.off_score, 0.0f, result);
+    update_track(EPISODE_DYSK_ON,
+                 result.motor_candidate == MOTOR_DYSK_ON,
+                 result.motor_state == MOTOR_DYSK_ON,
+                 result.dysk_level, 0.0f, result);
+}
+
+void episode_tracker_save(EpisodeTrack tracks_out[EPISODE_TYPES]) {
+    memcpy(tracks_out, tracks, sizeof(tracks));
+}
+
+void episode_tracker_restore(const EpisodeTrack tracks_in[EPISODE_TYPES]) {
+    memcpy(tracks, tracks_in, sizeof(tracks));
+}
+
+const EpisodeRecord* episode_get(size_t n) {
+    if (n >= episode_count || n >= EPISODE_RING_SIZE) return nullptr;
+    return &episode_ring[(episode_count - 1 - n) % EPISODE_RING_SIZE];
+}
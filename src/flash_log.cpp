@@ -0,0 +1,530 @@
+/**
+ * @file flash_log.cpp
+ * @brief Log-structured session recorder on the on-board QSPI NOR flash
+ */
+
+#include "flash_log.h"
+#include "QSPIFBlockDevice.h"
+#include "record_format.h"
+#include "episode_tracker.h"
+#include "blackbox.h"
+#include "sensor.h"
+#include <cstring>
+
+// Hardware (pins from the target's QSPI_FLASH1 configuration)
+QSPIFBlockDevice qspi_flash;
+
+FlashLogStats flash_log_stats = {};
+bool flash_log_ready = false;
+
+// Block device and writer thread
+static BlockDevice *flash_bd = nullptr;
+static Mutex flash_mutex;
+static EventFlags writer_flags;
+static Thread *writer_thread = nullptr;       // a terminated Thread cannot be restarted
+static const uint32_t WRITER_FLAG_DATA = 0x1;
+static const uint32_t WRITER_FLAG_STOP = 0x2;
+
+// Segment table (sequence 0 = free / erased)
+struct SegmentInfo {
+    uint32_t sequence;
+    uint32_t erase_count;
+};
+
+static SegmentInfo segments[FLASH_LOG_MAX_SEGMENTS];
+static uint16_t segment_count = 0;
+static int active_segment = -1;
+static int pre_erased_segment = -1;
+static uint32_t write_offset = 0;
+static uint32_t last_sequence = 0;
+
+// Staging ring: complete records (header + padded payload), producers -> writer
+static uint8_t staging[FLASH_LOG_STAGING_SIZE];
+static size_t staging_head = 0;
+static size_t staging_tail = 0;
+static size_t staging_used = 0;
+static Mutex staging_mutex;
+
+// Recorder state (main thread)
+static uint8_t encode_buffer[imu_block_max_size(WINDOW_SIZE)];
+static BlackboxCapture *capture_draining = nullptr;
+static bool capture_info_logged = false;
+static size_t capture_pos = 0;
+
+static MbedCRC<POLY_32BIT_ANSI, 32> crc32;
+
+static inline size_t align4(size_t n) {
+    return (n + 3) & ~(size_t)3;
+}
+
+static inline bd_addr_t segment_addr(int seg) {
+    return (bd_addr_t)seg * FLASH_LOG_SEGMENT_SIZE;
+}
+
+static void update_wear_stats() {
+    uint32_t lo = 0xFFFFFFFF, hi = 0;
+    for (uint16_t s = 0; s < segment_count; s++) {
+        if (segments[s].erase_count < lo) lo = segments[s].erase_count;
+        if (segments[s].erase_count > hi) hi = segments[s].erase_count;
+    }
+    flash_log_stats.min_erase_count = lo;
+    flash_log_stats.max_erase_count = hi;
+}
+
+static bool erase_segment(int seg) {
+    Timer t;
+    t.start();
+    flash_mutex.lock();
+    int err = flash_bd->erase(segment_addr(seg), FLASH_LOG_SEGMENT_SIZE);
+    segments[seg].sequence = 0;
+    segments[seg].erase_count++;
+    flash_mutex.unlock();
+    t.stop();
+
+    flash_log_stats.erases++;
+    flash_log_stats.erase_us += (uint32_t)t.elapsed_time().count();
+    return err == 0;
+}
+
+// Oldest segment first (free segments count as oldest), lowest erase count on ties
+static int pick_next_segment() {
+    if (pre_erased_segment >= 0) return pre_erased_segment;
+
+    int best = -1;
+    for (int s = 0; s < segment_count; s++) {
+        if (s == active_segment) continue;
+        if (best < 0 ||
+            segments[s].sequence < segments[best].sequence ||
+            (segments[s].sequence == segments[best].sequence &&
+             segments[s].erase_count < segments[best].erase_count)) {
+            best = s;
+        }
+    }
+    return best;
+}
+
+static bool open_next_segment() {
+    int next = pick_next_segment();
+    if (next < 0) return false;
+
+    if (next != pre_erased_segment && !erase_segment(next)) return false;
+    pre_erased_segment = -1;
+
+    FlashSegmentHeader hdr;
+    hdr.magic = FLASH_SEGMENT_MAGIC;
+    hdr.sequence = ++last_sequence;
+    hdr.erase_count = segments[next].erase_count;
+    hdr.check = hdr.magic ^ hdr.sequence ^ hdr.erase_count;
+
+    flash_mutex.lock();
+    int err = flash_bd->program(&hdr, segment_addr(next), sizeof(hdr));
+    if (err == 0) {
+        segments[next].sequence = hdr.sequence;
+        active_segment = next;
+        write_offset = sizeof(hdr);
+    }
+    flash_mutex.unlock();
+
+    flash_log_stats.active_segment = (uint16_t)next;
+    update_wear_stats();
+    return err == 0;
+}
+
+static bool program_record(const uint8_t* data, size_t total) {
+    if (active_segment < 0 || write_offset + total > FLASH_LOG_SEGMENT_SIZE) {
+        if (!open_next_segment()) return false;
+    }
+
+    Timer t;
+    t.start();
+    flash_mutex.lock();
+    int err = flash_bd->program(data, segment_addr(active_segment) + write_offset, total);
+    // Skip the space even on error so a partial record is never overwritten
+    write_offset += total;
+    flash_mutex.unlock();
+    t.stop();
+
+    flash_log_stats.program_us += (uint32_t)t.elapsed_time().count();
+    if (err != 0) return false;
+
+    flash_log_stats.records_written++;
+    flash_log_stats.bytes_written += total;
+    return true;
+}
+
+static void drain_staging() {
+    while (true) {
+        staging_mutex.lock();
+        if (staging_used == 0) {
+            staging_mutex.unlock();
+            return;
+        }
+
+        size_t tail = staging_tail;
+        uint16_t magic;
+        memcpy(&magic, &staging[tail], sizeof(magic));
+        if (magic != FLASH_RECORD_MAGIC) {
+            // Wrap marker: rest of the buffer is unused
+            staging_used -= FLASH_LOG_STAGING_SIZE - tail;
+            staging_tail = 0;
+            staging_mutex.unlock();
+            continue;
+        }
+
+        FlashRecordHeader hdr;
+        memcpy(&hdr, &staging[tail], sizeof(hdr));
+        staging_mutex.unlock();
+
+        // The record stays owned by the ring until the tail moves past it
+        size_t total = sizeof(hdr) + align4(hdr.length);
+        if (!program_record(&staging[tail], total)) {
+            flash_log_stats.records_dropped++;
+        }
+
+        staging_mutex.lock();
+        staging_tail = tail + total;
+        if (staging_tail >= FLASH_LOG_STAGING_SIZE) staging_tail = 0;
+        staging_used -= total;
+        staging_mutex.unlock();
+    }
+}
+
+// Erase ahead while there is slack, so switching segments doesn't wait on an erase
+static void maybe_pre_erase() {
+    if (pre_erased_segment >= 0 || active_segment < 0) return;
+    if (write_offset < (FLASH_LOG_SEGMENT_SIZE / 4) * 3) return;
+
+    int next = pick_next_segment();
+    if (next >= 0 && erase_segment(next)) {
+        pre_erased_segment = next;
+    }
+}
+
+static void writer_main() {
+    while (true) {
+        uint32_t flags = writer_flags.wait_any(WRITER_FLAG_DATA | WRITER_FLAG_STOP);
+        drain_staging();
+        if (flags & WRITER_FLAG_STOP) return;
+        maybe_pre_erase();
+    }
+}
+
+static void recovery_scan() {
+    Timer t;
+    t.start();
+
+    int erase_value = flash_bd->get_erase_value();
+    uint8_t ev = (erase_value < 0) ? 0xFF : (uint8_t)erase_value;
+    const uint16_t erased_magic = (uint16_t)((ev << 8) | ev);
+
+    int newest = -1;
+    for (uint16_t s = 0; s < segment_count; s++) {
+        FlashSegmentHeader hdr;
+        segments[s].sequence = 0;
+        segments[s].erase_count = 0;
+
+        if (flash_bd->read(&hdr, segment_addr(s), sizeof(hdr)) != 0) continue;
+        if (hdr.magic != FLASH_SEGMENT_MAGIC) continue;
+        if (hdr.check != (hdr.magic ^ hdr.sequence ^ hdr.erase_count)) continue;
+
+        segments[s].sequence = hdr.sequence;
+        segments[s].erase_count = hdr.erase_count;
+        if (hdr.sequence > last_sequence) {
+            last_sequence = hdr.sequence;
+            newest = s;
+        }
+    }
+
+    // Only the newest segment can be partially written
+    if (newest >= 0) {
+        uint32_t offset = sizeof(FlashSegmentHeader);
+        while (offset + sizeof(FlashRecordHeader) <= FLASH_LOG_SEGMENT_SIZE) {
+            FlashRecordHeader hdr;
+            if (flash_bd->read(&hdr, segment_addr(newest) + offset, sizeof(hdr)) != 0) {
+                offset = FLASH_LOG_SEGMENT_SIZE;
+                break;
+            }
+            if (hdr.magic == erased_magic) break;
+            if (hdr.magic != FLASH_RECORD_MAGIC || hdr.length > FLASH_LOG_MAX_PAYLOAD) {
+                offset = FLASH_LOG_SEGMENT_SIZE;  // corrupt tail: seal the segment
+                break;
+            }
+            offset += sizeof(hdr) + align4(hdr.length);
+            flash_log_stats.scan_records++;
+        }
+
+        active_segment = newest;
+        write_offset = (offset < FLASH_LOG_SEGMENT_SIZE) ? offset : FLASH_LOG_SEGMENT_SIZE;
+        flash_log_stats.active_segment = (uint16_t)newest;
+    }
+
+    update_wear_stats();
+    t.stop();
+    flash_log_stats.scan_ms = (uint32_t)(t.elapsed_time().count() / 1000);
+}
+
+static void on_episode(const EpisodeRecord& record) {
+    flash_log_append(FLASH_REC_EPISODE, 0, &record, sizeof(record));
+}
+
+bool init_flash_log(BlockDevice* bd) {
+    printf("\n=== Initializing QSPI Flash Log ===\n");
+
+    flash_log_stats = {};
+    flash_bd = (bd != nullptr) ? bd : &qspi_flash;
+    if (flash_bd->init() != 0) {
+        printf("   ❌ ERROR: Flash init failed\n");
+        return false;
+    }
+
+    if ((FLASH_LOG_SEGMENT_SIZE % flash_bd->get_erase_size()) != 0 ||
+        (sizeof(uint32_t) % flash_bd->get_program_size()) != 0) {
+        printf("   ❌ ERROR: Unsupported flash geometry\n");
+        return false;
+    }
+
+    uint64_t count = flash_bd->size() / FLASH_LOG_SEGMENT_SIZE;
+    segment_count = (uint16_t)((count < FLASH_LOG_MAX_SEGMENTS) ? count : FLASH_LOG_MAX_SEGMENTS);
+    if (segment_count < 2) {
+        printf("   ❌ ERROR: Flash too small\n");
+        return false;
+    }
+    flash_log_stats.segments = segment_count;
+
+    recovery_scan();
+    if (active_segment < 0 && !open_next_segment()) {
+        printf("   ❌ ERROR: Cannot open log segment\n");
+        return false;
+    }
+
+    printf("   ✓ %u segments x %lu KB, active #%u (seq %lu)\n",
+           segment_count, (unsigned long)(FLASH_LOG_SEGMENT_SIZE / 1024),
+           (unsigned)active_segment, (unsigned long)last_sequence);
+    printf("   ✓ Recovery scan: %lu records in %lu ms\n",
+           (unsigned long)flash_log_stats.scan_records, (unsigned long)flash_log_stats.scan_ms);
+
+    static bool subscribed = false;
+    if (!subscribed) subscribed = episode_subscribe(on_episode);
+
+    writer_flags.clear(WRITER_FLAG_DATA | WRITER_FLAG_STOP);
+    writer_thread = new Thread(osPriorityBelowNormal, 2048, nullptr, "flash_log");
+    writer_thread->start(writer_main);
+    flash_log_ready = true;
+
+    printf("=== Flash Log Ready ===\n\n");
+    return true;
+}
+
+void deinit_flash_log() {
+    if (!flash_log_ready) return;
+
+    // Appends are refused from here on; the writer drains what is staged
+    flash_log_ready = false;
+    writer_flags.set(WRITER_FLAG_STOP);
+    writer_thread->join();
+    delete writer_thread;
+    writer_thread = nullptr;
+    flash_bd->deinit();
+
+    if (capture_draining != nullptr) {
+        blackbox_release(capture_draining);
+        capture_draining = nullptr;
+    }
+    segment_count = 0;
+    active_segment = -1;
+    pre_erased_segment = -1;
+    write_offset = 0;
+    last_sequence = 0;
+    staging_head = staging_tail = staging_used = 0;
+}
+
+bool flash_log_append(FlashRecordType type, uint8_t flags, const void* payload, size_t length) {
+    if (!flash_log_ready || length == 0 || length > FLASH_LOG_MAX_PAYLOAD) {
+        flash_log_stats.records_dropped++;
+        return false;
+    }
+
+    FlashRecordHeader hdr;
+    hdr.magic = FLASH_RECORD_MAGIC;
+    hdr.type = type;
+    hdr.flags = flags;
+    hdr.length = (uint16_t)length;
+    hdr.reserved = 0;
+    crc32.compute(payload, length, &hdr.crc);
+
+    const size_t total = sizeof(hdr) + align4(length);
+
+    staging_mutex.lock();
+    size_t end_room = FLASH_LOG_STAGING_SIZE - staging_head;
+    size_t need = total + ((end_room < total) ? end_room : 0);
+    if (staging_used + need > FLASH_LOG_STAGING_SIZE) {
+        staging_mutex.unlock();
+        flash_log_stats.records_dropped++;
+        return false;
+    }
+
+    if (end_room < total) {
+        const uint16_t wrap = 0;
+        memcpy(&staging[staging_head], &wrap, sizeof(wrap));
+        staging_used += end_room;
+        staging_head = 0;
+    }
+
+    uint8_t* dst = &staging[staging_head];
+    memcpy(dst, &hdr, sizeof(hdr));
+    memcpy(dst + sizeof(hdr), payload, length);
+    memset(dst + sizeof(hdr) + length, 0, align4(length) - length);
+
+    staging_head += total;
+    if (staging_head >= FLASH_LOG_STAGING_SIZE) staging_head = 0;
+    staging_used += total;
+    staging_mutex.unlock();
+
+    writer_flags.set(WRITER_FLAG_DATA);
+    return true;
+}
+
+size_t flash_log_staging_free() {
+    staging_mutex.lock();
+    size_t free_bytes = FLASH_LOG_STAGING_SIZE - staging_used;
+    staging_mutex.unlock();
+    return free_bytes;
+}
+
+void flash_log_record_window(const WindowResult& result) {
+    if (!flash_log_ready || replay_mode) return;
+
+    const int16_t* columns[IMU_AXES];
+    for (int axis = 0; axis < IMU_AXES; axis++) columns[axis] = raw_imu_buffer[axis];
+
+    size_t len = imu_block_encode(columns, WINDOW_SIZE, result.start_sample, result.timestamp_ms,
+                                  true, encode_buffer, sizeof(encode_buffer));
+    if (len > 0) {
+        flash_log_append(FLASH_REC_IMU_BLOCK, 0, encode_buffer, len);
+    }
+
+    WindowRecord record;
+    window_record_from_result(result, &record);
+    flash_log_append(FLASH_REC_WINDOW, 0, &record, sizeof(record));
+}
+
+void flash_log_service() {
+    if (!flash_log_ready) return;
+
+    if (capture_draining == nullptr) {
+        capture_draining = blackbox_acquire_frozen();
+        if (capture_draining == nullptr) return;
+        capture_info_logged = false;
+        capture_pos = 0;
+    }
+    BlackboxCapture* capture = capture_draining;
+
+    // Worst case a record also wastes the end of the ring when wrapping
+    const size_t worst = 2 * (sizeof(FlashRecordHeader) + sizeof(encode_buffer));
+    if (flash_log_staging_free() < worst) return;
+
+    if (!capture_info_logged) {
+        FlashCaptureInfo info = {};
+        info.first_sample = capture->first_sample;
+        info.trigger_sample = capture->trigger_sample;
+        info.trigger_ms = capture->trigger_ms;
+        info.samples = capture->filled;
+        info.trigger_type = capture->trigger_type;
+        if (!flash_log_append(FLASH_REC_CAPTURE, 0, &info, sizeof(info))) return;
+        capture_info_logged = true;
+        return;
+    }
+
+    // One block per call, never crossing the ring wrap of the capture
+    const int16_t* columns[IMU_AXES];
+    size_t n = 0;
+    for (int axis = 0; axis < IMU_AXES; axis++) {
+        const int16_t *first, *second;
+        size_t first_len, second_len;
+        blackbox_column_spans(capture, (ImuAxis)axis, &first, &first_len, &second, &second_len);
+
+        if (capture_pos < first_len) {
+            columns[axis] = first + capture_pos;
+            n = first_len - capture_pos;
+        } else {
+            columns[axis] = second + (capture_pos - first_len);
+            n = first_len + second_len - capture_pos;
+        }
+    }
+    if (n > WINDOW_SIZE) n = WINDOW_SIZE;
+
+    if (n > 0) {
+        size_t len = imu_block_encode(columns, (uint16_t)n, capture->first_sample + capture_pos,
+                                      capture->trigger_ms, true, encode_buffer, sizeof(encode_buffer));
+        if (len == 0 || !flash_log_append(FLASH_REC_IMU_BLOCK, FLASH_FLAG_CAPTURE, encode_buffer, len)) {
+            return;
+        }
+        capture_pos += n;
+    }
+
+    if (capture_pos >= capture->filled) {
+        blackbox_release(capture);
+        capture_draining = nullptr;
+    }
+}
+
+static void advance_segment(FlashLogCursor* cursor) {
+    int next = -1;
+    for (int s = 0; s < segment_count; s++) {
+        if (segments[s].sequence > cursor->sequence &&
+            (next < 0 || segments[s].sequence < segments[next].sequence)) {
+            next = s;
+        }
+    }
+
+    if (next < 0) {
+        cursor->sequence = 0;
+        return;
+    }
+    cursor->segment = (uint16_t)next;
+    cursor->sequence = segments[next].sequence;
+    cursor->offset = sizeof(FlashSegmentHeader);
+}
+
+void flash_log_rewind(FlashLogCursor* cursor) {
+    cursor->sequence = 0;
+    advance_segment(cursor);
+}
+
+int flash_log_next(FlashLogCursor* cursor, FlashRecordHeader* hdr, void* payload, size_t payload_size) {
+    if (!flash_log_ready) return -1;
+
+    while (cursor->sequence != 0) {
+        flash_mutex.lock();
+        bool reused = (segments[cursor->segment].sequence != cursor->sequence);
+        uint32_t limit = (cursor->segment == active_segment) ? write_offset : FLASH_LOG_SEGMENT_SIZE;
+        bool have_header = false;
+        if (!reused && cursor->offset + sizeof(FlashRecordHeader) <= limit) {
+            have_header = (flash_bd->read(hdr, segment_addr(cursor->segment) + cursor->offset,
+                                          sizeof(*hdr)) == 0);
+        }
+        flash_mutex.unlock();
+
+        if (!have_header || hdr->magic != FLASH_RECORD_MAGIC || hdr->length > FLASH_LOG_MAX_PAYLOAD) {
+            advance_segment(cursor);
+            continue;
+        }
+
+        size_t total = sizeof(*hdr) + align4(hdr->length);
+        bd_addr_t addr = segment_addr(cursor->segment) + cursor->offset + sizeof(*hdr);
+        cursor->offset += total;
+        if (hdr->length > payload_size) return -1;
+
+        flash_mutex.lock();
+        int err = flash_bd->read(payload, addr, hdr->length);
+        flash_mutex.unlock();
+        if (err != 0) return -1;
+
+        uint32_t crc;
+        crc32.compute(payload, hdr->length, &crc);
+        if (crc != hdr->crc) continue;  // torn write, skip
+
+        return hdr->length;
+    }
+    return 0;
+}
@@ -6,23 +6,21 @@
 #include "fog_detection.h"
 #include "signal_processing.h"  // For tremor_intensity and dysk_intensity
 #include "config.h"
+#include "baseline.h"
+#include "wavelet.h"
 #include <cstdio>   // Required for printf
 #include <cstdint>  // Required for uint32_t, uint16_t
 #include <cstdbool> // Good practice for boolean types (or just built-in for C++)
 
-// External variables from signal_processing.cpp
-extern uint16_t tremor_intensity;
-extern uint16_t dysk_intensity;
-
 // FOG state machine
-FOGDetector fog_detector = {FOG_NOT_WALKING, 0, 0, 0, 0.0f, 0, 0};
+PIPELINE_STATE FOGDetector fog_detector = {FOG_NOT_WALKING, 0, 0, 0, 0.0f, 0, 0};
 
 // Step detection variables
-uint16_t steps_in_window = 0;
-bool above_step_threshold = false;
-uint32_t last_step_time_ms = 0;
-float accel_baseline_ema = 1.0f;
-uint8_t fog_status = 0;
+PIPELINE_STATE uint16_t steps_in_window = 0;
+PIPELINE_STATE bool above_step_threshold = false;
+PIPELINE_STATE uint32_t last_step_time_ms = 0;
+PIPELINE_STATE float accel_baseline_ema = 1.0f;
+PIPELINE_STATE uint8_t fog_status = 0;
 
 void init_fog_detection()
 {
@@ -57,11 +55,14 @@ void process_fog_detection(float variance, uint32_t current_time)
     const uint32_t MIN_STEPS_FOR_WALKING = 2;
     
     const float FREEZE_CADENCE_MAX = 12.0f;
-    const float FREEZE_VARIANCE_MAX = 0.020f;
+    const float FREEZE_VARIANCE_MAX = personal_thresholds.freeze_variance_max;
     
     const uint32_t MIN_WALKING_DURATION_MS = 1000;
     const uint32_t FREEZE_CONFIRMATION_MS = 1250;
 
+    const uint32_t TREMBLING_AFTER_STRIKE_MS = 4000;
+    const uint32_t TREMBLING_MAX_FREEZE_MS = 20000;
+
     // Walking detection
     bool currently_walking = (steps_in_window >= MIN_STEPS_FOR_WALKING &&
                               cadence >= WALKING_CADENCE_MIN &&
@@ -69,9 +70,22 @@ void process_fog_detection(float variance, uint32_t current_time)
                               variance >= WALKING_VARIANCE_MIN &&
                               variance <= WALKING_VARIANCE_MAX);
 
-    // Freeze detection
+    // Trembling in place (wavelet freeze band) is a freeze only right after
+    // gait: a heel strike shortly before the onset, and for a bounded time
+    // after it. Windows the tremor detector claims are rest tremor, which
+    // would otherwise start a freeze and then block the recovery below.
+    bool tremor_window = (window_result.raw_detection == DETECT_TREMOR || tremor_intensity > 0);
+    bool trembling = wavelet_result.trembling && !tremor_window;
+    if (fog_detector.state == FOG_POTENTIAL_FREEZE || fog_detector.state == FOG_FREEZE_CONFIRMED) {
+        trembling = trembling && current_time - fog_detector.freeze_start_time <= TREMBLING_MAX_FREEZE_MS;
+    } else {
+        uint32_t last_strike = wavelet_result.last_strike_ms;
+        trembling = trembling && last_strike > 0 && current_time - last_strike <= TREMBLING_AFTER_STRIKE_MS;
+    }
+
+    // Freeze detection: akinetic (quiet) or trembling in place
     bool freeze_indicators = (cadence < FREEZE_CADENCE_MAX &&
-                              variance < FREEZE_VARIANCE_MAX &&
+                              (variance < FREEZE_VARIANCE_MAX || trembling) &&
                               fog_detector.walking_start_time > 0);
     
     // Time gating
@@ -79,16 +93,14 @@ void process_fog_detection(float variance, uint32_t current_time)
                                     ? (current_time - last_step_time_ms) 
                                     : 9999999;
     
-    const uint32_t MAX_TIME_SINCE_STEP_MS = 15000;
-    
-    if (time_since_last_step > MAX_TIME_SINCE_STEP_MS) {
+    if (time_since_last_step > FOG_MAX_TIME_SINCE_STEP_MS) {
         freeze_indicators = false;
     }
 
-    printf(" [S:%d C:%.0f V:%.3f T:%.1fs FI:%d CW:%d]", 
-           steps_in_window, cadence, variance, 
-           time_since_last_step/1000.0f, freeze_indicators, 
-           currently_walking);
+    printf(" [S:%d HS:%u C:%.0f V:%.3f WF:%.1f T:%.1fs FI:%d CW:%d]", 
+           steps_in_window, wavelet_result.strikes, cadence, variance, 
+           wavelet_result.freeze_index, time_since_last_step/1000.0f, 
+           freeze_indicators, currently_walking);
 
     // Safety check
     if ((fog_detector.state == FOG_POTENTIAL_FREEZE || fog_detector.state == FOG_FREEZE_CONFIRMED) &&
@@ -140,7 +152,11 @@ void process_fog_detection(float variance, uint32_t current_time)
                 walking_duration >= MIN_WALKING_DURATION_MS)
             {
                 fog_detector.state = FOG_POTENTIAL_FREEZE;
-                fog_detector.freeze_start_time = current_time;
+                // Date the onset to the last heel strike when it falls inside the walk
+                uint32_t last_strike = wavelet_result.last_strike_ms;
+                fog_detector.freeze_start_time =
+                    (last_strike > fog_detector.walking_start_time && last_strike < current_time)
+                        ? last_strike : current_time;
                 fog_detector.consecutive_freeze_windows = 1;
             }
             else if (walking_duration < MIN_WALKING_DURATION_MS)
@@ -200,7 +216,7 @@ void process_fog_detection(float variance, uint32_t current_time)
             fog_detector.freeze_confirmed_start = current_time;
         }
 
-        bool recovery_movement = (steps_in_window > 0 || variance > FREEZE_VARIANCE_MAX);
+        bool recovery_movement = (steps_in_window > 0 || (variance > FREEZE_VARIANCE_MAX && !trembling));
         
         if (recovery_movement)
         {
@@ -0,0 +1,85 @@
+/**
+ * @file kv_writer.cpp
+ * @brief Deferred KVStore writes on a low-priority thread
+ */
+
+#include "kv_writer.h"
+#include "kvstore_global_api.h"
+#include <cstring>
+
+KvSlotStats kv_writer_stats[KV_SLOTS] = {};
+
+struct KvSlotRecord {
+    const char* key;
+    size_t size;
+    bool pending;
+    uint8_t data[KV_WRITER_MAX_RECORD];
+};
+
+static KvSlotRecord slots[KV_SLOTS];
+static Mutex slot_mutex;
+static EventFlags writer_flags;
+static Thread writer_thread(osPriorityBelowNormal, 1536, nullptr, "kv_writer");
+static const uint32_t WRITER_FLAG_DATA = 0x1;
+
+// Writer-side copy, so kv_set runs without holding the slot mutex
+static uint8_t write_buffer[KV_WRITER_MAX_RECORD];
+
+static void write_pending() {
+    for (int s = 0; s < KV_SLOTS; s++) {
+        slot_mutex.lock();
+        if (!slots[s].pending) {
+            slot_mutex.unlock();
+            continue;
+        }
+        const char* key = slots[s].key;
+        size_t size = slots[s].size;
+        memcpy(write_buffer, slots[s].data, size);
+        slots[s].pending = false;
+        slot_mutex.unlock();
+
+        Timer t;
+        t.start();
+        int err = kv_set(key, write_buffer, size, 0);
+        t.stop();
+
+        KvSlotStats& st = kv_writer_stats[s];
+        uint32_t ms = (uint32_t)(t.elapsed_time().count() / 1000);
+        if (ms > st.max_write_ms) st.max_write_ms = ms;
+        if (err == MBED_SUCCESS) {
+            st.written++;
+        } else {
+            st.failed++;
+        }
+    }
+}
+
+static void writer_main() {
+    while (true) {
+        writer_flags.wait_any(WRITER_FLAG_DATA);
+        write_pending();
+    }
+}
+
+void init_kv_writer() {
+    writer_thread.start(writer_main);
+    writer_flags.set(WRITER_FLAG_DATA);
+}
+
+bool kv_writer_post(KvSlot slot, const char* key, const void* data, size_t size) {
+    if (slot >= KV_SLOTS || size > KV_WRITER_MAX_RECORD) return false;
+    if (replay_mode) return false;   // a replay never touches the patient's stored state
+
+    slot_mutex.lock();
+    KvSlotRecord& r = slots[slot];
+    if (r.pending) kv_writer_stats[slot].superseded++;
+    r.key = key;
+    r.size = size;
+    memcpy(r.data, data, size);
+    r.pending = true;
+    kv_writer_stats[slot].posted++;
+    slot_mutex.unlock();
+
+    writer_flags.set(WRITER_FLAG_DATA);
+    return true;
+}
@@ -4,17 +4,21 @@
  */
 
 #include "led_control.h"
+#include "signal_processing.h"
+#include "fog_detection.h"
+#include "night_mode.h"
 
 // Hardware
 DigitalOut led(LED1);
 
 void update_led_indication() {
-    extern uint16_t tremor_intensity;
-    extern uint16_t dysk_intensity;
-    extern uint16_t fog_status;
-    
     uint32_t now = Kernel::get_ms_count();
     
+    if (night_mode_active) {
+        led = 0;  // dark at night
+        return;
+    }
+
     if (fog_status == 1) {
         uint32_t phase = now % FOG_CYCLE_PERIOD_MS;
         bool blink_on = ((phase < 100) || (phase >= 200 && phase < 300) || (phase >= 400 && phase < 500));
@@ -8,6 +8,23 @@
 #include "sensor.h"
 #include "signal_processing.h"
 #include "fog_detection.h"
+#include "symptom_summary.h"
+#include "episode_tracker.h"
+#include "blackbox.h"
+#include "flash_log.h"
+#include "calibration.h"
+#include "multires.h"
+#include "zoom_fft.h"
+#include "bradykinesia.h"
+#include "night_mode.h"
+#include "data_quality.h"
+#include "spectrogram.h"
+#include "baseline.h"
+#include "motor_state.h"
+#include "wavelet.h"
+#include "checkpoint.h"
+#include "kv_writer.h"
+#include "telemetry.h"
 #include "ble_comm.h"
 #include "led_control.h"
 
@@ -15,7 +32,7 @@
 
 BufferedSerial serial_port(USBTX, USBRX, 115200);
 FileHandle *mbed::mbed_override_console(int) {
-    return &serial_port;
+    return telemetry_console(&serial_port);   // text is muted while binary telemetry runs
 }
 
 int main() {
@@ -69,7 +86,29 @@ int main() {
     }
 
     // Initialize subsystems
+    init_calibration();
+    init_baseline();
     init_fog_detection();
+    init_symptom_summary();
+    init_episode_tracker();
+    init_bradykinesia();
+    init_wavelet();
+    init_motor_state();
+    init_blackbox();
+    init_multires();
+    init_night_mode();
+    init_data_quality();
+    init_spectrogram();
+    init_checkpoint();           // after the modules it restores into
+    init_kv_writer();            // flash writes from the pipeline go through its thread
+#ifdef ZOOM_FFT_BENCHMARK
+    zoom_fft_benchmark();
+#endif
+
+    // Session recorder on QSPI flash (detection keeps running without it)
+    if (!init_flash_log()) {
+        printf("⚠️  Flash log unavailable, recording disabled\n\n");
+    }
     
     // Attach interrupt handler
     data_ready_pin.rise(&data_ready_isr);
@@ -130,10 +169,16 @@ int main() {
     printf("║                                                               ║\n");
     ThisThread::sleep_for(100ms);
     
-    printf("║  BLE DATA FORMAT (3 characteristics):                         ║\n");
+    printf("║  BLE DATA FORMAT (9 characteristics):                         ║\n");
     printf("║  📊 Tremor Intensity: 0-1000 scale                            ║\n");
     printf("║  📊 Dyskinesia Intensity: 0-1000 scale                        ║\n");
     printf("║  📊 FOG Status: 0=NO_FOG, 1=FOG_DETECTED                      ║\n");
+    printf("║  📊 Hourly Summary: last 24h, 20 bytes/hour (read)            ║\n");
+    printf("║  📊 Summary Revision: notified when the summary changes       ║\n");
+    printf("║  📊 Episode Events: start/end records, 28 bytes               ║\n");
+    printf("║  📊 Bradykinesia: score, speed, decrement, 16 bytes           ║\n");
+    printf("║  📊 Spectrogram: newest 0.4-13 Hz row, 68 bytes               ║\n");
+    printf("║  🕒 Clock: write uint32 Unix time (enables night mode)        ║\n");
     printf("║                                                               ║\n");
     ThisThread::sleep_for(100ms);
     
@@ -166,6 +211,110 @@ int main() {
             printf("\n[Health] %lu samples, %lu windows, %.1fs/window\n\n", 
                 sample_count, (unsigned long)window_count, 
                 (window_count > 0) ? (now / 1000.0f) / window_count : 0.0f);
+            uint32_t cal_age = calibration_age_s(now);
+            if (calibration.gyro_valid && cal_age != UINT32_MAX) {
+                printf("[Cal] gyro bias %.2f/%.2f/%.2f dps, accel %s (%u dirs, %.1f mg residual), updated %lus ago\n",
+                    calibration.gyro_bias[0], calibration.gyro_bias[1], calibration.gyro_bias[2],
+                    calibration.accel_valid ? "fitted" : "default",
+                    calibration.orientations, calibration.accel_residual_g * 1000.0f,
+                    (unsigned long)cal_age);
+                printf("[Cal] %.1f °C, temp model %s (spread %.1f °C, gyro %.3f/%.3f/%.3f dps/°C)\n\n",
+                    calibration.temperature_c, calibration.temp_valid ? "active" : "learning",
+                    calibration.temp_spread_c, calibration.gyro_temp_coeff[0],
+                    calibration.gyro_temp_coeff[1], calibration.gyro_temp_coeff[2]);
+            } else {
+                printf("[Cal] %s, waiting for a still window\n\n",
+                    calibration.restored ? "restored from flash" : "uncalibrated");
+            }
+            uint32_t mr_deferred = 0, mr_skipped = 0;
+            for (int id = 0; id < MULTIRES_JOBS; id++) {
+                mr_deferred += multires_jobs[id].deferred;
+                mr_skipped += multires_jobs[id].skipped;
+            }
+            printf("[MultiRes] short %lu runs (%lu us), long %lu runs (%lu us), zoom %lu runs (%lu us), %lu deferred, %lu skipped, %.1f%% CPU\n\n",
+                (unsigned long)multires_jobs[MULTIRES_SHORT].runs, (unsigned long)multires_jobs[MULTIRES_SHORT].cost_us,
+                (unsigned long)multires_jobs[MULTIRES_LONG].runs, (unsigned long)multires_jobs[MULTIRES_LONG].cost_us,
+                (unsigned long)multires_jobs[MULTIRES_ZOOM].runs, (unsigned long)multires_jobs[MULTIRES_ZOOM].cost_us,
+                (unsigned long)mr_deferred, (unsigned long)mr_skipped,
+                (now > 0) ? multires_busy_us / 10.0f / now : 0.0f);
+            if (zoom_result.end_sample > 0) {
+                printf("[Zoom] tremor %.2f Hz (%.3f), dysk %.2f Hz (%.3f), %.3f Hz bins\n\n",
+                    zoom_result.tremor_freq, zoom_result.tremor_amp,
+                    zoom_result.dysk_freq, zoom_result.dysk_amp, zoom_result.freq_res);
+            }
+            const WaveletResult& wr = wavelet_result;
+            printf("[Wavelet] RMS d1-d5 %.0f/%.0f/%.0f/%.0f/%.0f mg, %u strikes, freeze index %.2f%s\n\n",
+                sqrtf((float)wr.energy[0]) * ACCEL_SCALE * 1000.0f, sqrtf((float)wr.energy[1]) * ACCEL_SCALE * 1000.0f,
+                sqrtf((float)wr.energy[2]) * ACCEL_SCALE * 1000.0f, sqrtf((float)wr.energy[3]) * ACCEL_SCALE * 1000.0f,
+                sqrtf((float)wr.energy[4]) * ACCEL_SCALE * 1000.0f, wr.strikes, wr.freeze_index,
+                wr.trembling ? " (trembling)" : "");
+            printf("[Motor] %s for %lus (next %s x%u), off %.2f (tremor %.2f, brady %.2f), dysk %.2f, %lu transitions\n\n",
+                motor_state_name(motor_state.state),
+                (unsigned long)((motor_state.state_since_ms > 0) ? (now - motor_state.state_since_ms) / 1000 : 0),
+                motor_state_name(motor_state.candidate), motor_state.candidate_windows,
+                motor_state.off_score, motor_state.tremor_level, motor_state.brady_level,
+                motor_state.dysk_level, (unsigned long)motor_state.transitions);
+            const PersonalThresholds& pt = personal_thresholds;
+            printf("[Baseline] %s %lu/%lu windows, %lu/%lu walking | floor min %.2f, tremor x%.1f, dysk x%.1f, freeze var %.3f\n\n",
+                pt.band_personal ? "personal" : "learning",
+                (unsigned long)baseline_sketch[BASELINE_TREMOR_RATIO].count, (unsigned long)BASELINE_BURN_IN_WINDOWS,
+                (unsigned long)baseline_sketch[BASELINE_WALK_VARIANCE].count, (unsigned long)BASELINE_WALK_BURN_IN_WINDOWS,
+                pt.noise_floor_min, pt.tremor_factor, pt.dysk_factor, pt.freeze_variance_max);
+            SpectroTrend tremor_trend;
+            if (spectro_band_trend(3.0f, 7.0f, SPECTRO_ROWS, &tremor_trend)) {
+                printf("[Spectro] 3-7 Hz peak in %.0f%% of %u windows, %.2f ± %.2f Hz, drift %+.3f Hz/min\n\n",
+                    tremor_trend.presence * 100.0f, (unsigned)spectro_rows(),
+                    tremor_trend.mean_freq, tremor_trend.freq_std, tremor_trend.drift_hz_per_min);
+            }
+            if (quality_stats.windows > 0) {
+                const uint32_t* fc = quality_stats.flag_counts;
+                printf("[Quality] %lu/%lu windows rejected, stuck %lu, dropout %lu (%lu samples), read err %lu (%lu), sat %lu, gravity %lu, noise %lu\n\n",
+                    (unsigned long)quality_stats.rejected, (unsigned long)quality_stats.windows,
+                    (unsigned long)fc[0], (unsigned long)fc[1], (unsigned long)sensor_missed_samples,
+                    (unsigned long)fc[2], (unsigned long)sensor_read_errors,
+                    (unsigned long)fc[3], (unsigned long)fc[4], (unsigned long)fc[5]);
+            }
+            printf("[Telemetry] %lu KB text since boot, %lu frames (%lu KB), %lu KB muted, BLE %lu KB (%lu episodes dropped)\n\n",
+                (unsigned long)(telemetry_stats.text_bytes / 1024), (unsigned long)telemetry_stats.frames,
+                (unsigned long)(telemetry_stats.telemetry_bytes / 1024),
+                (unsigned long)(telemetry_stats.text_muted_bytes / 1024), (unsigned long)(ble_tx_bytes / 1024),
+                (unsigned long)ble_episodes_dropped);
+            const KvSlotStats& cp = kv_writer_stats[KV_SLOT_CHECKPOINT];
+            printf("[Checkpoint] %lu saves (%lu written, %lu failed), last %lus ago, boot restore %s\n\n",
+                (unsigned long)checkpoint_stats.saves, (unsigned long)cp.written, (unsigned long)cp.failed,
+                (unsigned long)((now - checkpoint_stats.last_save_ms) / 1000),
+                (checkpoint_stats.restored == RESTORE_FULL) ? "full" :
+                (checkpoint_stats.restored == RESTORE_SLOW) ? "slow state" : "none");
+            uint32_t kv_failed = 0, kv_superseded = 0, kv_longest = 0;
+            for (int slot = 0; slot < KV_SLOTS; slot++) {
+                kv_failed += kv_writer_stats[slot].failed;
+                kv_superseded += kv_writer_stats[slot].superseded;
+                if (kv_writer_stats[slot].max_write_ms > kv_longest) kv_longest = kv_writer_stats[slot].max_write_ms;
+            }
+            printf("[KV] cal %lu/%lu, baseline %lu/%lu, checkpoint %lu/%lu written, %lu failed, %lu superseded, longest %lu ms\n\n",
+                (unsigned long)kv_writer_stats[KV_SLOT_CALIBRATION].written, (unsigned long)kv_writer_stats[KV_SLOT_CALIBRATION].posted,
+                (unsigned long)kv_writer_stats[KV_SLOT_BASELINE].written, (unsigned long)kv_writer_stats[KV_SLOT_BASELINE].posted,
+                (unsigned long)kv_writer_stats[KV_SLOT_CHECKPOINT].written, (unsigned long)kv_writer_stats[KV_SLOT_CHECKPOINT].posted,
+                (unsigned long)kv_failed, (unsigned long)kv_superseded, (unsigned long)kv_longest);
+            if (night_stats.entries > 0) {
+                float residency = night_mode_residency(now);
+                printf("[Night] %s, %lu entries, %lu wakes, %.1f%% of uptime, %.0f%% fewer samples\n\n",
+                    night_mode_active ? "active" : "off",
+                    (unsigned long)night_stats.entries, (unsigned long)night_stats.wakes,
+                    residency * 100.0f,
+                    residency * (1.0f - NIGHT_SAMPLE_RATE_HZ / TARGET_SAMPLE_RATE_HZ) * 100.0f);
+            }
+            if (flash_log_ready) {
+                printf("[Flash] %lu records, %lu KB, %.1f KB/s program, %lu dropped, %lu erases (wear %lu-%lu)\n\n",
+                    (unsigned long)flash_log_stats.records_written,
+                    (unsigned long)(flash_log_stats.bytes_written / 1024),
+                    (flash_log_stats.program_us > 0)
+                        ? flash_log_stats.bytes_written * 1000.0f / 1024.0f / flash_log_stats.program_us : 0.0f,
+                    (unsigned long)flash_log_stats.records_dropped,
+                    (unsigned long)flash_log_stats.erases,
+                    (unsigned long)flash_log_stats.min_erase_count,
+                    (unsigned long)flash_log_stats.max_erase_count);
+            }
             last_diagnostic_time = now;
         }
             
@@ -211,9 +360,29 @@ int main() {
             
         // Check if a complete window is ready for processing
         if (window_ready) {
-            process_window();
+            process_window(Kernel::get_ms_count());
         }
         
+        // Short/long window analysis, within its CPU budget
+        multires_service();
+
+        // Move frozen black-box captures into the flash log
+        flash_log_service();
+
+        // Console commands: 's' dumps the spectrogram ring, 't' toggles binary telemetry
+        if (serial_port.readable()) {
+            char command = 0;
+            if (serial_port.read(&command, 1) == 1) {
+                if (command == 's' || command == 'S') {
+                    spectro_request_dump();
+                } else if (command == 't' || command == 'T') {
+                    telemetry_set_active(!telemetry_active);
+                }
+            }
+        }
+        spectro_service();
+        telemetry_service(now);
+        
         // Process BLE events
         ble_event_queue.dispatch_once();
         
@@ -249,7 +418,11 @@ int main() {
             update_ble_characteristics();
         }
         
-        // Small delay to prevent busy-waiting
-        ThisThread::sleep_for(1ms);
+        // Small delay to prevent busy-waiting (longer at 12.5 Hz, samples are counted by the ISR)
+        if (night_mode_active) {
+            ThisThread::sleep_for(10ms);
+        } else {
+            ThisThread::sleep_for(1ms);
+        }
     }
 }
\ No newline at end of file
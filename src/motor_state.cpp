@@ -0,0 +1,86 @@
+/**
+ * @file motor_state.cpp
+ * @brief Slow ON/OFF motor-fluctuation estimator
+ */
+
+#include "motor_state.h"
+#include "bradykinesia.h"
+
+PIPELINE_STATE MotorStateEstimate motor_state = {};
+PIPELINE_STATE MotorInput motor_last_input = {};
+
+static const char* const MOTOR_STATE_NAMES[MOTOR_STATES] = {"UNKNOWN", "ON", "OFF", "DYSK-ON"};
+
+void init_motor_state() {
+    motor_state = {};
+    motor_state.state = MOTOR_UNKNOWN;
+    motor_state.candidate = MOTOR_UNKNOWN;
+    motor_last_input = {};
+}
+
+const char* motor_state_name(MotorState state) {
+    return (state < MOTOR_STATES) ? MOTOR_STATE_NAMES[state] : "?";
+}
+
+// Candidate with hysteresis around the current state
+static MotorState classify(const MotorStateEstimate& m) {
+    float dysk_threshold = (m.state == MOTOR_DYSK_ON) ? MOTOR_DYSK_EXIT : MOTOR_DYSK_ENTER;
+    float off_threshold = (m.state == MOTOR_OFF) ? MOTOR_OFF_EXIT : MOTOR_OFF_ENTER;
+
+    if (m.dysk_level >= dysk_threshold && m.dysk_level >= m.off_score) return MOTOR_DYSK_ON;
+    if (m.off_score >= off_threshold) return MOTOR_OFF;
+    return MOTOR_ON;
+}
+
+void motor_state_fold(const MotorInput& in) {
+    MotorStateEstimate& m = motor_state;
+
+    if (in.active) {
+        m.tremor_level += MOTOR_EMA_ALPHA * (in.tremor_intensity / 1000.0f - m.tremor_level);
+        m.dysk_level += MOTOR_EMA_ALPHA * (in.dysk_intensity / 1000.0f - m.dysk_level);
+        if (in.brady_scored) {
+            m.brady_level += MOTOR_EMA_ALPHA * (in.brady_score / 1000.0f - m.brady_level);
+        }
+
+        m.off_score = MOTOR_TREMOR_WEIGHT * m.tremor_level + (1.0f - MOTOR_TREMOR_WEIGHT) * m.brady_level;
+        m.active_windows++;
+
+        if (m.active_windows >= MOTOR_WARMUP_WINDOWS) {
+            MotorState candidate = classify(m);
+            if (candidate == m.candidate) {
+                if (m.candidate_windows < UINT16_MAX) m.candidate_windows++;
+            } else {
+                m.candidate = candidate;
+                m.candidate_windows = 1;
+            }
+
+            if (m.candidate != m.state &&
+                (m.state == MOTOR_UNKNOWN || m.candidate_windows >= MOTOR_CONFIRM_WINDOWS)) {
+                printf(" | 💊 %s → %s", motor_state_name(m.state), motor_state_name(m.candidate));
+                if (m.state != MOTOR_UNKNOWN) m.transitions++;
+                m.state = m.candidate;
+                m.state_since_ms = in.timestamp_ms;
+            }
+        }
+    }
+}
+
+void motor_state_update(WindowResult& result, bool active) {
+    const MotorStateEstimate& m = motor_state;
+
+    motor_last_input.timestamp_ms = result.timestamp_ms;
+    motor_last_input.tremor_intensity = result.tremor_intensity;
+    motor_last_input.dysk_intensity = result.dysk_intensity;
+    motor_last_input.brady_score = brady_result.score;
+    motor_last_input.active = active;
+    // Bradykinesia only counts while a scored movement sequence adds cycles;
+    // brady_result keeps the last sequence's score after it ends
+    motor_last_input.brady_scored = brady_result.cycles_in_window > 0 &&
+                                    brady_result.sequence_cycles >= BRADY_MIN_SEQUENCE_CYCLES;
+    motor_state_fold(motor_last_input);
+
+    result.motor_state = m.state;
+    result.motor_candidate = m.candidate;
+    result.off_score = (uint16_t)(m.off_score * 1000.0f);
+    result.dysk_level = (uint16_t)(m.dysk_level * 1000.0f);
+}
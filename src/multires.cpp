@@ -0,0 +1,298 @@
+/**
+ * @file multires.cpp
+ * @brief Multi-resolution time-frequency analysis on a shared sample history
+ */
+
+#include "multires.h"
+#include "signal_processing.h"
+#include "zoom_fft.h"
+#include <cstring>
+
+PIPELINE_STATE MultiResJob multires_jobs[MULTIRES_JOBS] = {
+    {"short", MULTIRES_SHORT_SAMPLES, MULTIRES_SHORT_HOP, MULTIRES_SHORT_FFT, 0, 0, 0, 0, 0},
+    {"long",  MULTIRES_LONG_SAMPLES,  MULTIRES_LONG_HOP,  MULTIRES_LONG_FFT,  0, 0, 0, 0, 0},
+    {"zoom",  MULTIRES_LONG_SAMPLES,  MULTIRES_LONG_HOP,  ZOOM_FFT_SIZE,      0, 0, 0, 0, 0},
+};
+PIPELINE_STATE MultiResResult multires_result = {};
+PIPELINE_STATE uint32_t multires_busy_us = 0;
+
+// Shared history (written from read_sensor_data, read from the main loop)
+static PIPELINE_STATE float history_accel[MULTIRES_HISTORY_SIZE];
+static PIPELINE_STATE float history_gyro[MULTIRES_HISTORY_SIZE];
+static PIPELINE_STATE uint32_t history_samples = 0;
+
+// FFT instances by size
+struct FftCacheEntry {
+    uint16_t size;
+    arm_rfft_fast_instance_f32 instance;
+};
+static PIPELINE_STATE FftCacheEntry fft_cache[MULTIRES_FFT_CACHE_SIZE];
+static PIPELINE_STATE size_t fft_cache_count = 0;
+
+// Per-length windows (flash tables)
+static PIPELINE_STATE WindowView short_window;
+static PIPELINE_STATE WindowView long_window;
+
+// Work buffers sized for the longest job. The blend inputs are dead once
+// work_in is built, so the magnitude reuses them, and the zoom FFT borrows
+// all of it as its scratch (its input is work_in).
+struct FftWork {
+    union {
+        float accel[MULTIRES_LONG_SAMPLES];
+        float mag[MULTIRES_LONG_FFT / 2];
+    };
+    float gyro[MULTIRES_LONG_SAMPLES];
+    float out[MULTIRES_LONG_FFT];
+};
+union WorkBuffers {
+    FftWork fft;
+    float zoom[ZOOM_WORK_FLOATS];
+};
+static_assert(MULTIRES_LONG_FFT / 2 <= MULTIRES_LONG_SAMPLES, "magnitude fits the blend input");
+static_assert(ZOOM_MAX_INPUT <= MULTIRES_LONG_FFT, "zoom input fits work_in");
+static PIPELINE_STATE WorkBuffers work;
+static PIPELINE_STATE float work_in[MULTIRES_LONG_FFT];
+
+// Scheduler
+static PIPELINE_STATE uint32_t tokens_us = MULTIRES_CPU_BUDGET_US;
+static PIPELINE_STATE uint32_t budget_sample = 0;
+static PIPELINE_STATE bool waiting[MULTIRES_JOBS];
+
+arm_rfft_fast_instance_f32* multires_fft_instance(uint16_t fft_size) {
+    for (size_t i = 0; i < fft_cache_count; i++) {
+        if (fft_cache[i].size == fft_size) return &fft_cache[i].instance;
+    }
+    if (fft_cache_count >= MULTIRES_FFT_CACHE_SIZE) return nullptr;
+
+    FftCacheEntry& entry = fft_cache[fft_cache_count];
+    if (arm_rfft_fast_init_f32(&entry.instance, fft_size) != ARM_MATH_SUCCESS) return nullptr;
+    entry.size = fft_size;
+    fft_cache_count++;
+    return &entry.instance;
+}
+
+void init_multires() {
+    memset(history_accel, 0, sizeof(history_accel));
+    memset(history_gyro, 0, sizeof(history_gyro));
+    history_samples = 0;
+    budget_sample = 0;
+    tokens_us = MULTIRES_CPU_BUDGET_US;
+    multires_result = {};
+    multires_busy_us = 0;
+
+    short_window = window_get(MULTIRES_SHORT_WINDOW, MULTIRES_SHORT_SAMPLES);
+    long_window = window_get(MULTIRES_LONG_WINDOW, MULTIRES_LONG_SAMPLES);
+
+    for (int id = 0; id < MULTIRES_JOBS; id++) {
+        MultiResJob& job = multires_jobs[id];
+        job.next_sample = job.window_samples;   // first run once the window has filled
+        job.cost_us = 0;
+        job.runs = job.deferred = job.skipped = 0;
+        waiting[id] = false;
+        if (id != MULTIRES_ZOOM) multires_fft_instance(job.fft_size);   // zoom uses a complex FFT
+    }
+    init_zoom_fft();
+
+    printf("✓ Multi-resolution analysis: %u-sample/%u-hop and %u-sample/%u-hop windows, %lu us/s budget\n",
+           (unsigned)MULTIRES_SHORT_SAMPLES, (unsigned)MULTIRES_SHORT_HOP,
+           (unsigned)MULTIRES_LONG_SAMPLES, (unsigned)MULTIRES_LONG_HOP,
+           (unsigned long)MULTIRES_CPU_BUDGET_US);
+}
+
+void multires_push(float accel_magnitude, float gyro_magnitude) {
+    size_t idx = history_samples & (MULTIRES_HISTORY_SIZE - 1);
+    history_accel[idx] = accel_magnitude;
+    history_gyro[idx] = gyro_magnitude;
+    history_samples++;
+}
+
+void multires_flush() {
+    budget_sample = history_samples;
+    for (int id = 0; id < MULTIRES_JOBS; id++) {
+        MultiResJob& job = multires_jobs[id];
+        job.next_sample = history_samples + job.window_samples;
+        waiting[id] = false;
+    }
+    multires_result = {};
+}
+
+/**
+ * Newest n samples as a normalized blend with the main window's current
+ * adaptive weights (fusion_accel_weight, updated once per main window),
+ * into work_in. Returns the raw accel std.
+ */
+static float load_blend(size_t n) {
+    uint32_t start = history_samples - n;
+    for (size_t i = 0; i < n; i++) {
+        size_t idx = (start + i) & (MULTIRES_HISTORY_SIZE - 1);
+        work.fft.accel[i] = history_accel[idx];
+        work.fft.gyro[i] = history_gyro[idx];
+    }
+
+    float accel_mean, gyro_mean, accel_var, gyro_var;
+    arm_mean_f32(work.fft.accel, n, &accel_mean);
+    arm_mean_f32(work.fft.gyro, n, &gyro_mean);
+    arm_offset_f32(work.fft.accel, -accel_mean, work.fft.accel, n);
+    arm_offset_f32(work.fft.gyro, -gyro_mean, work.fft.gyro, n);
+    arm_power_f32(work.fft.accel, n, &accel_var);
+    arm_power_f32(work.fft.gyro, n, &gyro_var);
+
+    const float eps = 1e-6f;
+    const float accel_std = sqrtf(accel_var / (float)n) + eps;
+    const float gyro_std = sqrtf(gyro_var / (float)n) + eps;
+
+    arm_scale_f32(work.fft.accel, fusion_accel_weight / accel_std, work.fft.accel, n);
+    arm_scale_f32(work.fft.gyro, (1.0f - fusion_accel_weight) / gyro_std, work.fft.gyro, n);
+    arm_add_f32(work.fft.accel, work.fft.gyro, work_in, n);
+    return accel_std;
+}
+
+/**
+ * Blended amplitude spectrum of the job's window into work.fft.mag, bin k at
+ * [k - 1]. Returns the raw accel std so callers can skip still windows.
+ */
+static float job_spectrum(const MultiResJob& job, const WindowView& window) {
+    const size_t n = job.window_samples;
+    float accel_std = load_blend(n);
+    arm_mult_f32(work_in, window.coeffs, work_in, n);
+    memset(&work_in[n], 0, (job.fft_size - n) * sizeof(float));
+
+    arm_rfft_fast_f32(multires_fft_instance(job.fft_size), work_in, work.fft.out, 0);
+    arm_cmplx_mag_f32(&work.fft.out[2], work.fft.mag, job.fft_size / 2 - 1);
+    arm_scale_f32(work.fft.mag, 2.0f / window.sum, work.fft.mag, job.fft_size / 2 - 1);
+
+    return accel_std;
+}
+
+// Peak amplitude over f_lo..f_hi of work.fft.mag
+static void spectrum_peak(uint16_t fft_size, float freq_res, float f_lo, float f_hi,
+                          float* amp, float* freq) {
+    size_t k_lo = (size_t)ceilf(f_lo / freq_res);
+    size_t k_hi = (size_t)floorf(f_hi / freq_res);
+    if (k_lo < 1) k_lo = 1;
+    if (k_hi > (size_t)fft_size / 2 - 1) k_hi = fft_size / 2 - 1;
+
+    *amp = 0.0f;
+    *freq = 0.0f;
+    if (k_hi < k_lo) return;
+
+    uint32_t idx;
+    arm_max_f32(&work.fft.mag[k_lo - 1], k_hi - k_lo + 1, amp, &idx);
+    *freq = (k_lo + idx) * freq_res;
+}
+
+static void run_short() {
+    const MultiResJob& job = multires_jobs[MULTIRES_SHORT];
+    float accel_std = job_spectrum(job, short_window);
+    const float freq_res = TARGET_SAMPLE_RATE_HZ / job.fft_size;
+
+    MultiResResult& r = multires_result;
+    spectrum_peak(job.fft_size, freq_res, 3.0f, 5.0f, &r.short_tremor_amp, &r.short_tremor_freq);
+    spectrum_peak(job.fft_size, freq_res, 5.0f + freq_res, 7.0f, &r.short_dysk_amp, &r.short_dysk_freq);
+    r.short_end_sample = history_samples;
+
+    // Burst: tremor-band peak well above the long-window floor while moving
+    if (accel_std >= STILLNESS_STD_THRESHOLD && r.long_noise_floor > 0.0f &&
+        r.short_tremor_amp > MULTIRES_BURST_RATIO * r.long_noise_floor &&
+        r.short_tremor_amp > r.short_dysk_amp) {
+        r.tremor_bursts++;
+    }
+}
+
+static void run_long() {
+    const MultiResJob& job = multires_jobs[MULTIRES_LONG];
+    job_spectrum(job, long_window);
+    const float freq_res = TARGET_SAMPLE_RATE_HZ / job.fft_size;
+
+    MultiResResult& r = multires_result;
+    size_t k0 = (size_t)ceilf(0.5f / freq_res);
+    size_t k1 = (size_t)floorf(2.0f / freq_res);
+    arm_mean_f32(&work.fft.mag[k0 - 1], k1 - k0 + 1, &r.long_noise_floor);
+    spectrum_peak(job.fft_size, freq_res, 0.5f, 2.0f, &r.locomotor_amp, &r.locomotor_freq);
+    r.long_end_sample = history_samples;
+}
+
+static void run_zoom() {
+    load_blend(multires_jobs[MULTIRES_ZOOM].window_samples);
+    if (zoom_fft_compute(work_in, multires_jobs[MULTIRES_ZOOM].window_samples, work.zoom)) {
+        zoom_result.end_sample = history_samples;
+    }
+}
+
+void multires_service() {
+    // Accrue budget for the samples that arrived since the last call
+    uint32_t new_samples = history_samples - budget_sample;
+    budget_sample = history_samples;
+    tokens_us += new_samples * MULTIRES_CPU_BUDGET_US / (uint32_t)TARGET_SAMPLE_RATE_HZ;
+    if (tokens_us > MULTIRES_CPU_BUDGET_US) tokens_us = MULTIRES_CPU_BUDGET_US;
+
+    // Jobs in priority order: short windows first, they carry the latency
+    for (int id = 0; id < MULTIRES_JOBS; id++) {
+        MultiResJob& job = multires_jobs[id];
+        if (history_samples < job.next_sample) continue;
+
+        // Replay runs every due job: the budget depends on host timing
+        if (!replay_mode && job.cost_us > tokens_us) {
+            if (!waiting[id]) {
+                job.deferred++;
+                waiting[id] = true;
+            }
+            if (history_samples >= job.next_sample + job.hop_samples) {
+                job.next_sample += job.hop_samples;
+                job.skipped++;
+            }
+            continue;
+        }
+        waiting[id] = false;
+
+        Timer t;
+        t.start();
+        if (id == MULTIRES_SHORT) {
+            run_short();
+        } else if (id == MULTIRES_LONG) {
+            run_long();
+        } else {
+            run_zoom();
+        }
+        t.stop();
+
+        uint32_t us = (uint32_t)t.elapsed_time().count();
+        job.cost_us = (job.runs == 0) ? us : (3 * job.cost_us + us) / 4;
+        job.runs++;
+        tokens_us = (tokens_us > us) ? tokens_us - us : 0;
+        multires_busy_us += us;
+
+        // Next hop; if we fell behind, realign to the newest data
+        job.next_sample += job.hop_samples;
+        while (job.next_sample + job.hop_samples <= history_samples) {
+            job.next_sample += job.hop_samples;
+            job.skipped++;
+        }
+    }
+}
+
+void multires_save(MultiResHistory* history) {
+    memcpy(history->accel, history_accel, sizeof(history_accel));
+    memcpy(history->gyro, history_gyro, sizeof(history_gyro));
+    history->samples = history_samples;
+    for (int id = 0; id < MULTIRES_JOBS; id++) history->next_sample[id] = multires_jobs[id].next_sample;
+    history->result = multires_result;
+}
+
+void multires_restore(const MultiResHistory* history) {
+    memcpy(history_accel, history->accel, sizeof(history_accel));
+    memcpy(history_gyro, history->gyro, sizeof(history_gyro));
+    history_samples = history->samples;
+    budget_sample = history_samples;
+    for (int id = 0; id < MULTIRES_JOBS; id++) {
+        multires_jobs[id].next_sample = history->next_sample[id];
+        waiting[id] = false;
+    }
+    multires_result = history->result;
+}
+
+uint16_t multires_take_bursts() {
+    uint16_t bursts = multires_result.tremor_bursts;
+    multires_result.tremor_bursts = 0;
+    return bursts;
+}
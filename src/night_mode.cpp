@@ -0,0 +1,119 @@
+/**
+ * @file night_mode.cpp
+ * @brief Low-duty nocturnal monitoring mode
+ */
+
+#include "night_mode.h"
+#include "sensor.h"
+#include "ble_comm.h"
+#include "multires.h"
+#include "blackbox.h"
+#include <ctime>
+
+PIPELINE_STATE bool night_mode_active = false;
+PIPELINE_STATE NightModeStats night_stats = {};
+
+void init_night_mode() {
+    night_mode_active = false;
+    night_stats = {};
+    night_stats.last_change_ms = replay_mode ? 0 : Kernel::get_ms_count();
+}
+
+// Forearm roughly horizontal, from the mean gravity of the raw window
+static bool resting_posture() {
+    int32_t sum[3] = {0, 0, 0};
+    for (size_t i = 0; i < WINDOW_SIZE; i++) {
+        sum[0] += raw_imu_buffer[IMU_AX][i];
+        sum[1] += raw_imu_buffer[IMU_AY][i];
+        sum[2] += raw_imu_buffer[IMU_AZ][i];
+    }
+    float gx = (float)sum[0], gy = (float)sum[1], gz = (float)sum[2];
+    float g = sqrtf(gx * gx + gy * gy + gz * gz);
+    return g > 0.0f && fabsf(gx) / g < NIGHT_POSTURE_MAX_X;
+}
+
+// Night hours in local time; false while the clock has not been set
+static bool night_hours() {
+    struct tm local;
+    if (!rtc_local_time(&local)) return false;
+    return local.tm_hour >= NIGHT_START_HOUR || local.tm_hour < NIGHT_END_HOUR;
+}
+
+static void switch_mode(bool night, const char* reason, uint32_t current_time) {
+    uint32_t elapsed = current_time - night_stats.last_change_ms;
+    if (night_mode_active) {
+        night_stats.night_ms += elapsed;
+    } else {
+        night_stats.day_ms += elapsed;
+    }
+    night_stats.last_change_ms = current_time;
+
+    float rate = night ? NIGHT_SAMPLE_RATE_HZ : TARGET_SAMPLE_RATE_HZ;
+    if (!set_sensor_odr(night ? NIGHT_ODR_BITS : DAY_ODR_BITS, rate)) {
+        printf("❌ ODR change failed ");
+        return;
+    }
+
+    night_mode_active = night;
+    night_stats.still_windows = 0;
+    ble_set_advertising_interval(night ? NIGHT_ADV_INTERVAL_MS : BLE_ADV_INTERVAL_MS);
+
+    if (night) {
+        night_stats.entries++;
+        printf("🌙 Night mode on (%.1f Hz) ", rate);
+    } else {
+        // The histories stopped at night entry; new samples must not be
+        // spliced onto them
+        multires_flush();
+        blackbox_flush();
+        night_stats.wakes++;
+        printf("☀️  Night mode off, %s ", reason);
+    }
+}
+
+void night_mode_update(const WindowResult& result, uint32_t current_time) {
+    // Recordings are at the day rate, and the replay clock is not the wear time
+    if (replay_mode) return;
+
+    if (night_mode_active) {
+        if (result.raw_detection == DETECT_TREMOR) {
+            switch_mode(false, "tremor", current_time);
+        } else if (result.std_dev >= NIGHT_WAKE_STD) {
+            switch_mode(false, "movement", current_time);
+        }
+        return;
+    }
+
+    bool quiet = result.std_dev < STILLNESS_STD_THRESHOLD &&
+                 result.tremor_intensity == 0 && result.dysk_intensity == 0;
+    if (quiet && resting_posture() && night_hours()) {
+        night_stats.still_windows++;
+    } else {
+        night_stats.still_windows = 0;
+    }
+
+    if (night_stats.still_windows >= NIGHT_ENTER_WINDOWS) {
+        switch_mode(true, nullptr, current_time);
+    }
+}
+
+void night_mode_restore(bool was_active, const NightModeStats& stats) {
+    night_stats = stats;
+    night_stats.still_windows = was_active ? NIGHT_ENTER_WINDOWS - 1 : stats.still_windows;
+}
+
+uint32_t night_mode_window_ms() {
+    return (uint32_t)(WINDOW_SIZE * 1000.0f / sensor_rate_hz);
+}
+
+float night_mode_residency(uint32_t current_time) {
+    uint32_t night = night_stats.night_ms;
+    uint32_t day = night_stats.day_ms;
+    uint32_t open = current_time - night_stats.last_change_ms;
+    if (night_mode_active) {
+        night += open;
+    } else {
+        day += open;
+    }
+    return (night + day > 0) ? (float)night / (night + day) : 0.0f;
+}
@@ -0,0 +1,250 @@
+/**
+ * @file record_format.cpp
+ * @brief Compact binary record format for raw IMU blocks and window results
+ */
+
+#include "record_format.h"
+#include <cstddef>
+#include <cstring>
+
+static bool fits_delta8(const int16_t* col, uint16_t n) {
+    for (uint16_t i = 1; i < n; i++) {
+        int32_t d = (int32_t)col[i] - (int32_t)col[i - 1];
+        if (d < -128 || d > 127) return false;
+    }
+    return true;
+}
+
+size_t imu_block_encode(const int16_t* const columns[IMU_AXES], uint16_t n,
+                        uint32_t first_sample, uint32_t timestamp_ms, bool compress,
+                        uint8_t* out, size_t out_size) {
+    if (n == 0 || n > IMU_BLOCK_MAX_SAMPLES || out_size < sizeof(ImuBlockHeader)) return 0;
+
+    ImuBlockHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = IMU_BLOCK_MAGIC;
+    hdr.first_sample = first_sample;
+    hdr.timestamp_ms = timestamp_ms;
+    hdr.sample_count = n;
+
+    uint8_t* payload = out + sizeof(ImuBlockHeader);
+    size_t payload_cap = out_size - sizeof(ImuBlockHeader);
+    size_t offset = 0;
+
+    for (int axis = 0; axis < IMU_AXES; axis++) {
+        const int16_t* col = columns[axis];
+
+        int16_t lo = col[0], hi = col[0];
+        for (uint16_t i = 1; i < n; i++) {
+            if (col[i] < lo) lo = col[i];
+            if (col[i] > hi) hi = col[i];
+        }
+        hdr.stats[axis].min = lo;
+        hdr.stats[axis].max = hi;
+        hdr.column_offset[axis] = (uint16_t)offset;
+
+        if (compress && fits_delta8(col, n)) {
+            size_t bytes = 2 + (n - 1);
+            bytes += bytes & 1;
+            if (offset + bytes > payload_cap) return 0;
+
+            uint8_t* dst = payload + offset;
+            memcpy(dst, &col[0], sizeof(int16_t));
+            for (uint16_t i = 1; i < n; i++) {
+                dst[1 + i] = (uint8_t)(int8_t)(col[i] - col[i - 1]);
+            }
+            if ((2 + (n - 1)) & 1) dst[bytes - 1] = 0;
+            hdr.encoding[axis] = COLUMN_DELTA8;
+            offset += bytes;
+        } else {
+            size_t bytes = (size_t)n * sizeof(int16_t);
+            if (offset + bytes > payload_cap) return 0;
+
+            memcpy(payload + offset, col, bytes);
+            hdr.encoding[axis] = COLUMN_RAW16;
+            offset += bytes;
+        }
+    }
+
+    // Pad so the next block starts 4-byte aligned
+    while (offset & 3) {
+        if (offset >= payload_cap) return 0;
+        payload[offset++] = 0;
+    }
+
+    hdr.payload_bytes = (uint16_t)offset;
+    memcpy(out, &hdr, sizeof(hdr));
+    return sizeof(ImuBlockHeader) + offset;
+}
+
+const ImuBlockHeader* imu_block_view(const uint8_t* data, size_t size) {
+    if (data == nullptr || size < sizeof(ImuBlockHeader)) return nullptr;
+    if (((uintptr_t)data & 3) != 0) return nullptr;
+
+    const ImuBlockHeader* hdr = (const ImuBlockHeader*)data;
+    if (hdr->magic != IMU_BLOCK_MAGIC) return nullptr;
+    if (hdr->sample_count == 0) return nullptr;
+    if (imu_block_size(hdr) > size) return nullptr;
+
+    for (int axis = 0; axis < IMU_AXES; axis++) {
+        size_t bytes = (hdr->encoding[axis] == COLUMN_DELTA8)
+                     ? (size_t)2 + (hdr->sample_count - 1)
+                     : (size_t)hdr->sample_count * sizeof(int16_t);
+        if (hdr->encoding[axis] > COLUMN_DELTA8) return nullptr;
+        if (hdr->column_offset[axis] + bytes > hdr->payload_bytes) return nullptr;
+    }
+    return hdr;
+}
+
+const int16_t* imu_block_column(const ImuBlockHeader* hdr, ImuAxis axis) {
+    if (hdr->encoding[axis] != COLUMN_RAW16) return nullptr;
+    const uint8_t* payload = (const uint8_t*)hdr + sizeof(ImuBlockHeader);
+    return (const int16_t*)(payload + hdr->column_offset[axis]);
+}
+
+bool imu_block_decode_column(const ImuBlockHeader* hdr, ImuAxis axis, int16_t* out) {
+    const uint8_t* src = (const uint8_t*)hdr + sizeof(ImuBlockHeader) + hdr->column_offset[axis];
+    uint16_t n = hdr->sample_count;
+
+    if (hdr->encoding[axis] == COLUMN_RAW16) {
+        memcpy(out, src, (size_t)n * sizeof(int16_t));
+        return true;
+    }
+    if (hdr->encoding[axis] == COLUMN_DELTA8) {
+        int16_t v;
+        memcpy(&v, src, sizeof(int16_t));
+        out[0] = v;
+        for (uint16_t i = 1; i < n; i++) {
+            v = (int16_t)(v + (int8_t)src[1 + i]);
+            out[i] = v;
+        }
+        return true;
+    }
+    return false;
+}
+
+void window_record_from_result(const WindowResult& result, WindowRecord* record) {
+    memset(record, 0, sizeof(*record));
+    record->magic = WINDOW_RECORD_MAGIC;
+    record->window_index = result.window_index;
+    record->start_sample = result.start_sample;
+    record->timestamp_ms = result.timestamp_ms;
+    record->std_dev = result.std_dev;
+    record->noise_floor = result.noise_floor;
+    record->tremor_peak = result.tremor_peak;
+    record->dysk_peak = result.dysk_peak;
+    record->tremor_freq_chz = (uint16_t)(result.tremor_freq * 100.0f + 0.5f);
+    record->dysk_freq_chz = (uint16_t)(result.dysk_freq * 100.0f + 0.5f);
+    record->tremor_intensity = result.tremor_intensity;
+    record->dysk_intensity = result.dysk_intensity;
+    record->raw_intensity_milli = (uint16_t)(result.raw_intensity * 1000.0f + 0.5f);
+    record->steps = result.steps;
+    record->raw_detection = (uint8_t)result.raw_detection;
+    record->fog_state = result.fog_state;
+    record->fog_status = result.fog_status;
+    record->flags = result.quality_flags;
+}
+
+// Where each column's values sit in a WindowRecord
+struct WindowFieldLayout {
+    uint8_t offset;
+    uint8_t size;
+};
+
+#define WINDOW_FIELD_LAYOUT(member) {offsetof(WindowRecord, member), sizeof(WindowRecord::member)}
+
+static const WindowFieldLayout window_fields[WINDOW_FIELDS] = {
+    WINDOW_FIELD_LAYOUT(window_index),
+    WINDOW_FIELD_LAYOUT(start_sample),
+    WINDOW_FIELD_LAYOUT(timestamp_ms),
+    WINDOW_FIELD_LAYOUT(std_dev),
+    WINDOW_FIELD_LAYOUT(noise_floor),
+    WINDOW_FIELD_LAYOUT(tremor_peak),
+    WINDOW_FIELD_LAYOUT(dysk_peak),
+    WINDOW_FIELD_LAYOUT(tremor_freq_chz),
+    WINDOW_FIELD_LAYOUT(dysk_freq_chz),
+    WINDOW_FIELD_LAYOUT(tremor_intensity),
+    WINDOW_FIELD_LAYOUT(dysk_intensity),
+    WINDOW_FIELD_LAYOUT(raw_intensity_milli),
+    WINDOW_FIELD_LAYOUT(steps),
+    WINDOW_FIELD_LAYOUT(raw_detection),
+    WINDOW_FIELD_LAYOUT(fog_state),
+    WINDOW_FIELD_LAYOUT(fog_status),
+    WINDOW_FIELD_LAYOUT(flags),
+};
+
+#undef WINDOW_FIELD_LAYOUT
+
+// Columns are laid out back to back in field order, each padded to 4 bytes
+static size_t column_bytes(WindowField field, uint16_t n) {
+    return ((size_t)n * window_fields[field].size + 3) & ~(size_t)3;
+}
+
+static size_t column_offset(WindowField field, uint16_t n) {
+    size_t offset = 0;
+    for (int f = 0; f < field; f++) offset += column_bytes((WindowField)f, n);
+    return offset;
+}
+
+size_t window_field_size(WindowField field) {
+    return (field < WINDOW_FIELDS) ? window_fields[field].size : 0;
+}
+
+size_t window_block_size(uint16_t n) {
+    return sizeof(WindowBlockHeader) + column_offset(WINDOW_FIELDS, n);
+}
+
+size_t window_block_encode(const WindowRecord* records, uint16_t n, uint8_t* out, size_t out_size) {
+    if (n == 0 || out_size < window_block_size(n)) return 0;
+
+    WindowBlockHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = WINDOW_BLOCK_MAGIC;
+    hdr.first_window = records[0].window_index;
+    hdr.window_count = n;
+    hdr.field_count = WINDOW_FIELDS;
+    hdr.payload_bytes = (uint32_t)column_offset(WINDOW_FIELDS, n);
+
+    uint8_t* dst = out + sizeof(WindowBlockHeader);
+    for (int f = 0; f < WINDOW_FIELDS; f++) {
+        const WindowFieldLayout& field = window_fields[f];
+        const size_t bytes = column_bytes((WindowField)f, n);
+        for (uint16_t i = 0; i < n; i++) {
+            memcpy(dst + (size_t)i * field.size, (const uint8_t*)&records[i] + field.offset, field.size);
+        }
+        memset(dst + (size_t)n * field.size, 0, bytes - (size_t)n * field.size);
+        dst += bytes;
+    }
+
+    memcpy(out, &hdr, sizeof(hdr));
+    return window_block_size(n);
+}
+
+const WindowBlockHeader* window_block_view(const uint8_t* data, size_t size) {
+    if (data == nullptr || size < sizeof(WindowBlockHeader)) return nullptr;
+    if (((uintptr_t)data & 3) != 0) return nullptr;
+
+    const WindowBlockHeader* hdr = (const WindowBlockHeader*)data;
+    if (hdr->magic != WINDOW_BLOCK_MAGIC || hdr->field_count != WINDOW_FIELDS) return nullptr;
+    if (hdr->window_count == 0) return nullptr;
+    if (hdr->payload_bytes != column_offset(WINDOW_FIELDS, hdr->window_count)) return nullptr;
+    if (window_block_size(hdr->window_count) > size) return nullptr;
+    return hdr;
+}
+
+const void* window_block_column(const WindowBlockHeader* hdr, WindowField field) {
+    if (field >= WINDOW_FIELDS) return nullptr;
+    return (const uint8_t*)hdr + sizeof(WindowBlockHeader) + column_offset(field, hdr->window_count);
+}
+
+bool window_block_record(const WindowBlockHeader* hdr, uint16_t i, WindowRecord* record) {
+    if (i >= hdr->window_count) return false;
+    memset(record, 0, sizeof(*record));
+    record->magic = WINDOW_RECORD_MAGIC;
+    for (int f = 0; f < WINDOW_FIELDS; f++) {
+        const WindowFieldLayout& field = window_fields[f];
+        const uint8_t* column = (const uint8_t*)window_block_column(hdr, (WindowField)f);
+        memcpy((uint8_t*)record + field.offset, column + (size_t)i * field.size, field.size);
+    }
+    return true;
+}
@@ -5,6 +5,13 @@
 
 #include "sensor.h"
 #include "fog_detection.h"
+#include "blackbox.h"
+#include "calibration.h"
+#include "multires.h"
+#include "night_mode.h"
+#include "data_quality.h"
+#include "telemetry.h"
+#include <cstring>
 
 // Hardware
 I2C i2c(PB_11, PB_10);
@@ -15,16 +22,20 @@ InterruptIn data_ready_pin(PD_11, PullDown);
 volatile bool new_data_available = false;
 volatile uint32_t interrupt_count = 0;
 volatile uint32_t pending_samples = 0;
-uint32_t sample_count = 0;
-uint32_t last_sample_time_ms = 0;
+PIPELINE_STATE uint32_t sample_count = 0;
+PIPELINE_STATE uint32_t last_sample_time_ms = 0;
+PIPELINE_STATE uint32_t sensor_read_errors = 0;
+PIPELINE_STATE uint32_t sensor_missed_samples = 0;
 
 // Data buffers
 
-float accel_magnitude_buffer[WINDOW_SIZE];
-float gyro_magnitude_buffer[WINDOW_SIZE];
-size_t buffer_index = 0;
-volatile bool window_ready = false;
-uint32_t window_count = 0;
+PIPELINE_STATE float accel_magnitude_buffer[WINDOW_SIZE];
+PIPELINE_STATE float gyro_magnitude_buffer[WINDOW_SIZE];
+PIPELINE_STATE int16_t raw_imu_buffer[IMU_AXES][WINDOW_SIZE];
+PIPELINE_STATE size_t buffer_index = 0;
+PIPELINE_STATE volatile bool window_ready = false;
+PIPELINE_STATE uint32_t window_count = 0;
+PIPELINE_STATE float sensor_rate_hz = TARGET_SAMPLE_RATE_HZ;
 
 // I2C communication
 bool write_register(uint8_t reg, uint8_t value) {
@@ -122,6 +133,33 @@ bool init_lsm6dsl() {
     return true;
 }
 
+// Switch accel and gyro ODR together (upper nibble of CTRL1_XL / CTRL2_G,
+// ranges unchanged). The partial window is discarded since it would mix
+// two sample rates.
+bool set_sensor_odr(uint8_t odr_bits, float rate_hz) {
+    if (!write_register(CTRL1_XL, odr_bits) || !write_register(CTRL2_G, odr_bits)) {
+        return false;
+    }
+    sensor_rate_hz = rate_hz;
+    buffer_index = 0;
+    window_ready = false;
+    return true;
+}
+
+void init_sensor_state() {
+    sample_count = 0;
+    last_sample_time_ms = 0;
+    sensor_read_errors = 0;
+    sensor_missed_samples = 0;
+    memset(accel_magnitude_buffer, 0, sizeof(accel_magnitude_buffer));
+    memset(gyro_magnitude_buffer, 0, sizeof(gyro_magnitude_buffer));
+    memset(raw_imu_buffer, 0, sizeof(raw_imu_buffer));
+    buffer_index = 0;
+    window_ready = false;
+    window_count = 0;
+    sensor_rate_hz = TARGET_SAMPLE_RATE_HZ;
+}
+
 void data_ready_isr() {
     new_data_available = true;
     interrupt_count++;
@@ -131,7 +169,10 @@ void data_ready_isr() {
 void read_sensor_data() {
     // Read raw accelerometer data
     uint8_t accel_data[6];
-    if (!read_burst(OUTX_L_XL, accel_data, 6)) return;
+    if (!read_burst(OUTX_L_XL, accel_data, 6)) {
+        sensor_read_errors++;
+        return;
+    }
     
     int16_t accel_x_raw = (int16_t)((accel_data[1] << 8) | accel_data[0]);
     int16_t accel_y_raw = (int16_t)((accel_data[3] << 8) | accel_data[2]);
@@ -139,30 +180,51 @@ void read_sensor_data() {
     
     // Read raw gyroscope data
     uint8_t gyro_data[6];
-    if (!read_burst(OUTX_L_G, gyro_data, 6)) return;
+    if (!read_burst(OUTX_L_G, gyro_data, 6)) {
+        sensor_read_errors++;
+        return;
+    }
     
     int16_t gyro_x_raw = (int16_t)((gyro_data[1] << 8) | gyro_data[0]);
     int16_t gyro_y_raw = (int16_t)((gyro_data[3] << 8) | gyro_data[2]);
     int16_t gyro_z_raw = (int16_t)((gyro_data[5] << 8) | gyro_data[4]);
     
-    // Convert to physical units
-    const float ACCEL_SCALE = 0.000061f;
-    float accel_x = accel_x_raw * ACCEL_SCALE;
-    float accel_y = accel_y_raw * ACCEL_SCALE;
-    float accel_z = accel_z_raw * ACCEL_SCALE;
-    
-    const float GYRO_SCALE = 0.00875f;
-    float gyro_x = gyro_x_raw * GYRO_SCALE;
-    float gyro_y = gyro_y_raw * GYRO_SCALE;
-    float gyro_z = gyro_z_raw * GYRO_SCALE;
+    // Die temperature for bias compensation (slow, so read at ~1 Hz)
+    if (sample_count % TEMP_READ_INTERVAL_SAMPLES == 0) {
+        uint8_t temp_data[2];
+        if (read_burst(OUT_TEMP_L, temp_data, 2)) {
+            int16_t temp_raw = (int16_t)((temp_data[1] << 8) | temp_data[0]);
+            calibration_set_temperature(CAL_TEMP_REF_C + temp_raw * TEMP_SCALE);
+        }
+    }
+
+    const int16_t raw_sample[IMU_AXES] = {accel_x_raw, accel_y_raw, accel_z_raw,
+                                          gyro_x_raw, gyro_y_raw, gyro_z_raw};
+    telemetry_sample_read();
+    sensor_ingest_sample(raw_sample, Kernel::get_ms_count());
+}
+
+void sensor_ingest_sample(const int16_t raw_sample[IMU_AXES], uint32_t current_time) {
+    // Convert to physical units with calibration applied
+    float sample[IMU_AXES];
+    calibration_apply(raw_sample, sample);
+    float accel_x = sample[IMU_AX];
+    float accel_y = sample[IMU_AY];
+    float accel_z = sample[IMU_AZ];
+    float gyro_x = sample[IMU_GX];
+    float gyro_y = sample[IMU_GY];
+    float gyro_z = sample[IMU_GZ];
     
     float accel_magnitude = sqrtf(accel_x*accel_x + accel_y*accel_y + accel_z*accel_z);
     float gyro_magnitude = sqrtf(gyro_x*gyro_x + gyro_y*gyro_y + gyro_z*gyro_z);
     
-    uint32_t current_time = Kernel::get_ms_count();
-    
+    // Read gaps of several periods mean the output registers were overwritten
     if (sample_count > 0) {
-        last_sample_time_ms = current_time;
+        float period_ms = 1000.0f / sensor_rate_hz;
+        float gap_ms = (float)(current_time - last_sample_time_ms);
+        if (gap_ms > QUALITY_GAP_PERIODS * period_ms) {
+            sensor_missed_samples += (uint32_t)(gap_ms / period_ms + 0.5f) - 1;
+        }
     }
     last_sample_time_ms = current_time;
     
@@ -170,6 +232,12 @@ void read_sensor_data() {
     
     accel_magnitude_buffer[buffer_index] = accel_magnitude;
     gyro_magnitude_buffer[buffer_index] = gyro_magnitude;
+    if (!night_mode_active) multires_push(accel_magnitude, gyro_magnitude);
+    for (size_t axis = 0; axis < IMU_AXES; axis++) {
+        raw_imu_buffer[axis][buffer_index] = raw_sample[axis];
+    }
+
+    if (!night_mode_active) blackbox_push(raw_sample);
     buffer_index++;
     
     if (buffer_index >= WINDOW_SIZE) {
@@ -183,12 +251,11 @@ void read_sensor_data() {
                         (1.0f - BASELINE_EMA_ALPHA) * accel_baseline_ema;
     
     float vertical_deviation = fabsf(accel_z - accel_baseline_ema);
-    uint32_t now = Kernel::get_ms_count();
 
     if (vertical_deviation > STEP_THRESHOLD && !above_step_threshold) {
-        if (now - last_step_time_ms > MIN_STEP_INTERVAL_MS) {
+        if (current_time - last_step_time_ms > MIN_STEP_INTERVAL_MS) {
             steps_in_window++;
-            last_step_time_ms = now;
+            last_step_time_ms = current_time;
         }
         above_step_threshold = true;
     } 
@@ -0,0 +1,367 @@
+/**
+ * @file spectral_batch.cpp
+ * @brief Spectral front end of many windows at once (host build)
+ */
+
+#ifdef PD_HOST_BUILD
+
+#include "spectral_batch.h"
+#include "signal_processing.h"
+#include "window_functions.h"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+// No a * b + c fused on the FMA targets: every kernel must round alike
+#pragma GCC optimize("fp-contract=off")
+#ifdef __clang__
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+// Lane l of every vector belongs to window l of the group, one group per
+// register width so nothing is split or spilled
+typedef float Vec4 __attribute__((vector_size(16)));
+typedef float Vec8 __attribute__((vector_size(32)));
+typedef float Vec16 __attribute__((vector_size(64)));
+
+template <typename Vec>
+struct VecTraits {
+    static const size_t lanes = sizeof(Vec) / sizeof(float);
+    typedef decltype(Vec{} > Vec{}) Mask;      // int32 lanes, -1 where true
+};
+
+const size_t HALF = FFT_SIZE / 2;              // complex points of the packed transform
+
+template <typename Vec>
+struct Spectrum {
+    Vec re[HALF + 1];            // bins 0..FFT_SIZE/2
+    Vec im[HALF + 1];
+    Vec std;
+    Vec snr;
+    Vec noise;
+};
+
+template <typename Vec>
+struct Workspace {
+    Vec x[FFT_SIZE];             // one channel, windowed and zero padded
+    Vec zr[HALF], zi[HALF];      // packed complex transform
+    Vec mag[HALF];               // fused magnitude, index k - 1 as magnitude_spectrum
+    Spectrum<Vec> accel, gyro;
+    Vec weight;
+};
+
+// Twiddles, window and bin ranges, shared by every kernel
+struct Tables {
+    float cos_half[HALF / 2], sin_half[HALF / 2];   // exp(-2 pi i k / HALF)
+    float cos_full[HALF], sin_full[HALF];           // exp(-2 pi i k / FFT_SIZE)
+    uint8_t reverse[HALF];
+    const float* window;
+    float freq_res;
+    size_t noise_lo, noise_hi;   // 0.5-2 Hz
+    size_t signal_lo, signal_hi; // 3-7 Hz
+    size_t tremor_lo, tremor_hi; // 3-5 Hz
+    size_t dysk_lo, dysk_hi;     // 5-7 Hz, above the tremor band
+
+    Tables() {
+        const double pi = 3.14159265358979323846;
+        for (size_t k = 0; k < HALF / 2; k++) {
+            cos_half[k] = (float)cos(2.0 * pi * k / HALF);
+            sin_half[k] = (float)sin(2.0 * pi * k / HALF);
+        }
+        for (size_t k = 0; k < HALF; k++) {
+            cos_full[k] = (float)cos(2.0 * pi * k / FFT_SIZE);
+            sin_full[k] = (float)sin(2.0 * pi * k / FFT_SIZE);
+            size_t r = 0;
+            for (size_t bit = 1, v = k; bit < HALF; bit <<= 1, v >>= 1) r = (r << 1) | (v & 1);
+            reverse[k] = (uint8_t)r;
+        }
+        window = window_get(ANALYSIS_WINDOW, WINDOW_SIZE).coeffs;
+
+        // Same expressions as analyze_frequency_content and its helpers
+        freq_res = TARGET_SAMPLE_RATE_HZ / (float)FFT_SIZE;
+        noise_lo = (size_t)ceilf(0.5f / freq_res);
+        noise_hi = (size_t)floorf(2.0f / freq_res);
+        if (noise_lo < 1) noise_lo = 1;
+        if (noise_hi > HALF - 1) noise_hi = HALF - 1;
+        signal_lo = (size_t)ceilf(3.0f / freq_res);
+        signal_hi = (size_t)floorf(7.0f / freq_res);
+        tremor_lo = (size_t)ceilf(3.0f / freq_res);
+        tremor_hi = (size_t)floorf(5.0f / freq_res);
+        dysk_lo = (size_t)ceilf(5.0f / freq_res);
+        if (dysk_lo < (size_t)floorf(5.0f / freq_res) + 1) dysk_lo = (size_t)floorf(5.0f / freq_res) + 1;
+        dysk_hi = (size_t)floorf(7.0f / freq_res);
+        if (tremor_lo < 1) tremor_lo = 1;
+        if (dysk_hi > HALF - 1) dysk_hi = HALF - 1;
+    }
+};
+
+static const Tables& tables() {
+    static const Tables t;
+    return t;
+}
+
+template <typename Vec>
+static ALWAYS_INLINE void lane_sqrt(Vec& v) {
+    for (size_t l = 0; l < VecTraits<Vec>::lanes; l++) v[l] = sqrtf(v[l]);
+}
+
+// Transpose `lanes` consecutive windows into x (unused lanes zero)
+template <typename Vec>
+static ALWAYS_INLINE void load(const float* data, size_t lanes, Vec* x) {
+    memset(x, 0, WINDOW_SIZE * sizeof(Vec));
+    for (size_t l = 0; l < lanes; l++) {
+        const float* window = data + l * WINDOW_SIZE;
+        for (size_t i = 0; i < WINDOW_SIZE; i++) x[i][l] = window[i];
+    }
+}
+
+// DC removal, std and window weighting, zero padded to FFT_SIZE
+template <typename Vec>
+static ALWAYS_INLINE void normalise(const float* window, Vec* x, Vec& std) {
+    Vec sum = {};
+    for (size_t i = 0; i < WINDOW_SIZE; i++) sum += x[i];
+    const Vec mean = sum / (float)WINDOW_SIZE;
+
+    Vec power = {};
+    for (size_t i = 0; i < WINDOW_SIZE; i++) {
+        x[i] -= mean;
+        power += x[i] * x[i];
+    }
+    std = power / (float)WINDOW_SIZE;
+    lane_sqrt(std);
+    std += 1e-6f;
+
+    for (size_t i = 0; i < WINDOW_SIZE; i++) x[i] *= window[i];
+    memset(&x[WINDOW_SIZE], 0, (FFT_SIZE - WINDOW_SIZE) * sizeof(Vec));
+}
+
+// Real FFT_SIZE-point transform: even/odd samples packed into one complex
+// HALF-point radix-2 transform, then split into bins 0..HALF
+template <typename Vec>
+static ALWAYS_INLINE void rfft(const Tables& t, Workspace<Vec>& w, Spectrum<Vec>& s) {
+    for (size_t n = 0; n < HALF; n++) {
+        w.zr[t.reverse[n]] = w.x[2 * n];
+        w.zi[t.reverse[n]] = w.x[2 * n + 1];
+    }
+    for (size_t m = 2; m <= HALF; m <<= 1) {
+        const size_t half = m / 2, step = HALF / m;
+        for (size_t start = 0; start < HALF; start += m) {
+            for (size_t j = 0; j < half; j++) {
+                const float c = t.cos_half[j * step], sn = t.sin_half[j * step];
+                Vec& ar = w.zr[start + j];
+                Vec& ai = w.zi[start + j];
+                Vec& br = w.zr[start + j + half];
+                Vec& bi = w.zi[start + j + half];
+                const Vec tr = br * c + bi * sn;       // b * exp(-i theta)
+                const Vec ti = bi * c - br * sn;
+                br = ar - tr;
+                bi = ai - ti;
+                ar += tr;
+                ai += ti;
+            }
+        }
+    }
+
+    s.re[0] = w.zr[0] + w.zi[0];
+    s.im[0] = Vec{};
+    s.re[HALF] = w.zr[0] - w.zi[0];
+    s.im[HALF] = Vec{};
+    for (size_t k = 1; k < HALF; k++) {
+        const Vec& zr = w.zr[k];
+        const Vec& zi = w.zi[k];
+        const Vec& yr = w.zr[HALF - k];
+        const Vec& yi = w.zi[HALF - k];
+        const Vec er = (zr + yr) * 0.5f, ei = (zi - yi) * 0.5f;    // even samples
+        const Vec odr = (zi + yi) * 0.5f, odi = (yr - zr) * 0.5f;  // odd samples
+        const float c = t.cos_full[k], sn = t.sin_full[k];
+        s.re[k] = er + (odr * c + odi * sn);
+        s.im[k] = ei + (odi * c - odr * sn);
+    }
+}
+
+// channel_snr: peak (3-7 Hz) over mean (0.5-2 Hz) of the spectrum scaled by 1/std
+template <typename Vec>
+static ALWAYS_INLINE void channel_snr(const Tables& t, Workspace<Vec>& w, Spectrum<Vec>& s) {
+    const Vec inv_std = 1.0f / s.std;
+    for (size_t k = 1; k <= t.signal_hi; k++) {
+        w.mag[k - 1] = s.re[k] * s.re[k] + s.im[k] * s.im[k];
+        lane_sqrt(w.mag[k - 1]);
+        w.mag[k - 1] *= inv_std;
+    }
+    Vec sum = {};
+    for (size_t k = t.noise_lo; k <= t.noise_hi; k++) sum += w.mag[k - 1];
+    Vec peak = w.mag[t.signal_lo - 1];
+    for (size_t k = t.signal_lo + 1; k <= t.signal_hi; k++) peak = (w.mag[k - 1] > peak) ? w.mag[k - 1] : peak;
+
+    s.noise = sum / (float)(t.noise_hi - t.noise_lo + 1) + 1e-6f;
+    s.snr = peak / s.noise;
+}
+
+// update_fusion_weight, window after window: the only state between lanes
+template <typename Vec>
+static ALWAYS_INLINE void fusion(Workspace<Vec>& w, size_t lanes, float* accel_weight) {
+    float weight = *accel_weight;
+    w.weight = Vec{};
+    for (size_t l = 0; l < lanes; l++) {
+        const float wa = w.accel.snr[l] / w.accel.noise[l];
+        const float wg = w.gyro.snr[l] / w.gyro.noise[l];
+        float target = (wa + wg > 0.0f) ? wa / (wa + wg) : FUSION_DEFAULT_ACCEL_WEIGHT;
+        if (target < FUSION_WEIGHT_MIN) target = FUSION_WEIGHT_MIN;
+        if (target > 1.0f - FUSION_WEIGHT_MIN) target = 1.0f - FUSION_WEIGHT_MIN;
+        weight += FUSION_WEIGHT_ALPHA * (target - weight);
+        w.weight[l] = weight;
+    }
+    *accel_weight = weight;
+}
+
+// First largest magnitude over k_lo..k_hi and its frequency, as bin_range_peak
+template <typename Vec>
+static ALWAYS_INLINE void band_peak(const Tables& t, const Workspace<Vec>& w, size_t k_lo, size_t k_hi,
+                                    Vec& peak, Vec& freq) {
+    typedef typename VecTraits<Vec>::Mask Mask;
+    Vec best = w.mag[k_lo - 1];
+    Mask bin = Mask{} + (int32_t)k_lo;
+    for (size_t k = k_lo + 1; k <= k_hi; k++) {
+        const Mask higher = w.mag[k - 1] > best;
+        best = higher ? w.mag[k - 1] : best;
+        bin = higher ? Mask{} + (int32_t)k : bin;
+    }
+    const Mask found = best > 0.0f;
+    peak = found ? best : Vec{};
+    freq = found ? __builtin_convertvector(bin, Vec) * t.freq_res : Vec{};
+}
+
+template <typename Vec>
+static ALWAYS_INLINE void run_group(Workspace<Vec>& w, const float* accel, const float* gyro, size_t lanes,
+                                    float* accel_weight, SpectralWindow* out, float* magnitude,
+                                    const float* window) {
+    const Tables& t = tables();
+
+    load(accel, lanes, w.x);
+    normalise(window, w.x, w.accel.std);
+    rfft(t, w, w.accel);
+    load(gyro, lanes, w.x);
+    normalise(window, w.x, w.gyro.std);
+    rfft(t, w, w.gyro);
+
+    channel_snr(t, w, w.accel);
+    channel_snr(t, w, w.gyro);
+    fusion(w, lanes, accel_weight);
+
+    // Linear blend of the two spectra, as analyze_frequency_content
+    const Vec accel_scale = w.weight / w.accel.std;
+    const Vec gyro_scale = (1.0f - w.weight) / w.gyro.std;
+    for (size_t k = 1; k < HALF; k++) {
+        const Vec re = w.accel.re[k] * accel_scale + w.gyro.re[k] * gyro_scale;
+        const Vec im = w.accel.im[k] * accel_scale + w.gyro.im[k] * gyro_scale;
+        w.mag[k - 1] = re * re + im * im;
+        lane_sqrt(w.mag[k - 1]);
+    }
+
+    Vec sum = {};
+    for (size_t k = t.noise_lo; k <= t.noise_hi; k++) sum += w.mag[k - 1];
+    const Vec floor = sum / (float)(t.noise_hi - t.noise_lo + 1);
+    Vec tremor_peak, tremor_freq, dysk_peak, dysk_freq;
+    band_peak(t, w, t.tremor_lo, t.tremor_hi, tremor_peak, tremor_freq);
+    band_peak(t, w, t.dysk_lo, t.dysk_hi, dysk_peak, dysk_freq);
+
+    for (size_t l = 0; l < lanes; l++) {
+        SpectralWindow& r = out[l];
+        r.accel_std = w.accel.std[l];
+        r.gyro_std = w.gyro.std[l];
+        r.accel_snr = w.accel.snr[l];
+        r.gyro_snr = w.gyro.snr[l];
+        r.accel_weight = w.weight[l];
+        r.noise_floor = floor[l];
+        r.tremor_peak = tremor_peak[l];
+        r.tremor_freq = tremor_freq[l];
+        r.dysk_peak = dysk_peak[l];
+        r.dysk_freq = dysk_freq[l];
+        if (magnitude != nullptr) {
+            for (size_t k = 0; k < SPECTRAL_BATCH_BINS; k++) magnitude[l * SPECTRAL_BATCH_BINS + k] = w.mag[k][l];
+        }
+    }
+}
+
+// Consecutive groups of as many windows as Vec has lanes
+template <typename Vec>
+static ALWAYS_INLINE void run_batch(const float* accel, const float* gyro, size_t windows, float* accel_weight,
+                                    SpectralWindow* out, float* magnitude, const float* window) {
+    const size_t width = VecTraits<Vec>::lanes;
+    std::unique_ptr<Workspace<Vec>> workspace(new Workspace<Vec>());
+    for (size_t first = 0; first < windows; first += width) {
+        const size_t lanes = (windows - first < width) ? windows - first : width;
+        run_group(*workspace, accel + first * WINDOW_SIZE, gyro + first * WINDOW_SIZE, lanes, accel_weight,
+                  out + first, (magnitude != nullptr) ? magnitude + first * SPECTRAL_BATCH_BINS : nullptr, window);
+    }
+}
+
+// One copy of the kernel per instruction set
+typedef void (*BatchKernel)(const float*, const float*, size_t, float*, SpectralWindow*, float*, const float*);
+
+static void batch_generic(const float* accel, const float* gyro, size_t windows, float* accel_weight,
+                          SpectralWindow* out, float* magnitude, const float* window) {
+    run_batch<Vec4>(accel, gyro, windows, accel_weight, out, magnitude, window);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPECTRAL_BATCH_X86 1
+
+__attribute__((target("avx2")))
+static void batch_avx2(const float* accel, const float* gyro, size_t windows, float* accel_weight,
+                       SpectralWindow* out, float* magnitude, const float* window) {
+    run_batch<Vec8>(accel, gyro, windows, accel_weight, out, magnitude, window);
+}
+
+__attribute__((target("avx512f")))
+static void batch_avx512(const float* accel, const float* gyro, size_t windows, float* accel_weight,
+                         SpectralWindow* out, float* magnitude, const float* window) {
+    run_batch<Vec16>(accel, gyro, windows, accel_weight, out, magnitude, window);
+}
+#endif
+
+static std::atomic<uint8_t> selected_isa(SPECTRAL_ISA_AUTO);
+
+static bool cpu_supports(SpectralIsa isa) {
+    switch (isa) {
+    case SPECTRAL_ISA_AUTO:
+    case SPECTRAL_ISA_GENERIC: return true;
+#ifdef SPECTRAL_BATCH_X86
+    case SPECTRAL_ISA_AVX2:    return __builtin_cpu_supports("avx2");
+    case SPECTRAL_ISA_AVX512:  return __builtin_cpu_supports("avx512f");
+#endif
+    default:                   return false;
+    }
+}
+
+bool spectral_batch_use(SpectralIsa isa) {
+    if (!cpu_supports(isa)) return false;
+    selected_isa = isa;
+    return true;
+}
+
+SpectralIsa spectral_batch_isa() {
+    SpectralIsa isa = (SpectralIsa)selected_isa.load();
+    if (isa != SPECTRAL_ISA_AUTO) return isa;
+    if (cpu_supports(SPECTRAL_ISA_AVX512)) return SPECTRAL_ISA_AVX512;
+    if (cpu_supports(SPECTRAL_ISA_AVX2)) return SPECTRAL_ISA_AVX2;
+    return SPECTRAL_ISA_GENERIC;
+}
+
+void spectral_batch(const float* accel, const float* gyro, size_t windows, float* accel_weight,
+                    SpectralWindow* out, float* magnitude, const float* window) {
+    BatchKernel kernel = batch_generic;
+#ifdef SPECTRAL_BATCH_X86
+    switch (spectral_batch_isa()) {
+    case SPECTRAL_ISA_AVX512: kernel = batch_avx512; break;
+    case SPECTRAL_ISA_AVX2:   kernel = batch_avx2; break;
+    default:                  break;
+    }
+#endif
+    kernel(accel, gyro, windows, accel_weight, out, magnitude, (window != nullptr) ? window : tables().window);
+}
+
+#endif // PD_HOST_BUILD
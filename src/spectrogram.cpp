@@ -0,0 +1,218 @@
+/**
+ * @file spectrogram.cpp
+ * @brief Spectral history ring for trend features and export
+ */
+
+#include "spectrogram.h"
+#include "arm_math.h"
+#include <cstring>
+
+PIPELINE_STATE uint32_t spectro_revision = 0;
+
+static PIPELINE_STATE uint8_t spectro_data[SPECTRO_ROWS][SPECTRO_BINS];
+static PIPELINE_STATE uint32_t spectro_window[SPECTRO_ROWS];
+static PIPELINE_STATE size_t spectro_head = 0;      // next row to write
+static PIPELINE_STATE size_t spectro_count = 0;
+static PIPELINE_STATE float power_lut[256];         // code -> magnitude^2
+static PIPELINE_STATE size_t dump_remaining = 0;
+
+void init_spectrogram() {
+    memset(spectro_data, 0, sizeof(spectro_data));
+    memset(spectro_window, 0, sizeof(spectro_window));
+    spectro_head = 0;
+    spectro_count = 0;
+    spectro_revision = 0;
+    dump_remaining = 0;
+    power_lut[0] = 0.0f;
+    for (int q = 1; q < 256; q++) {
+        power_lut[q] = exp2f(2.0f * (q - SPECTRO_ZERO_STEP) / SPECTRO_STEPS_PER_OCTAVE);
+    }
+}
+
+void spectro_append(uint32_t window_index, const float* magnitude) {
+    uint8_t* row = spectro_data[spectro_head];
+
+    if (magnitude == nullptr) {
+        memset(row, 0, SPECTRO_BINS);
+    } else {
+        const float* src = &magnitude[SPECTRO_FIRST_BIN - 1];
+        for (size_t c = 0; c < SPECTRO_BINS; c++) {
+            float q = (src[c] > 0.0f)
+                ? SPECTRO_STEPS_PER_OCTAVE * log2f(src[c]) + SPECTRO_ZERO_STEP + 0.5f : 0.0f;
+            row[c] = (q <= 1.0f) ? 0 : (q >= 255.0f) ? 255 : (uint8_t)q;
+        }
+    }
+
+    spectro_window[spectro_head] = window_index;
+    spectro_head = (spectro_head + 1) % SPECTRO_ROWS;
+    if (spectro_count < SPECTRO_ROWS) spectro_count++;
+    spectro_revision++;
+
+    // Rows still to be dumped moved one age back
+    if (dump_remaining > 0 && dump_remaining < SPECTRO_ROWS) dump_remaining++;
+}
+
+void spectro_save(SpectroHistory* history) {
+    memcpy(history->data, spectro_data, sizeof(spectro_data));
+    memcpy(history->window, spectro_window, sizeof(spectro_window));
+    history->head = spectro_head;
+    history->count = spectro_count;
+    history->revision = spectro_revision;
+}
+
+void spectro_restore(const SpectroHistory* history) {
+    memcpy(spectro_data, history->data, sizeof(spectro_data));
+    memcpy(spectro_window, history->window, sizeof(spectro_window));
+    spectro_head = history->head % SPECTRO_ROWS;
+    spectro_count = (history->count > SPECTRO_ROWS) ? SPECTRO_ROWS : history->count;
+    spectro_revision = history->revision;
+    dump_remaining = 0;
+}
+
+size_t spectro_rows() {
+    return spectro_count;
+}
+
+static size_t row_slot(size_t age) {
+    return (spectro_head + SPECTRO_ROWS - 1 - age) % SPECTRO_ROWS;
+}
+
+const uint8_t* spectro_row(size_t age) {
+    return (age < spectro_count) ? spectro_data[row_slot(age)] : nullptr;
+}
+
+uint32_t spectro_row_window(size_t age) {
+    return (age < spectro_count) ? spectro_window[row_slot(age)] : 0;
+}
+
+float spectro_bin_freq(size_t column) {
+    return (SPECTRO_FIRST_BIN + column) * TARGET_SAMPLE_RATE_HZ / FFT_SIZE;
+}
+
+// Band limits as column indices, false if the band misses the stored range
+static bool band_columns(float f_lo, float f_hi, size_t* c_lo, size_t* c_hi) {
+    const float freq_res = TARGET_SAMPLE_RATE_HZ / FFT_SIZE;
+    int lo = (int)ceilf(f_lo / freq_res) - (int)SPECTRO_FIRST_BIN;
+    int hi = (int)floorf(f_hi / freq_res) - (int)SPECTRO_FIRST_BIN;
+    if (lo < 0) lo = 0;
+    if (hi > (int)SPECTRO_BINS - 1) hi = SPECTRO_BINS - 1;
+    if (hi < lo) return false;
+    *c_lo = (size_t)lo;
+    *c_hi = (size_t)hi;
+    return true;
+}
+
+size_t spectro_band_series(float f_lo, float f_hi, size_t rows, float* out) {
+    size_t c_lo, c_hi;
+    if (!band_columns(f_lo, f_hi, &c_lo, &c_hi)) return 0;
+    if (rows > spectro_count) rows = spectro_count;
+
+    for (size_t i = 0; i < rows; i++) {
+        const uint8_t* row = spectro_data[row_slot(rows - 1 - i)];
+        float power = 0.0f;
+        for (size_t c = c_lo; c <= c_hi; c++) {
+            power += power_lut[row[c]];
+        }
+        out[i] = power;
+    }
+    return rows;
+}
+
+void spectro_mean_spectrum(size_t rows, float* out) {
+    float row_power[SPECTRO_BINS];
+    memset(out, 0, SPECTRO_BINS * sizeof(float));
+    if (rows > spectro_count) rows = spectro_count;
+    if (rows == 0) return;
+
+    for (size_t age = 0; age < rows; age++) {
+        const uint8_t* row = spectro_data[row_slot(age)];
+        for (size_t c = 0; c < SPECTRO_BINS; c++) {
+            row_power[c] = power_lut[row[c]];
+        }
+        arm_add_f32(out, row_power, out, SPECTRO_BINS);
+    }
+
+    // Mean power back to magnitude
+    arm_scale_f32(out, 1.0f / rows, out, SPECTRO_BINS);
+    for (size_t c = 0; c < SPECTRO_BINS; c++) {
+        arm_sqrt_f32(out[c], &out[c]);
+    }
+}
+
+bool spectro_band_trend(float f_lo, float f_hi, size_t rows, SpectroTrend* trend) {
+    *trend = {};
+    size_t c_lo, c_hi;
+    if (!band_columns(f_lo, f_hi, &c_lo, &c_hi)) return false;
+    if (rows > spectro_count) rows = spectro_count;
+    if (rows == 0) return false;
+
+    const float minutes_per_window = WINDOW_SIZE / TARGET_SAMPLE_RATE_HZ / 60.0f;
+    uint32_t newest = spectro_row_window(0);
+    float n = 0.0f, sx = 0.0f, sxx = 0.0f, sf = 0.0f, sff = 0.0f, sxf = 0.0f;
+
+    for (size_t age = 0; age < rows; age++) {
+        const uint8_t* row = spectro_data[row_slot(age)];
+
+        // Geometric-mean level of the row from the code sum
+        uint32_t sum = 0;
+        for (size_t c = 0; c < SPECTRO_BINS; c++) sum += row[c];
+        if (sum == 0) continue;   // blank row
+        uint32_t mean_code = sum / SPECTRO_BINS;
+
+        size_t peak_c = c_lo;
+        for (size_t c = c_lo + 1; c <= c_hi; c++) {
+            if (row[c] > row[peak_c]) peak_c = c;
+        }
+        if (row[peak_c] < mean_code + SPECTRO_PRESENCE_STEPS) continue;
+
+        float x = -(float)(newest - spectro_window[row_slot(age)]) * minutes_per_window;
+        float f = spectro_bin_freq(peak_c);
+        n += 1.0f;
+        sx += x;
+        sxx += x * x;
+        sf += f;
+        sff += f * f;
+        sxf += x * f;
+    }
+
+    if (n == 0.0f) return false;
+
+    trend->presence = n / rows;
+    trend->mean_freq = sf / n;
+    float var = sff / n - trend->mean_freq * trend->mean_freq;
+    trend->freq_std = (var > 0.0f) ? sqrtf(var) : 0.0f;
+    float denom = n * sxx - sx * sx;
+    trend->drift_hz_per_min = (denom > 0.0f) ? (n * sxf - sx * sf) / denom : 0.0f;
+    return true;
+}
+
+bool spectro_packet(size_t age, SpectroPacket* packet) {
+    const uint8_t* row = spectro_row(age);
+    if (row == nullptr) return false;
+    packet->window_index = spectro_row_window(age);
+    memcpy(packet->bins, row, SPECTRO_BINS);
+    return true;
+}
+
+void spectro_request_dump() {
+    if (dump_remaining > 0) return;
+    printf("\nSPECTRO rows=%u first_bin=%u res=%.4f steps_per_octave=%.0f zero=%d\n",
+           (unsigned)spectro_count, (unsigned)SPECTRO_FIRST_BIN,
+           TARGET_SAMPLE_RATE_HZ / FFT_SIZE, SPECTRO_STEPS_PER_OCTAVE, SPECTRO_ZERO_STEP);
+    dump_remaining = spectro_count;
+    if (dump_remaining == 0) printf("SPECTRO end\n");
+}
+
+void spectro_service() {
+    if (dump_remaining == 0) return;
+
+    // Oldest first, one row per call so sampling is not held up
+    dump_remaining--;
+    const uint8_t* row = spectro_data[row_slot(dump_remaining)];
+    printf("%lu:", (unsigned long)spectro_window[row_slot(dump_remaining)]);
+    for (size_t c = 0; c < SPECTRO_BINS; c++) {
+        printf("%02X", row[c]);
+    }
+    printf("\n");
+    if (dump_remaining == 0) printf("SPECTRO end\n");
+}
@@ -0,0 +1,175 @@
+/**
+ * @file symptom_summary.cpp
+ * @brief Hourly aggregation of confirmed window results
+ */
+
+#include "symptom_summary.h"
+#include <cstring>
+
+PIPELINE_STATE SummaryBucket summary_buckets[SUMMARY_HOURS];
+PIPELINE_STATE uint32_t summary_revision = 0;
+
+static PIPELINE_STATE uint8_t previous_fog_status = 0;
+
+// Uptime from the window timestamps, carried across their 32-bit wrap
+static PIPELINE_STATE uint64_t uptime_ms = 0;
+static PIPELINE_STATE uint32_t last_timestamp_ms = 0;
+static PIPELINE_STATE bool uptime_started = false;
+
+void init_symptom_summary() {
+    memset(summary_buckets, 0, sizeof(summary_buckets));
+    summary_revision = 0;
+    previous_fog_status = 0;
+    uptime_ms = 0;
+    last_timestamp_ms = 0;
+    uptime_started = false;
+}
+
+// Hour a window belongs to; true if it is a local wall-clock hour
+static bool window_hour(uint32_t timestamp_ms, uint32_t* hour) {
+    uptime_ms = uptime_started ? uptime_ms + (uint32_t)(timestamp_ms - last_timestamp_ms) : timestamp_ms;
+    last_timestamp_ms = timestamp_ms;
+    uptime_started = true;
+
+    // A replay keeps to the recording's own timeline
+    time_t local;
+    if (!replay_mode && rtc_local_seconds(&local)) {
+        *hour = (uint32_t)(local / 3600);
+        return true;
+    }
+    *hour = (uint32_t)(uptime_ms / SUMMARY_HOUR_MS);
+    return false;
+}
+
+static inline size_t intensity_bin(uint16_t intensity) {
+    size_t bin = intensity / 125;
+    return (bin < SUMMARY_INTENSITY_BINS) ? bin : SUMMARY_INTENSITY_BINS - 1;
+}
+
+void summary_add_window(const WindowResult& result, uint32_t window_ms) {
+    uint32_t hour;
+    bool rtc = window_hour(result.timestamp_ms, &hour);
+    SummaryBucket& b = summary_buckets[hour % SUMMARY_HOURS];
+
+    if (!b.valid || b.hour_index != hour || b.rtc != rtc) {
+        memset(&b, 0, sizeof(b));
+        b.hour_index = hour;
+        b.rtc = rtc;
+        b.valid = true;
+    }
+
+    b.windows++;
+    b.covered_ms += window_ms;
+
+    if (result.std_dev < STILLNESS_STD_THRESHOLD) {
+        b.still_ms += window_ms;
+    }
+
+    float freq = 0.0f;
+    if (result.tremor_intensity > 0) {
+        b.tremor_ms += window_ms;
+        b.tremor_hist[intensity_bin(result.tremor_intensity)]++;
+        if (result.tremor_intensity > b.peak_tremor) b.peak_tremor = result.tremor_intensity;
+        freq = result.tremor_freq;
+    } else if (result.dysk_intensity > 0) {
+        b.dysk_ms += window_ms;
+        b.dysk_hist[intensity_bin(result.dysk_intensity)]++;
+        if (result.dysk_intensity > b.peak_dysk) b.peak_dysk = result.dysk_intensity;
+        freq = result.dysk_freq;
+    }
+
+    // Only count the frequency when this window's raw detection agrees
+    if (freq >= 3.0f && freq <= 7.0f &&
+        ((result.tremor_intensity > 0 && result.raw_detection == DETECT_TREMOR) ||
+         (result.dysk_intensity > 0 && result.raw_detection == DETECT_DYSK))) {
+        size_t bin = (size_t)((freq - 3.0f) * 2.0f);
+        if (bin >= SUMMARY_FREQ_BINS) bin = SUMMARY_FREQ_BINS - 1;
+        b.freq_hist[bin]++;
+    }
+
+    if (result.fog_status) {
+        b.fog_ms += window_ms;
+        if (!previous_fog_status) b.fog_count++;
+    }
+    previous_fog_status = result.fog_status;
+
+    summary_revision++;
+}
+
+static uint8_t median_bin(const uint16_t* hist, size_t bins) {
+    uint32_t total = 0;
+    for (size_t i = 0; i < bins; i++) total += hist[i];
+    if (total == 0) return 0xFF;
+
+    uint32_t acc = 0;
+    for (size_t i = 0; i < bins; i++) {
+        acc += hist[i];
+        if (acc * 2 >= total) return (uint8_t)i;
+    }
+    return (uint8_t)(bins - 1);
+}
+
+static uint8_t mode_bin(const uint16_t* hist, size_t bins) {
+    uint8_t best = 0xFF;
+    uint16_t best_count = 0;
+    for (size_t i = 0; i < bins; i++) {
+        if (hist[i] > best_count) { best_count = hist[i]; best = (uint8_t)i; }
+    }
+    return best;
+}
+
+static inline uint16_t ms_to_s(uint32_t ms) {
+    uint32_t s = ms / 1000;
+    return (s < 0xFFFF) ? (uint16_t)s : 0xFFFF;
+}
+
+// Uptime hours before wall-clock hours, each in order
+static bool exported_before(const SummaryBucket& a, const SummaryBucket& b) {
+    return (a.rtc != b.rtc) ? b.rtc : a.hour_index < b.hour_index;
+}
+
+size_t summary_export(uint8_t* out, size_t out_size) {
+    // Newest hour of each kind; older than a ring's worth is stale
+    uint32_t newest[2] = {0, 0};
+    for (size_t i = 0; i < SUMMARY_HOURS; i++) {
+        const SummaryBucket& b = summary_buckets[i];
+        if (b.valid && b.hour_index > newest[b.rtc]) newest[b.rtc] = b.hour_index;
+    }
+
+    const SummaryBucket* order[SUMMARY_HOURS];
+    size_t count = 0;
+    for (size_t i = 0; i < SUMMARY_HOURS; i++) {
+        const SummaryBucket& b = summary_buckets[i];
+        if (!b.valid || b.hour_index + SUMMARY_HOURS <= newest[b.rtc]) continue;
+        size_t j = count++;
+        while (j > 0 && exported_before(b, *order[j - 1])) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = &b;
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < count; i++) {
+        const SummaryBucket& b = *order[i];
+        if (written + sizeof(SummaryPacket) > out_size) break;
+
+        SummaryPacket p;
+        p.hour_index = (uint16_t)((b.hour_index & SUMMARY_HOUR_MASK) | (b.rtc ? SUMMARY_HOUR_RTC : 0));
+        p.windows = b.windows;
+        p.tremor_s = ms_to_s(b.tremor_ms);
+        p.dysk_s = ms_to_s(b.dysk_ms);
+        p.fog_s = ms_to_s(b.fog_ms);
+        p.still_s = ms_to_s(b.still_ms);
+        p.peak_tremor = b.peak_tremor;
+        p.peak_dysk = b.peak_dysk;
+        p.fog_count = (b.fog_count < 0xFF) ? (uint8_t)b.fog_count : 0xFF;
+        p.tremor_median_bin = median_bin(b.tremor_hist, SUMMARY_INTENSITY_BINS);
+        p.dysk_median_bin = median_bin(b.dysk_hist, SUMMARY_INTENSITY_BINS);
+        p.dominant_freq_bin = mode_bin(b.freq_hist, SUMMARY_FREQ_BINS);
+
+        memcpy(out + written, &p, sizeof(p));
+        written += sizeof(p);
+    }
+    return written;
+}
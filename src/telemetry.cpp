@@ -0,0 +1,249 @@
+/**
+ * @file telemetry.cpp
+ * @brief Compact binary metrics and trace stream on the serial port
+ */
+
+#include "telemetry.h"
+#include "sensor.h"
+#include "spectrogram.h"
+#include "flash_log.h"
+#include "multires.h"
+#include "night_mode.h"
+#include "ble_comm.h"
+#include <cstring>
+
+PIPELINE_STATE bool telemetry_active = false;
+PIPELINE_STATE TelemetryStats telemetry_stats = {};
+
+static MbedCRC<POLY_8BIT_CCITT, 8> crc8;
+static PIPELINE_STATE uint8_t sequence = 0;
+
+// Stage timing within process_window()
+static PIPELINE_STATE Timer stage_timer;
+static PIPELINE_STATE uint32_t stage_mark_us = 0;
+static PIPELINE_STATE uint16_t stage_us[TELEMETRY_STAGES];
+
+// Sensor read intervals over the current health interval
+static PIPELINE_STATE Timer read_timer;
+static PIPELINE_STATE bool read_timer_started = false;
+static PIPELINE_STATE uint32_t last_read_us = 0;
+static PIPELINE_STATE uint32_t reads = 0;
+static PIPELINE_STATE float deviation_sum = 0.0f;     // from the nominal period, keeps the variance well conditioned
+static PIPELINE_STATE float deviation_sum2 = 0.0f;
+static PIPELINE_STATE uint32_t interval_max = 0;
+
+// Health interval state
+static PIPELINE_STATE uint32_t last_health_ms = 0;
+static PIPELINE_STATE uint16_t backlog_max = 0;
+static PIPELINE_STATE uint32_t last_deferred = 0;
+static PIPELINE_STATE uint32_t last_ble_bytes = 0;
+static PIPELINE_STATE uint32_t last_text_bytes = 0;
+static PIPELINE_STATE uint32_t last_telemetry_bytes = 0;
+
+// Console text goes through here; muted while the binary stream owns the port
+class ConsoleGate : public FileHandle {
+public:
+    FileHandle* port = nullptr;
+
+    ssize_t write(const void* buffer, size_t size) override {
+        telemetry_stats.text_bytes += size;
+        if (telemetry_active) {
+            telemetry_stats.text_muted_bytes += size;
+            return size;
+        }
+        return port->write(buffer, size);
+    }
+
+    ssize_t read(void* buffer, size_t size) override {
+        return port->read(buffer, size);
+    }
+
+    off_t seek(off_t, int) override {
+        return -ESPIPE;
+    }
+
+    int close() override {
+        return 0;
+    }
+
+    int isatty() override {
+        return 1;
+    }
+};
+
+static PIPELINE_STATE ConsoleGate console_gate;
+
+FileHandle* telemetry_console(FileHandle* port) {
+    console_gate.port = port;
+    return &console_gate;
+}
+
+void init_telemetry() {
+    telemetry_stats = {};
+    sequence = 0;
+    stage_mark_us = 0;
+    memset(stage_us, 0, sizeof(stage_us));
+    read_timer_started = false;
+    last_read_us = 0;
+    reads = 0;
+    deviation_sum = 0.0f;
+    deviation_sum2 = 0.0f;
+    interval_max = 0;
+    last_health_ms = 0;
+    backlog_max = 0;
+    last_deferred = 0;
+    last_ble_bytes = ble_tx_bytes;
+    last_text_bytes = 0;
+    last_telemetry_bytes = 0;
+}
+
+void telemetry_set_active(bool active) {
+    if (active == telemetry_active) return;
+    if (active) {
+        printf("\n📟 Binary telemetry on ('t' for text)\n");
+        fflush(stdout);
+    }
+    telemetry_active = active;
+    if (!active) {
+        printf("\n📟 Binary telemetry off, %lu frames, %lu KB of text muted\n",
+               (unsigned long)telemetry_stats.frames,
+               (unsigned long)(telemetry_stats.text_muted_bytes / 1024));
+    }
+}
+
+static void send_frame(TelemetryType type, const void* payload, uint8_t length) {
+    if (!telemetry_active || console_gate.port == nullptr) return;
+
+    uint8_t frame[TELEMETRY_OVERHEAD + 255];
+    frame[0] = TELEMETRY_SYNC0;
+    frame[1] = TELEMETRY_SYNC1;
+    frame[2] = type;
+    frame[3] = length;
+    frame[4] = sequence++;
+    memcpy(&frame[5], payload, length);
+
+    uint32_t crc = 0;
+    crc8.compute(&frame[2], 3 + length, &crc);
+    frame[5 + length] = (uint8_t)crc;
+
+    size_t total = TELEMETRY_OVERHEAD + length;
+    console_gate.port->write(frame, total);
+    telemetry_stats.frames++;
+    telemetry_stats.telemetry_bytes += total;
+}
+
+void telemetry_sample_read() {
+    if (!read_timer_started) {
+        read_timer.start();
+        read_timer_started = true;
+        last_read_us = 0;
+        return;
+    }
+    uint32_t now_us = (uint32_t)read_timer.elapsed_time().count();
+    uint32_t interval = now_us - last_read_us;
+    last_read_us = now_us;
+
+    float deviation = (float)interval - 1e6f / sensor_rate_hz;
+    reads++;
+    deviation_sum += deviation;
+    deviation_sum2 += deviation * deviation;
+    if (interval > interval_max) interval_max = interval;
+}
+
+void telemetry_window_begin() {
+    stage_timer.reset();
+    stage_timer.start();
+    stage_mark_us = 0;
+    memset(stage_us, 0, sizeof(stage_us));
+}
+
+void telemetry_stage(TelemetryStage stage) {
+    uint32_t now_us = (uint32_t)stage_timer.elapsed_time().count();
+    uint32_t us = now_us - stage_mark_us;
+    stage_us[stage] = (us > UINT16_MAX) ? UINT16_MAX : (uint16_t)us;
+    stage_mark_us = now_us;
+}
+
+void telemetry_window_end(const WindowResult& result, bool analysed) {
+    uint32_t total_us = (uint32_t)stage_timer.elapsed_time().count();
+    stage_timer.stop();
+    if (!telemetry_active) return;
+
+    TelemWindow w;
+    memset(&w, 0, sizeof(w));
+    w.window_index = result.window_index;
+    w.timestamp_ms = result.timestamp_ms;
+    w.std_mg = (uint16_t)(result.std_dev * 1000.0f);
+    w.tremor_freq_chz = (uint16_t)(result.tremor_freq * 100.0f);
+    w.tremor_intensity = result.tremor_intensity;
+    w.dysk_intensity = result.dysk_intensity;
+    w.brady_score = result.brady_score;
+    w.off_score = result.off_score;
+    w.raw_detection = result.raw_detection;
+    w.fog_state = result.fog_state;
+    w.quality_score = result.quality_score;
+    w.quality_flags = result.quality_flags;
+    w.motor_state = result.motor_state;
+    w.heel_strikes = result.heel_strikes;
+    w.steps = (result.steps > UINT8_MAX) ? UINT8_MAX : (uint8_t)result.steps;
+    w.night = night_mode_active ? 1 : 0;
+    send_frame(TELEM_WINDOW, &w, sizeof(w));
+
+    TelemStages st;
+    st.window_index = result.window_index;
+    memcpy(st.stage_us, stage_us, sizeof(st.stage_us));
+    st.total_us = (total_us > UINT16_MAX) ? UINT16_MAX : (uint16_t)total_us;
+    send_frame(TELEM_STAGES, &st, sizeof(st));
+
+    SpectroPacket packet;
+    if (analysed && spectro_packet(0, &packet)) {
+        send_frame(TELEM_SPECTRUM, &packet, sizeof(packet));
+    }
+}
+
+static uint16_t clamp16(uint32_t v) {
+    return (v > UINT16_MAX) ? UINT16_MAX : (uint16_t)v;
+}
+
+void telemetry_service(uint32_t now) {
+    uint32_t backlog = pending_samples;
+    if (backlog > backlog_max) backlog_max = clamp16(backlog);
+
+    uint32_t elapsed = now - last_health_ms;
+    if (elapsed < TELEMETRY_HEALTH_INTERVAL_MS) return;
+
+    uint32_t deferred = 0;
+    for (int id = 0; id < MULTIRES_JOBS; id++) deferred += multires_jobs[id].deferred;
+
+    TelemHealth h;
+    memset(&h, 0, sizeof(h));
+    h.uptime_ms = now;
+    h.sample_rate_chz = clamp16((uint32_t)(reads * 100000.0f / elapsed));
+    if (reads > 0) {
+        float mean = deviation_sum / reads;
+        float var = deviation_sum2 / reads - mean * mean;
+        h.interval_mean_us = clamp16((uint32_t)(1e6f / sensor_rate_hz + mean));
+        h.interval_std_us = clamp16((uint32_t)((var > 0.0f) ? sqrtf(var) : 0.0f));
+        h.interval_max_us = clamp16(interval_max);
+    }
+    h.isr_backlog_max = backlog_max;
+    h.flash_staging_used = clamp16(flash_log_ready ? FLASH_LOG_STAGING_SIZE - flash_log_staging_free() : 0);
+    h.multires_deferred = clamp16(deferred - last_deferred);
+    h.ble_tx_bytes = clamp16(ble_tx_bytes - last_ble_bytes);
+    h.text_bytes = clamp16(telemetry_stats.text_bytes - last_text_bytes);
+    h.telemetry_bytes = clamp16(telemetry_stats.telemetry_bytes - last_telemetry_bytes);
+    h.ble_connected = ble_connected ? 1 : 0;
+    h.night = night_mode_active ? 1 : 0;
+    send_frame(TELEM_HEALTH, &h, sizeof(h));
+
+    last_health_ms = now;
+    reads = 0;
+    deviation_sum = 0.0f;
+    deviation_sum2 = 0.0f;
+    interval_max = 0;
+    backlog_max = 0;
+    last_deferred = deferred;
+    last_ble_bytes = ble_tx_bytes;
+    last_text_bytes = telemetry_stats.text_bytes;
+    last_telemetry_bytes = telemetry_stats.telemetry_bytes;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file wavelet.cpp
+ * @brief Integer lifting wavelet transform for transient gait events
+ */
+
+#include "wavelet.h"
+#include "sensor.h"
+#include <cstring>
+
+PIPELINE_STATE WaveletResult wavelet_result = {};
+
+// Transformed copy of the window (coefficients interleaved in place)
+static PIPELINE_STATE int32_t coeffs[WINDOW_SIZE];
+
+void init_wavelet() {
+    wavelet_result = {};
+    memset(coeffs, 0, sizeof(coeffs));
+}
+
+// One lifting level over the n samples x[0], x[s], x[2s], ...
+static void lift_level(int32_t* x, size_t n, size_t s) {
+    if (n < 2) return;
+
+    // Predict: odd samples become details
+    for (size_t i = 1; i < n; i += 2) {
+        int32_t left = x[(i - 1) * s];
+        int32_t right = (i + 1 < n) ? x[(i + 1) * s] : left;
+        x[i * s] -= (left + right) >> 1;
+    }
+
+    // Update: even samples become the smoothed approximation
+    for (size_t i = 0; i < n; i += 2) {
+        int32_t left = (i > 0) ? x[(i - 1) * s] : x[s];
+        int32_t right = (i + 1 < n) ? x[(i + 1) * s] : left;
+        x[i * s] += (left + right + 2) >> 2;
+    }
+}
+
+void wavelet_forward(int32_t* x, size_t length, size_t levels) {
+    size_t n = length;
+    size_t s = 1;
+    for (size_t j = 0; j < levels && n >= 2; j++) {
+        lift_level(x, n, s);
+        n = (n + 1) / 2;
+        s *= 2;
+    }
+}
+
+// lift_level backwards: same neighbours, opposite sign, update before predict
+static void unlift_level(int32_t* x, size_t n, size_t s) {
+    if (n < 2) return;
+
+    for (size_t i = 0; i < n; i += 2) {
+        int32_t left = (i > 0) ? x[(i - 1) * s] : x[s];
+        int32_t right = (i + 1 < n) ? x[(i + 1) * s] : left;
+        x[i * s] -= (left + right + 2) >> 2;
+    }
+
+    for (size_t i = 1; i < n; i += 2) {
+        int32_t left = x[(i - 1) * s];
+        int32_t right = (i + 1 < n) ? x[(i + 1) * s] : left;
+        x[i * s] += (left + right) >> 1;
+    }
+}
+
+void wavelet_inverse(int32_t* x, size_t length, size_t levels) {
+    size_t n[WAVELET_LEVELS + 1];
+    size_t used = 0;
+    n[0] = length;
+    while (used < levels && used < WAVELET_LEVELS && n[used] >= 2) {
+        n[used + 1] = (n[used] + 1) / 2;
+        used++;
+    }
+    for (size_t j = used; j-- > 0;) {
+        unlift_level(x, n[j], (size_t)1 << j);
+    }
+}
+
+static int32_t abs32(int32_t v) {
+    return (v < 0) ? -v : v;
+}
+
+// Impulse strength on the d2 grid; the two d1 neighbours are added so a
+// strike counts the same whichever side of a d2 position it falls on
+static int32_t strike_strength(size_t pos) {
+    int32_t m = abs32(coeffs[pos]) + abs32(coeffs[pos - 1]);
+    if (pos + 1 < WINDOW_SIZE) m += abs32(coeffs[pos + 1]);
+    return m;
+}
+
+// Local maxima of the strength above the floor, spaced by the refractory period
+static void find_strikes(WaveletResult& r) {
+    const size_t s = (size_t)1 << (WAVELET_STRIKE_LEVEL - 1);
+    const int32_t floor_counts = (int32_t)(WAVELET_STRIKE_MIN_G / ACCEL_SCALE);
+    const size_t refractory = (size_t)(WAVELET_STRIKE_REFRACTORY_MS * TARGET_SAMPLE_RATE_HZ / 1000.0f);
+
+    r.strikes = 0;
+    size_t last = 0;
+    bool any = false;
+    for (size_t pos = s; pos < WINDOW_SIZE; pos += 2 * s) {
+        int32_t m = strike_strength(pos);
+        if (m < floor_counts) continue;
+        int32_t prev = (pos >= 3 * s) ? strike_strength(pos - 2 * s) : 0;
+        int32_t next = (pos + 2 * s < WINDOW_SIZE) ? strike_strength(pos + 2 * s) : 0;
+        if (m < prev || m <= next) continue;
+        if (any && pos - last < refractory) continue;
+        if (r.strikes < WAVELET_MAX_STRIKES) r.strike_offset[r.strikes++] = (uint16_t)pos;
+        last = pos;
+        any = true;
+    }
+}
+
+void wavelet_update_window(uint32_t current_time) {
+    WaveletResult& r = wavelet_result;
+
+    for (size_t i = 0; i < WINDOW_SIZE; i++) coeffs[i] = raw_imu_buffer[WAVELET_AXIS][i];
+    wavelet_forward(coeffs, WINDOW_SIZE, WAVELET_LEVELS);
+
+    // Mean squared detail per level
+    for (size_t j = 0; j < WAVELET_LEVELS; j++) {
+        const size_t s = (size_t)1 << j;
+        uint64_t sum = 0;
+        uint32_t count = 0;
+        for (size_t pos = s; pos < WINDOW_SIZE; pos += 2 * s) {
+            int64_t d = coeffs[pos];
+            sum += (uint64_t)(d * d);
+            count++;
+        }
+        const uint64_t mean = count ? sum / count : 0;
+        r.energy[j] = (mean > UINT32_MAX) ? UINT32_MAX : (uint32_t)mean;
+    }
+
+    float locomotor = (float)r.energy[3] + (float)r.energy[4];
+    r.freeze_index = (locomotor > 0.0f) ? r.energy[2] / locomotor : 0.0f;
+    const float band_floor = WAVELET_FREEZE_BAND_MIN_G / ACCEL_SCALE;
+    r.trembling = r.freeze_index >= WAVELET_FREEZE_INDEX_MIN &&
+                  (float)r.energy[2] >= band_floor * band_floor;
+
+    find_strikes(r);
+    if (r.strikes > 0) {
+        // Samples between the strike and now: rest of the window plus what arrived since
+        uint32_t age = (WINDOW_SIZE - r.strike_offset[r.strikes - 1]) + buffer_index;
+        r.last_strike_ms = current_time - (uint32_t)(age * 1000.0f / TARGET_SAMPLE_RATE_HZ);
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file window_functions.cpp
+ * @brief Analysis window library with compile-time coefficient tables
+ */
+
+#include "window_functions.h"
+#include "signal_processing.h"
+#include "multires.h"
+#include "zoom_fft.h"
+
+using window_detail::Table;
+using window_detail::make_table;
+
+// One window type at one length, evaluated at compile time; only the
+// instantiations window_get names are linked
+template <WindowType T, size_t N>
+struct WindowTable {
+    static constexpr Table<N> table = make_table<N>(T);
+
+    static WindowView view() {
+        return {table.coeffs, (uint16_t)N, table.sum, table.power};
+    }
+};
+
+template <WindowType T, size_t N>
+constexpr Table<N> WindowTable<T, N>::table;
+
+static const char* const WINDOW_NAMES[WINDOW_TYPES] = {
+    "rectangular", "Hann", "Hamming", "Blackman-Harris", "flat-top"
+};
+
+WindowView window_get(WindowType type, size_t length) {
+    // The window each stage is configured with, at its length
+    switch (length) {
+    case WINDOW_SIZE:
+        if (type == ANALYSIS_WINDOW) return WindowTable<ANALYSIS_WINDOW, WINDOW_SIZE>::view();
+        break;
+    case MULTIRES_SHORT_SAMPLES:
+        if (type == MULTIRES_SHORT_WINDOW) return WindowTable<MULTIRES_SHORT_WINDOW, MULTIRES_SHORT_SAMPLES>::view();
+        break;
+    case MULTIRES_LONG_SAMPLES:
+        if (type == MULTIRES_LONG_WINDOW) return WindowTable<MULTIRES_LONG_WINDOW, MULTIRES_LONG_SAMPLES>::view();
+        break;
+    case ZOOM_WINDOW_SAMPLES:
+        if (type == ZOOM_WINDOW) return WindowTable<ZOOM_WINDOW, ZOOM_WINDOW_SAMPLES>::view();
+        break;
+    default:
+        break;
+    }
+    return {nullptr, 0, 0.0f, 0.0f};
+}
+
+const char* window_name(WindowType type) {
+    return (type < WINDOW_TYPES) ? WINDOW_NAMES[type] : "?";
+}
@@ -0,0 +1,186 @@
+/**
+ * @file zoom_fft.cpp
+ * @brief Zoom spectrum of the 2-8 Hz region
+ */
+
+#include "zoom_fft.h"
+#include <cstring>
+
+PIPELINE_STATE float zoom_magnitude[ZOOM_FFT_SIZE];
+PIPELINE_STATE ZoomResult zoom_result = {};
+
+static const size_t ZOOM_MAX_DECIMATED = ZOOM_MAX_INPUT / ZOOM_DECIMATION;
+static const size_t ZOOM_SETTLE = ZOOM_TAPS / ZOOM_DECIMATION;   // decimated outputs still filling the FIR
+
+static_assert(2 * ZOOM_MAX_INPUT >= 2 * ZOOM_FFT_SIZE, "FFT buffer reuses the mixer outputs");
+
+static PIPELINE_STATE float fir_coeffs[ZOOM_TAPS];
+static PIPELINE_STATE float state_i[ZOOM_TAPS + ZOOM_FIR_BLOCK - 1];
+static PIPELINE_STATE float state_q[ZOOM_TAPS + ZOOM_FIR_BLOCK - 1];
+static PIPELINE_STATE arm_fir_decimate_instance_f32 decim_i;
+static PIPELINE_STATE arm_fir_decimate_instance_f32 decim_q;
+static PIPELINE_STATE arm_cfft_instance_f32 cfft;
+
+static PIPELINE_STATE float mix_cos[ZOOM_MIX_PERIOD];
+static PIPELINE_STATE float mix_sin[ZOOM_MIX_PERIOD];
+static PIPELINE_STATE WindowView dec_window;
+static PIPELINE_STATE bool zoom_ready = false;
+
+bool init_zoom_fft() {
+    const float pi = 3.14159265359f;
+
+    // Hamming-windowed sinc low-pass, cutoff between the 3 Hz half span
+    // and the 6.5 Hz Nyquist of the decimated rate
+    const float fc = 4.0f / TARGET_SAMPLE_RATE_HZ;
+    float sum = 0.0f;
+    for (size_t i = 0; i < ZOOM_TAPS; i++) {
+        float m = i - (ZOOM_TAPS - 1) / 2.0f;
+        float sinc = (fabsf(m) < 1e-6f) ? 2.0f * fc : sinf(2.0f * pi * fc * m) / (pi * m);
+        float hamming = 0.54f - 0.46f * cosf(2.0f * pi * i / (ZOOM_TAPS - 1));
+        fir_coeffs[i] = sinc * hamming;
+        sum += fir_coeffs[i];
+    }
+    arm_scale_f32(fir_coeffs, 1.0f / sum, fir_coeffs, ZOOM_TAPS);
+
+    // Mixer: multiply by exp(-j 2 pi fc n / fs); the table repeats, so it
+    // must hold whole cycles
+    float cycles = ZOOM_CENTER_HZ * ZOOM_MIX_PERIOD / TARGET_SAMPLE_RATE_HZ;
+    if (fabsf(cycles - roundf(cycles)) > 1e-4f) {
+        printf("❌ Zoom FFT init failed\n");
+        return false;
+    }
+    for (size_t i = 0; i < ZOOM_MIX_PERIOD; i++) {
+        float phase = 2.0f * pi * ZOOM_CENTER_HZ * i / TARGET_SAMPLE_RATE_HZ;
+        mix_cos[i] = cosf(phase);
+        mix_sin[i] = -sinf(phase);
+    }
+
+    if (arm_fir_decimate_init_f32(&decim_i, ZOOM_TAPS, ZOOM_DECIMATION, fir_coeffs,
+                                  state_i, ZOOM_FIR_BLOCK) != ARM_MATH_SUCCESS ||
+        arm_fir_decimate_init_f32(&decim_q, ZOOM_TAPS, ZOOM_DECIMATION, fir_coeffs,
+                                  state_q, ZOOM_FIR_BLOCK) != ARM_MATH_SUCCESS ||
+        arm_cfft_init_f32(&cfft, ZOOM_FFT_SIZE) != ARM_MATH_SUCCESS) {
+        printf("❌ Zoom FFT init failed\n");
+        return false;
+    }
+
+    memset(zoom_magnitude, 0, sizeof(zoom_magnitude));
+    zoom_result = {};
+    zoom_result.freq_res = TARGET_SAMPLE_RATE_HZ / ZOOM_DECIMATION / ZOOM_FFT_SIZE;
+    zoom_ready = true;
+    return true;
+}
+
+bool zoom_fft_compute(const float* input, size_t n, float* work) {
+    if (!zoom_ready || n > ZOOM_MAX_INPUT || n % ZOOM_DECIMATION != 0) return false;
+    if (n / ZOOM_DECIMATION <= ZOOM_SETTLE + 4) return false;
+
+    // Scratch: mixer outputs, later the FFT buffer, then the decimated I and Q
+    float* mixed_i = work;
+    float* mixed_q = work + ZOOM_MAX_INPUT;
+    float* cfft_buf = work;
+    float* dec_i = work + 2 * ZOOM_MAX_INPUT;
+    float* dec_q = dec_i + ZOOM_MAX_DECIMATED;
+
+    // Complex mix-down to baseband, one mixer period at a time
+    for (size_t i = 0; i < n; i += ZOOM_MIX_PERIOD) {
+        size_t len = (n - i < ZOOM_MIX_PERIOD) ? n - i : ZOOM_MIX_PERIOD;
+        arm_mult_f32(&input[i], mix_cos, &mixed_i[i], len);
+        arm_mult_f32(&input[i], mix_sin, &mixed_q[i], len);
+    }
+
+    // Low-pass and decimate I and Q from a clean filter state, in blocks
+    // that the state buffers are sized for
+    memset(state_i, 0, sizeof(state_i));
+    memset(state_q, 0, sizeof(state_q));
+    for (size_t i = 0; i < n; i += ZOOM_FIR_BLOCK) {
+        size_t len = (n - i < ZOOM_FIR_BLOCK) ? n - i : ZOOM_FIR_BLOCK;
+        arm_fir_decimate_f32(&decim_i, &mixed_i[i], &dec_i[i / ZOOM_DECIMATION], len);
+        arm_fir_decimate_f32(&decim_q, &mixed_q[i], &dec_q[i / ZOOM_DECIMATION], len);
+    }
+
+    // Drop the outputs produced while the FIR was filling, then window
+    const size_t m = n / ZOOM_DECIMATION - ZOOM_SETTLE;
+    if (m != dec_window.length) {
+        dec_window = window_get(ZOOM_WINDOW, m);
+        if (dec_window.coeffs == nullptr) return false;   // no table for this length
+    }
+
+    const float* w = dec_window.coeffs;
+    for (size_t i = 0; i < m; i++) {
+        cfft_buf[2 * i] = dec_i[ZOOM_SETTLE + i] * w[i];
+        cfft_buf[2 * i + 1] = dec_q[ZOOM_SETTLE + i] * w[i];
+    }
+    memset(&cfft_buf[2 * m], 0, 2 * (ZOOM_FFT_SIZE - m) * sizeof(float));
+
+    arm_cfft_f32(&cfft, cfft_buf, 0, 1);
+
+    // Reorder so index 0 is the lowest frequency; a real sine of amplitude A
+    // mixes to A/2, so scale by 2 / window sum for amplitude
+    const size_t half = ZOOM_FFT_SIZE / 2;
+    arm_cmplx_mag_f32(&cfft_buf[2 * half], zoom_magnitude, half);
+    arm_cmplx_mag_f32(cfft_buf, &zoom_magnitude[half], half);
+    arm_scale_f32(zoom_magnitude, 2.0f / dec_window.sum, zoom_magnitude, ZOOM_FFT_SIZE);
+
+    zoom_band_peak(3.0f, 5.0f, &zoom_result.tremor_amp, &zoom_result.tremor_freq);
+    zoom_band_peak(5.0f + zoom_result.freq_res, 7.0f, &zoom_result.dysk_amp, &zoom_result.dysk_freq);
+    return true;
+}
+
+void zoom_band_peak(float f_lo, float f_hi, float* amp, float* freq) {
+    const float res = TARGET_SAMPLE_RATE_HZ / ZOOM_DECIMATION / ZOOM_FFT_SIZE;
+    int lo = (int)ceilf((f_lo - ZOOM_CENTER_HZ) / res) + (int)(ZOOM_FFT_SIZE / 2);
+    int hi = (int)floorf((f_hi - ZOOM_CENTER_HZ) / res) + (int)(ZOOM_FFT_SIZE / 2);
+    if (lo < 0) lo = 0;
+    if (hi > (int)ZOOM_FFT_SIZE - 1) hi = ZOOM_FFT_SIZE - 1;
+
+    *amp = 0.0f;
+    *freq = 0.0f;
+    if (hi < lo) return;
+
+    uint32_t idx;
+    arm_max_f32(&zoom_magnitude[lo], hi - lo + 1, amp, &idx);
+    *freq = zoom_bin_freq(lo + idx);
+}
+
+#ifdef ZOOM_FFT_BENCHMARK
+void zoom_fft_benchmark() {
+    if (!zoom_ready) return;
+
+    const size_t RFFT_SIZE = 1024;
+    float* in = new float[RFFT_SIZE];
+    float* out = new float[RFFT_SIZE];
+    float* work = new float[ZOOM_WORK_FLOATS];
+    arm_rfft_fast_instance_f32 rfft;
+    arm_rfft_fast_init_f32(&rfft, RFFT_SIZE);
+
+    // 6 s of a 4.2 Hz test tone, zero padded for the real FFT
+    const float pi = 3.14159265359f;
+    for (size_t i = 0; i < RFFT_SIZE; i++) {
+        in[i] = (i < ZOOM_MAX_INPUT) ? sinf(2.0f * pi * 4.2f * i / TARGET_SAMPLE_RATE_HZ) : 0.0f;
+    }
+
+    Timer t;
+    t.start();
+    zoom_fft_compute(in, ZOOM_MAX_INPUT, work);
+    t.stop();
+    uint32_t zoom_us = (uint32_t)t.elapsed_time().count();
+    float zoom_freq = zoom_result.tremor_freq;
+
+    t.reset();
+    t.start();
+    arm_rfft_fast_f32(&rfft, in, out, 0);
+    arm_cmplx_mag_f32(&out[2], in, RFFT_SIZE / 2 - 1);
+    t.stop();
+    uint32_t rfft_us = (uint32_t)t.elapsed_time().count();
+
+    printf("✓ Zoom FFT 2-8 Hz: %lu us (%.3f Hz bins, test tone at %.2f Hz) vs 1024-pt rfft: %lu us\n",
+           (unsigned long)zoom_us, zoom_result.freq_res, zoom_freq, (unsigned long)rfft_us);
+
+    delete[] in;
+    delete[] out;
+    delete[] work;
+    zoom_result = {};
+    zoom_result.freq_res = TARGET_SAMPLE_RATE_HZ / ZOOM_DECIMATION / ZOOM_FFT_SIZE;
+}
+#endif
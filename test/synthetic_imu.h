@@ -0,0 +1,78 @@
+/**
+ * @file synthetic_imu.h
+ * @brief Synthetic raw LSM6DSL recordings shared by the native tests
+ *
+ * Forearm resting with gravity in the y-z plane, with optional rest tremor
+ * (roll about x plus the matching linear acceleration) and sensor noise
+ * from a fixed-seed generator, so every test run sees the same samples.
+ * Optional: a second harmonic on the roll, a steady roll rate under the
+ * tremor, a 1.2 Hz body sway on the accelerometer only, and a tremor-rate
+ * tone that only one sensor sees (a gyro artefact, or a vibration without
+ * rotation).
+ * Samples are interleaved int16 counts, ax ay az gx gy gz.
+ */
+
+#ifndef SYNTHETIC_IMU_H
+#define SYNTHETIC_IMU_H
+
+#include "config.h"
+#include <vector>
+
+struct SyntheticSegment {
+    float seconds;
+    float tremor_hz;
+    float tremor_dps;            // roll rate amplitude, 0 for rest
+    float roll_bias_dps = 0.0f;  // steady roll rate under the tremor
+    float sway_g = 0.0f;         // 1.2 Hz linear sway on y
+    float coupling_g_per_dps = 0.002f;   // tremor linear acceleration per dps
+    float harmonic = 0.0f;               // second harmonic, relative to the tremor amplitude
+    float gyro_artifact_dps = 0.0f;      // tone on gx that does not turn the forearm
+    float vibration_g = 0.0f;            // tone on y that does not turn the forearm
+};
+
+inline std::vector<int16_t> synthetic_recording(const SyntheticSegment* segments, size_t count,
+                                                uint32_t seed) {
+    const float pi = 3.14159265f;
+    std::vector<int16_t> out;
+    uint32_t state = seed * 2654435761u + 1u;
+    auto noise = [&state](float amplitude) {
+        state = state * 1664525u + 1013904223u;
+        return amplitude * ((float)(state >> 8) / 8388608.0f - 1.0f);
+    };
+
+    float roll = 0.3f;
+    size_t i = 0;
+    for (size_t s = 0; s < count; s++) {
+        const SyntheticSegment& seg = segments[s];
+        size_t n = (size_t)(seg.seconds * TARGET_SAMPLE_RATE_HZ);
+        for (size_t k = 0; k < n; k++, i++) {
+            float t = i / TARGET_SAMPLE_RATE_HZ;
+            float wave = sinf(2.0f * pi * seg.tremor_hz * t) + seg.harmonic * sinf(4.0f * pi * seg.tremor_hz * t);
+            float gx = seg.roll_bias_dps + seg.tremor_dps * wave + noise(1.0f);
+            roll += gx / TARGET_SAMPLE_RATE_HZ * pi / 180.0f;
+            gx += seg.gyro_artifact_dps * wave;
+            float ay = sinf(roll) + (seg.coupling_g_per_dps * seg.tremor_dps + seg.vibration_g) * wave +
+                       seg.sway_g * sinf(2.0f * pi * 1.2f * t);
+            float az = cosf(roll);
+            out.push_back((int16_t)noise(15.0f));
+            out.push_back((int16_t)(ay / ACCEL_SCALE));
+            out.push_back((int16_t)(az / ACCEL_SCALE));
+            out.push_back((int16_t)(gx / GYRO_SCALE));
+            out.push_back((int16_t)noise(50.0f));
+            out.push_back((int16_t)noise(50.0f));
+        }
+    }
+    return out;
+}
+
+// Rest and tremor alternating every minute
+inline std::vector<int16_t> synthetic_tremor_session(float minutes, uint32_t seed) {
+    std::vector<SyntheticSegment> segments;
+    for (float m = 0.0f; m < minutes; m += 1.0f) {
+        bool tremor = ((int)m % 2) == 1;
+        segments.push_back({60.0f, 4.8f, tremor ? 40.0f : 0.0f});
+    }
+    return synthetic_recording(segments.data(), segments.size(), seed);
+}
+
+#endif // SYNTHETIC_IMU_H
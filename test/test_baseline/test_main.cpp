@@ -0,0 +1,170 @@
+/**
+ * @file test_main.cpp
+ * @brief P² quantile accuracy, the bounds on personalised thresholds and
+ *        what the band sketches learn from
+ */
+
+#include <unity.h>
+#include "baseline.h"
+#include "detect_api.h"
+#include "signal_processing.h"
+#include "../synthetic_imu.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Fixed-seed uniform (0, 1)
+struct Lcg {
+    uint32_t state;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return ((state >> 8) + 0.5f) / 16777216.0f;
+    }
+};
+
+static float exact_quantile(std::vector<float> xs, float p) {
+    std::sort(xs.begin(), xs.end());
+    return xs[(size_t)(p * (xs.size() - 1) + 0.5f)];
+}
+
+// Estimate against the sorted sample, error relative to the 5-95 % spread
+static float p2_error(const std::vector<float>& xs, float p) {
+    P2Quantile q;
+    p2_init(&q, p);
+    for (float x : xs) p2_add(&q, x);
+    TEST_ASSERT_EQUAL_UINT32(xs.size(), q.count);
+    float spread = exact_quantile(xs, 0.95f) - exact_quantile(xs, 0.05f);
+    return fabsf(p2_value(&q) - exact_quantile(xs, p)) / spread;
+}
+
+static std::vector<float> sample(size_t n, uint32_t seed, float (*shape)(Lcg&)) {
+    Lcg rng = {seed};
+    std::vector<float> xs(n);
+    for (float& x : xs) x = shape(rng);
+    return xs;
+}
+
+static float uniform(Lcg& rng) { return rng.next(); }
+static float normal(Lcg& rng) {
+    return sqrtf(-2.0f * logf(rng.next())) * cosf(6.2831853f * rng.next());
+}
+static float lognormal(Lcg& rng) { return expf(0.8f * normal(rng)); }   // skewed, like band ratios
+
+void setUp(void) {
+    detect_reset();   // replay mode: nothing stored is loaded or saved
+}
+void tearDown(void) {}
+
+void test_p2_tracks_quantiles_of_several_shapes(void) {
+    const float ps[] = {0.10f, 0.50f, 0.95f};
+    float (*shapes[])(Lcg&) = {uniform, normal, lognormal};
+    for (auto shape : shapes) {
+        std::vector<float> xs = sample(20000, 7, shape);
+        for (float p : ps) TEST_ASSERT_LESS_THAN(0.01f, p2_error(xs, p));
+    }
+}
+
+void test_p2_converges_with_more_observations(void) {
+    std::vector<float> xs = sample(50000, 11, lognormal);
+    std::vector<float> head(xs.begin(), xs.begin() + 200);
+    TEST_ASSERT_LESS_THAN(0.10f, p2_error(head, 0.95f));
+    TEST_ASSERT_LESS_THAN(0.002f, p2_error(xs, 0.95f));
+}
+
+void test_p2_handles_sorted_input(void) {
+    // Worst case for marker movement: a monotone ramp
+    std::vector<float> xs(10000);
+    for (size_t i = 0; i < xs.size(); i++) xs[i] = (float)i;
+    TEST_ASSERT_LESS_THAN(0.005f, p2_error(xs, 0.10f));
+    std::reverse(xs.begin(), xs.end());
+    TEST_ASSERT_LESS_THAN(0.005f, p2_error(xs, 0.95f));
+}
+
+void test_p2_is_exact_before_five_observations(void) {
+    P2Quantile q;
+    p2_init(&q, 0.5f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.0f, p2_value(&q));
+    p2_add(&q, 3.0f);
+    p2_add(&q, 1.0f);
+    p2_add(&q, 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 2.0f, p2_value(&q));
+}
+
+void test_thresholds_stay_default_until_burn_in(void) {
+    for (uint32_t i = 0; i + 1 < BASELINE_BURN_IN_WINDOWS; i++) baseline_observe_spectrum(0.3f, 5.0f, 5.0f);
+    baseline_update(0);
+    TEST_ASSERT_FALSE(personal_thresholds.band_personal);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, TREMOR_THRESHOLD_FACTOR, personal_thresholds.tremor_factor);
+
+    baseline_observe_spectrum(0.3f, 5.0f, 5.0f);
+    baseline_update(0);
+    TEST_ASSERT_TRUE(personal_thresholds.band_personal);
+}
+
+void test_thresholds_are_bounded(void) {
+    // A quiet patient cannot loosen the defaults, a noisy one is capped
+    Lcg rng = {3};
+    for (uint32_t i = 0; i < BASELINE_BURN_IN_WINDOWS; i++) {
+        baseline_observe_spectrum(0.001f * rng.next(), 0.1f * rng.next(), 100.0f + rng.next());
+    }
+    baseline_update(0);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, NOISE_FLOOR_MIN, personal_thresholds.noise_floor_min);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, TREMOR_THRESHOLD_FACTOR, personal_thresholds.tremor_factor);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, DYSK_THRESHOLD_FACTOR * BASELINE_FACTOR_CAP, personal_thresholds.dysk_factor);
+}
+
+// Four hours of light movement with tremor in 40 % of the windows, 10-40
+// dps. The thresholds settle after the burn-in instead of climbing on
+// tremor windows they no longer detect
+void test_intermittent_tremor_does_not_ratchet_thresholds(void) {
+    Lcg rng = {5};
+    std::vector<SyntheticSegment> windows;
+    for (int w = 0; w < 240 * 20; w++) {
+        SyntheticSegment s = {3.0f, 4.8f, 0.0f};       // one 156-sample window
+        s.sway_g = 0.03f * (0.5f + rng.next());
+        if (rng.next() < 0.4f) s.tremor_dps = 10.0f + 30.0f * rng.next();
+        windows.push_back(s);
+    }
+    std::vector<int16_t> rec = synthetic_recording(windows.data(), windows.size(), 1);
+
+    float settled = 0.0f;
+    size_t after_burn_in = 0, detected_after_burn_in = 0, tremor_after_burn_in = 0;
+    size_t detected_last = 0, tremor_last = 0;
+    for (size_t w = 0; w < windows.size(); w++) {
+        const int16_t* axes[IMU_AXES];
+        for (size_t a = 0; a < IMU_AXES; a++) axes[a] = &rec[w * WINDOW_SIZE * IMU_AXES + a];
+        DetectWindow out;
+        TEST_ASSERT_EQUAL(1, detect_run(axes, IMU_AXES, WINDOW_SIZE,
+                                        (uint32_t)(w * WINDOW_SIZE * 1000 / TARGET_SAMPLE_RATE_HZ), &out, 1));
+        if (!personal_thresholds.band_personal) continue;
+        if (after_burn_in++ == 0) settled = personal_thresholds.tremor_factor;
+
+        // The hour after the burn-in against the last hour
+        const bool tremor = windows[w].tremor_dps > 0.0f;
+        const bool hit = out.raw_detection == DETECT_TREMOR;
+        if (after_burn_in <= 1200) {
+            tremor_after_burn_in += tremor;
+            detected_after_burn_in += tremor && hit;
+        } else if (w >= windows.size() - 1200) {
+            tremor_last += tremor;
+            detected_last += tremor && hit;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(1200, after_burn_in);
+    TEST_ASSERT_GREATER_THAN(TREMOR_THRESHOLD_FACTOR, settled);    // personal, above the default
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, settled, personal_thresholds.tremor_factor);
+    TEST_ASSERT_GREATER_THAN(0.9f * detected_after_burn_in / tremor_after_burn_in,
+                             (float)detected_last / tremor_last);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_p2_tracks_quantiles_of_several_shapes);
+    RUN_TEST(test_p2_converges_with_more_observations);
+    RUN_TEST(test_p2_handles_sorted_input);
+    RUN_TEST(test_p2_is_exact_before_five_observations);
+    RUN_TEST(test_thresholds_stay_default_until_burn_in);
+    RUN_TEST(test_thresholds_are_bounded);
+    RUN_TEST(test_intermittent_tremor_does_not_ratchet_thresholds);
+    return UNITY_END();
+}
@@ -0,0 +1,146 @@
+/**
+ * @file test_main.cpp
+ * @brief Still-window detection and the six-parameter accelerometer fit on
+ *        synthetic orientations with a known offset, scale and gyro bias
+ */
+
+#include <unity.h>
+#include "calibration.h"
+#include "detect_api.h"
+#include "sensor.h"
+#include <cmath>
+#include <cstring>
+
+// The sensor errors the windows are built with: measured = true / scale + offset
+static const float OFFSET_G[3] = {0.030f, -0.020f, 0.045f};
+static const float SCALE[3] = {1.020f, 0.970f, 1.010f};
+static const float GYRO_BIAS_DPS[3] = {1.50f, -0.80f, 0.40f};
+
+// Fixed-seed uniform (-1, 1)
+struct Lcg {
+    uint32_t state;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return ((state >> 8) + 0.5f) / 8388608.0f - 1.0f;
+    }
+};
+
+// One window held at gravity direction g (unit), with uniform noise of the
+// given peak on every accel (g) and gyro (dps) sample
+static void fill_window(const float g[3], float accel_noise_g, float gyro_noise_dps, Lcg& rng) {
+    for (size_t n = 0; n < WINDOW_SIZE; n++) {
+        for (int i = 0; i < 3; i++) {
+            float a = g[i] / SCALE[i] + OFFSET_G[i] + accel_noise_g * rng.next();
+            float w = GYRO_BIAS_DPS[i] + gyro_noise_dps * rng.next();
+            raw_imu_buffer[IMU_AX + i][n] = (int16_t)lrintf(a / ACCEL_SCALE);
+            raw_imu_buffer[IMU_GX + i][n] = (int16_t)lrintf(w / GYRO_SCALE);
+        }
+    }
+}
+
+// Icosahedron vertices: twelve directions 63° apart
+static void direction(int k, float g[3]) {
+    const float phi = 1.6180340f;
+    const float v[12][3] = {
+        {0, 1, phi}, {0, -1, phi}, {0, 1, -phi}, {0, -1, -phi},
+        {1, phi, 0}, {-1, phi, 0}, {1, -phi, 0}, {-1, -phi, 0},
+        {phi, 0, 1}, {-phi, 0, 1}, {phi, 0, -1}, {-phi, 0, -1},
+    };
+    float n = sqrtf(1.0f + phi * phi);
+    for (int i = 0; i < 3; i++) g[i] = v[k][i] / n;
+}
+
+void setUp(void) {
+    detect_reset();   // replay mode: starts uncalibrated, nothing is saved
+}
+void tearDown(void) {}
+
+void test_only_still_windows_are_used(void) {
+    Lcg rng = {1};
+    const float up[3] = {0.0f, 0.0f, 1.0f};
+
+    // Tremor-sized gyro noise, then an accelerometer that shakes
+    fill_window(up, 0.0005f, 2.0f, rng);
+    calibration_update_window(3000);
+    fill_window(up, 0.02f, 0.2f, rng);
+    calibration_update_window(6000);
+    TEST_ASSERT_EQUAL_UINT32(0, calibration.still_windows);
+    TEST_ASSERT_FALSE(calibration.gyro_valid);
+    TEST_ASSERT_EQUAL(0, calibration.orientations);
+
+    // At rest: the first window sets the bias, one direction is stored
+    fill_window(up, 0.0005f, 0.2f, rng);
+    calibration_update_window(9000);
+    TEST_ASSERT_EQUAL_UINT32(1, calibration.still_windows);
+    TEST_ASSERT_TRUE(calibration.gyro_valid);
+    TEST_ASSERT_EQUAL(1, calibration.orientations);
+    for (int i = 0; i < 3; i++) TEST_ASSERT_FLOAT_WITHIN(0.02f, GYRO_BIAS_DPS[i], calibration.gyro_bias[i]);
+    TEST_ASSERT_EQUAL_UINT32(9, calibration_age_s(18000));
+
+    // Learning off: a still window changes nothing
+    replay_learning = false;
+    fill_window(up, 0.0005f, 0.2f, rng);
+    calibration_update_window(12000);
+    TEST_ASSERT_EQUAL_UINT32(1, calibration.still_windows);
+}
+
+void test_fit_recovers_offset_and_scale(void) {
+    Lcg rng = {2};
+    uint32_t t = 0;
+    for (int k = 0; k < 12; k++) {
+        float g[3];
+        direction(k, g);
+        for (int w = 0; w < 3; w++) {
+            fill_window(g, 0.0005f, 0.2f, rng);
+            calibration_update_window(t += 3000);
+            TEST_ASSERT_EQUAL(k + 1 >= (int)CAL_MIN_ORIENTATIONS, calibration.accel_valid);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(36, calibration.still_windows);
+    TEST_ASSERT_EQUAL(12, calibration.orientations);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.002f, OFFSET_G[i], calibration.accel_offset[i]);
+        TEST_ASSERT_FLOAT_WITHIN(0.002f, SCALE[i], calibration.accel_scale[i]);
+        TEST_ASSERT_FLOAT_WITHIN(0.02f, GYRO_BIAS_DPS[i], calibration.gyro_bias[i]);
+    }
+    TEST_ASSERT_TRUE(calibration.accel_residual_g < 0.001f);
+
+    // The decode coefficients undo the errors: 1 g and no rotation
+    float g[3];
+    direction(5, g);
+    int16_t raw[IMU_AXES];
+    for (int i = 0; i < 3; i++) {
+        raw[IMU_AX + i] = (int16_t)lrintf((g[i] / SCALE[i] + OFFSET_G[i]) / ACCEL_SCALE);
+        raw[IMU_GX + i] = (int16_t)lrintf(GYRO_BIAS_DPS[i] / GYRO_SCALE);
+    }
+    float out[IMU_AXES];
+    calibration_apply(raw, out);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.003f, g[i], out[IMU_AX + i]);
+        TEST_ASSERT_FLOAT_WITHIN(0.03f, 0.0f, out[IMU_GX + i]);
+    }
+}
+
+// A fit outside the datasheet tolerances is not taken
+void test_fit_rejects_out_of_range_scale(void) {
+    Lcg rng = {3};
+    uint32_t t = 0;
+    for (int k = 0; k < 12; k++) {
+        float g[3];
+        direction(k, g);
+        for (int i = 0; i < 3; i++) g[i] *= 0.85f;      // a 0.85 g "gravity": scale 1.18
+        fill_window(g, 0.0005f, 0.2f, rng);
+        calibration_update_window(t += 3000);
+    }
+    TEST_ASSERT_TRUE(calibration.orientations >= CAL_MIN_ORIENTATIONS);    // the fit ran
+    TEST_ASSERT_FALSE(calibration.accel_valid);
+    for (int i = 0; i < 3; i++) TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, calibration.accel_scale[i]);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_only_still_windows_are_used);
+    RUN_TEST(test_fit_recovers_offset_and_scale);
+    RUN_TEST(test_fit_rejects_out_of_range_scale);
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+/**
+ * @file test_main.cpp
+ * @brief Pipeline snapshot and restore: equality, rebasing, restore tiers
+ */
+
+#include <unity.h>
+#include "checkpoint.h"
+#include "detect_api.h"
+#include "sensor.h"
+#include "../synthetic_imu.h"
+#include <cstring>
+
+static PipelineState saved, again;
+static PipelineHistory saved_history, again_history;
+
+// Replay a tremor session and return the time of its last sample
+static uint32_t replay_session(float minutes, uint32_t seed) {
+    std::vector<int16_t> rec = synthetic_tremor_session(minutes, seed);
+    const int16_t* axes[IMU_AXES];
+    for (size_t a = 0; a < IMU_AXES; a++) axes[a] = &rec[a];
+    size_t n = rec.size() / IMU_AXES;
+
+    detect_reset();
+    detect_run(axes, IMU_AXES, n, 1000, nullptr, 0);
+    return 1000 + (uint32_t)((n - 1) * 1000.0 / TARGET_SAMPLE_RATE_HZ);
+}
+
+// A fresh pipeline at the given sample count, as after a reboot
+static void fresh_pipeline(uint32_t samples) {
+    detect_reset();
+    sample_count = samples;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_restore_reproduces_the_snapshot(void) {
+    uint32_t now = replay_session(6, 1);
+    pipeline_snapshot(&saved, now);
+    pipeline_snapshot_history(&saved_history);
+    TEST_ASSERT_GREATER_THAN(0, saved.tremor_intensity);   // ends in a tremor minute
+
+    fresh_pipeline(saved.saved_sample);
+    pipeline_restore(&saved, RESTORE_FULL, now);
+    pipeline_restore_history(&saved_history);
+    pipeline_snapshot(&again, now);
+    pipeline_snapshot_history(&again_history);
+
+    TEST_ASSERT_EQUAL_MEMORY(&saved, &again, sizeof(saved));
+    TEST_ASSERT_EQUAL_MEMORY(&saved_history, &again_history, sizeof(saved_history));
+}
+
+void test_restore_rebases_times_and_samples(void) {
+    uint32_t now = replay_session(6, 2);
+    pipeline_snapshot(&saved, now);
+
+    // Resume later on a different clock and sample count
+    const uint32_t later = 5000, samples = 777;
+    fresh_pipeline(samples);
+    pipeline_restore(&saved, RESTORE_FULL, later);
+    pipeline_snapshot(&again, later);
+
+    TEST_ASSERT_EQUAL_UINT32(samples, again.saved_sample);
+    TEST_ASSERT_EQUAL_UINT16(saved.tremor_intensity, again.tremor_intensity);
+    TEST_ASSERT_EQUAL_MEMORY(&saved.detection, &again.detection, sizeof(saved.detection));
+    if (saved.motor.state_since_ms != 0) {
+        TEST_ASSERT_EQUAL_UINT32(saved.saved_ms - saved.motor.state_since_ms,
+                                 again.saved_ms - again.motor.state_since_ms);
+    } else {
+        TEST_ASSERT_EQUAL_UINT32(0, again.motor.state_since_ms);   // unset stays unset
+    }
+    for (size_t i = 0; i < EPISODE_TYPES; i++) {
+        const EpisodeTrack& a = saved.episodes[i];
+        const EpisodeTrack& b = again.episodes[i];
+        TEST_ASSERT_EQUAL_UINT32(saved.saved_sample - a.run_start_sample, again.saved_sample - b.run_start_sample);
+        TEST_ASSERT_EQUAL_UINT32(saved.saved_sample - a.last_match_end, again.saved_sample - b.last_match_end);
+        if (a.record.start_ms != 0) {
+            TEST_ASSERT_EQUAL_UINT32(saved.saved_ms - a.record.start_ms, again.saved_ms - b.record.start_ms);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(saved.saved_sample - saved.brady.last_cycle_end,
+                             again.saved_sample - again.brady.last_cycle_end);
+}
+
+void test_slow_restore_leaves_detectors_fresh(void) {
+    uint32_t now = replay_session(6, 3);
+    pipeline_snapshot(&saved, now);
+
+    fresh_pipeline(0);
+    PipelineState initial;
+    pipeline_snapshot(&initial, 0);
+    pipeline_restore(&saved, RESTORE_SLOW, 0);
+    pipeline_snapshot(&again, 0);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, saved.accel_baseline_ema, again.accel_baseline_ema);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, saved.fusion_accel_weight, again.fusion_accel_weight);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, saved.still_noise_lsb, again.still_noise_lsb);
+    TEST_ASSERT_EQUAL_MEMORY(&initial.detection, &again.detection, sizeof(initial.detection));
+    TEST_ASSERT_EQUAL_MEMORY(&initial.episodes, &again.episodes, sizeof(initial.episodes));
+    TEST_ASSERT_EQUAL_UINT16(0, again.tremor_intensity);
+
+    // RESTORE_NONE changes nothing
+    fresh_pipeline(0);
+    pipeline_restore(&saved, RESTORE_NONE, 0);
+    pipeline_snapshot(&again, 0);
+    TEST_ASSERT_EQUAL_MEMORY(&initial, &again, sizeof(initial));
+}
+
+void test_replay_snapshot_has_no_rtc_time(void) {
+    uint32_t now = replay_session(2, 4);
+    pipeline_snapshot(&saved, now);
+    TEST_ASSERT_EQUAL_UINT32(0, saved.saved_rtc);
+    TEST_ASSERT_EQUAL_UINT16(sizeof(PipelineState), saved.size);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_restore_reproduces_the_snapshot);
+    RUN_TEST(test_restore_rebases_times_and_samples);
+    RUN_TEST(test_slow_restore_leaves_detectors_fresh);
+    RUN_TEST(test_replay_snapshot_has_no_rtc_time);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_main.cpp
+ * @brief Chunked replay: same windows as a sequential run, reconciliation, learning off
+ */
+
+#include <unity.h>
+#include "detect_api.h"
+#include "checkpoint.h"
+#include "calibration.h"
+#include "baseline.h"
+#include "sensor.h"
+#include "../synthetic_imu.h"
+#include <cstring>
+
+static std::vector<int16_t> rec;
+static std::vector<DetectWindow> expected, actual;
+static PipelineState saved;
+static PipelineHistory saved_history;
+
+static size_t samples() { return rec.size() / IMU_AXES; }
+
+static void axes_of(const int16_t* axes[IMU_AXES], size_t first) {
+    for (size_t a = 0; a < IMU_AXES; a++) axes[a] = &rec[first * IMU_AXES + a];
+}
+
+// The reference: one thread, one pass, learning off
+static void sequential(size_t n) {
+    const int16_t* axes[IMU_AXES];
+    axes_of(axes, 0);
+    expected.assign(n / WINDOW_SIZE, DetectWindow());
+    detect_reset();
+    detect_set_learning(0);
+    detect_run(axes, IMU_AXES, n, 1000, expected.data(), expected.size());
+}
+
+static DetectChunkStats chunked(size_t n, size_t threads, size_t segment, size_t warmup) {
+    const int16_t* axes[IMU_AXES];
+    axes_of(axes, 0);
+    DetectChunking chunking = {threads, segment, warmup};
+    DetectChunkStats stats;
+    actual.assign(n / WINDOW_SIZE, DetectWindow());
+    size_t total = detect_run_chunked(axes, IMU_AXES, n, 1000, actual.data(), actual.size(),
+                                      &chunking, &stats);
+    TEST_ASSERT_EQUAL(n / WINDOW_SIZE, total);
+    return stats;
+}
+
+static void assert_same_windows(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_MEMORY(&expected[i], &actual[i], sizeof(DetectWindow));
+    }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_long_session_matches_sequential(void) {
+    rec = synthetic_tremor_session(720, 1);           // 12 h, 14400 windows
+    sequential(samples());
+    DetectChunkStats stats = chunked(samples(), 4, 2400, DETECT_CHUNK_WARMUP_WINDOWS);
+    TEST_ASSERT_EQUAL(6, stats.segments);
+    TEST_ASSERT_EQUAL(5, stats.reconciled);             // the warm-up converged everywhere
+    TEST_ASSERT_EQUAL(0, stats.replayed);
+    assert_same_windows(expected.size());
+}
+
+void test_replay_stops_at_the_workers_state(void) {
+    rec = synthetic_tremor_session(720, 1);
+    sequential(samples());
+    DetectChunkStats stats = chunked(samples(), 4, 2400, 100);
+    TEST_ASSERT_GREATER_THAN(0, stats.replayed);
+    TEST_ASSERT_LESS_THAN(stats.replayed * 2400, stats.replayed_windows);   // met a mark before the end
+    assert_same_windows(expected.size());
+}
+
+void test_short_warmup_is_replayed_and_still_matches(void) {
+    rec = synthetic_tremor_session(60, 2);
+    sequential(samples());
+    DetectChunkStats stats = chunked(samples(), 3, 200, 20);
+    TEST_ASSERT_EQUAL(6, stats.segments);
+    TEST_ASSERT_GREATER_THAN(0, stats.replayed);
+    TEST_ASSERT_EQUAL(stats.segments - 1, stats.reconciled + stats.replayed);
+    assert_same_windows(expected.size());
+}
+
+void test_uneven_lengths_and_short_output(void) {
+    rec = synthetic_tremor_session(30, 3);
+    const size_t n = samples() - 100;                 // trailing samples complete no window
+    sequential(n);
+    chunked(n, 2, 97, 30);
+    assert_same_windows(expected.size());
+
+    // Only max_out windows are written, the count is still the whole recording
+    const int16_t* axes[IMU_AXES];
+    axes_of(axes, 0);
+    DetectChunking chunking = {2, 97, 30};
+    std::vector<DetectWindow> few(150);
+    size_t total = detect_run_chunked(axes, IMU_AXES, n, 1000, few.data(), few.size(), &chunking, nullptr);
+    TEST_ASSERT_EQUAL(expected.size(), total);
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), few.data(), few.size() * sizeof(DetectWindow));
+
+    // One segment is a plain sequential run
+    DetectChunkStats stats = chunked(n, 1, 0, 0);
+    TEST_ASSERT_EQUAL(1, stats.segments);
+    assert_same_windows(expected.size());
+}
+
+void test_resume_at_a_window_boundary_is_exact(void) {
+    rec = synthetic_tremor_session(20, 4);
+    sequential(samples());
+
+    // First half, then a fresh pipeline seeded from its snapshot
+    const size_t half = (expected.size() / 2) * WINDOW_SIZE;
+    const int16_t* axes[IMU_AXES];
+    axes_of(axes, 0);
+    detect_reset();
+    detect_set_learning(0);
+    detect_run(axes, IMU_AXES, half, 1000, nullptr, 0);
+    uint32_t now = 1000 + (uint32_t)((half - 1) * 1000.0 / TARGET_SAMPLE_RATE_HZ);
+    pipeline_snapshot(&saved, now);
+    pipeline_snapshot_history(&saved_history);
+
+    // The way detect_run_chunked continues a segment that failed to reconcile
+    detect_reset();
+    detect_set_learning(0);
+    sample_count = (uint32_t)half;
+    window_count = (uint32_t)(half / WINDOW_SIZE);
+    last_sample_time_ms = now;
+    pipeline_restore(&saved, RESTORE_FULL, now);
+    pipeline_restore_history(&saved_history);
+    axes_of(axes, half);
+    std::vector<DetectWindow> rest(expected.size() - half / WINDOW_SIZE);
+    detect_run(axes, IMU_AXES, samples() - half, 1000 + (uint32_t)(half * 1000.0 / TARGET_SAMPLE_RATE_HZ),
+               rest.data(), rest.size());
+    TEST_ASSERT_EQUAL_MEMORY(&expected[half / WINDOW_SIZE], rest.data(), rest.size() * sizeof(DetectWindow));
+}
+
+void test_learning_off_leaves_calibration_and_baseline(void) {
+    rec = synthetic_tremor_session(10, 5);
+    const int16_t* axes[IMU_AXES];
+    axes_of(axes, 0);
+
+    detect_reset();
+    detect_run(axes, IMU_AXES, samples(), 1000, nullptr, 0);
+    TEST_ASSERT_GREATER_THAN(0, calibration.still_windows);    // learning on: rest windows count
+
+    detect_reset();
+    detect_set_learning(0);
+    detect_run(axes, IMU_AXES, samples(), 1000, nullptr, 0);
+    TEST_ASSERT_EQUAL(0, calibration.still_windows);
+    TEST_ASSERT_FALSE(calibration.gyro_valid);
+    baseline_observe_spectrum(1.0f, 2.0f, 2.0f);
+    baseline_observe_gait(0.1f);
+    for (size_t m = 0; m < BASELINE_METRICS; m++) TEST_ASSERT_EQUAL(0, baseline_sketch[m].count);
+
+    // detect_reset turns it back on
+    detect_reset();
+    baseline_observe_spectrum(1.0f, 2.0f, 2.0f);
+    TEST_ASSERT_EQUAL(1, baseline_sketch[BASELINE_NOISE_FLOOR].count);
+    detect_run(axes, IMU_AXES, samples(), 1000, nullptr, 0);
+    TEST_ASSERT_GREATER_THAN(0, calibration.still_windows);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_long_session_matches_sequential);
+    RUN_TEST(test_replay_stops_at_the_workers_state);
+    RUN_TEST(test_short_warmup_is_replayed_and_still_matches);
+    RUN_TEST(test_uneven_lengths_and_short_output);
+    RUN_TEST(test_resume_at_a_window_boundary_is_exact);
+    RUN_TEST(test_learning_off_leaves_calibration_and_baseline);
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_main.cpp
+ * @brief Flash log on a file-backed NOR stand-in: remount, wrap, torn tail
+ */
+
+#include <unity.h>
+#include "flash_log.h"
+#include "FileBlockDevice.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const char* const PATH = "test_flash_log.bin";
+static const bd_size_t SEGMENTS = 8;
+
+struct Payload {
+    uint32_t id;
+    uint8_t fill[FLASH_LOG_MAX_PAYLOAD - sizeof(uint32_t)];
+};
+
+static Payload payload;
+static FileBlockDevice bd(PATH, SEGMENTS * FLASH_LOG_SEGMENT_SIZE);
+
+static size_t length_of(uint32_t id) {
+    return sizeof(uint32_t) + (id * 37) % 600;       // 4..603 bytes, most not a multiple of 4
+}
+
+static void make(uint32_t id) {
+    payload.id = id;
+    for (size_t i = 0; i < sizeof(payload.fill); i++) payload.fill[i] = (uint8_t)(id + i * 7);
+}
+
+// Producers never block; a test that outruns the writer waits for room instead
+static void append(uint32_t id) {
+    make(id);
+    const size_t need = 2 * (sizeof(FlashRecordHeader) + FLASH_LOG_MAX_PAYLOAD);
+    while (flash_log_staging_free() < need) ThisThread::sleep_for(std::chrono::milliseconds(1));
+    TEST_ASSERT_TRUE(flash_log_append(FLASH_REC_WINDOW, 0, &payload, length_of(id)));
+}
+
+// Ids of every stored record, oldest first, each payload checked
+static std::vector<uint32_t> read_back() {
+    std::vector<uint32_t> ids;
+    static Payload got;
+    FlashLogCursor cursor;
+    FlashRecordHeader hdr;
+    flash_log_rewind(&cursor);
+    int n;
+    while ((n = flash_log_next(&cursor, &hdr, &got, sizeof(got))) > 0) {
+        TEST_ASSERT_EQUAL(FLASH_REC_WINDOW, hdr.type);
+        TEST_ASSERT_EQUAL(length_of(got.id), n);
+        make(got.id);
+        TEST_ASSERT_EQUAL_MEMORY(&payload, &got, n);
+        ids.push_back(got.id);
+    }
+    TEST_ASSERT_EQUAL(0, n);
+    return ids;
+}
+
+static void assert_consecutive(const std::vector<uint32_t>& ids, uint32_t first, uint32_t end) {
+    TEST_ASSERT_EQUAL(end - first, ids.size());
+    for (size_t i = 0; i < ids.size(); i++) TEST_ASSERT_EQUAL(first + i, ids[i]);
+}
+
+void setUp(void) {
+    remove(PATH);
+}
+
+void tearDown(void) {
+    deinit_flash_log();
+    bd.deinit();
+    remove(PATH);
+}
+
+void test_nor_semantics(void) {
+    FileBlockDevice small(PATH, 4 * 4096);
+    TEST_ASSERT_EQUAL(0, small.init());
+
+    uint8_t cells[8];
+    TEST_ASSERT_EQUAL(0, small.read(cells, 4096, sizeof(cells)));
+    for (uint8_t c : cells) TEST_ASSERT_EQUAL_HEX8(0xFF, c);
+
+    // Programming only clears bits
+    const uint8_t first[8] = {0xF0, 0x0F, 0xAA, 0x55, 0x00, 0xFF, 0x12, 0x34};
+    const uint8_t second[8] = {0xFF, 0xFF, 0x0F, 0x0F, 0xFF, 0x00, 0xFF, 0xFF};
+    TEST_ASSERT_EQUAL(0, small.program(first, 4096, 8));
+    TEST_ASSERT_EQUAL(0, small.program(second, 4096, 8));
+    TEST_ASSERT_EQUAL(0, small.read(cells, 4096, 8));
+    for (int i = 0; i < 8; i++) TEST_ASSERT_EQUAL_HEX8(first[i] & second[i], cells[i]);
+
+    // Whole, aligned blocks only
+    TEST_ASSERT_NOT_EQUAL(0, small.erase(4096 + 512, 4096));
+    TEST_ASSERT_NOT_EQUAL(0, small.erase(4096, 100));
+    TEST_ASSERT_NOT_EQUAL(0, small.read(cells, 4 * 4096 - 4, 8));
+    TEST_ASSERT_EQUAL(0, small.erase(4096, 4096));
+    TEST_ASSERT_EQUAL(0, small.read(cells, 4096, 8));
+    for (uint8_t c : cells) TEST_ASSERT_EQUAL_HEX8(0xFF, c);
+
+    // Contents outlive the mount
+    TEST_ASSERT_EQUAL(0, small.program(first, 0, 8));
+    small.deinit();
+    FileBlockDevice again(PATH, 4 * 4096);
+    TEST_ASSERT_EQUAL(0, again.init());
+    TEST_ASSERT_EQUAL(0, again.read(cells, 0, 8));
+    TEST_ASSERT_EQUAL_MEMORY(first, cells, 8);
+}
+
+void test_records_survive_a_remount(void) {
+    TEST_ASSERT_TRUE(init_flash_log(&bd));
+    TEST_ASSERT_EQUAL(SEGMENTS, flash_log_stats.segments);
+    TEST_ASSERT_EQUAL(0, flash_log_stats.scan_records);
+    for (uint32_t id = 0; id < 100; id++) append(id);
+    deinit_flash_log();
+    TEST_ASSERT_EQUAL(100, flash_log_stats.records_written);
+    TEST_ASSERT_EQUAL(0, flash_log_stats.records_dropped);
+
+    // 100 records fit one segment: the scan walks all of them
+    TEST_ASSERT_TRUE(init_flash_log(&bd));
+    TEST_ASSERT_EQUAL(100, flash_log_stats.scan_records);
+    assert_consecutive(read_back(), 0, 100);
+
+    // Appends continue behind them
+    for (uint32_t id = 100; id < 150; id++) append(id);
+    deinit_flash_log();
+    TEST_ASSERT_TRUE(init_flash_log(&bd));
+    TEST_ASSERT_EQUAL(150, flash_log_stats.scan_records);
+    assert_consecutive(read_back(), 0, 150);
+}
+
+void test_wrap_reclaims_the_oldest_and_levels_wear(void) {
+    TEST_ASSERT_TRUE(init_flash_log(&bd));
+    const uint32_t total = 6000;                     // ~1.8 MB through 512 KB, the log wraps 3 times
+    for (uint32_t id = 0; id < total; id++) append(id);
+    deinit_flash_log();
+    TEST_ASSERT_EQUAL(total, flash_log_stats.records_written);
+    TEST_ASSERT_EQUAL(0, flash_log_stats.records_dropped);
+
+    TEST_ASSERT_TRUE(init_flash_log(&bd));
+    std::vector<uint32_t> ids = read_back();
+    TEST_ASSERT_GREATER_THAN(0, ids.front());        // the oldest were reclaimed
+    assert_consecutive(ids, ids.front(), total);     // with no gap behind them
+    TEST_ASSERT_GREATER_OR_EQUAL(3, flash_log_stats.min_erase_count);
+    TEST_ASSERT_LESS_OR_EQUAL(1, flash_log_stats.max_erase_count - flash_log_stats.min_erase_count);
+}
+
+void test_torn_tail_seals_the_segment(void) {
+    TEST_ASSERT_TRUE(init_flash_log(&bd));
+    for (uint32_t id = 0; id < 20; id++) append(id);
+    uint16_t active = flash_log_stats.active_segment;
+    deinit_flash_log();
+
+    // A power cut mid-header: a record header with a length no record has
+    uint32_t end = sizeof(FlashSegmentHeader);
+    for (uint32_t id = 0; id < 20; id++) end += sizeof(FlashRecordHeader) + ((length_of(id) + 3) & ~3u);
+    FlashRecordHeader torn = {FLASH_RECORD_MAGIC, FLASH_REC_WINDOW, 0, 0xFFFF, 0xFFFF, 0xFFFFFFFF};
+    TEST_ASSERT_EQUAL(0, bd.init());
+    TEST_ASSERT_EQUAL(0, bd.program(&torn, (bd_addr_t)active * FLASH_LOG_SEGMENT_SIZE + end, sizeof(torn)));
+    bd.deinit();
+
+    TEST_ASSERT_TRUE(init_flash_log(&bd));
+    TEST_ASSERT_EQUAL(20, flash_log_stats.scan_records);
+    for (uint32_t id = 20; id < 30; id++) append(id);
+    deinit_flash_log();
+
+    // The next append opened a fresh segment; nothing was lost on either side
+    TEST_ASSERT_TRUE(init_flash_log(&bd));
+    TEST_ASSERT_NOT_EQUAL(active, flash_log_stats.active_segment);
+    TEST_ASSERT_EQUAL(10, flash_log_stats.scan_records);
+    assert_consecutive(read_back(), 0, 30);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_nor_semantics);
+    RUN_TEST(test_records_survive_a_remount);
+    RUN_TEST(test_wrap_reclaims_the_oldest_and_levels_wear);
+    RUN_TEST(test_torn_tail_seals_the_segment);
+    return UNITY_END();
+}
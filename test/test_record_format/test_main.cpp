@@ -0,0 +1,245 @@
+/**
+ * @file test_main.cpp
+ * @brief IMU blocks, window records and window blocks: round trip,
+ *        statistics, validation
+ */
+
+#include <unity.h>
+#include "record_format.h"
+#include "../synthetic_imu.h"
+#include <cstring>
+#include <vector>
+
+static const uint16_t BLOCK = WINDOW_SIZE;
+
+// One block of SoA columns cut from an interleaved recording
+struct Columns {
+    int16_t data[IMU_AXES][BLOCK];
+    const int16_t* ptr[IMU_AXES];
+
+    Columns(const std::vector<int16_t>& rec, size_t first) {
+        for (size_t a = 0; a < IMU_AXES; a++) {
+            for (size_t i = 0; i < BLOCK; i++) data[a][i] = rec[(first + i) * IMU_AXES + a];
+            ptr[a] = data[a];
+        }
+    }
+};
+
+alignas(4) static uint8_t buffer[2 * imu_block_max_size(BLOCK)];
+
+static void assert_round_trip(const Columns& cols, const ImuBlockHeader* hdr) {
+    int16_t decoded[BLOCK];
+    for (int a = 0; a < IMU_AXES; a++) {
+        TEST_ASSERT_TRUE(imu_block_decode_column(hdr, (ImuAxis)a, decoded));
+        TEST_ASSERT_EQUAL_INT16_ARRAY(cols.data[a], decoded, BLOCK);
+    }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_raw_block_round_trips_zero_copy(void) {
+    Columns cols(synthetic_tremor_session(2, 1), 52 * 70);
+    size_t size = imu_block_encode(cols.ptr, BLOCK, 52 * 70, 70000, false, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL(imu_block_max_size(BLOCK) - IMU_AXES * 2, size);
+    TEST_ASSERT_EQUAL(0, size % 4);
+
+    const ImuBlockHeader* hdr = imu_block_view(buffer, size);
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT_EQUAL(size, imu_block_size(hdr));
+    TEST_ASSERT_EQUAL_UINT32(52 * 70, hdr->first_sample);
+    TEST_ASSERT_EQUAL_UINT32(70000, hdr->timestamp_ms);
+    assert_round_trip(cols, hdr);
+
+    for (int a = 0; a < IMU_AXES; a++) {
+        const int16_t* col = imu_block_column(hdr, (ImuAxis)a);
+        TEST_ASSERT_TRUE(col >= (const int16_t*)buffer && col < (const int16_t*)(buffer + size));
+        TEST_ASSERT_EQUAL_INT16_ARRAY(cols.data[a], col, BLOCK);
+    }
+}
+
+void test_compressed_block_is_lossless_and_smaller(void) {
+    // Rest: small deltas everywhere except the noisy gyro axes
+    Columns cols(synthetic_tremor_session(1, 2), 0);
+    for (size_t i = 0; i < BLOCK; i++) cols.data[IMU_GY][i] = (int16_t)(i / 4);
+
+    size_t raw = imu_block_encode(cols.ptr, BLOCK, 0, 0, false, buffer, sizeof(buffer));
+    size_t packed = imu_block_encode(cols.ptr, BLOCK, 0, 0, true, buffer, sizeof(buffer));
+    TEST_ASSERT_LESS_THAN(raw, packed);
+
+    const ImuBlockHeader* hdr = imu_block_view(buffer, packed);
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT_EQUAL_UINT8(COLUMN_DELTA8, hdr->encoding[IMU_AX]);
+    TEST_ASSERT_EQUAL_UINT8(COLUMN_DELTA8, hdr->encoding[IMU_GY]);
+    TEST_ASSERT_NULL(imu_block_column(hdr, IMU_GY));
+    assert_round_trip(cols, hdr);
+}
+
+void test_delta_overflow_falls_back_to_raw(void) {
+    Columns cols(synthetic_tremor_session(1, 3), 0);
+    for (size_t i = 0; i < BLOCK; i++) cols.data[IMU_AZ][i] = (i & 1) ? 32767 : -32768;
+
+    size_t size = imu_block_encode(cols.ptr, BLOCK, 0, 0, true, buffer, sizeof(buffer));
+    const ImuBlockHeader* hdr = imu_block_view(buffer, size);
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT_EQUAL_UINT8(COLUMN_RAW16, hdr->encoding[IMU_AZ]);
+    TEST_ASSERT_EQUAL_INT16(-32768, hdr->stats[IMU_AZ].min);
+    TEST_ASSERT_EQUAL_INT16(32767, hdr->stats[IMU_AZ].max);
+    assert_round_trip(cols, hdr);
+}
+
+void test_column_stats_bound_every_sample(void) {
+    Columns cols(synthetic_tremor_session(2, 4), 52 * 60);
+    size_t size = imu_block_encode(cols.ptr, BLOCK, 0, 0, true, buffer, sizeof(buffer));
+    const ImuBlockHeader* hdr = imu_block_view(buffer, size);
+    TEST_ASSERT_NOT_NULL(hdr);
+
+    for (int a = 0; a < IMU_AXES; a++) {
+        int16_t lo = cols.data[a][0], hi = cols.data[a][0];
+        for (size_t i = 1; i < BLOCK; i++) {
+            if (cols.data[a][i] < lo) lo = cols.data[a][i];
+            if (cols.data[a][i] > hi) hi = cols.data[a][i];
+        }
+        TEST_ASSERT_EQUAL_INT16(lo, hdr->stats[a].min);
+        TEST_ASSERT_EQUAL_INT16(hi, hdr->stats[a].max);
+    }
+}
+
+void test_consecutive_blocks_walk_in_place(void) {
+    std::vector<int16_t> rec = synthetic_tremor_session(2, 5);
+    Columns first(rec, 0), second(rec, BLOCK);
+    size_t a = imu_block_encode(first.ptr, BLOCK, 0, 0, true, buffer, sizeof(buffer));
+    size_t b = imu_block_encode(second.ptr, BLOCK, BLOCK, 3000, true, buffer + a, sizeof(buffer) - a);
+    TEST_ASSERT_NOT_EQUAL(0, b);
+
+    const ImuBlockHeader* hdr = imu_block_view(buffer, a + b);
+    TEST_ASSERT_NOT_NULL(hdr);
+    hdr = imu_block_view(buffer + imu_block_size(hdr), a + b - imu_block_size(hdr));
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT_EQUAL_UINT32(BLOCK, hdr->first_sample);
+    assert_round_trip(second, hdr);
+}
+
+void test_view_rejects_damaged_blocks(void) {
+    Columns cols(synthetic_tremor_session(1, 6), 0);
+    size_t size = imu_block_encode(cols.ptr, BLOCK, 0, 0, true, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL(0, imu_block_encode(cols.ptr, BLOCK, 0, 0, false, buffer + size, 64));
+
+    TEST_ASSERT_NULL(imu_block_view(buffer, size - 4));
+    TEST_ASSERT_NULL(imu_block_view(buffer + 2, size));
+
+    ImuBlockHeader* hdr = (ImuBlockHeader*)buffer;
+    hdr->encoding[IMU_GX] = 7;
+    TEST_ASSERT_NULL(imu_block_view(buffer, size));
+    hdr->encoding[IMU_GX] = COLUMN_RAW16;
+    hdr->column_offset[IMU_GX] = hdr->payload_bytes;
+    TEST_ASSERT_NULL(imu_block_view(buffer, size));
+    hdr->magic ^= 1;
+    TEST_ASSERT_NULL(imu_block_view(buffer, size));
+}
+
+void test_window_record_fixed_point_fields(void) {
+    WindowResult r;
+    memset(&r, 0, sizeof(r));
+    r.window_index = 42;
+    r.start_sample = 42 * WINDOW_SIZE;
+    r.tremor_freq = 4.806f;
+    r.raw_intensity = 0.4567f;
+    r.tremor_intensity = 512;
+    r.raw_detection = DETECT_TREMOR;
+    r.quality_flags = 0x05;
+
+    WindowRecord rec;
+    window_record_from_result(r, &rec);
+    TEST_ASSERT_EQUAL_UINT32(WINDOW_RECORD_MAGIC, rec.magic);
+    TEST_ASSERT_EQUAL_UINT32(42, rec.window_index);
+    TEST_ASSERT_EQUAL_UINT32(42 * WINDOW_SIZE, rec.start_sample);
+    TEST_ASSERT_EQUAL_UINT16(481, rec.tremor_freq_chz);
+    TEST_ASSERT_EQUAL_UINT16(457, rec.raw_intensity_milli);
+    TEST_ASSERT_EQUAL_UINT16(512, rec.tremor_intensity);
+    TEST_ASSERT_EQUAL_UINT8(1, rec.raw_detection);
+    TEST_ASSERT_EQUAL_UINT8(0x05, rec.flags);
+}
+
+void test_block_sample_count_fits_the_header(void) {
+    // Ramps: every delta fits DELTA8, but RAW16 is the bound that matters
+    std::vector<int16_t> col(IMU_BLOCK_MAX_SAMPLES + 1);
+    for (size_t i = 0; i < col.size(); i++) col[i] = (int16_t)(i * 300);
+    const int16_t* ptr[IMU_AXES];
+    for (size_t a = 0; a < IMU_AXES; a++) ptr[a] = col.data();
+
+    std::vector<uint32_t> out(imu_block_max_size(IMU_BLOCK_MAX_SAMPLES + 1) / 4 + 1);
+    uint8_t* bytes = (uint8_t*)out.data();
+    TEST_ASSERT_EQUAL(0, imu_block_encode(ptr, IMU_BLOCK_MAX_SAMPLES + 1, 0, 0, false, bytes, out.size() * 4));
+
+    size_t size = imu_block_encode(ptr, IMU_BLOCK_MAX_SAMPLES, 0, 0, false, bytes, out.size() * 4);
+    TEST_ASSERT_NOT_EQUAL(0, size);
+    const ImuBlockHeader* hdr = imu_block_view(bytes, size);
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT_EQUAL(size, imu_block_size(hdr));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(col.data(), imu_block_column(hdr, IMU_GZ), IMU_BLOCK_MAX_SAMPLES);
+}
+
+void test_window_block_regroups_records(void) {
+    const uint16_t n = 50;
+    std::vector<WindowRecord> records(n);
+    for (uint16_t i = 0; i < n; i++) {
+        WindowResult r;
+        memset(&r, 0, sizeof(r));
+        r.window_index = 100 + i;
+        r.start_sample = (100 + i) * WINDOW_SIZE;
+        r.std_dev = 0.01f * i;
+        r.tremor_freq = 4.0f + 0.02f * i;
+        r.tremor_intensity = (uint16_t)(20 * i);
+        r.raw_detection = (i % 3 == 0) ? DETECT_TREMOR : DETECT_NONE;
+        r.quality_flags = (uint8_t)i;
+        window_record_from_result(r, &records[i]);
+    }
+
+    std::vector<uint32_t> out(window_block_size(n) / 4);
+    uint8_t* bytes = (uint8_t*)out.data();
+    TEST_ASSERT_EQUAL(0, window_block_encode(records.data(), n, bytes, out.size() * 4 - 4));
+    size_t size = window_block_encode(records.data(), n, bytes, out.size() * 4);
+    TEST_ASSERT_EQUAL(window_block_size(n), size);
+    TEST_ASSERT_EQUAL(0, size % 4);
+
+    const WindowBlockHeader* hdr = window_block_view(bytes, size);
+    TEST_ASSERT_NOT_NULL(hdr);
+    TEST_ASSERT_EQUAL_UINT32(100, hdr->first_window);
+
+    // Columns in place, at their WindowRecord types
+    const uint16_t* intensity = (const uint16_t*)window_block_column(hdr, WINDOW_FIELD_TREMOR_INTENSITY);
+    const float* std_dev = (const float*)window_block_column(hdr, WINDOW_FIELD_STD_DEV);
+    const uint8_t* flags = (const uint8_t*)window_block_column(hdr, WINDOW_FIELD_FLAGS);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)std_dev & 3);
+    for (uint16_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_UINT16(records[i].tremor_intensity, intensity[i]);
+        TEST_ASSERT_FLOAT_WITHIN(0.0f, records[i].std_dev, std_dev[i]);
+        TEST_ASSERT_EQUAL_UINT8(records[i].flags, flags[i]);
+
+        WindowRecord back;
+        TEST_ASSERT_TRUE(window_block_record(hdr, i, &back));
+        TEST_ASSERT_EQUAL(0, memcmp(&records[i], &back, sizeof(back)));
+    }
+    WindowRecord back;
+    TEST_ASSERT_FALSE(window_block_record(hdr, n, &back));
+
+    TEST_ASSERT_NULL(window_block_view(bytes, size - 4));
+    TEST_ASSERT_NULL(window_block_view(bytes + 2, size));
+    ((WindowBlockHeader*)bytes)->field_count = WINDOW_FIELDS + 1;
+    TEST_ASSERT_NULL(window_block_view(bytes, size));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_raw_block_round_trips_zero_copy);
+    RUN_TEST(test_compressed_block_is_lossless_and_smaller);
+    RUN_TEST(test_delta_overflow_falls_back_to_raw);
+    RUN_TEST(test_column_stats_bound_every_sample);
+    RUN_TEST(test_consecutive_blocks_walk_in_place);
+    RUN_TEST(test_view_rejects_damaged_blocks);
+    RUN_TEST(test_window_record_fixed_point_fields);
+    RUN_TEST(test_block_sample_count_fits_the_header);
+    RUN_TEST(test_window_block_regroups_records);
+    return UNITY_END();
+}
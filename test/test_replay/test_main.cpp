@@ -0,0 +1,279 @@
+/**
+ * @file test_main.cpp
+ * @brief Replay through detect_api.h: determinism, reset, threads, no side effects,
+ *        adaptive fusion weights, the coherence gate, harmonic reattribution
+ */
+
+#include <unity.h>
+#include "detect_api.h"
+#include "kv_writer.h"
+#include "kvstore_global_api.h"
+#include "night_mode.h"
+#include "sensor.h"
+#include "signal_processing.h"
+#include "../synthetic_imu.h"
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+static std::vector<DetectWindow> replay(const std::vector<int16_t>& samples, bool reset = true) {
+    const int16_t* axes[IMU_AXES];
+    for (size_t a = 0; a < IMU_AXES; a++) axes[a] = &samples[a];
+    size_t n = samples.size() / IMU_AXES;
+
+    if (reset) detect_reset();
+    std::vector<DetectWindow> out(n / WINDOW_SIZE + 1);
+    size_t windows = detect_run(axes, IMU_AXES, n, 0, out.data(), out.size());
+    out.resize(windows);
+    return out;
+}
+
+static bool same(const std::vector<DetectWindow>& a, const std::vector<DetectWindow>& b) {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(DetectWindow)) == 0;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_replay_detects_tremor_repeatably(void) {
+    std::vector<int16_t> rec = synthetic_tremor_session(6, 1);
+    std::vector<DetectWindow> first = replay(rec);
+    std::vector<DetectWindow> second = replay(rec);
+
+    TEST_ASSERT_EQUAL(rec.size() / IMU_AXES / WINDOW_SIZE, first.size());
+    TEST_ASSERT_TRUE(same(first, second));
+
+    size_t tremor_windows = 0, rest_detections = 0;
+    for (const DetectWindow& w : first) {
+        bool tremor_minute = ((w.start_sample / 52 / 60) % 2) == 1;
+        if (tremor_minute && w.tremor_intensity > 0) tremor_windows++;
+        if (!tremor_minute && w.raw_detection != 0) rest_detections++;
+        if (w.raw_detection == 1) TEST_ASSERT_FLOAT_WITHIN(0.3f, 4.8f, w.tremor_freq);
+    }
+    TEST_ASSERT_GREATER_THAN(first.size() / 3, tremor_windows);
+    TEST_ASSERT_EQUAL(0, rest_detections);
+}
+
+void test_reset_forgets_previous_recording(void) {
+    std::vector<int16_t> a = synthetic_tremor_session(4, 2);
+    std::vector<int16_t> b = synthetic_tremor_session(4, 3);
+    std::vector<DetectWindow> fresh = replay(b);
+    replay(a);
+    TEST_ASSERT_TRUE(same(fresh, replay(b)));
+}
+
+void test_pieces_continue_the_pipeline(void) {
+    std::vector<int16_t> rec = synthetic_tremor_session(4, 4);
+    std::vector<DetectWindow> whole = replay(rec);
+
+    // Split off-window so a partial window carries across the calls
+    size_t split = (rec.size() / IMU_AXES / 2 + 77) * IMU_AXES;
+    std::vector<int16_t> head(rec.begin(), rec.begin() + split);
+    std::vector<int16_t> tail(rec.begin() + split, rec.end());
+    std::vector<DetectWindow> pieces = replay(head);
+
+    const int16_t* axes[IMU_AXES];
+    for (size_t ax = 0; ax < IMU_AXES; ax++) axes[ax] = &tail[ax];
+    std::vector<DetectWindow> rest(whole.size());
+    uint32_t start_ms = (uint32_t)(split / IMU_AXES * 1000.0 / TARGET_SAMPLE_RATE_HZ);
+    size_t n = detect_run(axes, IMU_AXES, tail.size() / IMU_AXES, start_ms, rest.data(), rest.size());
+    rest.resize(n);
+    pieces.insert(pieces.end(), rest.begin(), rest.end());
+
+    TEST_ASSERT_EQUAL(whole.size(), pieces.size());
+    for (size_t i = 0; i < whole.size(); i++) {
+        TEST_ASSERT_EQUAL(whole[i].raw_detection, pieces[i].raw_detection);
+        TEST_ASSERT_EQUAL(whole[i].tremor_intensity, pieces[i].tremor_intensity);
+        TEST_ASSERT_EQUAL(whole[i].motor_state, pieces[i].motor_state);
+    }
+}
+
+void test_threads_replay_independently(void) {
+    std::vector<int16_t> recs[4];
+    std::vector<DetectWindow> sequential[4], threaded[4];
+    for (int i = 0; i < 4; i++) {
+        recs[i] = synthetic_tremor_session(4, 10 + i);
+        sequential[i] = replay(recs[i]);
+    }
+
+    std::thread workers[4];
+    for (int i = 0; i < 4; i++) {
+        workers[i] = std::thread([&, i]() { threaded[i] = replay(recs[i]); });
+    }
+    for (int i = 0; i < 4; i++) workers[i].join();
+
+    for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(same(sequential[i], threaded[i]));
+}
+
+void test_replay_has_no_side_effects(void) {
+    // Long enough still stretch for night entry and several checkpoint and
+    // calibration save intervals
+    SyntheticSegment still = {20.0f * 60.0f, 0.0f, 0.0f};
+    std::vector<int16_t> rec = synthetic_recording(&still, 1, 5);
+    replay(rec);
+
+    for (int slot = 0; slot < KV_SLOTS; slot++) TEST_ASSERT_EQUAL(0, kv_writer_stats[slot].posted);
+    uint8_t buffer[KV_WRITER_MAX_RECORD];
+    size_t actual = 0;
+    TEST_ASSERT_TRUE(kv_get("checkpoint", buffer, sizeof(buffer), &actual) != MBED_SUCCESS);
+    TEST_ASSERT_FALSE(night_mode_active);
+    TEST_ASSERT_EQUAL(0, night_stats.entries);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, TARGET_SAMPLE_RATE_HZ, sensor_rate_hz);
+}
+
+// 3-7 Hz peak over the 0.5-2 Hz mean of the std-normalized blend of one
+// window's magnitudes, FFT_SIZE bins of a Hann window as in the pipeline
+static float blend_snr(const int16_t* samples, float accel_weight) {
+    const double pi = 3.14159265358979323846;
+    double accel[WINDOW_SIZE], gyro[WINDOW_SIZE];
+    for (size_t i = 0; i < WINDOW_SIZE; i++) {
+        const int16_t* s = &samples[i * IMU_AXES];
+        accel[i] = ACCEL_SCALE * sqrt((double)s[0] * s[0] + (double)s[1] * s[1] + (double)s[2] * s[2]);
+        gyro[i] = GYRO_SCALE * sqrt((double)s[3] * s[3] + (double)s[4] * s[4] + (double)s[5] * s[5]);
+    }
+    double* channels[2] = {accel, gyro};
+    for (double* c : channels) {
+        double mean = 0.0, var = 0.0;
+        for (size_t i = 0; i < WINDOW_SIZE; i++) mean += c[i] / WINDOW_SIZE;
+        for (size_t i = 0; i < WINDOW_SIZE; i++) var += (c[i] - mean) * (c[i] - mean) / WINDOW_SIZE;
+        for (size_t i = 0; i < WINDOW_SIZE; i++) c[i] = (c[i] - mean) / (sqrt(var) + 1e-6);
+    }
+
+    const double freq_res = TARGET_SAMPLE_RATE_HZ / FFT_SIZE;
+    double floor_sum = 0.0, peak = 0.0;
+    size_t floor_bins = 0;
+    for (size_t k = (size_t)ceil(0.5 / freq_res); k <= (size_t)floor(7.0 / freq_res); k++) {
+        double re = 0.0, im = 0.0;
+        for (size_t i = 0; i < WINDOW_SIZE; i++) {
+            double hann = 0.5 - 0.5 * cos(2.0 * pi * i / (WINDOW_SIZE - 1));
+            double x = hann * (accel_weight * accel[i] + (1.0 - accel_weight) * gyro[i]);
+            re += x * cos(2.0 * pi * k * i / FFT_SIZE);
+            im -= x * sin(2.0 * pi * k * i / FFT_SIZE);
+        }
+        double mag = sqrt(re * re + im * im);
+        if (k <= (size_t)floor(2.0 / freq_res)) {
+            floor_sum += mag;
+            floor_bins++;
+        }
+        if (k >= (size_t)ceil(3.0 / freq_res)) peak = fmax(peak, mag);
+    }
+    return (float)(peak / (floor_sum / floor_bins + 1e-9));
+}
+
+// Rotational tremor rides on the gyro while body sway swamps the
+// accelerometer: the adaptive weight leans on the gyro, its blend beats
+// the fixed default split and the tremor is found
+void test_rotational_tremor_leans_on_the_gyro(void) {
+    SyntheticSegment roll = {120.0f, 4.8f, 25.0f};
+    roll.roll_bias_dps = 30.0f;
+    roll.sway_g = 0.2f;
+    roll.coupling_g_per_dps = 0.0005f;
+    std::vector<int16_t> rec = synthetic_recording(&roll, 1, 7);
+    size_t n = rec.size() / IMU_AXES;
+
+    detect_reset();
+    size_t windows = 0, gyro_led = 0, better = 0, detected = 0;
+    for (size_t start = 0; start + WINDOW_SIZE <= n; start += WINDOW_SIZE, windows++) {
+        const int16_t* axes[IMU_AXES];
+        for (size_t a = 0; a < IMU_AXES; a++) axes[a] = &rec[start * IMU_AXES + a];
+        DetectWindow w;
+        uint32_t t0 = (uint32_t)(start * 1000 / TARGET_SAMPLE_RATE_HZ);
+        TEST_ASSERT_EQUAL(1, detect_run(axes, IMU_AXES, WINDOW_SIZE, t0, &w, 1));
+
+        const float weight = window_result.accel_weight;
+        if (weight < 0.5f) gyro_led++;
+        const int16_t* samples = &rec[start * IMU_AXES];
+        if (blend_snr(samples, weight) > 2.0f * blend_snr(samples, FUSION_DEFAULT_ACCEL_WEIGHT)) better++;
+        if (w.raw_detection == DETECT_TREMOR) {
+            detected++;
+            TEST_ASSERT_FLOAT_WITHIN(0.3f, 4.8f, w.tremor_freq);
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(windows * 9 / 10, gyro_led);
+    TEST_ASSERT_GREATER_THAN(windows * 9 / 10, better);
+    TEST_ASSERT_GREATER_THAN(windows * 9 / 10, detected);
+}
+
+struct GateCounts {
+    size_t windows;
+    size_t over_threshold;       // peak clears the default factor and dominates the dyskinesia band
+    size_t coherent;
+    size_t detected;
+    size_t dysk;
+    size_t reattributed;         // a dyskinesia-band lobe taken as a tremor harmonic
+};
+
+static GateCounts replay_gate(const SyntheticSegment& segment) {
+    std::vector<int16_t> rec = synthetic_recording(&segment, 1, 11);
+    size_t n = rec.size() / IMU_AXES;
+
+    detect_reset();
+    GateCounts c = {};
+    for (size_t start = 0; start + WINDOW_SIZE <= n; start += WINDOW_SIZE) {
+        const int16_t* axes[IMU_AXES];
+        for (size_t a = 0; a < IMU_AXES; a++) axes[a] = &rec[start * IMU_AXES + a];
+        DetectWindow w;
+        uint32_t t0 = (uint32_t)(start * 1000 / TARGET_SAMPLE_RATE_HZ);
+        TEST_ASSERT_EQUAL(1, detect_run(axes, IMU_AXES, WINDOW_SIZE, t0, &w, 1));
+
+        const WindowResult& r = window_result;
+        c.windows++;
+        if (r.tremor_peak > r.noise_floor * TREMOR_THRESHOLD_FACTOR && r.tremor_peak > r.dysk_peak * 1.1f) {
+            c.over_threshold++;
+        }
+        if (r.tremor_coherence >= COHERENCE_MIN) c.coherent++;
+        if (w.raw_detection == DETECT_TREMOR) c.detected++;
+        if (w.raw_detection == DETECT_DYSK) c.dysk++;
+        if (r.harmonic_reattributed) c.reattributed++;
+    }
+    return c;
+}
+
+// Pronation/supination moves both sensors at the tremor rate and passes;
+// a vibration only the accelerometer sees is as strong in the blend but
+// never coherent, from the first window on
+void test_coherence_gate_passes_pronation_supination_only(void) {
+    SyntheticSegment pronation = {120.0f, 4.8f, 30.0f};
+    GateCounts tremor = replay_gate(pronation);
+    TEST_ASSERT_EQUAL(tremor.windows, tremor.over_threshold);
+    TEST_ASSERT_EQUAL(tremor.windows - (COHERENCE_MIN_WINDOWS - 1), tremor.coherent);
+    TEST_ASSERT_EQUAL(tremor.coherent, tremor.detected);
+
+    SyntheticSegment vibration = {120.0f, 4.8f, 0.0f};
+    vibration.vibration_g = 0.05f;
+    GateCounts noise = replay_gate(vibration);
+    TEST_ASSERT_EQUAL(noise.windows, noise.over_threshold);
+    TEST_ASSERT_EQUAL(0, noise.coherent);
+    TEST_ASSERT_EQUAL(0, noise.detected);
+}
+
+// A 3.2 Hz tremor puts its second harmonic in the dyskinesia band, here
+// as strong as the fundamental; the lobe goes back to the tremor. A 6 Hz
+// dyskinesia has no 3 Hz fundamental under it and stays dyskinesia
+void test_harmonic_reattribution_keeps_slow_tremor(void) {
+    SyntheticSegment slow = {120.0f, 3.2f, 30.0f};
+    slow.harmonic = 1.0f;
+    GateCounts tremor = replay_gate(slow);
+    TEST_ASSERT_EQUAL(tremor.windows, tremor.reattributed);
+    TEST_ASSERT_EQUAL(tremor.windows - (COHERENCE_MIN_WINDOWS - 1), tremor.detected);
+    TEST_ASSERT_EQUAL(0, tremor.dysk);
+
+    SyntheticSegment dyskinesia = {120.0f, 6.0f, 30.0f};
+    GateCounts dysk = replay_gate(dyskinesia);
+    TEST_ASSERT_EQUAL(0, dysk.reattributed);
+    TEST_ASSERT_EQUAL(dysk.windows, dysk.dysk);
+    TEST_ASSERT_EQUAL(0, dysk.detected);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_detects_tremor_repeatably);
+    RUN_TEST(test_reset_forgets_previous_recording);
+    RUN_TEST(test_pieces_continue_the_pipeline);
+    RUN_TEST(test_threads_replay_independently);
+    RUN_TEST(test_replay_has_no_side_effects);
+    RUN_TEST(test_rotational_tremor_leans_on_the_gyro);
+    RUN_TEST(test_coherence_gate_passes_pronation_supination_only);
+    RUN_TEST(test_harmonic_reattribution_keeps_slow_tremor);
+    return UNITY_END();
+}
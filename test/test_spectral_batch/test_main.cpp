@@ -0,0 +1,211 @@
+/**
+ * @file test_main.cpp
+ * @brief Batched spectral front end: agreement with the firmware path, across
+ *        kernels and, for detections, across window types
+ */
+
+#include <unity.h>
+#include "spectral_batch.h"
+#include "signal_processing.h"
+#include "baseline.h"
+#include "detect_api.h"
+#include "sensor.h"
+#include "window_functions.h"
+#include "../synthetic_imu.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+const size_t WINDOWS = 200;                    // 12 full groups and a partial one
+
+static std::vector<float> accel, gyro;
+
+// Magnitude windows with one tone in 3.6-6.8 Hz over walking-rate motion and noise
+static void make_windows(uint32_t seed) {
+    const float pi = 3.14159265f;
+    uint32_t state = seed * 2654435761u + 1u;
+    auto noise = [&state](float amplitude) {
+        state = state * 1664525u + 1013904223u;
+        return amplitude * ((float)(state >> 8) / 8388608.0f - 1.0f);
+    };
+    accel.assign(WINDOWS * WINDOW_SIZE, 0.0f);
+    gyro.assign(WINDOWS * WINDOW_SIZE, 0.0f);
+    for (size_t w = 0; w < WINDOWS; w++) {
+        float tone = 3.6f + 3.2f * (0.5f + 0.5f * noise(1.0f));
+        float gait = 1.0f + 0.5f * noise(1.0f);
+        float accel_amp = 0.05f * (1.0f + noise(0.9f)), gyro_amp = 20.0f * (1.0f + noise(0.9f));
+        for (size_t i = 0; i < WINDOW_SIZE; i++) {
+            float t = (w * WINDOW_SIZE + i) / TARGET_SAMPLE_RATE_HZ;
+            accel[w * WINDOW_SIZE + i] = 1.0f + accel_amp * sinf(2 * pi * tone * t) +
+                                         0.03f * sinf(2 * pi * gait * t) + noise(0.01f);
+            gyro[w * WINDOW_SIZE + i] = 30.0f + gyro_amp * sinf(2 * pi * tone * t + 0.4f) + noise(2.0f);
+        }
+    }
+}
+
+static float relative(float a, float b) {
+    float scale = fabsf(a) > fabsf(b) ? fabsf(a) : fabsf(b);
+    return scale > 0.0f ? fabsf(a - b) / scale : 0.0f;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_matches_the_firmware_path(void) {
+    make_windows(1);
+    std::vector<SpectralWindow> batch(WINDOWS);
+    std::vector<float> magnitude(WINDOWS * SPECTRAL_BATCH_BINS);
+    float weight = FUSION_DEFAULT_ACCEL_WEIGHT;
+    spectral_batch(accel.data(), gyro.data(), WINDOWS, &weight, batch.data(), magnitude.data());
+
+    detect_reset();
+    size_t compared = 0;
+    for (size_t w = 0; w < WINDOWS; w++) {
+        char condition[16];
+        float intensity;
+        analyze_frequency_content(&accel[w * WINDOW_SIZE], &gyro[w * WINDOW_SIZE], WINDOW_SIZE,
+                                  TARGET_SAMPLE_RATE_HZ, condition, &intensity);
+        const SpectralWindow& b = batch[w];
+        const float* m = &magnitude[w * SPECTRAL_BATCH_BINS];
+
+        // Spectrum errors against the window's largest bin
+        float peak = 0.0f;
+        for (size_t k = 0; k < SPECTRAL_BATCH_BINS; k++) peak = fmaxf(peak, magnitude_spectrum[k]);
+        for (size_t k = 0; k < SPECTRAL_BATCH_BINS; k++) TEST_ASSERT_FLOAT_WITHIN(2e-6f * peak, magnitude_spectrum[k], m[k]);
+
+        TEST_ASSERT_TRUE(relative(b.accel_snr, window_result.accel_snr) < 2e-5f);
+        TEST_ASSERT_TRUE(relative(b.gyro_snr, window_result.gyro_snr) < 2e-5f);
+        TEST_ASSERT_FLOAT_WITHIN(1e-6f, window_result.accel_weight, b.accel_weight);
+        TEST_ASSERT_FLOAT_WITHIN(2e-6f * peak, window_result.noise_floor,
+                                 fmaxf(b.noise_floor, personal_thresholds.noise_floor_min));
+
+        // Harmonic reattribution moves the band peaks after the front end
+        if (window_result.harmonic_reattributed) continue;
+        TEST_ASSERT_FLOAT_WITHIN(2e-6f * peak, window_result.tremor_peak, b.tremor_peak);
+        TEST_ASSERT_FLOAT_WITHIN(2e-6f * peak, window_result.dysk_peak, b.dysk_peak);
+        TEST_ASSERT_FLOAT_WITHIN(0.0f, window_result.tremor_freq, b.tremor_freq);
+        TEST_ASSERT_FLOAT_WITHIN(0.0f, window_result.dysk_freq, b.dysk_freq);
+        compared++;
+    }
+    TEST_ASSERT_GREATER_THAN(WINDOWS * 9 / 10, compared);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, fusion_accel_weight, weight);
+}
+
+void test_every_kernel_gives_the_same_bits(void) {
+    make_windows(2);
+    std::vector<SpectralWindow> reference(WINDOWS), batch(WINDOWS);
+    std::vector<float> reference_mag(WINDOWS * SPECTRAL_BATCH_BINS), magnitude(WINDOWS * SPECTRAL_BATCH_BINS);
+    float weight = FUSION_DEFAULT_ACCEL_WEIGHT;
+    TEST_ASSERT_TRUE(spectral_batch_use(SPECTRAL_ISA_GENERIC));
+    spectral_batch(accel.data(), gyro.data(), WINDOWS, &weight, reference.data(), reference_mag.data());
+
+    const SpectralIsa wide[] = {SPECTRAL_ISA_AVX2, SPECTRAL_ISA_AVX512};
+    for (SpectralIsa isa : wide) {
+        if (!spectral_batch_use(isa)) continue;    // not on this CPU
+        TEST_ASSERT_EQUAL(isa, spectral_batch_isa());
+        weight = FUSION_DEFAULT_ACCEL_WEIGHT;
+        spectral_batch(accel.data(), gyro.data(), WINDOWS, &weight, batch.data(), magnitude.data());
+        TEST_ASSERT_EQUAL_MEMORY(reference.data(), batch.data(), WINDOWS * sizeof(SpectralWindow));
+        TEST_ASSERT_EQUAL_MEMORY(reference_mag.data(), magnitude.data(), magnitude.size() * sizeof(float));
+    }
+    TEST_ASSERT_TRUE(spectral_batch_use(SPECTRAL_ISA_AUTO));
+}
+
+void test_calls_continue_the_fusion_weight(void) {
+    make_windows(3);
+    std::vector<SpectralWindow> whole(WINDOWS), parts(WINDOWS);
+    float weight = FUSION_DEFAULT_ACCEL_WEIGHT;
+    spectral_batch(accel.data(), gyro.data(), WINDOWS, &weight, whole.data(), nullptr);
+
+    // Split off the group grid: every lane lands in a different place
+    float carried = FUSION_DEFAULT_ACCEL_WEIGHT;
+    const size_t first = 37;
+    spectral_batch(accel.data(), gyro.data(), first, &carried, parts.data(), nullptr);
+    spectral_batch(&accel[first * WINDOW_SIZE], &gyro[first * WINDOW_SIZE], WINDOWS - first, &carried,
+                   &parts[first], nullptr);
+    TEST_ASSERT_EQUAL_MEMORY(whole.data(), parts.data(), WINDOWS * sizeof(SpectralWindow));
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, weight, carried);
+}
+
+// Band-threshold decision of analyze_frequency_content at the default
+// factors (coherence and harmonic reattribution left out)
+static bool tremor_decision(const SpectralWindow& w) {
+    const float floor = fmaxf(w.noise_floor, NOISE_FLOOR_MIN);
+    return w.tremor_peak > floor * TREMOR_THRESHOLD_FACTOR && w.tremor_peak > w.dysk_peak * 1.1f;
+}
+
+// The analysed windows of a replayed session (rest with light movement,
+// tremor of varying strength every other minute), compared across window
+// types. Each window is scaled to Hann's coherent gain, so a tone reads
+// the same amplitude against the same absolute floor clamp
+void test_window_types_compared_on_replayed_detections(void) {
+    std::vector<SyntheticSegment> minutes;
+    for (int m = 0; m < 20; m++) {
+        SyntheticSegment s = {60.0f, 4.8f, (m % 2) ? 8.0f + 32.0f * (float)((m * 7) % 10) / 9.0f : 0.0f};
+        s.sway_g = 0.03f;
+        minutes.push_back(s);
+    }
+    std::vector<int16_t> rec = synthetic_recording(minutes.data(), minutes.size(), 3);
+    const size_t windows = rec.size() / IMU_AXES / WINDOW_SIZE;
+
+    std::vector<float> a, g;
+    std::vector<bool> tremor, detected;
+    detect_reset();
+    for (size_t w = 0; w < windows; w++) {
+        const int16_t* axes[IMU_AXES];
+        for (size_t ax = 0; ax < IMU_AXES; ax++) axes[ax] = &rec[w * WINDOW_SIZE * IMU_AXES + ax];
+        DetectWindow out;
+        detect_run(axes, IMU_AXES, WINDOW_SIZE, (uint32_t)(w * WINDOW_SIZE * 1000 / TARGET_SAMPLE_RATE_HZ), &out, 1);
+        if (window_result.noise_floor <= 0.0f) continue;          // not analysed
+        a.insert(a.end(), accel_magnitude_buffer, accel_magnitude_buffer + WINDOW_SIZE);
+        g.insert(g.end(), gyro_magnitude_buffer, gyro_magnitude_buffer + WINDOW_SIZE);
+        tremor.push_back(minutes[w * WINDOW_SIZE / (60 * 52)].tremor_dps > 0.0f);
+        detected.push_back(out.raw_detection == DETECT_TREMOR);
+    }
+    const size_t n = tremor.size();
+    TEST_ASSERT_GREATER_THAN(windows * 9 / 10, n);
+    size_t tremor_windows = 0;
+    for (bool t : tremor) tremor_windows += t;
+
+    const window_detail::Table<WINDOW_SIZE> hann = window_detail::make_table<WINDOW_SIZE>(WINDOW_HANN);
+    size_t hits[WINDOW_TYPES], false_alarms[WINDOW_TYPES], agree_pipeline = 0;
+    for (int type = 0; type < WINDOW_TYPES; type++) {
+        window_detail::Table<WINDOW_SIZE> t = window_detail::make_table<WINDOW_SIZE>((WindowType)type);
+        for (size_t i = 0; i < WINDOW_SIZE; i++) t.coeffs[i] *= hann.sum / t.sum;
+
+        std::vector<SpectralWindow> out(n);
+        float weight = FUSION_DEFAULT_ACCEL_WEIGHT;
+        spectral_batch(a.data(), g.data(), n, &weight, out.data(), nullptr, t.coeffs);
+
+        hits[type] = false_alarms[type] = 0;
+        for (size_t w = 0; w < n; w++) {
+            const bool d = tremor_decision(out[w]);
+            hits[type] += tremor[w] && d;
+            false_alarms[type] += !tremor[w] && d;
+            if (type == ANALYSIS_WINDOW) agree_pipeline += d == detected[w];
+        }
+    }
+
+    // The decision above is the pipeline's own with the configured window
+    TEST_ASSERT_GREATER_THAN(n * 98 / 100, agree_pipeline);
+
+    // The table of window_functions.h, within a few windows
+    static const int EXPECTED_HITS[WINDOW_TYPES] = {139, 119, 125, 81, 8};
+    static const int EXPECTED_FALSE_ALARMS[WINDOW_TYPES] = {5, 8, 8, 6, 11};
+    TEST_ASSERT_EQUAL(n / 2, tremor_windows);
+    for (int type = 0; type < WINDOW_TYPES; type++) {
+        TEST_ASSERT_INT_WITHIN(3, EXPECTED_HITS[type], (int)hits[type]);
+        TEST_ASSERT_INT_WITHIN(3, EXPECTED_FALSE_ALARMS[type], (int)false_alarms[type]);
+    }
+    TEST_ASSERT_GREATER_THAN(hits[WINDOW_BLACKMAN_HARRIS], hits[WINDOW_HANN]);
+    TEST_ASSERT_GREATER_THAN(hits[WINDOW_FLAT_TOP] * 4, hits[WINDOW_HANN]);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_the_firmware_path);
+    RUN_TEST(test_every_kernel_gives_the_same_bits);
+    RUN_TEST(test_calls_continue_the_fusion_weight);
+    RUN_TEST(test_window_types_compared_on_replayed_detections);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+/**
+ * @file test_main.cpp
+ * @brief Hourly summary ring: rollover, the uptime wrap, export order, wall-clock hours
+ */
+
+#include <unity.h>
+#include "symptom_summary.h"
+#include "detect_api.h"
+#include <cstring>
+#include <vector>
+
+const uint32_t WINDOW_MS = 3000;
+
+static void add(uint32_t timestamp_ms, uint16_t tremor) {
+    WindowResult r;
+    memset(&r, 0, sizeof(r));
+    r.timestamp_ms = timestamp_ms;
+    r.std_dev = 0.05f;
+    r.tremor_intensity = tremor;
+    summary_add_window(r, WINDOW_MS);
+}
+
+static std::vector<SummaryPacket> exported() {
+    uint8_t out[SUMMARY_EXPORT_SIZE];
+    size_t n = summary_export(out, sizeof(out));
+    TEST_ASSERT_EQUAL(0, n % sizeof(SummaryPacket));
+    std::vector<SummaryPacket> packets(n / sizeof(SummaryPacket));
+    memcpy(packets.data(), out, n);
+    return packets;
+}
+
+void setUp(void) {
+    detect_reset();   // replay mode: uptime hours from the window timestamps
+}
+void tearDown(void) {}
+
+void test_hours_roll_over_the_ring(void) {
+    // Two windows an hour for 30 hours, tremor in the second
+    for (uint32_t hour = 0; hour < 30; hour++) {
+        add(hour * SUMMARY_HOUR_MS, 0);
+        add(hour * SUMMARY_HOUR_MS + 1800000, 100 + hour);
+    }
+    std::vector<SummaryPacket> packets = exported();
+    TEST_ASSERT_EQUAL(SUMMARY_HOURS, packets.size());
+    for (size_t i = 0; i < packets.size(); i++) {
+        TEST_ASSERT_EQUAL(30 - SUMMARY_HOURS + i, packets[i].hour_index);
+        TEST_ASSERT_EQUAL(2, packets[i].windows);
+        TEST_ASSERT_EQUAL(WINDOW_MS / 1000, packets[i].tremor_s);
+        TEST_ASSERT_EQUAL(100 + packets[i].hour_index, packets[i].peak_tremor);
+    }
+}
+
+void test_uptime_continues_across_the_millisecond_wrap(void) {
+    // Half-hourly windows from 3 h before the 32-bit wrap to 3 h after
+    const uint32_t start = 0u - 3 * SUMMARY_HOUR_MS;
+    for (uint32_t i = 0; i < 12; i++) add(start + i * (SUMMARY_HOUR_MS / 2), 0);
+
+    std::vector<SummaryPacket> packets = exported();
+    TEST_ASSERT_EQUAL(6, packets.size());
+    const uint32_t first = start / SUMMARY_HOUR_MS;
+    for (size_t i = 0; i < packets.size(); i++) {
+        TEST_ASSERT_EQUAL((first + i) & SUMMARY_HOUR_MASK, packets[i].hour_index);
+        TEST_ASSERT_EQUAL(2, packets[i].windows);
+    }
+}
+
+void test_export_skips_stale_hours(void) {
+    // Hours 0-2, then nothing until hour 25: only 2 and 25 are within a day
+    for (uint32_t hour = 0; hour < 3; hour++) add(hour * SUMMARY_HOUR_MS, 0);
+    add(25 * SUMMARY_HOUR_MS, 0);
+
+    std::vector<SummaryPacket> packets = exported();
+    TEST_ASSERT_EQUAL(2, packets.size());
+    TEST_ASSERT_EQUAL(2, packets[0].hour_index);
+    TEST_ASSERT_EQUAL(25, packets[1].hour_index);
+}
+
+void test_wall_clock_hours_follow_uptime_hours(void) {
+    // The host clock is set, like the RTC after a time write
+    for (uint32_t hour = 0; hour < 3; hour++) add(hour * SUMMARY_HOUR_MS, 0);
+    replay_mode = false;
+    rtc_utc_offset_min = 330;
+    time_t before;
+    TEST_ASSERT_TRUE(rtc_local_seconds(&before));
+    add(3 * SUMMARY_HOUR_MS, 0);
+    time_t after;
+    rtc_local_seconds(&after);
+    replay_mode = true;
+    rtc_utc_offset_min = 0;
+
+    std::vector<SummaryPacket> packets = exported();
+    TEST_ASSERT_EQUAL(4, packets.size());
+    for (uint32_t i = 0; i < 3; i++) TEST_ASSERT_EQUAL(i, packets[i].hour_index);
+
+    const uint16_t hour = packets[3].hour_index;
+    TEST_ASSERT_TRUE(hour & SUMMARY_HOUR_RTC);
+    TEST_ASSERT_TRUE((hour & SUMMARY_HOUR_MASK) == ((before / 3600) & SUMMARY_HOUR_MASK) ||
+                     (hour & SUMMARY_HOUR_MASK) == ((after / 3600) & SUMMARY_HOUR_MASK));
+
+    // Day-aligned: the ring slot is the local hour of the day
+    const SummaryBucket& b = summary_buckets[(hour & SUMMARY_HOUR_MASK) == ((after / 3600) & SUMMARY_HOUR_MASK)
+                                             ? after / 3600 % SUMMARY_HOURS : before / 3600 % SUMMARY_HOURS];
+    TEST_ASSERT_TRUE(b.valid && b.rtc);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hours_roll_over_the_ring);
+    RUN_TEST(test_uptime_continues_across_the_millisecond_wrap);
+    RUN_TEST(test_export_skips_stale_hours);
+    RUN_TEST(test_wall_clock_hours_follow_uptime_hours);
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+/**
+ * @file test_main.cpp
+ * @brief Telemetry frames: layout, CRC-8, sequence numbers, muted text
+ */
+
+#include <unity.h>
+#include "telemetry.h"
+#include "detect_api.h"
+#include "spectrogram.h"
+#include "../synthetic_imu.h"
+#include <cstring>
+#include <string>
+
+class Capture : public FileHandle {
+public:
+    std::string bytes;
+
+    ssize_t write(const void* buffer, size_t size) override {
+        bytes.append(static_cast<const char*>(buffer), size);
+        return (ssize_t)size;
+    }
+    ssize_t read(void*, size_t) override { return 0; }
+    off_t seek(off_t, int) override { return -ESPIPE; }
+    int close() override { return 0; }
+};
+
+struct Frame {
+    uint8_t type;
+    uint8_t sequence;
+    std::string payload;
+};
+
+// Reference CRC-8/CCITT (poly 0x07, init 0), independent of MbedCRC
+static uint8_t crc8_reference(const uint8_t* p, size_t n) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= p[i];
+        for (int k = 0; k < 8; k++) crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+    }
+    return crc;
+}
+
+// Split a capture into frames, asserting that every byte belongs to a valid one
+static std::vector<Frame> parse(const std::string& bytes) {
+    std::vector<Frame> frames;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(bytes.data());
+    size_t i = 0;
+    while (i < bytes.size()) {
+        TEST_ASSERT_TRUE(bytes.size() - i >= TELEMETRY_OVERHEAD);
+        TEST_ASSERT_EQUAL_HEX8(TELEMETRY_SYNC0, p[i]);
+        TEST_ASSERT_EQUAL_HEX8(TELEMETRY_SYNC1, p[i + 1]);
+        uint8_t length = p[i + 3];
+        TEST_ASSERT_TRUE(bytes.size() - i >= TELEMETRY_OVERHEAD + length);
+        TEST_ASSERT_EQUAL_HEX8(crc8_reference(&p[i + 2], 3 + length), p[i + 5 + length]);
+        frames.push_back({p[i + 2], p[i + 4], bytes.substr(i + 5, length)});
+        i += TELEMETRY_OVERHEAD + length;
+    }
+    return frames;
+}
+
+static Capture port;
+
+// Replay with the stream on, servicing health once a second as the main loop would
+static std::vector<Frame> stream(float minutes) {
+    std::vector<int16_t> rec = synthetic_tremor_session(minutes, 1);
+    size_t n = rec.size() / IMU_AXES;
+    const size_t chunk = (size_t)TARGET_SAMPLE_RATE_HZ;
+
+    detect_reset();
+    port.bytes.clear();
+    telemetry_console(&port);
+    telemetry_set_active(true);
+    for (size_t first = 0; first < n; first += chunk) {
+        const int16_t* axes[IMU_AXES];
+        for (size_t a = 0; a < IMU_AXES; a++) axes[a] = &rec[first * IMU_AXES + a];
+        uint32_t t = (uint32_t)(first * 1000.0 / TARGET_SAMPLE_RATE_HZ);
+        detect_run(axes, IMU_AXES, (n - first < chunk) ? n - first : chunk, t, nullptr, 0);
+        telemetry_service(t + 1000);
+    }
+    telemetry_set_active(false);
+    return parse(port.bytes);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_frames_are_valid_and_sized_as_documented(void) {
+    std::vector<Frame> frames = stream(2);
+    size_t windows = 0, health = 0;
+    for (const Frame& f : frames) {
+        switch (f.type) {
+            case TELEM_WINDOW:   TEST_ASSERT_EQUAL(sizeof(TelemWindow), f.payload.size()); windows++; break;
+            case TELEM_STAGES:   TEST_ASSERT_EQUAL(sizeof(TelemStages), f.payload.size()); break;
+            case TELEM_SPECTRUM: TEST_ASSERT_EQUAL(sizeof(SpectroPacket), f.payload.size()); break;
+            case TELEM_HEALTH:   TEST_ASSERT_EQUAL(sizeof(TelemHealth), f.payload.size()); health++; break;
+            default:             TEST_ASSERT_TRUE_MESSAGE(false, "unknown frame type");
+        }
+    }
+    TEST_ASSERT_EQUAL(2 * 60 * 52 / WINDOW_SIZE, windows);
+    TEST_ASSERT_EQUAL(60, health);   // one per 2 s interval
+    TEST_ASSERT_EQUAL(frames.size(), telemetry_stats.frames);
+    TEST_ASSERT_EQUAL(port.bytes.size(), telemetry_stats.telemetry_bytes);
+}
+
+void test_sequence_counts_every_frame_from_reset(void) {
+    std::vector<Frame> frames = stream(4);
+    TEST_ASSERT_GREATER_THAN(255, frames.size());   // wraps at least once
+    for (size_t i = 0; i < frames.size(); i++) TEST_ASSERT_EQUAL_UINT8((uint8_t)i, frames[i].sequence);
+}
+
+void test_window_frames_follow_the_pipeline(void) {
+    std::vector<Frame> frames = stream(2);
+    uint32_t expected = 1;   // window_count of the first window
+    for (const Frame& f : frames) {
+        if (f.type != TELEM_WINDOW) continue;
+        TelemWindow w;
+        memcpy(&w, f.payload.data(), sizeof(w));
+        TEST_ASSERT_EQUAL_UINT32(expected, w.window_index);
+        if (w.raw_detection == DETECT_TREMOR) TEST_ASSERT_FLOAT_WITHIN(30, 480, w.tremor_freq_chz);
+        expected++;
+    }
+}
+
+void test_crc_detects_corruption(void) {
+    std::vector<Frame> frames = stream(1);
+    std::string bytes = port.bytes;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(bytes.data());
+    uint8_t length = p[3];
+    for (size_t bit = 0; bit < 8u * (3 + length); bit++) {
+        std::string damaged = bytes.substr(0, TELEMETRY_OVERHEAD + length);
+        damaged[2 + bit / 8] ^= (char)(1 << (bit % 8));
+        const uint8_t* d = reinterpret_cast<const uint8_t*>(damaged.data());
+        TEST_ASSERT_NOT_EQUAL(d[5 + length], crc8_reference(&d[2], 3 + length));
+    }
+}
+
+void test_text_is_muted_only_while_active(void) {
+    FileHandle* console = telemetry_console(&port);
+    port.bytes.clear();
+    telemetry_stats = {};
+
+    telemetry_set_active(false);
+    console->write("abc", 3);
+    TEST_ASSERT_EQUAL_STRING_LEN("abc", port.bytes.c_str(), 3);
+
+    telemetry_set_active(true);
+    console->write("defg", 4);
+    TEST_ASSERT_EQUAL(3, port.bytes.size());
+    TEST_ASSERT_EQUAL(7, telemetry_stats.text_bytes);
+    TEST_ASSERT_EQUAL(4, telemetry_stats.text_muted_bytes);
+    telemetry_set_active(false);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_are_valid_and_sized_as_documented);
+    RUN_TEST(test_sequence_counts_every_frame_from_reset);
+    RUN_TEST(test_window_frames_follow_the_pipeline);
+    RUN_TEST(test_crc_detects_corruption);
+    RUN_TEST(test_text_is_muted_only_while_active);
+    return UNITY_END();
+}
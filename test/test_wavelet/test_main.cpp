@@ -0,0 +1,121 @@
+/**
+ * @file test_main.cpp
+ * @brief LeGall 5/3 lifting: exact reconstruction, full-scale range, detail placement
+ */
+
+#include <unity.h>
+#include "wavelet.h"
+#include "../synthetic_imu.h"
+#include <cstdlib>
+
+static const size_t MAX_LENGTH = 4 * WINDOW_SIZE;
+
+static void widen(const int16_t* signal, int32_t* x, size_t length) {
+    for (size_t i = 0; i < length; i++) x[i] = signal[i];
+}
+
+static void assert_reconstructs(const int16_t* signal, size_t length, size_t levels) {
+    int32_t x[MAX_LENGTH], expected[MAX_LENGTH];
+    widen(signal, x, length);
+    widen(signal, expected, length);
+    wavelet_forward(x, length, levels);
+    wavelet_inverse(x, length, levels);
+    TEST_ASSERT_EQUAL_INT32_ARRAY(expected, x, length);
+}
+
+// Mean squared level-j detail (1-based), as wavelet_update_window computes it
+static float detail_energy(const int32_t* x, size_t length, size_t level) {
+    const size_t s = (size_t)1 << (level - 1);
+    double sum = 0.0;
+    size_t count = 0;
+    for (size_t pos = s; pos < length; pos += 2 * s, count++) sum += (double)x[pos] * x[pos];
+    return count ? (float)(sum / count) : 0.0f;
+}
+
+static void sine(int32_t* x, size_t length, float hz, float amplitude) {
+    for (size_t i = 0; i < length; i++) {
+        x[i] = (int32_t)(amplitude * sinf(6.2831853f * hz * i / TARGET_SAMPLE_RATE_HZ));
+    }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_recorded_axes_reconstruct_exactly(void) {
+    std::vector<int16_t> rec = synthetic_tremor_session(2, 1);
+    int16_t column[MAX_LENGTH];
+    for (size_t axis = 0; axis < IMU_AXES; axis++) {
+        for (size_t i = 0; i < MAX_LENGTH; i++) column[i] = rec[(52 * 60 + i) * IMU_AXES + axis];
+        for (size_t levels = 1; levels <= WAVELET_LEVELS; levels++) {
+            assert_reconstructs(column, WINDOW_SIZE, levels);
+            assert_reconstructs(column, MAX_LENGTH, levels);
+        }
+    }
+}
+
+void test_odd_and_short_lengths_reconstruct(void) {
+    int16_t x[MAX_LENGTH];
+    uint32_t state = 5;
+    for (size_t i = 0; i < MAX_LENGTH; i++) {
+        state = state * 1664525u + 1013904223u;
+        x[i] = (int16_t)((int32_t)(state >> 16) % 8000 - 4000);
+    }
+    const size_t lengths[] = {1, 2, 3, 5, 7, 39, 155, 157};
+    for (size_t length : lengths) assert_reconstructs(x, length, WAVELET_LEVELS);
+}
+
+void test_full_scale_swings_reconstruct(void) {
+    // Rail to rail every sample, and every 2^j samples: the details reach
+    // past int16 at every level and must come back exactly
+    int16_t x[MAX_LENGTH];
+    for (size_t period = 1; period <= 16; period *= 2) {
+        for (size_t i = 0; i < MAX_LENGTH; i++) x[i] = ((i / period) % 2) ? INT16_MIN : INT16_MAX;
+        for (size_t levels = 1; levels <= WAVELET_LEVELS; levels++) assert_reconstructs(x, MAX_LENGTH, levels);
+    }
+
+    int32_t c[WINDOW_SIZE];
+    for (size_t i = 0; i < WINDOW_SIZE; i++) c[i] = (i % 2) ? INT16_MIN : INT16_MAX;
+    wavelet_forward(c, WINDOW_SIZE, WAVELET_LEVELS);
+    TEST_ASSERT_EQUAL(-65535, c[1]);
+    for (size_t i = 0; i < WINDOW_SIZE; i++) TEST_ASSERT_LESS_THAN(1 << 19, abs(c[i]));
+}
+
+void test_smooth_signals_have_no_detail(void) {
+    // The 5/3 predictor is exact on lines, so a ramp leaves only rounding
+    // away from the right edge, where the symmetric extension bends it
+    int32_t x[WINDOW_SIZE];
+    for (size_t i = 0; i < WINDOW_SIZE; i++) x[i] = 16000 + 20 * (int32_t)i;
+    wavelet_forward(x, WINDOW_SIZE, WAVELET_LEVELS);
+    for (size_t level = 1; level <= WAVELET_LEVELS; level++) {
+        const size_t s = (size_t)1 << (level - 1);
+        for (size_t pos = s; pos + 4 * s < WINDOW_SIZE; pos += 2 * s) {
+            TEST_ASSERT_LESS_OR_EQUAL(1, abs(x[pos]));
+        }
+    }
+}
+
+void test_detail_levels_follow_the_dyadic_bands(void) {
+    // Centre of each band: d1 13-26 Hz, d2 6.5-13 Hz, d3 3.3-6.5 Hz, d4 1.6-3.3 Hz
+    const float centre_hz[] = {19.0f, 9.5f, 4.8f, 2.4f};
+    for (size_t band = 0; band < 4; band++) {
+        int32_t x[WINDOW_SIZE];
+        sine(x, WINDOW_SIZE, centre_hz[band], 2000.0f);
+        wavelet_forward(x, WINDOW_SIZE, WAVELET_LEVELS);
+
+        size_t strongest = 1;
+        for (size_t level = 2; level <= WAVELET_LEVELS; level++) {
+            if (detail_energy(x, WINDOW_SIZE, level) > detail_energy(x, WINDOW_SIZE, strongest)) strongest = level;
+        }
+        TEST_ASSERT_EQUAL(band + 1, strongest);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_recorded_axes_reconstruct_exactly);
+    RUN_TEST(test_odd_and_short_lengths_reconstruct);
+    RUN_TEST(test_full_scale_swings_reconstruct);
+    RUN_TEST(test_smooth_signals_have_no_detail);
+    RUN_TEST(test_detail_levels_follow_the_dyadic_bands);
+    return UNITY_END();
+}
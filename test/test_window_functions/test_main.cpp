@@ -0,0 +1,122 @@
+/**
+ * @file test_main.cpp
+ * @brief Window tables: the leakage figures of window_functions.h, the configured stages
+ */
+
+#include <unity.h>
+#include "window_functions.h"
+#include "signal_processing.h"
+#include "multires.h"
+#include "zoom_fft.h"
+#include <cmath>
+#include <vector>
+
+using window_detail::Table;
+using window_detail::make_table;
+
+const size_t N = WINDOW_SIZE;
+const size_t PAD = 64;               // zero padding: 64 points per DFT bin
+
+struct Leakage {
+    double coherent_gain;
+    double enbw_bins;
+    double sidelobe_db;              // highest sidelobe, relative to the main lobe
+    double scalloping_db;            // loss half a bin off centre
+};
+
+// Table of the header, N = 156
+static const Leakage EXPECTED[WINDOW_TYPES] = {
+    {1.000, 1.00, -13.3, 3.92},
+    {0.497, 1.51, -31.5, 1.41},
+    {0.537, 1.37, -42.6, 1.74},
+    {0.356, 2.02, -92.0, 0.81},
+    {0.214, 3.79, -91.9, 0.01},
+};
+
+static double response(const float* w, size_t k) {
+    const double pi = 3.14159265358979323846;
+    double re = 0.0, im = 0.0;
+    for (size_t i = 0; i < N; i++) {
+        re += w[i] * cos(2.0 * pi * k * i / (N * PAD));
+        im -= w[i] * sin(2.0 * pi * k * i / (N * PAD));
+    }
+    return sqrt(re * re + im * im);
+}
+
+static Leakage measure(WindowType type) {
+    const Table<N> t = make_table<N>(type);
+    Leakage l;
+    l.coherent_gain = t.sum / N;
+    l.enbw_bins = N * (double)t.power / ((double)t.sum * t.sum);
+
+    // Magnitude response over half the band; the main lobe ends at the first
+    // minimum past half its height (the flat-top's ripples on top are not nulls)
+    std::vector<double> mag(N * PAD / 2);
+    for (size_t k = 0; k < mag.size(); k++) mag[k] = response(t.coeffs, k);
+    size_t k = 1;
+    while (k + 1 < mag.size() && mag[k] > mag[0] / 2) k++;
+    while (k + 1 < mag.size() && mag[k + 1] < mag[k]) k++;
+    double sidelobe = 0.0;
+    for (; k < mag.size(); k++) sidelobe = fmax(sidelobe, mag[k]);
+
+    l.sidelobe_db = 20.0 * log10(sidelobe / mag[0]);
+    l.scalloping_db = -20.0 * log10(mag[PAD / 2] / mag[0]);
+    return l;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_leakage_matches_the_header(void) {
+    for (int type = 0; type < WINDOW_TYPES; type++) {
+        Leakage l = measure((WindowType)type);
+        TEST_ASSERT_FLOAT_WITHIN(0.0005, EXPECTED[type].coherent_gain, l.coherent_gain);
+        TEST_ASSERT_FLOAT_WITHIN(0.005, EXPECTED[type].enbw_bins, l.enbw_bins);
+        TEST_ASSERT_FLOAT_WITHIN(0.05, EXPECTED[type].sidelobe_db, l.sidelobe_db);
+        TEST_ASSERT_FLOAT_WITHIN(0.005, EXPECTED[type].scalloping_db, l.scalloping_db);
+    }
+}
+
+void test_tables_are_symmetric(void) {
+    for (int type = 0; type < WINDOW_TYPES; type++) {
+        const Table<N> t = make_table<N>((WindowType)type);
+        for (size_t i = 0; i < N / 2; i++) TEST_ASSERT_FLOAT_WITHIN(1e-6f, t.coeffs[i], t.coeffs[N - 1 - i]);
+    }
+    const Table<N> hann = make_table<N>(WINDOW_HANN);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7f, 0.0f, hann.coeffs[0]);
+    TEST_ASSERT_FLOAT_WITHIN(2e-4f, 1.0f, hann.coeffs[N / 2]);    // even N: no sample on the peak
+}
+
+// Each stage gets its configured window, nothing else is linked
+void test_only_configured_stages_have_tables(void) {
+    const struct {
+        WindowType type;
+        size_t length;
+    } stages[] = {
+        {ANALYSIS_WINDOW, WINDOW_SIZE},
+        {MULTIRES_SHORT_WINDOW, MULTIRES_SHORT_SAMPLES},
+        {MULTIRES_LONG_WINDOW, MULTIRES_LONG_SAMPLES},
+        {ZOOM_WINDOW, ZOOM_WINDOW_SAMPLES},
+    };
+    for (const auto& stage : stages) {
+        WindowView v = window_get(stage.type, stage.length);
+        TEST_ASSERT_NOT_NULL(v.coeffs);
+        TEST_ASSERT_EQUAL(stage.length, v.length);
+
+        double sum = 0.0;
+        for (size_t i = 0; i < v.length; i++) sum += v.coeffs[i];
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, (float)sum, v.sum);
+    }
+    const WindowType unused = (ANALYSIS_WINDOW == WINDOW_RECT) ? WINDOW_FLAT_TOP : WINDOW_RECT;
+    TEST_ASSERT_NULL(window_get(unused, WINDOW_SIZE).coeffs);
+    TEST_ASSERT_NULL(window_get(ANALYSIS_WINDOW, WINDOW_SIZE + 1).coeffs);
+    TEST_ASSERT_NULL(window_get(WINDOW_TYPES, WINDOW_SIZE).coeffs);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_leakage_matches_the_header);
+    RUN_TEST(test_tables_are_symmetric);
+    RUN_TEST(test_only_configured_stages_have_tables);
+    return UNITY_END();
+}